@@ -0,0 +1,459 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <BinaryLog.cpp> and
+Class <BinaryLog> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "BinaryLog.h"
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+
+ThreadRings<BinaryLogRecord, BINARYLOG_RING_SIZE, BINARYLOG_MAX_THREADS> BinaryLog::m_rings;
+const char* volatile BinaryLog::m_formats[BINARYLOG_MAX_FORMATS] = {NULL};
+volatile LONG BinaryLog::m_formatCount = 0;
+volatile LONG BinaryLog::m_droppedCount = 0;
+
+namespace
+{
+	/**
+	* Record of a drain, with the thread it was written on.
+	***/
+	struct DrainedRecord
+	{
+		DWORD threadId;
+		BinaryLogRecord record;
+	};
+
+	/**
+	* Drain records are ordered by time across threads.
+	***/
+	bool EarlierRecord(const DrainedRecord& a, const DrainedRecord& b)
+	{
+		return a.record.time < b.record.time;
+	}
+
+	/**
+	* Locks, format registration (rare) and draining (writer thread or Flush()).
+	***/
+	struct LogLocks
+	{
+		LogLocks() { InitializeCriticalSection(&registration); InitializeCriticalSection(&drain); }
+		~LogLocks() { DeleteCriticalSection(&registration); DeleteCriticalSection(&drain); }
+		CRITICAL_SECTION registration;
+		CRITICAL_SECTION drain;
+	} locks;
+
+	/**
+	* Writer thread handle and its stop event, started with the first record (registration lock).
+	***/
+	HANDLE volatile hWriterThread = NULL;
+	HANDLE hWriterStopEvent = NULL;
+
+	/**
+	* Log file output (see SetFileOutput()), log file, records drained and performance counter 
+	* values (drain lock only).
+	***/
+	bool fileOutput = BINARYLOG_FILE_OUTPUT_DEFAULT;
+	bool fileCreated = false;
+	FILE* pLogFile = NULL;
+	std::vector<DrainedRecord> drainedRecords;
+	LONGLONG startTime = 0;
+	double toSeconds = 0.0;
+	LONG reportedDroppedCount = 0;
+}
+
+/**
+* Registers a format, called once per call site (see BLOG_FORMAT_ID).
+* Registering the same format pointer again returns the same id.
+* @return The format id, 0 if no more formats can be registered (records with id 0 are ignored).
+***/
+UINT BinaryLog::RegisterFormat(const char* format)
+{
+	EnterCriticalSection(&locks.registration);
+
+	UINT formatId = 0;
+	for (LONG i = 0; i < m_formatCount; i++)
+	{
+		if (m_formats[i] == format)
+		{
+			formatId = i + 1;
+			break;
+		}
+	}
+
+	if ((formatId == 0) && (m_formatCount < BINARYLOG_MAX_FORMATS))
+	{
+		m_formats[m_formatCount] = format;
+		// publish (volatile write, release)
+		m_formatCount = m_formatCount + 1;
+		formatId = m_formatCount;
+	}
+
+	if (startTime == 0)
+	{
+		LARGE_INTEGER now, frequency;
+		QueryPerformanceCounter(&now);
+		QueryPerformanceFrequency(&frequency);
+		startTime = now.QuadPart;
+		toSeconds = 1.0 / (double)frequency.QuadPart;
+	}
+
+	LeaveCriticalSection(&locks.registration);
+	return formatId;
+}
+
+/**
+* Writes a record to the ring of the calling thread.
+* Lock free, the record is dropped if the ring of the thread is full.
+***/
+void BinaryLog::Write(UINT formatId, UINT argCount, UINT64 arg0, UINT64 arg1, UINT64 arg2, UINT64 arg3)
+{
+	if (formatId == 0)
+		return;
+
+	if (!hWriterThread)
+		StartWriter();
+
+	ThreadRing<BinaryLogRecord, BINARYLOG_RING_SIZE>* pRing = m_rings.Get();
+	BinaryLogRecord* pRecord = pRing ? pRing->BeginWrite() : NULL;
+	if (!pRecord)
+	{
+		InterlockedIncrement(&m_droppedCount);
+		return;
+	}
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	pRecord->time = now.QuadPart;
+	pRecord->formatId = formatId;
+	pRecord->argCount = argCount;
+	pRecord->args[0] = arg0;
+	pRecord->args[1] = arg1;
+	pRecord->args[2] = arg2;
+	pRecord->args[3] = arg3;
+	pRing->EndWrite();
+}
+
+/**
+* Drains and writes all records now.
+***/
+void BinaryLog::Flush()
+{
+	Drain();
+}
+
+/**
+* Stops and joins the writer thread, writes the remaining records and closes the log file
+* (device release, before the process may exit). Logging goes on, the next record starts the 
+* writer thread again.
+***/
+void BinaryLog::Shutdown()
+{
+	EnterCriticalSection(&locks.registration);
+	HANDLE hThread = hWriterThread;
+	HANDLE hStopEvent = hWriterStopEvent;
+	hWriterThread = NULL;
+	hWriterStopEvent = NULL;
+	LeaveCriticalSection(&locks.registration);
+
+	if (hThread)
+	{
+		SetEvent(hStopEvent);
+		WaitForSingleObject(hThread, INFINITE);
+		CloseHandle(hThread);
+		CloseHandle(hStopEvent);
+	}
+
+	Drain();
+
+	EnterCriticalSection(&locks.drain);
+	if (pLogFile)
+	{
+		fclose(pLogFile);
+		pLogFile = NULL;
+	}
+	LeaveCriticalSection(&locks.drain);
+}
+
+/**
+* Sets whether records are appended to vireio_log.txt or written to the debug output.
+* Default is BINARYLOG_FILE_OUTPUT_DEFAULT, the file is only created once a record is written to it.
+***/
+void BinaryLog::SetFileOutput(bool enable)
+{
+	EnterCriticalSection(&locks.drain);
+	fileOutput = enable;
+	if (!fileOutput && pLogFile)
+	{
+		fclose(pLogFile);
+		pLogFile = NULL;
+	}
+	LeaveCriticalSection(&locks.drain);
+}
+
+/**
+* Formats a record with its printf style format.
+* Supports flags, width and precision, the conversions d i u o x X c e E f g G s p and the
+* ll / I64 length modifiers (other length modifiers are ignored).
+* @param format The registered format.
+* @param record The record.
+* @param buffer [out] The text, always zero terminated.
+* @param bufferSize Size of the buffer.
+***/
+void BinaryLog::Format(const char* format, const BinaryLogRecord& record, char* buffer, size_t bufferSize)
+{
+	size_t length = 0;
+	UINT arg = 0;
+	const char* p = format;
+
+	while (*p && (length + 1 < bufferSize))
+	{
+		if (*p != '%')
+		{
+			buffer[length++] = *p++;
+			continue;
+		}
+		if (p[1] == '%')
+		{
+			buffer[length++] = '%';
+			p += 2;
+			continue;
+		}
+
+		// flags, width, precision
+		char spec[32];
+		size_t specLength = 0;
+		spec[specLength++] = *p++;
+		while (*p && strchr("-+ #0123456789.", *p) && (specLength < 24))
+			spec[specLength++] = *p++;
+
+		// length modifiers
+		bool wide = false;
+		while (*p && strchr("hlLI", *p))
+		{
+			if ((p[0] == 'l') && (p[1] == 'l'))
+			{
+				wide = true;
+				p++;
+			}
+			else if ((p[0] == 'I') && (p[1] == '6') && (p[2] == '4'))
+			{
+				wide = true;
+				p += 2;
+			}
+			else if ((p[0] == 'I') && (p[1] == '3') && (p[2] == '2'))
+				p += 2;
+			else if (p[0] == 'I')
+				wide = (sizeof(void*) == 8);
+			p++;
+		}
+
+		char conversion = *p;
+		if (!conversion)
+			break;
+		p++;
+
+		UINT64 value = (arg < record.argCount) ? record.args[arg] : 0;
+		arg++;
+
+		if (wide && strchr("diuoxX", conversion))
+		{
+			spec[specLength++] = 'I';
+			spec[specLength++] = '6';
+			spec[specLength++] = '4';
+		}
+		spec[specLength++] = conversion;
+		spec[specLength] = 0;
+
+		char* pOut = buffer + length;
+		size_t outSize = bufferSize - length;
+		int written;
+		switch (conversion)
+		{
+		case 'd':
+		case 'i':
+			if (wide)
+				written = _snprintf_s(pOut, outSize, _TRUNCATE, spec, (LONGLONG)value);
+			else
+				written = _snprintf_s(pOut, outSize, _TRUNCATE, spec, (int)value);
+			break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			if (wide)
+				written = _snprintf_s(pOut, outSize, _TRUNCATE, spec, value);
+			else
+				written = _snprintf_s(pOut, outSize, _TRUNCATE, spec, (unsigned int)value);
+			break;
+		case 'c':
+			written = _snprintf_s(pOut, outSize, _TRUNCATE, spec, (int)value);
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'g':
+		case 'G':
+			{
+				double real;
+				memcpy(&real, &value, sizeof(real));
+				written = _snprintf_s(pOut, outSize, _TRUNCATE, spec, real);
+			}
+			break;
+		case 's':
+			{
+				const char* text = (const char*)(UINT_PTR)value;
+				written = _snprintf_s(pOut, outSize, _TRUNCATE, spec, text ? text : "(null)");
+			}
+			break;
+		case 'p':
+			written = _snprintf_s(pOut, outSize, _TRUNCATE, spec, (void*)(UINT_PTR)value);
+			break;
+		default:
+			// unknown conversion, keep the text
+			written = _snprintf_s(pOut, outSize, _TRUNCATE, "%s", spec);
+			break;
+		}
+
+		// truncated
+		if (written < 0)
+		{
+			length = bufferSize - 1;
+			break;
+		}
+		length += written;
+	}
+
+	buffer[length] = 0;
+}
+
+/**
+* Starts the writer thread (if not running).
+***/
+void BinaryLog::StartWriter()
+{
+	EnterCriticalSection(&locks.registration);
+
+	if (!hWriterThread)
+	{
+		hWriterStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		if (hWriterStopEvent)
+		{
+			hWriterThread = CreateThread(NULL, 0, WriterThread, hWriterStopEvent, 0, NULL);
+			if (hWriterThread)
+				SetThreadPriority(hWriterThread, THREAD_PRIORITY_BELOW_NORMAL);
+			else
+			{
+				CloseHandle(hWriterStopEvent);
+				hWriterStopEvent = NULL;
+			}
+		}
+	}
+
+	LeaveCriticalSection(&locks.registration);
+}
+
+/**
+* Reads all records written since the last drain and writes them (ordered by time) to 
+* vireio_log.txt or the debug output.
+***/
+void BinaryLog::Drain()
+{
+	EnterCriticalSection(&locks.drain);
+
+	drainedRecords.clear();
+	m_rings.DrainAll([](DWORD threadId, const BinaryLogRecord& record)
+	{
+		DrainedRecord drained;
+		drained.threadId = threadId;
+		drained.record = record;
+		drainedRecords.push_back(drained);
+	});
+
+	LONG droppedCount = m_droppedCount;
+	if (!drainedRecords.empty() || (droppedCount != reportedDroppedCount))
+	{
+		// created once per process, appended to after a shutdown
+		if (fileOutput && !pLogFile && ((fopen_s(&pLogFile, "vireio_log.txt", fileCreated ? "a" : "w") != 0) || !pLogFile))
+		{
+			OutputDebugString("BinaryLog: Failed to open log file\n");
+			pLogFile = NULL;
+		}
+		if (pLogFile)
+			fileCreated = true;
+
+		std::stable_sort(drainedRecords.begin(), drainedRecords.end(), EarlierRecord);
+
+		char text[1024];
+		char line[1100];
+		for (std::vector<DrainedRecord>::iterator it = drainedRecords.begin(); it != drainedRecords.end(); ++it)
+		{
+			UINT formatId = it->record.formatId;
+			const char* format = (formatId <= (UINT)m_formatCount) ? m_formats[formatId - 1] : "(unknown format)";
+			Format(format, it->record, text, sizeof(text));
+
+			size_t length = strlen(text);
+			if ((length > 0) && (text[length - 1] == '\n'))
+				text[length - 1] = 0;
+
+			sprintf_s(line, "%12.6f [%5u] %s\n", (double)(it->record.time - startTime) * toSeconds, it->threadId, text);
+			if (pLogFile)
+				fputs(line, pLogFile);
+			else
+				OutputDebugString(line);
+		}
+
+		if (droppedCount != reportedDroppedCount)
+		{
+			sprintf_s(line, "BinaryLog: %d records dropped\n", droppedCount - reportedDroppedCount);
+			if (pLogFile)
+				fputs(line, pLogFile);
+			else
+				OutputDebugString(line);
+			reportedDroppedCount = droppedCount;
+		}
+
+		if (pLogFile)
+			fflush(pLogFile);
+	}
+
+	LeaveCriticalSection(&locks.drain);
+}
+
+/**
+* Writer thread : drains the rings every BINARYLOG_DRAIN_MS until the stop event is set.
+* @param pParam The stop event.
+***/
+DWORD WINAPI BinaryLog::WriterThread(LPVOID pParam)
+{
+	HANDLE hStopEvent = (HANDLE)pParam;
+	while (WaitForSingleObject(hStopEvent, BINARYLOG_DRAIN_MS) == WAIT_TIMEOUT)
+		Drain();
+	return 0;
+}
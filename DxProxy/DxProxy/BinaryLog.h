@@ -0,0 +1,148 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <BinaryLog.h> and
+Class <BinaryLog> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef BINARYLOG_H_INCLUDED
+#define BINARYLOG_H_INCLUDED
+
+#include <windows.h>
+#include <string.h>
+#include "ThreadRings.h"
+
+/**
+* Records per thread ring buffer (power of two).
+***/
+#define BINARYLOG_RING_SIZE 4096
+/**
+* Maximum number of threads logging.
+***/
+#define BINARYLOG_MAX_THREADS 32
+/**
+* Maximum number of registered formats.
+***/
+#define BINARYLOG_MAX_FORMATS 1024
+/**
+* Maximum number of arguments per record.
+***/
+#define BINARYLOG_MAX_ARGS 4
+/**
+* Writer thread drain interval.
+***/
+#define BINARYLOG_DRAIN_MS 50
+/**
+* Whether records go to vireio_log.txt by default (debug builds), debug output otherwise.
+* See BinaryLog::SetFileOutput().
+***/
+#ifdef _DEBUG
+#define BINARYLOG_FILE_OUTPUT_DEFAULT true
+#else
+#define BINARYLOG_FILE_OUTPUT_DEFAULT false
+#endif
+
+/**
+* One fixed size log record : format id and raw arguments, formatted later on the writer thread.
+***/
+struct BinaryLogRecord
+{
+	LONGLONG time;
+	UINT formatId;
+	UINT argCount;
+	UINT64 args[BINARYLOG_MAX_ARGS];
+};
+
+/**
+* Binary low overhead logger.
+* Call sites register their printf style format once (BLOG macros, id kept in a static) and then 
+* only write the format id, a timestamp and up to four raw arguments into the ring buffer of the 
+* calling thread (single producer, single consumer, no locks, no allocation, no string building).
+* A writer thread drains the rings every BINARYLOG_DRAIN_MS, formats the records and appends them
+* to vireio_log.txt (if file output is on, see SetFileOutput()) or writes them to the debug output.
+* Records are dropped (and counted) if a ring is full. Shutdown() stops the writer thread, it is
+* started again by the next record.
+* String arguments (%s) are stored as pointers and must be literals or otherwise never freed.
+*/
+class BinaryLog
+{
+public:
+	/*** BinaryLog public methods ***/
+	static UINT RegisterFormat(const char* format);
+	static void Write(UINT formatId, UINT argCount, UINT64 arg0, UINT64 arg1, UINT64 arg2, UINT64 arg3);
+	static void Flush();
+	static void Shutdown();
+	static void SetFileOutput(bool fileOutput);
+	static LONG GetDroppedCount() { return m_droppedCount; }
+	static void Format(const char* format, const BinaryLogRecord& record, char* buffer, size_t bufferSize);
+
+private:
+	/*** BinaryLog private methods ***/
+	static void StartWriter();
+	static void Drain();
+	static DWORD WINAPI WriterThread(LPVOID pParam);
+
+	/**
+	* Record rings of the logging threads, read by the writer (under the drain lock) only.
+	***/
+	static ThreadRings<BinaryLogRecord, BINARYLOG_RING_SIZE, BINARYLOG_MAX_THREADS> m_rings;
+	/**
+	* Registered formats, index is the format id - 1.
+	***/
+	static const char* volatile m_formats[BINARYLOG_MAX_FORMATS];
+	static volatile LONG m_formatCount;
+	/**
+	* Records dropped (ring full or too many threads).
+	***/
+	static volatile LONG m_droppedCount;
+};
+
+/**
+* Raw argument conversion, signed values are sign extended, floats stored as double.
+***/
+inline UINT64 BinaryLogArg(int value) { return (UINT64)(LONGLONG)value; }
+inline UINT64 BinaryLogArg(long value) { return (UINT64)(LONGLONG)value; }
+inline UINT64 BinaryLogArg(LONGLONG value) { return (UINT64)value; }
+inline UINT64 BinaryLogArg(unsigned int value) { return (UINT64)value; }
+inline UINT64 BinaryLogArg(unsigned long value) { return (UINT64)value; }
+inline UINT64 BinaryLogArg(UINT64 value) { return value; }
+inline UINT64 BinaryLogArg(bool value) { return value ? 1 : 0; }
+inline UINT64 BinaryLogArg(double value) { UINT64 bits; memcpy(&bits, &value, sizeof(bits)); return bits; }
+inline UINT64 BinaryLogArg(float value) { return BinaryLogArg((double)value); }
+inline UINT64 BinaryLogArg(const char* value) { return (UINT64)(UINT_PTR)value; }
+inline UINT64 BinaryLogArg(const void* value) { return (UINT64)(UINT_PTR)value; }
+
+/**
+* Log macros, the format is registered on first use.
+***/
+#define BLOG_FORMAT_ID(format) static volatile LONG blogFormatId = 0; if (!blogFormatId) blogFormatId = BinaryLog::RegisterFormat(format)
+#define BLOG0(format) do { BLOG_FORMAT_ID(format); BinaryLog::Write(blogFormatId, 0, 0, 0, 0, 0); } while (0)
+#define BLOG1(format, a) do { BLOG_FORMAT_ID(format); BinaryLog::Write(blogFormatId, 1, BinaryLogArg(a), 0, 0, 0); } while (0)
+#define BLOG2(format, a, b) do { BLOG_FORMAT_ID(format); BinaryLog::Write(blogFormatId, 2, BinaryLogArg(a), BinaryLogArg(b), 0, 0); } while (0)
+#define BLOG3(format, a, b, c) do { BLOG_FORMAT_ID(format); BinaryLog::Write(blogFormatId, 3, BinaryLogArg(a), BinaryLogArg(b), BinaryLogArg(c), 0); } while (0)
+#define BLOG4(format, a, b, c, d) do { BLOG_FORMAT_ID(format); BinaryLog::Write(blogFormatId, 4, BinaryLogArg(a), BinaryLogArg(b), BinaryLogArg(c), BinaryLogArg(d)); } while (0)
+
+#endif
@@ -0,0 +1,345 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CompositionStates.cpp> and
+Class <CompositionStates> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "CompositionStates.h"
+#include <d3dx9.h>
+
+/**
+* Constructor.
+***/
+CompositionStates::CompositionStates() :
+	m_pActualDevice(NULL),
+	m_deviceStateFlags(0),
+	m_pStateBlock(NULL),
+	m_pLastVertexShader(NULL),
+	m_pLastPixelShader(NULL),
+	m_pLastTexture(NULL),
+	m_pLastTexture1(NULL),
+	m_pLastVertexDeclaration(NULL),
+	m_pLastRenderTarget0(NULL),
+	m_pLastRenderTarget1(NULL),
+	m_tssColorOp(0),
+	m_tssColorArg1(0),
+	m_tssAlphaOp(0),
+	m_tssAlphaArg1(0),
+	m_tssConstant(0),
+	m_rsAlphaEnable(0),
+	m_rsZEnable(0),
+	m_rsZWriteEnable(0),
+	m_rsSrgbEnable(0),
+	m_ssSrgb(0),
+	m_ssSrgb1(0),
+	m_ssAddressU(0),
+	m_ssAddressV(0),
+	m_ssAddressW(0),
+	m_ssMag0(0),
+	m_ssMag1(0),
+	m_ssMin0(0),
+	m_ssMin1(0),
+	m_ssMip0(0),
+	m_ssMip1(0)
+{
+}
+
+/**
+* Destructor, releases the state block and saved objects.
+***/
+CompositionStates::~CompositionStates()
+{
+	ReleaseEverything();
+}
+
+/**
+* Sets the actual device the states are set on.
+* @param deviceStateFlags Device state flags of the game type (@see ProxyHelper::DeviceStateFlags).
+***/
+void CompositionStates::Init(IDirect3DDevice9* pActualDevice, int deviceStateFlags)
+{
+	m_pActualDevice = pActualDevice;
+	m_deviceStateFlags = deviceStateFlags;
+}
+
+/**
+* Releases the state block and any saved objects not restored yet.
+***/
+void CompositionStates::ReleaseEverything()
+{
+	if (m_pStateBlock)
+		m_pStateBlock->Release();
+	m_pStateBlock = NULL;
+
+	ReleaseSavedObjects();
+}
+
+/**
+* Releases the objects read by SaveSelectedStates().
+***/
+void CompositionStates::ReleaseSavedObjects()
+{
+	if (m_pLastVertexShader)
+		m_pLastVertexShader->Release();
+	m_pLastVertexShader = NULL;
+
+	if (m_pLastPixelShader)
+		m_pLastPixelShader->Release();
+	m_pLastPixelShader = NULL;
+
+	if (m_pLastTexture)
+		m_pLastTexture->Release();
+	m_pLastTexture = NULL;
+
+	if (m_pLastTexture1)
+		m_pLastTexture1->Release();
+	m_pLastTexture1 = NULL;
+
+	if (m_pLastVertexDeclaration)
+		m_pLastVertexDeclaration->Release();
+	m_pLastVertexDeclaration = NULL;
+
+	if (m_pLastRenderTarget0)
+		m_pLastRenderTarget0->Release();
+	m_pLastRenderTarget0 = NULL;
+
+	if (m_pLastRenderTarget1)
+		m_pLastRenderTarget1->Release();
+	m_pLastRenderTarget1 = NULL;
+}
+
+/**
+* Set all states and settings for fullscreen render.
+* Also sets identity world, view and projection matrix. 
+***/
+void CompositionStates::SetFullscreenStates()
+{
+	D3DXMATRIX	identity;
+	m_pActualDevice->SetTransform(D3DTS_WORLD, D3DXMatrixIdentity(&identity));
+	m_pActualDevice->SetTransform(D3DTS_VIEW, &identity);
+	m_pActualDevice->SetTransform(D3DTS_PROJECTION, &identity);
+	m_pActualDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	m_pActualDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	m_pActualDevice->SetRenderState(D3DRS_ZENABLE,  D3DZB_TRUE);
+	m_pActualDevice->SetRenderState(D3DRS_ZWRITEENABLE, TRUE);
+	m_pActualDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, FALSE);
+	m_pActualDevice->SetRenderState(D3DRS_ALPHATESTENABLE, FALSE);// This fixed interior or car not being drawn in rFactor
+	m_pActualDevice->SetRenderState(D3DRS_STENCILENABLE, FALSE); 
+
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_ALPHAARG1, D3DTA_CONSTANT);
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_CONSTANT, 0xffffffff);
+
+	m_pActualDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, FALSE);
+	m_pActualDevice->SetRenderState(D3DRS_ZENABLE, D3DZB_TRUE);
+	m_pActualDevice->SetRenderState(D3DRS_ZWRITEENABLE, TRUE);
+	m_pActualDevice->SetRenderState(D3DRS_ALPHATESTENABLE, FALSE);  
+
+	if (m_deviceStateFlags & 2)
+	{
+		m_pActualDevice->SetSamplerState(0, D3DSAMP_SRGBTEXTURE, m_ssSrgb);
+		m_pActualDevice->SetSamplerState(1, D3DSAMP_SRGBTEXTURE, m_ssSrgb);
+	}
+	else
+	{
+		//Borderlands Dark Eye FIX
+		m_pActualDevice->SetSamplerState(0, D3DSAMP_SRGBTEXTURE, 0);
+		m_pActualDevice->SetSamplerState(1, D3DSAMP_SRGBTEXTURE, 0);
+	}
+	
+
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSU, D3DTADDRESS_CLAMP);
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSV, D3DTADDRESS_CLAMP);
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSW, D3DTADDRESS_CLAMP);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_ADDRESSU, D3DTADDRESS_CLAMP);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_ADDRESSV, D3DTADDRESS_CLAMP);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_ADDRESSW, D3DTADDRESS_CLAMP);
+
+	// TODO Need to check m_pActualDevice capabilities if we want a prefered order of fallback rather than 
+	// whatever the default is being used when a mode isn't supported.
+	// Example - GeForce 660 doesn't appear to support D3DTEXF_ANISOTROPIC on the MAGFILTER (at least
+	// according to the spam of error messages when running with the directx debug runtime)
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_ANISOTROPIC);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_MAGFILTER, D3DTEXF_ANISOTROPIC);
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_ANISOTROPIC);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_MINFILTER, D3DTEXF_ANISOTROPIC);
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_NONE);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_MIPFILTER, D3DTEXF_NONE);
+
+	//m_pActualDevice->SetTexture(0, NULL);
+	//m_pActualDevice->SetTexture(1, NULL);
+
+	m_pActualDevice->SetVertexShader(NULL);
+	m_pActualDevice->SetPixelShader(NULL);
+
+	m_pActualDevice->SetVertexDeclaration(NULL);
+
+	//It's a Direct3D9 error when using the debug runtine to set RenderTarget 0 to NULL
+	//m_pActualDevice->SetRenderTarget(0, NULL);
+	m_pActualDevice->SetRenderTarget(1, NULL);
+	m_pActualDevice->SetRenderTarget(2, NULL);
+	m_pActualDevice->SetRenderTarget(3, NULL);
+}
+
+/**
+* Reads the game states changed by the fullscreen render one by one.
+* Workaround for Half Life 2 for now.
+***/
+void CompositionStates::SaveSelectedStates()
+{
+	m_pActualDevice->GetTextureStageState(0, D3DTSS_COLOROP, &m_tssColorOp);
+	m_pActualDevice->GetTextureStageState(0, D3DTSS_COLORARG1, &m_tssColorArg1);
+	m_pActualDevice->GetTextureStageState(0, D3DTSS_ALPHAOP, &m_tssAlphaOp);
+	m_pActualDevice->GetTextureStageState(0, D3DTSS_ALPHAARG1, &m_tssAlphaArg1);
+	m_pActualDevice->GetTextureStageState(0, D3DTSS_CONSTANT, &m_tssConstant);
+
+	m_pActualDevice->GetRenderState(D3DRS_ALPHABLENDENABLE, &m_rsAlphaEnable);
+	m_pActualDevice->GetRenderState(D3DRS_ZWRITEENABLE, &m_rsZWriteEnable);
+	m_pActualDevice->GetRenderState(D3DRS_ZENABLE, &m_rsZEnable);
+	m_pActualDevice->GetRenderState(D3DRS_SRGBWRITEENABLE, &m_rsSrgbEnable);
+
+	m_pActualDevice->GetSamplerState(0, D3DSAMP_SRGBTEXTURE, &m_ssSrgb);
+	m_pActualDevice->GetSamplerState(1, D3DSAMP_SRGBTEXTURE, &m_ssSrgb1);
+	
+	m_pActualDevice->GetSamplerState(0, D3DSAMP_ADDRESSU, &m_ssAddressU);
+	m_pActualDevice->GetSamplerState(0, D3DSAMP_ADDRESSV, &m_ssAddressV);
+	m_pActualDevice->GetSamplerState(0, D3DSAMP_ADDRESSW, &m_ssAddressW);
+
+	m_pActualDevice->GetSamplerState(0, D3DSAMP_MAGFILTER, &m_ssMag0);
+	m_pActualDevice->GetSamplerState(1, D3DSAMP_MAGFILTER, &m_ssMag1);
+	m_pActualDevice->GetSamplerState(0, D3DSAMP_MINFILTER, &m_ssMin0);
+	m_pActualDevice->GetSamplerState(1, D3DSAMP_MINFILTER, &m_ssMin1);
+	m_pActualDevice->GetSamplerState(0, D3DSAMP_MIPFILTER, &m_ssMip0);
+	m_pActualDevice->GetSamplerState(1, D3DSAMP_MIPFILTER, &m_ssMip1);
+
+	m_pActualDevice->GetTexture(0, &m_pLastTexture);
+	m_pActualDevice->GetTexture(1, &m_pLastTexture1);
+
+	m_pActualDevice->GetVertexShader(&m_pLastVertexShader);
+	m_pActualDevice->GetPixelShader(&m_pLastPixelShader);
+
+	m_pActualDevice->GetVertexDeclaration(&m_pLastVertexDeclaration);
+
+	m_pActualDevice->GetRenderTarget(0, &m_pLastRenderTarget0);
+	m_pActualDevice->GetRenderTarget(1, &m_pLastRenderTarget1);
+}
+
+/**
+* Sets the states read by SaveSelectedStates() again, releases the saved objects.
+* Workaround for Half Life 2 for now.
+***/
+void CompositionStates::RestoreSelectedStates()
+{
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_COLOROP, m_tssColorOp);
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_COLORARG1, m_tssColorArg1);
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, m_tssAlphaOp);
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_ALPHAARG1, m_tssAlphaArg1);
+	m_pActualDevice->SetTextureStageState(0, D3DTSS_CONSTANT, m_tssConstant);
+
+	m_pActualDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, m_rsAlphaEnable);
+	m_pActualDevice->SetRenderState(D3DRS_ZWRITEENABLE, m_rsZWriteEnable);
+	m_pActualDevice->SetRenderState(D3DRS_ZENABLE, m_rsZEnable);
+	m_pActualDevice->SetRenderState(D3DRS_SRGBWRITEENABLE, m_rsSrgbEnable);
+
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_SRGBTEXTURE, m_ssSrgb);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_SRGBTEXTURE, m_ssSrgb1);
+
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSU, m_ssAddressU);
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSV, m_ssAddressV);
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSW, m_ssAddressW);
+
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, m_ssMag0);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_MAGFILTER, m_ssMag1);
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_MINFILTER, m_ssMin0);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_MINFILTER, m_ssMin1);
+	m_pActualDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, m_ssMip0);
+	m_pActualDevice->SetSamplerState(1, D3DSAMP_MIPFILTER, m_ssMip1);
+
+	m_pActualDevice->SetTexture(0, m_pLastTexture);
+	m_pActualDevice->SetTexture(1, m_pLastTexture1);
+	m_pActualDevice->SetVertexShader(m_pLastVertexShader);
+	m_pActualDevice->SetPixelShader(m_pLastPixelShader);
+	m_pActualDevice->SetVertexDeclaration(m_pLastVertexDeclaration);
+	m_pActualDevice->SetRenderTarget(0, m_pLastRenderTarget0);
+	m_pActualDevice->SetRenderTarget(1, m_pLastRenderTarget1);
+
+	ReleaseSavedObjects();
+}
+
+/**
+* Starts recording the state block, records the fullscreen states.
+* Record any further states changed by the draw before calling EndRecord().
+* @return False if the device could not start recording.
+***/
+bool CompositionStates::BeginRecord()
+{
+	if (FAILED(m_pActualDevice->BeginStateBlock())) {
+		OutputDebugString("BeginStateBlock failed\n");
+		return false;
+	}
+
+	SetFullscreenStates();
+	return true;
+}
+
+/**
+* Ends recording the state block.
+* @return False if the state block could not be created.
+***/
+bool CompositionStates::EndRecord()
+{
+	if (m_pStateBlock)
+		m_pStateBlock->Release();
+	m_pStateBlock = NULL;
+
+	if (FAILED(m_pActualDevice->EndStateBlock(&m_pStateBlock))) {
+		OutputDebugString("EndStateBlock failed\n");
+		m_pStateBlock = NULL;
+		return false;
+	}
+	return true;
+}
+
+/**
+* Captures the current game states into the state block (if recorded).
+***/
+void CompositionStates::CaptureStateBlock()
+{
+	if (m_pStateBlock)
+		m_pStateBlock->Capture();
+}
+
+/**
+* Applies the game states captured last (if recorded).
+***/
+void CompositionStates::ApplyStateBlock()
+{
+	if (m_pStateBlock)
+		m_pStateBlock->Apply();
+}
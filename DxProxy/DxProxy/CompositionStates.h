@@ -0,0 +1,115 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CompositionStates.h> and
+Class <CompositionStates> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef COMPOSITIONSTATES_H_INCLUDED
+#define COMPOSITIONSTATES_H_INCLUDED
+
+#include <d3d9.h>
+
+/**
+* Device states of the stereo view composition.
+* Sets the states of the fullscreen render and saves and restores the game states around it, 
+* either with a state block recorded once (captured before and applied after each draw) or with
+* the selected states read and set one by one (for games that don't work with state blocks).
+* Only uses the actual device passed to Init().
+*/
+class CompositionStates
+{
+public:
+	CompositionStates();
+	virtual ~CompositionStates();
+
+	/*** CompositionStates public methods ***/
+	void Init(IDirect3DDevice9* pActualDevice, int deviceStateFlags);
+	void ReleaseEverything();
+	void SetFullscreenStates();
+	void SaveSelectedStates();
+	void RestoreSelectedStates();
+	bool BeginRecord();
+	bool EndRecord();
+	bool HasStateBlock() { return m_pStateBlock != NULL; }
+	void CaptureStateBlock();
+	void ApplyStateBlock();
+
+private:
+	/*** CompositionStates private methods ***/
+	void ReleaseSavedObjects();
+
+	/**
+	* The actual, unwrapped Direct3D Device (not add-refed).
+	***/
+	IDirect3DDevice9* m_pActualDevice;
+	/**
+	* Device state flags of the game type.
+	* @see ProxyHelper::DeviceStateFlags
+	***/
+	int m_deviceStateFlags;
+	/**
+	* Render state block.
+	* Recorded once with the states changed by drawing stereoscopic, captured before and applied after 
+	* each draw.
+	***/
+	IDirect3DStateBlock9* m_pStateBlock;
+	/**
+	* Saved game objects to be restored after drawing stereoscopic (selected states).
+	***/
+	IDirect3DVertexShader9* m_pLastVertexShader;
+	IDirect3DPixelShader9* m_pLastPixelShader;
+	IDirect3DBaseTexture9* m_pLastTexture;
+	IDirect3DBaseTexture9* m_pLastTexture1;
+	IDirect3DVertexDeclaration9* m_pLastVertexDeclaration;
+	IDirect3DSurface9* m_pLastRenderTarget0;
+	IDirect3DSurface9* m_pLastRenderTarget1;
+	/**
+	* Saved game states to be restored after drawing stereoscopic (selected states).
+	***/
+	DWORD m_tssColorOp;
+	DWORD m_tssColorArg1;
+	DWORD m_tssAlphaOp;
+	DWORD m_tssAlphaArg1;
+	DWORD m_tssConstant;
+	DWORD m_rsAlphaEnable;
+	DWORD m_rsZEnable;
+	DWORD m_rsZWriteEnable;
+	DWORD m_rsSrgbEnable;
+	DWORD m_ssSrgb;
+	DWORD m_ssSrgb1;
+	DWORD m_ssAddressU;
+	DWORD m_ssAddressV;
+	DWORD m_ssAddressW;
+	DWORD m_ssMag0;
+	DWORD m_ssMag1;
+	DWORD m_ssMin0;
+	DWORD m_ssMin1;
+	DWORD m_ssMip0;
+	DWORD m_ssMip1;
+};
+
+#endif
@@ -0,0 +1,170 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ConfigSaver.cpp> and
+Class <ConfigSaver> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#include "ConfigSaver.h"
+
+/**
+* Constructor.
+***/
+ConfigSaver::ConfigSaver() :
+	m_hThread(NULL),
+	m_hStopEvent(NULL),
+	m_hSubmitEvent(NULL),
+	m_hasPending(false),
+	m_saveCount(0)
+{
+	InitializeCriticalSection(&m_cs);
+}
+
+/**
+* Destructor, writes a pending snapshot.
+***/
+ConfigSaver::~ConfigSaver()
+{
+	Stop();
+	DeleteCriticalSection(&m_cs);
+}
+
+/**
+* Submits a configuration snapshot to be saved, replaces a snapshot not written yet.
+* Saves on the calling thread if the saver thread could not be started.
+***/
+void ConfigSaver::Submit(const ProxyConfig& config)
+{
+	if (!m_hThread && !Start())
+	{
+		ProxyConfig copy = config;
+		if (Write(copy))
+			InterlockedIncrement(&m_saveCount);
+		return;
+	}
+
+	EnterCriticalSection(&m_cs);
+	m_pending = config;
+	m_hasPending = true;
+	LeaveCriticalSection(&m_cs);
+
+	SetEvent(m_hSubmitEvent);
+}
+
+/**
+* Writes a pending snapshot and ends the saver thread.
+***/
+void ConfigSaver::Stop()
+{
+	if (m_hThread)
+	{
+		SetEvent(m_hStopEvent);
+		WaitForSingleObject(m_hThread, INFINITE);
+		CloseHandle(m_hThread);
+		m_hThread = NULL;
+	}
+	if (m_hStopEvent)
+	{
+		CloseHandle(m_hStopEvent);
+		m_hStopEvent = NULL;
+	}
+	if (m_hSubmitEvent)
+	{
+		CloseHandle(m_hSubmitEvent);
+		m_hSubmitEvent = NULL;
+	}
+}
+
+/**
+* Writes a snapshot (saver thread). Override to redirect the save, overriding classes call Stop()
+* in their destructor.
+***/
+bool ConfigSaver::Write(ProxyConfig& config)
+{
+	ProxyHelper helper;
+	return helper.SaveConfig(config);
+}
+
+/**
+* Starts the saver thread.
+***/
+bool ConfigSaver::Start()
+{
+	m_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	m_hSubmitEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (m_hStopEvent && m_hSubmitEvent)
+		m_hThread = CreateThread(NULL, 0, SaveThread, this, 0, NULL);
+
+	if (!m_hThread)
+	{
+		OutputDebugString("ConfigSaver : Could not start the saver thread, saving synchronously\n");
+		Stop();
+		return false;
+	}
+	return true;
+}
+
+/**
+* Takes the pending snapshot.
+* @return False if there is none.
+***/
+bool ConfigSaver::TakePending(ProxyConfig* pConfig)
+{
+	EnterCriticalSection(&m_cs);
+	bool hasPending = m_hasPending;
+	if (hasPending)
+		*pConfig = m_pending;
+	m_hasPending = false;
+	LeaveCriticalSection(&m_cs);
+	return hasPending;
+}
+
+/**
+* Saver thread : writes the latest snapshot after each submit, and once more on stop.
+***/
+DWORD WINAPI ConfigSaver::SaveThread(LPVOID pParam)
+{
+	ConfigSaver* pSaver = (ConfigSaver*)pParam;
+	HANDLE handles[2] = {pSaver->m_hStopEvent, pSaver->m_hSubmitEvent};
+
+	for (;;)
+	{
+		DWORD result = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+
+		ProxyConfig config;
+		while (pSaver->TakePending(&config))
+		{
+			if (pSaver->Write(config))
+				InterlockedIncrement(&pSaver->m_saveCount);
+			else
+				OutputDebugString("ConfigSaver : Save failed\n");
+		}
+
+		if (result != WAIT_OBJECT_0 + 1)
+			return 0;
+	}
+}
@@ -0,0 +1,84 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ConfigSaver.h> and
+Class <ConfigSaver> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#ifndef CONFIGSAVER_H_INCLUDED
+#define CONFIGSAVER_H_INCLUDED
+
+#include <windows.h>
+#include "ProxyHelper.h"
+
+/**
+* Background configuration saver.
+* Submit() stores a snapshot of the game configuration and returns at once, the saver thread 
+* writes the latest snapshot (ProxyHelper::SaveConfig(), temporary file and rename). Snapshots
+* submitted while a save is running are coalesced to one save. Stop() writes a pending snapshot
+* before the thread ends, so no change is lost on exit.
+***/
+class ConfigSaver
+{
+public:
+	ConfigSaver();
+	virtual ~ConfigSaver();
+
+	/*** ConfigSaver public methods ***/
+	void Submit(const ProxyConfig& config);
+	void Stop();
+	LONG GetSaveCount() {return m_saveCount;}
+
+protected:
+	/*** ConfigSaver protected methods ***/
+	virtual bool Write(ProxyConfig& config);
+
+private:
+	/*** ConfigSaver private methods ***/
+	bool Start();
+	bool TakePending(ProxyConfig* pConfig);
+	static DWORD WINAPI SaveThread(LPVOID pParam);
+
+	/**
+	* Saver thread, its stop event and the submit event (auto reset).
+	***/
+	HANDLE m_hThread;
+	HANDLE m_hStopEvent;
+	HANDLE m_hSubmitEvent;
+	/**
+	* Latest snapshot not written yet, guarded by m_cs (never held during the write).
+	***/
+	CRITICAL_SECTION m_cs;
+	ProxyConfig m_pending;
+	bool m_hasPending;
+	/**
+	* Saves written.
+	***/
+	volatile LONG m_saveCount;
+};
+
+#endif
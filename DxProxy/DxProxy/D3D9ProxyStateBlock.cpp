@@ -45,19 +45,18 @@ D3D9ProxyStateBlock::D3D9ProxyStateBlock(IDirect3DStateBlock9* pActualStateBlock
 	BaseDirect3DStateBlock9(pActualStateBlock, pOwningDevice),
 	m_pWrappedDevice(pOwningDevice),
 	m_eCaptureMode(type),
-	m_storedTextureStages(),
-	m_storedVertexBuffers(),
 	m_storedViewport(),
 	m_eSidesAre(isSideLeft ? SidesAllLeft : SidesAllRight),
-	m_selectedStates(),
-	m_selectedTextureSamplers(),
-	m_selectedVertexStreams(),
-	m_storedSelectedPSRegistersF(),
-	m_storedAllPSRegistersF(),
-	m_selectedPixelConstantRegistersF(),
-	m_storedSelectedVSRegistersF(),
-	m_storedAllVSRegistersF(),
-	m_selectedVertexConstantRegistersF()
+	m_selectedStates(0),
+	m_selectedTextureSamplers(0),
+	m_selectedVertexStreams(0),
+	m_storedTextureMask(0),
+	m_storedVertexBufferMask(0),
+	m_applyProgram(),
+	m_bApplyProgramDirty(true),
+	m_bHoldsStereoStates(false),
+	m_storedPSRegistersF(),
+	m_storedVSRegistersF()
 {
 	assert (pOwningDevice != NULL);
 
@@ -71,6 +70,8 @@ D3D9ProxyStateBlock::D3D9ProxyStateBlock(IDirect3DStateBlock9* pActualStateBlock
 	m_pStoredVertexShader = NULL;
 	m_pStoredVertexDeclaration = NULL;
 	m_pStoredPixelShader = NULL;
+	ZeroMemory(m_storedTextureStages, sizeof(m_storedTextureStages));
+	ZeroMemory(m_storedVertexBuffers, sizeof(m_storedVertexBuffers));
 
 	D3DXMatrixIdentity(&m_storedLeftView);
 	D3DXMatrixIdentity(&m_storedRightView);
@@ -78,29 +79,31 @@ D3D9ProxyStateBlock::D3D9ProxyStateBlock(IDirect3DStateBlock9* pActualStateBlock
 	D3DXMatrixIdentity(&m_storedRightProjection);
 
 	switch (type) {
-	case Cap_Type_Full: 
+	case Cap_Type_Full:
 		{
-			static const CaptureableState toCapture[] = { IndexBuffer, Viewport, ViewMatrices, ProjectionMatrices, PixelShader, VertexShader, VertexDeclaration };
-			m_selectedStates.insert(toCapture, toCapture + 7);
+			m_selectedStates = (1 << IndexBuffer) | (1 << Viewport) | (1 << ViewMatrices) | (1 << ProjectionMatrices) |
+				(1 << PixelShader) | (1 << VertexShader) | (1 << VertexDeclaration);
 			break;
 		}
 
 	case Cap_Type_Vertex:
 		{
-			static const CaptureableState toCapture[] = { VertexShader, VertexDeclaration };
-			m_selectedStates.insert(toCapture, toCapture + 2);
+			m_selectedStates = (1 << VertexShader) | (1 << VertexDeclaration);
 			break;
 		}
 
 	case Cap_Type_Pixel:
 		{
-			m_selectedStates.insert(PixelShader);
+			m_selectedStates = (1 << PixelShader);
 			break;
 		}
 
 	case Cap_Type_Selected:
 		{
 			// Select no specific state, state to capture will be indicated by calls to the various SelectAndCaptureState methods.
+			// Registers likewise, only the ones set while recording are part of the block.
+			m_storedVSRegistersF.partial = true;
+			m_storedPSRegistersF.partial = true;
 			break;
 		}
 
@@ -125,11 +128,12 @@ D3D9ProxyStateBlock::~D3D9ProxyStateBlock()
 {
 	ClearCapturedData();
 
-	m_selectedStates.clear();
-	m_selectedTextureSamplers.clear();
-	m_selectedVertexStreams.clear();
-	m_selectedPixelConstantRegistersF.clear();
-	m_selectedVertexConstantRegistersF.clear();
+	m_selectedStates = 0;
+	m_selectedTextureSamplers = 0;
+	m_selectedVertexStreams = 0;
+	m_storedVSRegistersF.ClearAll();
+	m_storedPSRegistersF.ClearAll();
+	m_applyProgram.clear();
 
 	m_pWrappedDevice->Release();
 }
@@ -152,36 +156,37 @@ HRESULT WINAPI D3D9ProxyStateBlock::Capture()
 /**
 * Applies basic state block states and stored ones.
 *
-* Calls private Apply() to apply non-indexed states. Note that this private method needs to know
-* wether the states were captured while the device side was set to the same side. (set in 
-* updateCaptureSideTracking() )
+* Compiles the apply program if the captured layout changed since last apply, switches the device
+* to the capture side (only if stereo states are held and all were captured on the same side),
+* applies the actual state block and then runs the apply program.
 *
-* Removes co-existing vertex buffers in wrapped device and inserts stored ones.
-*
-* Then it calls the managed shader register class (ShaderRegisters) stored in the wrapped device 
-* (m_spManagedShaderRegisters) to apply all vertex shader constants according to capture type.
-*
-* If states were not captured while the device side was set to the same side it applies the 
-* stored texture stages to the actual device else it applies the stored texture stages to the 
-* wrapped device without applying to the actual device.
+* The program applies non-indexed states, then the vertex buffers, then the managed shader registers
+* (ShaderRegisters stored in the wrapped device, m_spManagedShaderRegisters) according to capture type
+* and last the texture stages. If states were not captured while the device side was set to the same
+* side the textures are set on the actual device, else only the wrapped device is updated.
+* @see CompileApplyProgram()
 * @see updateCaptureSideTracking()
-* @see Apply(CaptureableState toApply, bool reApplyStereo)
 * @see ShaderRegisters
 * @see m_spManagedShaderRegisters
 ***/
 HRESULT WINAPI D3D9ProxyStateBlock::Apply()
 {
-	// assert that device isn't in the middle of a begin/end stateblock capture cycle because said situation is not accounted for 
+	// assert that device isn't in the middle of a begin/end stateblock capture cycle because said situation is not accounted for
 	// (probably an error in D3D but haven't tested to check)
 	assert (!m_pWrappedDevice->m_bInBeginEndStateBlock);
 
+	if (m_bApplyProgramDirty)
+		CompileApplyProgram();
 
 	// If all stereo states recorded on the same side then switch the proxy device to that side
-	if (m_eSidesAre == SidesAllLeft) {
-		m_pWrappedDevice->setDrawingSide(vireio::Left);
-	}
-	else if (m_eSidesAre == SidesAllRight) {
-		m_pWrappedDevice->setDrawingSide(vireio::Right);
+	// (no need to if the block holds no stereo states at all, switching sides touches all stereo targets and textures)
+	if (m_bHoldsStereoStates) {
+		if (m_eSidesAre == SidesAllLeft) {
+			m_pWrappedDevice->setDrawingSide(vireio::Left);
+		}
+		else if (m_eSidesAre == SidesAllRight) {
+			m_pWrappedDevice->setDrawingSide(vireio::Right);
+		}
 	}
 
 
@@ -189,117 +194,31 @@ HRESULT WINAPI D3D9ProxyStateBlock::Apply()
 
 	if (SUCCEEDED(result)) {
 
-		// If mixed sides then manually apply all state from stereo components based on the current proxy device side to the actual device
-		bool reApplyStereo = (m_eSidesAre == SidesMixed);
-
-		// Note: We're only updating the internal state of the proxy device to reflect the state that has already been applied by the 
-		// actual stateblock to the actual device for non-stereo states. For stereo states we do need to reapply the states on the device 
+		// in order of ApplyStep
+		static const ApplyFunction applyFunctions[APPLY_STEP_COUNT] = {
+			&D3D9ProxyStateBlock::ApplyIndexBuffer,
+			&D3D9ProxyStateBlock::ApplyViewport,
+			&D3D9ProxyStateBlock::ApplyViewMatrices,
+			&D3D9ProxyStateBlock::ApplyProjectionMatrices,
+			&D3D9ProxyStateBlock::ApplyPixelShader,
+			&D3D9ProxyStateBlock::ApplyVertexShader,
+			&D3D9ProxyStateBlock::ApplyVertexDeclaration,
+			&D3D9ProxyStateBlock::ApplyVertexBuffer,
+			&D3D9ProxyStateBlock::ApplyManagedVertexShader,
+			&D3D9ProxyStateBlock::ApplyManagedPixelShader,
+			&D3D9ProxyStateBlock::ApplyVertexShaderRegisters,
+			&D3D9ProxyStateBlock::ApplyPixelShaderRegisters,
+			&D3D9ProxyStateBlock::ApplyTexture,
+			&D3D9ProxyStateBlock::ApplyTextureStereo
+		};
+
+		// Note: We're only updating the internal state of the proxy device to reflect the state that has already been applied by the
+		// actual stateblock to the actual device for non-stereo states. For stereo states we do need to reapply the states on the device
 		// when the sides are mixed, so we use the normal Set methods in that case.)
-
-		// Apply non-indexed states
-		auto itSelected = m_selectedStates.begin();
-		while (itSelected != m_selectedStates.end()) {
-			Apply(*itSelected, reApplyStereo);
-			++itSelected;
-		}
-
-
-
-		// Apply non-stereo indexed states
-		auto itVertexBuffer = m_storedVertexBuffers.begin();
-		while (itVertexBuffer != m_storedVertexBuffers.end()) {
-
-			// Remove and Release existing buffer in proxy device
-			if (m_pWrappedDevice->m_activeVertexBuffers.count(itVertexBuffer->first) == 1) {
-
-				auto removing = m_pWrappedDevice->m_activeVertexBuffers[itVertexBuffer->first];
-				if (removing != NULL) {
-					removing->Release();
-				}
-				m_pWrappedDevice->m_activeVertexBuffers.erase(itVertexBuffer->first);
-			}
-
-			auto inserted = m_pWrappedDevice->m_activeVertexBuffers.insert(std::pair<UINT, BaseDirect3DVertexBuffer9*>(itVertexBuffer->first, itVertexBuffer->second));
-			// insert success and buffer not NULL
-			if (inserted.second && inserted.first->second) {
-				inserted.first->second->AddRef();
-			}
-
-			++itVertexBuffer;
-		}
-
-
-
-		// Shader constants
-		switch (m_eCaptureMode) 
-		{			
-		case Cap_Type_Selected:
-
-			if (m_selectedStates.count(VertexShader) == 1) 
-				m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockVertexShader(m_pStoredVertexShader);
-			if (m_selectedStates.count(PixelShader) == 1)
-				m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockPixelShader(m_pStoredPixelShader);
-
-			m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockData(&m_storedSelectedVSRegistersF, &m_storedSelectedPSRegistersF);
-			break;
-
-		case Cap_Type_Full:
-			m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockVertexShader(m_pStoredVertexShader);
-			m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockPixelShader(m_pStoredPixelShader);
-			m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockData(&m_storedAllVSRegistersF, &m_storedAllPSRegistersF);
-			break;
-
-		case Cap_Type_Vertex:
-			m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockVertexShader(m_pStoredVertexShader);
-			m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockData(&m_storedAllVSRegistersF, NULL);
-			break;
-
-		case Cap_Type_Pixel:
-		default:
-			m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockPixelShader(m_pStoredPixelShader);
-			m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockData(NULL, &m_storedAllPSRegistersF);
-			break;
-		}
-
-
-
-		// Apply stereo indexed states
-		if (reApplyStereo) {
-
-			// Textures
-			auto itTextures = m_storedTextureStages.begin();
-			while (itTextures != m_storedTextureStages.end()) {
-
-				m_pWrappedDevice->SetTexture(itTextures->first, itTextures->second);
-				++itTextures;
-			}
-		}
-		// Update the internal state of the proxy device for the above indexed stereo states without applying to the actual device (actual stateblock will
-		// have applied the correct state already)
-		else {
-
-			// Textures 
-			auto itTextures = m_storedTextureStages.begin();
-			while (itTextures != m_storedTextureStages.end()) {
-
-				// Remove and Release existing active texture in proxy device
-				if (m_pWrappedDevice->m_activeTextureStages.count(itTextures->first) == 1) {
-
-					auto removing = m_pWrappedDevice->m_activeTextureStages[itTextures->first];
-					if (removing != NULL) {
-						removing->Release();
-					}
-					m_pWrappedDevice->m_activeTextureStages.erase(itTextures->first);
-				}
-
-				auto inserted = m_pWrappedDevice->m_activeTextureStages.insert(std::pair<DWORD, IDirect3DBaseTexture9*>(itTextures->first, itTextures->second));
-				// insert success and texture not NULL
-				if (inserted.second && inserted.first->second) {
-					inserted.first->second->AddRef();
-				}
-
-				++itTextures;
-			}
+		auto itOperation = m_applyProgram.begin();
+		while (itOperation != m_applyProgram.end()) {
+			(this->*(applyFunctions[itOperation->step]))(itOperation->index);
+			++itOperation;
 		}
 	}
 
@@ -319,12 +238,16 @@ void D3D9ProxyStateBlock::SelectAndCaptureState(BaseDirect3DIndexBuffer9* pWrapp
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	if (!m_selectedStates.insert(IndexBuffer).second) {
+	if (IsSelected(IndexBuffer)) {
 		// Release existing
 		if (m_pStoredIndicies) {
 			m_pStoredIndicies->Release();
 		}
-	} 
+	}
+	else {
+		m_selectedStates |= (1 << IndexBuffer);
+		m_bApplyProgramDirty = true;
+	}
 
 	m_pStoredIndicies = pWrappedIndexBuffer;
 	if (m_pStoredIndicies) {
@@ -344,7 +267,10 @@ void D3D9ProxyStateBlock::SelectAndCaptureState(D3DVIEWPORT9 viewport)
 	assert (!m_pActualStateBlock);
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 
-	m_selectedStates.insert(Viewport);
+	if (!IsSelected(Viewport)) {
+		m_selectedStates |= (1 << Viewport);
+		m_bApplyProgramDirty = true;
+	}
 
 	m_storedViewport = viewport;
 }
@@ -364,7 +290,10 @@ void D3D9ProxyStateBlock::SelectAndCaptureViewTransform(D3DXMATRIX left, D3DXMAT
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	m_selectedStates.insert(ViewMatrices);
+	if (!IsSelected(ViewMatrices)) {
+		m_selectedStates |= (1 << ViewMatrices);
+		m_bApplyProgramDirty = true;
+	}
 
 	m_storedLeftView = left;
 	m_storedRightView = right;
@@ -387,7 +316,10 @@ void D3D9ProxyStateBlock::SelectAndCaptureProjectionTransform(D3DXMATRIX left, D
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	m_selectedStates.insert(ProjectionMatrices);
+	if (!IsSelected(ProjectionMatrices)) {
+		m_selectedStates |= (1 << ProjectionMatrices);
+		m_bApplyProgramDirty = true;
+	}
 
 	m_storedLeftProjection = left;
 	m_storedRightProjection = right;
@@ -407,12 +339,16 @@ void D3D9ProxyStateBlock::SelectAndCaptureState(D3D9ProxyPixelShader* pWrappedPi
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	if (!m_selectedStates.insert(PixelShader).second) {
+	if (IsSelected(PixelShader)) {
 		// Release existing
 		if (m_pStoredPixelShader) {
 			m_pStoredPixelShader->Release();
 		}
-	} 
+	}
+	else {
+		m_selectedStates |= (1 << PixelShader);
+		m_bApplyProgramDirty = true;
+	}
 
 	m_pStoredPixelShader = pWrappedPixelShader;
 	if (m_pStoredPixelShader) {
@@ -432,12 +368,16 @@ void D3D9ProxyStateBlock::SelectAndCaptureState(D3D9ProxyVertexShader* pWrappedV
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	if (!m_selectedStates.insert(VertexShader).second) {
+	if (IsSelected(VertexShader)) {
 		// Release existing
 		if (m_pStoredVertexShader) {
 			m_pStoredVertexShader->Release();
 		}
-	} 
+	}
+	else {
+		m_selectedStates |= (1 << VertexShader);
+		m_bApplyProgramDirty = true;
+	}
 
 	m_pStoredVertexShader = pWrappedVertexShader;
 	if (m_pStoredVertexShader) {
@@ -457,12 +397,16 @@ void D3D9ProxyStateBlock::SelectAndCaptureState(BaseDirect3DVertexDeclaration9*
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	if (!m_selectedStates.insert(VertexDeclaration).second) {
+	if (IsSelected(VertexDeclaration)) {
 		// Release existing
 		if (m_pStoredVertexDeclaration) {
 			m_pStoredVertexDeclaration->Release();
 		}
-	} 
+	}
+	else {
+		m_selectedStates |= (1 << VertexDeclaration);
+		m_bApplyProgramDirty = true;
+	}
 
 	m_pStoredVertexDeclaration = pWrappedVertexDeclaration;
 	if (m_pStoredVertexDeclaration) {
@@ -483,22 +427,30 @@ void D3D9ProxyStateBlock::SelectAndCaptureState(DWORD Stage, IDirect3DBaseTextur
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	m_selectedTextureSamplers.insert(Stage);
+	int slot = TextureSlot(Stage);
+	if (slot < 0) {
+		OutputDebugString("SelectAndCaptureState: Invalid texture sampler in ProxyStateBlock\n");
+		return;
+	}
+
+	DWORD slotBit = 1 << slot;
+	m_selectedTextureSamplers |= slotBit;
 
-	if (m_storedTextureStages.count(Stage) == 1) {
-		IDirect3DBaseTexture9* pOldTexture = m_storedTextureStages.at(Stage);
+	if (m_storedTextureMask & slotBit) {
+		IDirect3DBaseTexture9* pOldTexture = m_storedTextureStages[slot];
 
 		if (pOldTexture)
 			pOldTexture->Release();
-
-		m_storedTextureStages.erase(Stage);
 	}
-
-	if(m_storedTextureStages.insert(std::pair<DWORD, IDirect3DBaseTexture9*>(Stage, pWrappedTexture)).second) {
-		if (pWrappedTexture)
-			pWrappedTexture->AddRef();
+	else {
+		m_storedTextureMask |= slotBit;
+		m_bApplyProgramDirty = true;
 	}
 
+	m_storedTextureStages[slot] = pWrappedTexture;
+	if (pWrappedTexture)
+		pWrappedTexture->AddRef();
+
 	updateCaptureSideTracking();
 }
 
@@ -513,27 +465,34 @@ void D3D9ProxyStateBlock::SelectAndCaptureState(UINT StreamNumber, BaseDirect3DV
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	m_selectedVertexStreams.insert(StreamNumber);
+	if (StreamNumber >= STATEBLOCK_VERTEX_STREAMS) {
+		OutputDebugString("SelectAndCaptureState: Invalid vertex stream in ProxyStateBlock\n");
+		return;
+	}
+
+	DWORD streamBit = 1 << StreamNumber;
+	m_selectedVertexStreams |= streamBit;
 
-	if (m_storedVertexBuffers.count(StreamNumber) == 1) {
-		BaseDirect3DVertexBuffer9* pOldBuffer = m_storedVertexBuffers.at(StreamNumber);
+	if (m_storedVertexBufferMask & streamBit) {
+		BaseDirect3DVertexBuffer9* pOldBuffer = m_storedVertexBuffers[StreamNumber];
 
 		if (pOldBuffer)
 			pOldBuffer->Release();
-
-		m_storedVertexBuffers.erase(StreamNumber);
 	}
-
-	if(m_storedVertexBuffers.insert(std::pair<DWORD, BaseDirect3DVertexBuffer9*>(StreamNumber, pWrappedStreamData)).second) {
-		if (pWrappedStreamData)
-			pWrappedStreamData->AddRef();
+	else {
+		m_storedVertexBufferMask |= streamBit;
+		m_bApplyProgramDirty = true;
 	}
+
+	m_storedVertexBuffers[StreamNumber] = pWrappedStreamData;
+	if (pWrappedStreamData)
+		pWrappedStreamData->AddRef();
 }
 
-/** 
+/**
 * Adds registers to selected vertex constant registers and captures the constant data.
 * Use these methods when the respective methods on the device are called between Start/End StateBlock.
-* Assumption: Only float registers will need to be stereo. 
+* Assumption: Only float registers will need to be stereo.
 * If this proves to be untrue then int and bool containers will need adding throughout this class.
 * @see D3DProxyDevice::SetVertexShaderConstantF()
 ***/
@@ -543,25 +502,23 @@ HRESULT WINAPI D3D9ProxyStateBlock::SelectAndCaptureStateVSConst(UINT StartRegis
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	// The assumption here is that most registers won't need to be stereo so we set them all on the actual device imiediately and overwrite the stereo ones 
+	// The assumption here is that most registers won't need to be stereo so we set them all on the actual device imiediately and overwrite the stereo ones
 	// when we Apply. (if there are any). This Simplifies "Apply" when this block is applied later.
-	HRESULT result = m_pOwningDevice->SetVertexShaderConstantF(StartRegister, pConstantData, Vector4fCount);
+	// (set on the actual device, the proxy device would route the call straight back to this block)
+	HRESULT result = m_pWrappedDevice->getActual()->SetVertexShaderConstantF(StartRegister, pConstantData, Vector4fCount);
 
 	if (SUCCEEDED(result)) {
 		// Mark these registers as being tracked and save them
-		for (UINT i = StartRegister; i < (StartRegister + Vector4fCount); i++) {
-			m_selectedVertexConstantRegistersF.insert(i);
-			m_storedSelectedVSRegistersF.insert(std::pair<UINT, D3DXVECTOR4>(i, pConstantData));
-		}
+		result = m_pWrappedDevice->m_spManagedShaderRegisters->RecordVSSnapshot(&m_storedVSRegistersF, StartRegister, pConstantData, Vector4fCount);
 	}
 
 	return result;
 }
 
-/** 
+/**
 * Adds registers to selected pixel constant registers and captures the constant data.
 * Use these methods when the respective methods on the device are called between Start/End StateBlock.
-* Assumption: Only float registers will need to be stereo. 
+* Assumption: Only float registers will need to be stereo.
 * If this proves to be untrue then int and bool containers will need adding throughout this class.
 * @see D3DProxyDevice::SetPixelShaderConstantF()
 ***/
@@ -571,26 +528,24 @@ HRESULT WINAPI D3D9ProxyStateBlock::SelectAndCaptureStatePSConst(UINT StartRegis
 	assert (m_pWrappedDevice->m_bInBeginEndStateBlock);
 	assert (!m_pActualStateBlock);
 
-	// The assumption here is that most registers won't need to be stereo so we set them all on the actual device imiediately and overwrite the stereo ones 
+	// The assumption here is that most registers won't need to be stereo so we set them all on the actual device imiediately and overwrite the stereo ones
 	// when we Apply. (if there are any). This Simplifies "Apply" when this block is applied later.
-	HRESULT result = m_pOwningDevice->SetPixelShaderConstantF(StartRegister, pConstantData, Vector4fCount);
+	// (set on the actual device, the proxy device would route the call straight back to this block)
+	HRESULT result = m_pWrappedDevice->getActual()->SetPixelShaderConstantF(StartRegister, pConstantData, Vector4fCount);
 
 	if (SUCCEEDED(result)) {
 		// Mark these registers as being tracked and save them
-		for (UINT i = StartRegister; i < (StartRegister + Vector4fCount); i++) {
-			m_selectedPixelConstantRegistersF.insert(i);
-			m_storedSelectedPSRegistersF.insert(std::pair<UINT, D3DXVECTOR4>(i, pConstantData));
-		}
+		result = m_pWrappedDevice->m_spManagedShaderRegisters->RecordPSSnapshot(&m_storedPSRegistersF, StartRegister, pConstantData, Vector4fCount);
 	}
 
 	return result;
 }
 
 /**
-* If this ProxyStateBlock was created in a BeginStateBlock call then call this method in the 
-* EndStateBlock with the actual stateblock returned from EndStateBlock of the actual device. 
-* It is an error to call this method with NULL, to call it on a ProxyStateBlock created with an 
-* actual state block or more than once. 
+* If this ProxyStateBlock was created in a BeginStateBlock call then call this method in the
+* EndStateBlock with the actual stateblock returned from EndStateBlock of the actual device.
+* It is an error to call this method with NULL, to call it on a ProxyStateBlock created with an
+* actual state block or more than once.
 ***/
 void D3D9ProxyStateBlock::EndStateBlock(IDirect3DStateBlock9* pActualStateBlock)
 {
@@ -599,7 +554,7 @@ void D3D9ProxyStateBlock::EndStateBlock(IDirect3DStateBlock9* pActualStateBlock)
 	m_pActualStateBlock = pActualStateBlock;
 }
 
-/*void D3D9ProxyStateBlock::ClearSelected(UINT StartRegister) 
+/*void D3D9ProxyStateBlock::ClearSelected(UINT StartRegister)
 {
 m_StoredStereoShaderConstsF.erase(StartRegister);
 }*/
@@ -614,6 +569,7 @@ m_StoredStereoShaderConstsF.erase(StartRegister);
 *
 * If capture type is 'selected', it copies additional data according to the selections.
 *
+* Marks the apply program dirty if the captured slots or the side tracking changed.
 * @see CaptureType
 * @see Capture()
 * @see ShaderRegisters
@@ -621,63 +577,71 @@ m_StoredStereoShaderConstsF.erase(StartRegister);
 ***/
 void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 {
+	DWORD previousTextureMask = m_storedTextureMask;
+	DWORD previousVertexBufferMask = m_storedVertexBufferMask;
+	bool previouslyMixed = (m_eSidesAre == SidesMixed);
+
 	// Clear out any existing captured data before we begin.
 	ClearCapturedData();
 
 
 	// 'Copy' (actually just keeping a reference) all selected (non-indexed) states to ProxyStateBlock from ProxyDevice
-	auto itSelected = m_selectedStates.begin();
-	while (itSelected != m_selectedStates.end()) {
-		Capture(*itSelected);
-		++itSelected;
+	for (int state = IndexBuffer; state <= VertexDeclaration; state++) {
+		if (IsSelected((CaptureableState)state))
+			Capture((CaptureableState)state);
 	}
 
 	// Copy indexed states
 	switch (m_eCaptureMode) {
-	case Cap_Type_Full: 
+	case Cap_Type_Full:
 		{
 			// if full - copy all textures, vertex buffers and shader constants.
 
 			// Textures
-			m_storedTextureStages = m_pWrappedDevice->m_activeTextureStages;
-
-			// TODO Do we need to copy Textures rather than just keeping reference. Textures could be changed (have new data stretched/copied into them) 
+			// TODO Do we need to copy Textures rather than just keeping reference. Textures could be changed (have new data stretched/copied into them)
 			// TODO Check actual behaviour of state block. Is it saving a reference to the texture or a copy of the texture??
 			// Need to increase ref count on all copied textures
-			auto itTextures = m_storedTextureStages.begin();
-			while (itTextures != m_storedTextureStages.end()) {
-				if (itTextures->second != NULL) {
-					itTextures->second->AddRef();
+			auto itTextures = m_pWrappedDevice->m_activeTextureStages.begin();
+			while (itTextures != m_pWrappedDevice->m_activeTextureStages.end()) {
+				int slot = TextureSlot(itTextures->first);
+				if (slot >= 0) {
+					m_storedTextureStages[slot] = itTextures->second;
+					m_storedTextureMask |= (1 << slot);
+					if (itTextures->second != NULL) {
+						itTextures->second->AddRef();
+					}
 				}
 				++itTextures;
 			}
 
 
 			// Vertex buffers
-			m_storedVertexBuffers = m_pWrappedDevice->m_activeVertexBuffers;
-
 			// TODO same question as for Textures above
 			// Need to increase ref count on all copied vbs
-			auto itVB = m_storedVertexBuffers.begin();
-			while (itVB != m_storedVertexBuffers.end()) {
-				if (itVB->second != NULL) {
-					itVB->second->AddRef();
+			auto itVB = m_pWrappedDevice->m_activeVertexBuffers.begin();
+			while (itVB != m_pWrappedDevice->m_activeVertexBuffers.end()) {
+				if (itVB->first < STATEBLOCK_VERTEX_STREAMS) {
+					m_storedVertexBuffers[itVB->first] = itVB->second;
+					m_storedVertexBufferMask |= (1 << itVB->first);
+					if (itVB->second != NULL) {
+						itVB->second->AddRef();
+					}
 				}
 				++itVB;
 			}
 
 
-			// Vertex Shader constants
-			m_storedAllVSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->GetAllVSConstantRegistersF();
+			// Vertex Shader constants (pages are shared, not copied)
+			m_pWrappedDevice->m_spManagedShaderRegisters->CaptureVSSnapshot(&m_storedVSRegistersF);
 			// Pixel Shader constants
-			m_storedAllPSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->GetAllPSConstantRegistersF();
+			m_pWrappedDevice->m_spManagedShaderRegisters->CapturePSSnapshot(&m_storedPSRegistersF);
 			break;
 		}
 
 	case Cap_Type_Vertex:
 		{
 			// Vertex Shader constants
-			m_storedAllVSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->GetAllVSConstantRegistersF();
+			m_pWrappedDevice->m_spManagedShaderRegisters->CaptureVSSnapshot(&m_storedVSRegistersF);
 
 			break;
 		}
@@ -685,77 +649,50 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 	case Cap_Type_Pixel:
 		{
 			// Pixel Shader constants
-			m_storedAllPSRegistersF = m_pWrappedDevice->m_spManagedShaderRegisters->GetAllPSConstantRegistersF();
+			m_pWrappedDevice->m_spManagedShaderRegisters->CapturePSSnapshot(&m_storedPSRegistersF);
 			break;
 		}
 
 	case Cap_Type_Selected:
 		{
-			// if selected - iterate m_selectedTextureSamplers, m_selectedVertexStreams and m_selectedVertexConstantRegistersF and copy as selected.
-
-			auto itSelectedTextures = m_selectedTextureSamplers.begin();
-			while (itSelectedTextures != m_selectedTextureSamplers.end()) {
-
-				if (m_pWrappedDevice->m_activeTextureStages.count(*itSelectedTextures) == 1) {
-
-					auto inserted = m_storedTextureStages.insert(std::pair<DWORD, IDirect3DBaseTexture9*>(*itSelectedTextures, m_pWrappedDevice->m_activeTextureStages[*itSelectedTextures]));
-					// insert success and texture is not NULL
-					if (inserted.second && inserted.first->second) {
-						inserted.first->second->AddRef();
-					}
-					else { // insertfailed
-						//OutputDebugString("Texture sampler capture to StateBlock failed");
-						//TODO aaaaa why does this get spammed
-					}
+			// if selected - walk the selected sampler slots and vertex streams and copy as selected.
+
+			for (UINT slot = 0; slot < STATEBLOCK_TEXTURE_SLOTS; slot++) {
+				if ((m_selectedTextureSamplers & (1 << slot)) == 0)
+					continue;
+
+				auto itActive = m_pWrappedDevice->m_activeTextureStages.find(TextureStage(slot));
+				if (itActive != m_pWrappedDevice->m_activeTextureStages.end()) {
+					m_storedTextureStages[slot] = itActive->second;
+					m_storedTextureMask |= (1 << slot);
+					if (itActive->second)
+						itActive->second->AddRef();
 				}
-
-				++itSelectedTextures;
 			}
 
 
-			auto itSelectedVertexStreams = m_selectedVertexStreams.begin();
-			while (itSelectedVertexStreams != m_selectedVertexStreams.end()) {
-
-				if (m_pWrappedDevice->m_activeVertexBuffers.count(*itSelectedVertexStreams) == 1) {
+			for (UINT stream = 0; stream < STATEBLOCK_VERTEX_STREAMS; stream++) {
+				if ((m_selectedVertexStreams & (1 << stream)) == 0)
+					continue;
 
-					auto inserted = m_storedVertexBuffers.insert(std::pair<UINT, BaseDirect3DVertexBuffer9*>(*itSelectedVertexStreams, m_pWrappedDevice->m_activeVertexBuffers[*itSelectedVertexStreams]));
-					// insert success and buffer is not NULL
-					if (inserted.second && inserted.first->second) {
-						inserted.first->second->AddRef();
-					}
-					else { // insertfailed
-						//Need to find out why this is repeatedly written in Bioshock 2
-						//OutputDebugString("Vertex buffer capture to StateBlock failed");
-					}
+				auto itActive = m_pWrappedDevice->m_activeVertexBuffers.find(stream);
+				if (itActive != m_pWrappedDevice->m_activeVertexBuffers.end()) {
+					m_storedVertexBuffers[stream] = itActive->second;
+					m_storedVertexBufferMask |= (1 << stream);
+					if (itActive->second)
+						itActive->second->AddRef();
 				}
-
-				++itSelectedVertexStreams;
 			}
 
 
 
-			// Vertex Shader constants
-			float currentRegister [4];
-			auto itSelectedVertexConstants = m_selectedVertexConstantRegistersF.begin();
-			while (itSelectedVertexConstants != m_selectedVertexConstantRegistersF.end()) {
-
-				m_pWrappedDevice->m_spManagedShaderRegisters->GetVertexShaderConstantF(*itSelectedVertexConstants, currentRegister, 1);
-
-				m_storedSelectedVSRegistersF.insert(std::pair<UINT, D3DXVECTOR4>(*itSelectedVertexConstants, currentRegister));
-
-				++itSelectedVertexConstants;
-			}
+			// Vertex Shader constants (share current pages, the selection masks are kept)
+			if (m_storedVSRegistersF.partial)
+				m_pWrappedDevice->m_spManagedShaderRegisters->CaptureVSSnapshot(&m_storedVSRegistersF);
 
 			// Pixel Shader constants
-			auto itSelectedPixelConstants = m_selectedPixelConstantRegistersF.begin();
-			while (itSelectedPixelConstants != m_selectedPixelConstantRegistersF.end()) {
-
-				m_pWrappedDevice->m_spManagedShaderRegisters->GetPixelShaderConstantF(*itSelectedPixelConstants, currentRegister, 1);
-
-				m_storedSelectedPSRegistersF.insert(std::pair<UINT, D3DXVECTOR4>(*itSelectedPixelConstants, currentRegister));
-
-				++itSelectedPixelConstants;
-			}
+			if (m_storedPSRegistersF.partial)
+				m_pWrappedDevice->m_spManagedShaderRegisters->CapturePSSnapshot(&m_storedPSRegistersF);
 
 			break;
 		}
@@ -777,6 +714,12 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 	else {
 		OutputDebugString("CaptureSelectedFromProxyDevice: This shouldn't be possible.\n");
 	}
+
+	// Recapturing the same layout (the usual case) keeps the apply program
+	if ((previousTextureMask != m_storedTextureMask) || (previousVertexBufferMask != m_storedVertexBufferMask) ||
+		(previouslyMixed != (m_eSidesAre == SidesMixed))) {
+			m_bApplyProgramDirty = true;
+	}
 }
 
 /**
@@ -786,9 +729,9 @@ void D3D9ProxyStateBlock::CaptureSelectedFromProxyDevice()
 ***/
 void D3D9ProxyStateBlock::Capture(CaptureableState toCap)
 {
-	switch (toCap) 
+	switch (toCap)
 	{
-	case IndexBuffer: 
+	case IndexBuffer:
 		{
 			m_pStoredIndicies = m_pWrappedDevice->m_pActiveIndicies;
 			if (m_pStoredIndicies)
@@ -797,27 +740,27 @@ void D3D9ProxyStateBlock::Capture(CaptureableState toCap)
 			break;
 		}
 
-	case Viewport: 
+	case Viewport:
 		{
 			m_storedViewport = m_pWrappedDevice->m_LastViewportSet;
 			break;
 		}
 
-	case ViewMatrices: 
+	case ViewMatrices:
 		{
 			m_storedLeftView = m_pWrappedDevice->m_leftView;
 			m_storedRightView = m_pWrappedDevice->m_rightView;
 			break;
 		}
 
-	case ProjectionMatrices: 
+	case ProjectionMatrices:
 		{
 			m_storedLeftProjection = m_pWrappedDevice->m_leftProjection;
 			m_storedRightProjection = m_pWrappedDevice->m_rightProjection;
 			break;
 		}
 
-	case PixelShader: 
+	case PixelShader:
 		{
 			m_pStoredPixelShader = m_pWrappedDevice->m_pActivePixelShader;
 			if (m_pStoredPixelShader)
@@ -826,7 +769,7 @@ void D3D9ProxyStateBlock::Capture(CaptureableState toCap)
 			break;
 		}
 
-	case VertexShader: 
+	case VertexShader:
 		{
 			m_pStoredVertexShader = m_pWrappedDevice->m_pActiveVertexShader;
 			if (m_pStoredVertexShader)
@@ -835,7 +778,7 @@ void D3D9ProxyStateBlock::Capture(CaptureableState toCap)
 			break;
 		}
 
-	case VertexDeclaration: 
+	case VertexDeclaration:
 		{
 			m_pStoredVertexDeclaration = m_pWrappedDevice->m_pActiveVertexDeclaration;
 			if (m_pStoredVertexDeclaration)
@@ -857,27 +800,25 @@ void D3D9ProxyStateBlock::Capture(CaptureableState toCap)
 ***/
 void D3D9ProxyStateBlock::ClearCapturedData()
 {
-	auto it = m_storedTextureStages.begin();
-	while (it != m_storedTextureStages.end()) {
-		if (it->second)
-			it->second->Release();
-		++it;
+	for (UINT slot = 0; slot < STATEBLOCK_TEXTURE_SLOTS; slot++) {
+		if (m_storedTextureStages[slot]) {
+			m_storedTextureStages[slot]->Release();
+			m_storedTextureStages[slot] = NULL;
+		}
 	}
-	m_storedTextureStages.clear();
+	m_storedTextureMask = 0;
 
-	auto it2 = m_storedVertexBuffers.begin();
-	while (it2 != m_storedVertexBuffers.end()) {
-		if (it2->second)
-			it2->second->Release();
-		++it2;
+	for (UINT stream = 0; stream < STATEBLOCK_VERTEX_STREAMS; stream++) {
+		if (m_storedVertexBuffers[stream]) {
+			m_storedVertexBuffers[stream]->Release();
+			m_storedVertexBuffers[stream] = NULL;
+		}
 	}
-	m_storedVertexBuffers.clear();
-
-	m_storedSelectedVSRegistersF.clear();
-	m_storedAllVSRegistersF.clear();
+	m_storedVertexBufferMask = 0;
 
-	m_storedSelectedPSRegistersF.clear();
-	m_storedAllPSRegistersF.clear();
+	// release pages only, selection of registers remains
+	m_storedVSRegistersF.Clear();
+	m_storedPSRegistersF.Clear();
 
 	if (m_pStoredIndicies) {
 		m_pStoredIndicies->Release();
@@ -906,97 +847,232 @@ void D3D9ProxyStateBlock::ClearCapturedData()
 }
 
 /**
-* Applies stored data to wrapped device according to selection.
-* @param toApply The selection to be applied.
-* @param reApplyStereo True if the states were captured while the device side was set to the same side.  
-* @see updateCaptureSideTracking() )
+* Builds the list of operations executed by Apply().
+* @see StateBlockApplyProgram::Compile()
+* @see Apply()
 ***/
-void D3D9ProxyStateBlock::Apply(CaptureableState toApply, bool reApplyStereo)
+void D3D9ProxyStateBlock::CompileApplyProgram()
 {
-	switch (toApply) 
+	// If mixed sides then manually apply all state from stereo components based on the current proxy device side to the actual device
+	bool reApplyStereo = (m_eSidesAre == SidesMixed);
+
+	ApplyShaders shaders;
+	switch (m_eCaptureMode)
 	{
-	case IndexBuffer: 
-		{
-			if (m_pWrappedDevice->m_pActiveIndicies)
-				m_pWrappedDevice->m_pActiveIndicies->Release();
+	case Cap_Type_Selected:
+		shaders = APPLY_SHADERS_SELECTED;
+		break;
+	case Cap_Type_Full:
+		shaders = APPLY_SHADERS_ALL;
+		break;
+	case Cap_Type_Vertex:
+		shaders = APPLY_SHADERS_VERTEX;
+		break;
+	case Cap_Type_Pixel:
+	default:
+		shaders = APPLY_SHADERS_PIXEL;
+		break;
+	}
 
-			m_pWrappedDevice->m_pActiveIndicies = m_pStoredIndicies;
-			if (m_pWrappedDevice->m_pActiveIndicies)
-				m_pStoredIndicies->AddRef();
+	StateBlockApplyProgram::Compile(shaders, m_selectedStates, m_storedVertexBufferMask, m_storedTextureMask, reApplyStereo, m_applyProgram);
 
-			break;
-		}
+	m_bHoldsStereoStates = (m_storedTextureMask != 0) || IsSelected(ViewMatrices) || IsSelected(ProjectionMatrices);
+	m_bApplyProgramDirty = false;
+}
 
-	case Viewport: 
-		{
-			m_pWrappedDevice->m_LastViewportSet = m_storedViewport;
-			m_pWrappedDevice->m_bActiveViewportIsDefault = m_pWrappedDevice->isViewportDefaultForMainRT(&m_storedViewport);
+/**
+* Apply program : Index buffer.
+* Reference counts are only touched if the stored buffer is not active already.
+***/
+void D3D9ProxyStateBlock::ApplyIndexBuffer(UINT unused)
+{
+	if (m_pWrappedDevice->m_pActiveIndicies == m_pStoredIndicies)
+		return;
 
-			break;
-		}
+	if (m_pWrappedDevice->m_pActiveIndicies)
+		m_pWrappedDevice->m_pActiveIndicies->Release();
 
-	case ViewMatrices: 
-		{
-			m_pWrappedDevice->SetStereoViewTransform(m_storedLeftView, m_storedRightView, reApplyStereo);
+	m_pWrappedDevice->m_pActiveIndicies = m_pStoredIndicies;
+	if (m_pWrappedDevice->m_pActiveIndicies)
+		m_pStoredIndicies->AddRef();
+}
 
-			break;
-		}
+/**
+* Apply program : Viewport.
+***/
+void D3D9ProxyStateBlock::ApplyViewport(UINT unused)
+{
+	m_pWrappedDevice->m_LastViewportSet = m_storedViewport;
+	m_pWrappedDevice->m_bActiveViewportIsDefault = m_pWrappedDevice->isViewportDefaultForMainRT(&m_storedViewport);
+}
 
-	case ProjectionMatrices: 
-		{
-			m_pWrappedDevice->SetStereoProjectionTransform(m_storedLeftProjection, m_storedRightProjection, reApplyStereo);
+/**
+* Apply program : View matrices.
+* @param reApplyStereo Not zero if the states were captured on mixed sides. @see updateCaptureSideTracking()
+***/
+void D3D9ProxyStateBlock::ApplyViewMatrices(UINT reApplyStereo)
+{
+	m_pWrappedDevice->SetStereoViewTransform(m_storedLeftView, m_storedRightView, reApplyStereo != 0);
+}
 
-			break;
-		}
+/**
+* Apply program : Projection matrices.
+* @param reApplyStereo Not zero if the states were captured on mixed sides. @see updateCaptureSideTracking()
+***/
+void D3D9ProxyStateBlock::ApplyProjectionMatrices(UINT reApplyStereo)
+{
+	m_pWrappedDevice->SetStereoProjectionTransform(m_storedLeftProjection, m_storedRightProjection, reApplyStereo != 0);
+}
 
-	case PixelShader: 
-		{
-			if (m_pWrappedDevice->m_pActivePixelShader)
-				m_pWrappedDevice->m_pActivePixelShader->Release();
+/**
+* Apply program : Pixel shader.
+***/
+void D3D9ProxyStateBlock::ApplyPixelShader(UINT unused)
+{
+	if (m_pWrappedDevice->m_pActivePixelShader == m_pStoredPixelShader)
+		return;
 
-			m_pWrappedDevice->m_pActivePixelShader = m_pStoredPixelShader;
-			if (m_pWrappedDevice->m_pActivePixelShader)
-				m_pWrappedDevice->m_pActivePixelShader->AddRef();
+	if (m_pWrappedDevice->m_pActivePixelShader)
+		m_pWrappedDevice->m_pActivePixelShader->Release();
 
-			break;
-		}
+	m_pWrappedDevice->m_pActivePixelShader = m_pStoredPixelShader;
+	if (m_pWrappedDevice->m_pActivePixelShader)
+		m_pWrappedDevice->m_pActivePixelShader->AddRef();
+}
 
-	case VertexShader: 
-		{
-			if (m_pWrappedDevice->m_pActiveVertexShader)
-				m_pWrappedDevice->m_pActiveVertexShader->Release();
+/**
+* Apply program : Vertex shader.
+***/
+void D3D9ProxyStateBlock::ApplyVertexShader(UINT unused)
+{
+	if (m_pWrappedDevice->m_pActiveVertexShader == m_pStoredVertexShader)
+		return;
 
-			m_pWrappedDevice->m_pActiveVertexShader = m_pStoredVertexShader;
-			if (m_pWrappedDevice->m_pActiveVertexShader)
-				m_pWrappedDevice->m_pActiveVertexShader->AddRef();
+	if (m_pWrappedDevice->m_pActiveVertexShader)
+		m_pWrappedDevice->m_pActiveVertexShader->Release();
 
-			break;
-		}
+	m_pWrappedDevice->m_pActiveVertexShader = m_pStoredVertexShader;
+	if (m_pWrappedDevice->m_pActiveVertexShader)
+		m_pWrappedDevice->m_pActiveVertexShader->AddRef();
+}
 
-	case VertexDeclaration: 
-		{
-			if (m_pWrappedDevice->m_pActiveVertexDeclaration)
-				m_pWrappedDevice->m_pActiveVertexDeclaration->Release();
+/**
+* Apply program : Vertex declaration.
+***/
+void D3D9ProxyStateBlock::ApplyVertexDeclaration(UINT unused)
+{
+	if (m_pWrappedDevice->m_pActiveVertexDeclaration == m_pStoredVertexDeclaration)
+		return;
 
-			m_pWrappedDevice->m_pActiveVertexDeclaration = m_pStoredVertexDeclaration;
-			if (m_pWrappedDevice->m_pActiveVertexDeclaration)
-				m_pWrappedDevice->m_pActiveVertexDeclaration->AddRef();
+	if (m_pWrappedDevice->m_pActiveVertexDeclaration)
+		m_pWrappedDevice->m_pActiveVertexDeclaration->Release();
 
-			break;
-		}
+	m_pWrappedDevice->m_pActiveVertexDeclaration = m_pStoredVertexDeclaration;
+	if (m_pWrappedDevice->m_pActiveVertexDeclaration)
+		m_pWrappedDevice->m_pActiveVertexDeclaration->AddRef();
+}
 
-	default:
-		{
-			OutputDebugString("SelectAndCaptureState: Unknown CaptureableState in ProxyStateBlock\n");
-			break;
-		}
+/**
+* Apply program : Vertex buffer of one stream, updates the wrapped device only.
+* @param stream The vertex stream.
+***/
+void D3D9ProxyStateBlock::ApplyVertexBuffer(UINT stream)
+{
+	BaseDirect3DVertexBuffer9* pStored = m_storedVertexBuffers[stream];
+
+	auto itActive = m_pWrappedDevice->m_activeVertexBuffers.find(stream);
+	if (itActive != m_pWrappedDevice->m_activeVertexBuffers.end()) {
+		if (itActive->second == pStored)
+			return;
+
+		// Release existing buffer in proxy device
+		if (itActive->second)
+			itActive->second->Release();
+
+		itActive->second = pStored;
+	}
+	else {
+		m_pWrappedDevice->m_activeVertexBuffers.insert(std::pair<UINT, BaseDirect3DVertexBuffer9*>(stream, pStored));
 	}
+
+	if (pStored)
+		pStored->AddRef();
+}
+
+/**
+* Apply program : Managed vertex shader.
+***/
+void D3D9ProxyStateBlock::ApplyManagedVertexShader(UINT unused)
+{
+	m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockVertexShader(m_pStoredVertexShader);
+}
+
+/**
+* Apply program : Managed pixel shader.
+***/
+void D3D9ProxyStateBlock::ApplyManagedPixelShader(UINT unused)
+{
+	m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockPixelShader(m_pStoredPixelShader);
+}
+
+/**
+* Apply program : Managed vertex shader registers.
+***/
+void D3D9ProxyStateBlock::ApplyVertexShaderRegisters(UINT unused)
+{
+	m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockData(&m_storedVSRegistersF, NULL);
+}
+
+/**
+* Apply program : Managed pixel shader registers.
+***/
+void D3D9ProxyStateBlock::ApplyPixelShaderRegisters(UINT unused)
+{
+	m_pWrappedDevice->m_spManagedShaderRegisters->SetFromStateBlockData(NULL, &m_storedPSRegistersF);
+}
+
+/**
+* Apply program : Texture of one sampler slot, updates the wrapped device only (actual stateblock
+* applied the correct side already).
+* @param slot The sampler slot. @see TextureSlot()
+***/
+void D3D9ProxyStateBlock::ApplyTexture(UINT slot)
+{
+	IDirect3DBaseTexture9* pStored = m_storedTextureStages[slot];
+
+	auto itActive = m_pWrappedDevice->m_activeTextureStages.find(TextureStage(slot));
+	if (itActive != m_pWrappedDevice->m_activeTextureStages.end()) {
+		if (itActive->second == pStored)
+			return;
+
+		// Release existing active texture in proxy device
+		if (itActive->second)
+			itActive->second->Release();
+
+		itActive->second = pStored;
+	}
+	else {
+		m_pWrappedDevice->m_activeTextureStages.insert(std::pair<DWORD, IDirect3DBaseTexture9*>(TextureStage(slot), pStored));
+	}
+
+	if (pStored)
+		pStored->AddRef();
+}
+
+/**
+* Apply program : Texture of one sampler slot, set on the actual device for the current side
+* (states captured on mixed sides).
+* @param slot The sampler slot. @see TextureSlot()
+***/
+void D3D9ProxyStateBlock::ApplyTextureStereo(UINT slot)
+{
+	m_pWrappedDevice->SetTexture(TextureStage(slot), m_storedTextureStages[slot]);
 }
 
 /**
 * Needs to be called whenever a stereo state is recorded to see if side remains consistent.
 * If sides ever become inconsistent amongst tracked stereo states then all stereo states need
-* to be manually reapplied on apply. If they remain consistent then device side should be switched 
+* to be manually reapplied on apply. If they remain consistent then device side should be switched
 * to that side before applying (actual device will then apply the correct states for the side)
 ***/
 inline void D3D9ProxyStateBlock::updateCaptureSideTracking()
@@ -1008,5 +1084,6 @@ inline void D3D9ProxyStateBlock::updateCaptureSideTracking()
 		((m_pWrappedDevice->m_currentRenderingSide == vireio::Right) && (m_eSidesAre != SidesAllRight))) {
 
 			m_eSidesAre = SidesMixed;
+			m_bApplyProgramDirty = true;
 	}
-}
\ No newline at end of file
+}
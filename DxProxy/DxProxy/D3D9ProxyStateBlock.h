@@ -34,9 +34,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <d3dx9.h>
 #include "D3DProxyDevice.h"
 #include "Direct3DStateBlock9.h"
-#include <unordered_set>
 #include <unordered_map>
-#include <map>
+#include <vector>
 #include "Direct3DVertexBuffer9.h"
 #include "Direct3DIndexBuffer9.h"
 #include "D3D9ProxyPixelShader.h"
@@ -44,6 +43,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Direct3DPixelShader9.h"
 #include "Direct3DVertexDeclaration9.h"
 #include "StereoShaderConstant.h"
+#include "RegisterSnapshot.h"
+#include "StateBlockApplyProgram.h"
 
 class BaseDirect3DStateBlock9;
 class D3DProxyDevice;
@@ -89,6 +90,9 @@ class D3D9ProxyVertexShader;
 *
 * Pixel shader constants TODO - if needed (if stereo'ified for some reason), otherwise leave these to 
 * the actual device.
+*
+* Selections are bitmasks, indexed states are kept in flat arrays (one slot per sampler/stream). Apply()
+* runs a precompiled list of operations, rebuilt only when the captured layout changes.
 */
 class D3D9ProxyStateBlock : public BaseDirect3DStateBlock9
 {
@@ -157,9 +161,42 @@ private:
 	void CaptureSelectedFromProxyDevice();
 	void Capture(CaptureableState toCap);
 	void ClearCapturedData();
-	void Apply(CaptureableState toApply, bool reApplyStereo);
+	void CompileApplyProgram();
+	void ApplyIndexBuffer(UINT unused);
+	void ApplyViewport(UINT unused);
+	void ApplyViewMatrices(UINT reApplyStereo);
+	void ApplyProjectionMatrices(UINT reApplyStereo);
+	void ApplyPixelShader(UINT unused);
+	void ApplyVertexShader(UINT unused);
+	void ApplyVertexDeclaration(UINT unused);
+	void ApplyVertexBuffer(UINT stream);
+	void ApplyManagedVertexShader(UINT unused);
+	void ApplyManagedPixelShader(UINT unused);
+	void ApplyVertexShaderRegisters(UINT unused);
+	void ApplyPixelShaderRegisters(UINT unused);
+	void ApplyTexture(UINT slot);
+	void ApplyTextureStereo(UINT slot);
 	void updateCaptureSideTracking();
 
+	/**
+	* Slot of a sampler stage in m_storedTextureStages, -1 if the stage is no valid sampler.
+	***/
+	static int   TextureSlot(DWORD Stage) { if (Stage < 16) return (int)Stage; if ((Stage >= D3DDMAPSAMPLER) && (Stage <= D3DVERTEXTEXTURESAMPLER3)) return (int)(16 + Stage - D3DDMAPSAMPLER); return -1; }
+	/**
+	* Sampler stage of a slot in m_storedTextureStages.
+	***/
+	static DWORD TextureStage(UINT slot) { return (slot < 16) ? slot : (D3DDMAPSAMPLER + slot - 16); }
+	/**
+	* True if the non-indexed state is selected.
+	***/
+	bool         IsSelected(CaptureableState state) { return (m_selectedStates & (1 << state)) != 0; }
+
+	/**
+	* Apply method of an apply program step, called with the index (stream, sampler slot or flag)
+	* stored along with the step.
+	***/
+	typedef void (D3D9ProxyStateBlock::*ApplyFunction)(UINT index);
+
 	/**
 	* If all captures of stereo states are done on the same side we can just switch to
 	* that side and apply when needed. If stereo states are captured on different sides
@@ -183,33 +220,51 @@ private:
 	***/
 	const CaptureType m_eCaptureMode;
 	/**
-	* Selected States to capture are only relevant if CaptureType is Cap_Type_Selected.
+	* Selected States to capture, one bit per CaptureableState.
+	* Set according to capture type, for Cap_Type_Selected by the various SelectAndCaptureState methods.
 	***/
-	std::unordered_set<CaptureableState> m_selectedStates;
+	DWORD m_selectedStates;
 	/**
+	* Selected texture sampler slots, one bit per slot (@see TextureSlot()).
 	* Selected States to capture are only relevant if CaptureType is Cap_Type_Selected.
 	***/
-	std::unordered_set<DWORD> m_selectedTextureSamplers; 
+	DWORD m_selectedTextureSamplers; 
 	/**
+	* Selected vertex streams, one bit per stream.
 	* Selected States to capture are only relevant if CaptureType is Cap_Type_Selected.
 	***/
-	std::unordered_set<UINT> m_selectedVertexStreams;
+	DWORD m_selectedVertexStreams;
 	/**
-	* Selected States to capture are only relevant if CaptureType is Cap_Type_Selected.
+	* Slots of m_storedTextureStages holding a captured texture (which may be NULL).
 	***/
-	std::unordered_set<UINT> m_selectedVertexConstantRegistersF;
+	DWORD m_storedTextureMask;
 	/**
-	* Selected States to capture are only relevant if CaptureType is Cap_Type_Selected.
+	* Streams of m_storedVertexBuffers holding a captured buffer (which may be NULL).
 	***/
-	std::unordered_set<UINT> m_selectedPixelConstantRegistersF;
+	DWORD m_storedVertexBufferMask;
 	/**
 	* General States - Textures in samplers (standard, vertex and displacement).
+	* Indexed by slot, @see TextureSlot().
 	***/
-	std::unordered_map<DWORD, IDirect3DBaseTexture9*> m_storedTextureStages;
+	IDirect3DBaseTexture9* m_storedTextureStages[STATEBLOCK_TEXTURE_SLOTS];
 	/**
 	* General States - Vertex Buffers.
 	***/
-	std::unordered_map<UINT, BaseDirect3DVertexBuffer9*> m_storedVertexBuffers;
+	BaseDirect3DVertexBuffer9* m_storedVertexBuffers[STATEBLOCK_VERTEX_STREAMS];
+	/**
+	* Operations executed by Apply(), in order.
+	* @see CompileApplyProgram()
+	***/
+	std::vector<StateBlockApplyProgram::Operation> m_applyProgram;
+	/**
+	* True if the apply program needs to be compiled before next Apply().
+	***/
+	bool m_bApplyProgramDirty;
+	/**
+	* True if the block holds states that depend on the drawing side (textures, view/projection).
+	* If not, Apply() doesn't need to switch the device side.
+	***/
+	bool m_bHoldsStereoStates;
 	/**
 	* General States - Index Buffer.
 	***/
@@ -246,28 +301,18 @@ private:
 	BaseDirect3DVertexDeclaration9* m_pStoredVertexDeclaration;
 	/**
 	* Vertex Shader States -  Shader registers 
-	* Use this when using Cap_Type_Selected.
+	* Pages shared with the managed shader registers, partial (selected registers only) when using Cap_Type_Selected.
 	**/
-	std::map<UINT, D3DXVECTOR4> m_storedSelectedVSRegistersF;
-	/**
-	* Vertex Shader States -  Shader registers 
-	* Use this to copy everything when needed with other modes.
-	**/
-	std::vector<float> m_storedAllVSRegistersF;
+	RegisterSnapshot m_storedVSRegistersF;
 	/**
 	* Pixel Shader State - Stored pixel shader.
 	***/
 	D3D9ProxyPixelShader* m_pStoredPixelShader;
 	/**
 	* Pixel Shader States -  Shader registers 
-	* Use this when using Cap_Type_Selected.
-	**/
-	std::map<UINT, D3DXVECTOR4> m_storedSelectedPSRegistersF;
-	/**
-	* Pixel Shader States -  Shader registers 
-	* Use this to copy everything when needed with other modes.
+	* Pages shared with the managed shader registers, partial (selected registers only) when using Cap_Type_Selected.
 	**/
-	std::vector<float> m_storedAllPSRegistersF;
+	RegisterSnapshot m_storedPSRegistersF;
 	/**
 	* Pointer to wrapped device - quick solution (TODO) 
 	* Had issues when the type of the device in the base class was the wrapped type rather than the 
@@ -34,10 +34,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "StereoViewFactory.h"
 #include "MotionTrackerFactory.h"
 #include "HMDisplayInfoFactory.h"
+#include "EffectCache.h"
+#include "InitTaskGraph.h"
 #include <typeinfo>
 #include <assert.h>
 #include <comdef.h>
 #include <tchar.h>
+#include <mmsystem.h>
 #include "Resource.h"
 #include <D3DX9Shader.h>
 
@@ -55,6 +58,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define PI 3.141592654
 #define RADIANS_TO_DEGREES(rad) ((float) rad * (float) (180.0 / PI))
 
+#define TRACKING_WORKER_INTERVAL_MS 2
+
 #define OUTPUT_HRESULT(hr) { _com_error err(hr); LPCTSTR errMsg = err.ErrorMessage(); OutputDebugString(errMsg); }
 
 #define MAX_PIXEL_SHADER_CONST_2_0 32
@@ -172,6 +177,7 @@ D3DProxyDevice::D3DProxyDevice(IDirect3DDevice9* pDevice, BaseDirect3D9* pCreate
 	show_fps(FPS_NONE),
 	calibrate_tracker(false),
 	hmdInfo(NULL),
+	stereoView(NULL),
 	m_saveConfigTimer(MAXDWORD),
 	m_comfortModeYaw(0.0f),
 	m_disableAllHotkeys(false),
@@ -183,14 +189,23 @@ D3DProxyDevice::D3DProxyDevice(IDirect3DDevice9* pDevice, BaseDirect3D9* pCreate
 	SHOW_CALL("D3DProxyDevice");
 	OutputDebugString("D3D ProxyDev Created\n");
 	
-	InitVRBoost();
+	// independent startup work (no D3D) runs on the init workers, joined where it is needed
+	InitTaskGraph startup;
+	startup.Add("VRboost", [this]() { InitVRBoost(); });
+	startup.Add("Duck and cover", [this]() { m_DuckAndCover.LoadFromRegistry(); });
+	int userConfigTask = startup.Add("User config", [this]() {
+		ProxyHelper helper = ProxyHelper();
+		helper.LoadUserConfig(userConfig);
+	});
+	int hmdInfoTask = startup.Add("HMD info", [this]() {
+		hmdInfo = HMDisplayInfoFactory::CreateHMDisplayInfo(static_cast<StereoView::StereoTypes>(userConfig.mode)); 
+		OutputDebugString(("Created HMD Info for: " + hmdInfo->GetHMDName()).c_str());
+	});
+	startup.DependsOn(hmdInfoTask, userConfigTask);
+	startup.Start();
 
 	// rift info
-	ProxyHelper helper = ProxyHelper();
-	helper.LoadUserConfig(userConfig);
-	hmdInfo = HMDisplayInfoFactory::CreateHMDisplayInfo(static_cast<StereoView::StereoTypes>(userConfig.mode)); 
-	OutputDebugString(("Created HMD Info for: " + hmdInfo->GetHMDName()).c_str());
-
+	startup.Wait(hmdInfoTask);
 	m_spShaderViewAdjustment = std::make_shared<ViewAdjustment>(hmdInfo, &config);
 	m_pGameHandler = new GameHandler();
 
@@ -246,20 +261,41 @@ D3DProxyDevice::D3DProxyDevice(IDirect3DDevice9* pDevice, BaseDirect3D9* pCreate
 	m_telescopeTargetFOV = FLT_MAX;
 	m_telescopeCurrentFOV = FLT_MAX;
 
-	//Restore duck and cover settings
-	m_DuckAndCover.LoadFromRegistry();
+	//Restore duck and cover settings, VRboost
+	startup.WaitAll();
 
+	OpenTelemetry();
+	m_gpuProfiler.Init(getActual());
+
+	m_hTrackingThread = NULL;
+	m_hTrackingStopEvent = NULL;
+	InitializeCriticalSection(&m_trackerLock);
+	ZeroMemory(&m_trackingSettings, sizeof(m_trackingSettings));
 }
 
 /**
-* Destructor : calls ReleaseEverything() and releases swap chains.
+* Destructor : calls ReleaseEverything(), ReleaseHUD(), deletes the stereo view and releases swap chains.
 * @see ReleaseEverything()
 ***/
 D3DProxyDevice::~D3DProxyDevice()
 {
 	SHOW_CALL("~D3DProxyDevice");
 	
+	StopTrackingWorker();
+	m_trackerConnection.Stop();
+	DeleteCriticalSection(&m_trackerLock);
+	m_configSaver.Stop();
+
 	ReleaseEverything();
+	ReleaseHUD();
+
+	// the stereo view releases the objects it keeps over device resets (view effect, vertex buffer, logo)
+	if (stereoView)
+	{
+		stereoView->ReleaseEverything();
+		delete stereoView;
+		stereoView = NULL;
+	}
 
 	m_spShaderViewAdjustment.reset();
 
@@ -268,6 +304,9 @@ D3DProxyDevice::~D3DProxyDevice()
 
 	FreeLibrary(hmVRboost);
 
+	CloseTelemetry();
+	BinaryLog::Shutdown();
+
 	// always do this last
 	auto it = m_activeSwapChains.begin();
 	while (it != m_activeSwapChains.end()) {
@@ -370,6 +409,8 @@ HRESULT WINAPI D3DProxyDevice::GetSwapChain(UINT iSwapChain,IDirect3DSwapChain9*
 
 /**
 * Calls release functions here and in stereo view class, releases swap chains and restores everything.
+* Only D3DPOOL_DEFAULT resources are released, the ones surviving a reset (HUD fonts and sprites, view effect,
+* managed buffers and textures) are kept and restored.
 * Subclasses which override this method must call through to super method at the end of the subclasses
 * implementation.
 * @see ReleaseEverything()
@@ -430,7 +471,14 @@ HRESULT WINAPI D3DProxyDevice::Present(CONST RECT* pSourceRect,CONST RECT* pDest
 		IDirect3DSurface9* pWrappedBackBuffer = NULL;
 		m_activeSwapChains.at(0)->GetBackBuffer(0, D3DBACKBUFFER_TYPE_MONO, &pWrappedBackBuffer);
 		if (stereoView->initialized)
+		{
+			EnterCriticalSection(&m_trackerLock);
+			HandleLateLatch();
+			LeaveCriticalSection(&m_trackerLock);
+			GPU_PROFILE_MARK(m_gpuProfiler, GPS_COMPOSITION);
 			stereoView->Draw(static_cast<D3D9ProxySurface*>(pWrappedBackBuffer));
+			GPU_PROFILE_MARK(m_gpuProfiler, GPS_OTHER);
+		}
 				
 		pWrappedBackBuffer->Release();
 	}
@@ -448,28 +496,26 @@ HRESULT WINAPI D3DProxyDevice::Present(CONST RECT* pSourceRect,CONST RECT* pDest
 	//Now calculate frames per second
 	fps = CalcFPS();
 
-	//Write FPS to debug log every half second
-	static DWORD lastFPSTick = GetTickCount();
-	if (GetTickCount() - lastFPSTick > 500)
+	//Publish FPS and frame statistics for the Perception App
+	UpdateTelemetry();
+
+	GPU_PROFILE_END_FRAME(m_gpuProfiler);
+
+	HRESULT hr;
 	{
-		lastFPSTick = GetTickCount();
-		char buffer[256];
-		sprintf_s(buffer, "%.1f", fps);
-		//OutputDebugString((std::string("FPS: ") + buffer).c_str());
-
-		//Now write FPS to the registry for the Perception App (hopefully this is a very quick operation)
-		HKEY hKey;
-		LONG openRes = RegOpenKeyEx(HKEY_CURRENT_USER, "SOFTWARE\\Vireio\\Perception", 0, KEY_ALL_ACCESS , &hKey);
-		if (openRes==ERROR_SUCCESS)
-		{
-			RegSetValueEx(hKey, "FPS", 0, REG_SZ, (LPBYTE)buffer, strlen(buffer)+1);
-			RegCloseKey(hKey);
-		}
+		PROFILE_SCOPE("Present");
+		hr =  BaseDirect3DDevice9::Present(pSourceRect, pDestRect, hDestWindowOverride, pDirtyRegion);	
 	}
-	HRESULT hr =  BaseDirect3DDevice9::Present(pSourceRect, pDestRect, hDestWindowOverride, pDirtyRegion);	
 
+	// next frame starts on the current side
+	GPU_PROFILE_MARK(m_gpuProfiler, (m_currentRenderingSide == vireio::Left) ? GPS_LEFT_EYE : GPS_RIGHT_EYE);
+
+	EnterCriticalSection(&m_trackerLock);
 	if (tracker)
 		tracker->EndFrame();
+	LeaveCriticalSection(&m_trackerLock);
+
+	PROFILE_END_FRAME();
 
 	return hr;
 }
@@ -697,7 +743,7 @@ HRESULT WINAPI D3DProxyDevice::UpdateSurface(IDirect3DSurface9* pSourceSurface,C
 			//OutputDebugString("INFO: UpdateSurface - Source is not stereo, destination is stereo. Copying source to both sides of destination.\n");
 
 			if (FAILED(BaseDirect3DDevice9::UpdateSurface(pSourceSurfaceLeft, pSourceRect, pDestSurfaceRight, pDestPoint))) {
-				OutputDebugString("ERROR: UpdateSurface - Failed to copy source left to destination right.\n");
+				BLOG0("ERROR: UpdateSurface - Failed to copy source left to destination right.");
 			}
 		} 
 		else if (pSourceSurfaceRight && !pDestSurfaceRight) {
@@ -705,7 +751,7 @@ HRESULT WINAPI D3DProxyDevice::UpdateSurface(IDirect3DSurface9* pSourceSurface,C
 		}
 		else if (pSourceSurfaceRight && pDestSurfaceRight)	{
 			if (FAILED(BaseDirect3DDevice9::UpdateSurface(pSourceSurfaceRight, pSourceRect, pDestSurfaceRight, pDestPoint))) {
-				OutputDebugString("ERROR: UpdateSurface - Failed to copy source right to destination right.\n");
+				BLOG0("ERROR: UpdateSurface - Failed to copy source right to destination right.");
 			}
 		}
 	}
@@ -741,7 +787,7 @@ HRESULT WINAPI D3DProxyDevice::UpdateTexture(IDirect3DBaseTexture9* pSourceTextu
 			//OutputDebugString("INFO: UpdateTexture - Source is not stereo, destination is stereo. Copying source to both sides of destination.\n");
 
 			if (FAILED(BaseDirect3DDevice9::UpdateTexture(pSourceTextureLeft, pDestTextureRight))) {
-				OutputDebugString("ERROR: UpdateTexture - Failed to copy source left to destination right.\n");
+				BLOG0("ERROR: UpdateTexture - Failed to copy source left to destination right.");
 			}
 		} 
 		else if (pSourceTextureRight && !pDestTextureRight) {
@@ -749,7 +795,7 @@ HRESULT WINAPI D3DProxyDevice::UpdateTexture(IDirect3DBaseTexture9* pSourceTextu
 		}
 		else if (pSourceTextureRight && pDestTextureRight)	{
 			if (FAILED(BaseDirect3DDevice9::UpdateTexture(pSourceTextureRight, pDestTextureRight))) {
-				OutputDebugString("ERROR: UpdateTexture - Failed to copy source right to destination right.\n");
+				BLOG0("ERROR: UpdateTexture - Failed to copy source right to destination right.");
 			}
 		}
 	}
@@ -782,7 +828,7 @@ HRESULT WINAPI D3DProxyDevice::GetRenderTargetData(IDirect3DSurface9* pRenderTar
 			//OutputDebugString("INFO: GetRenderTargetData - Source is not stereo, destination is stereo. Copying source to both sides of destination.\n");
 
 			if (FAILED(BaseDirect3DDevice9::GetRenderTargetData(pRenderTargetLeft, pDestSurfaceRight))) {
-				OutputDebugString("ERROR: GetRenderTargetData - Failed to copy source left to destination right.\n");
+				BLOG0("ERROR: GetRenderTargetData - Failed to copy source left to destination right.");
 			}
 		} 
 		else if (pRenderTargetRight && !pDestSurfaceRight) {
@@ -790,7 +836,7 @@ HRESULT WINAPI D3DProxyDevice::GetRenderTargetData(IDirect3DSurface9* pRenderTar
 		}
 		else if (pRenderTargetRight && pDestSurfaceRight)	{
 			if (FAILED(BaseDirect3DDevice9::GetRenderTargetData(pRenderTargetRight, pDestSurfaceRight))) {
-				OutputDebugString("ERROR: GetRenderTargetData - Failed to copy source right to destination right.\n");
+				BLOG0("ERROR: GetRenderTargetData - Failed to copy source right to destination right.");
 			}
 		}
 	}
@@ -844,7 +890,7 @@ HRESULT WINAPI D3DProxyDevice::StretchRect(IDirect3DSurface9* pSourceSurface,CON
 			//OutputDebugString("INFO: StretchRect - Source is not stereo, destination is stereo. Copying source to both sides of destination.\n");
 
 			if (FAILED(BaseDirect3DDevice9::StretchRect(pSourceSurfaceLeft, pSourceRect, pDestSurfaceRight, pDestRect, Filter))) {
-				OutputDebugString("ERROR: StretchRect - Failed to copy source left to destination right.\n");
+				BLOG0("ERROR: StretchRect - Failed to copy source left to destination right.");
 			}
 		} 
 		else if (pSourceSurfaceRight && !pDestSurfaceRight) {
@@ -852,7 +898,7 @@ HRESULT WINAPI D3DProxyDevice::StretchRect(IDirect3DSurface9* pSourceSurface,CON
 		}
 		else if (pSourceSurfaceRight && pDestSurfaceRight)	{
 			if (FAILED(BaseDirect3DDevice9::StretchRect(pSourceSurfaceRight, pSourceRect, pDestSurfaceRight, pDestRect, Filter))) {
-				OutputDebugString("ERROR: StretchRect - Failed to copy source right to destination right.\n");
+				BLOG0("ERROR: StretchRect - Failed to copy source right to destination right.");
 			}
 		}
 	}
@@ -1090,6 +1136,9 @@ HRESULT WINAPI D3DProxyDevice::BeginScene()
 			}
 		}
 
+		// tracker calls are serialized with the tracking worker
+		EnterCriticalSection(&m_trackerLock);
+
 		//If we need to save configuration, do it now
 		if (m_saveConfigTimer != MAXDWORD &&
 			//Wait 10 seconds before saving
@@ -1103,6 +1152,8 @@ HRESULT WINAPI D3DProxyDevice::BeginScene()
 		if (tracker)
 			tracker->BeginFrame();
 
+		LeaveCriticalSection(&m_trackerLock);
+
 		// save screenshot before first clear() is called
 		if (screenshot>0)
 		{
@@ -1135,7 +1186,9 @@ HRESULT WINAPI D3DProxyDevice::BeginScene()
 		HandleLandmarkMoment(DeviceBehavior::WhenToDo::BEGIN_SCENE);
 		
 		// handle controls
+		EnterCriticalSection(&m_trackerLock);
 		HandleControls();
+		LeaveCriticalSection(&m_trackerLock);
 
 		// set vertex shader call count to zero
 		m_VertexShaderCount = 0;
@@ -1171,9 +1224,7 @@ HRESULT WINAPI D3DProxyDevice::Clear(DWORD Count,CONST D3DRECT* pRects,DWORD Fla
 			if (FAILED(hr = BaseDirect3DDevice9::Clear(Count, pRects, Flags, Color, Z, Stencil))) {
 
 #ifdef _DEBUG
-				debugf("Error: %s error description: %s\n", DXGetErrorString(hr), DXGetErrorDescription(hr));
-				OutputDebugString("Clear failed\n");
-
+				BLOG2("Clear failed, error: %s error description: %s", DXGetErrorString(hr), DXGetErrorDescription(hr));
 #endif
 
 			}
@@ -1571,6 +1622,8 @@ HRESULT WINAPI D3DProxyDevice::DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType,UINT
 	if(bSkipFrame)
 		return D3D_OK;
 
+	m_frameDrawCalls++;
+
 	//If we shouldn't draw this shader, then just return immediately
 	if (m_bDoNotDrawVShader || m_bDoNotDrawPShader)
 		return S_OK;
@@ -1597,6 +1650,8 @@ HRESULT WINAPI D3DProxyDevice::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveTy
 	if(bSkipFrame)
 		return D3D_OK;
 
+	m_frameDrawCalls++;
+
 	//If we shouldn't draw this shader, then just return immediately
 	if (m_bDoNotDrawVShader || m_bDoNotDrawPShader)
 		return S_OK;
@@ -1608,7 +1663,7 @@ HRESULT WINAPI D3DProxyDevice::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveTy
 		if (m_3DReconstructionMode == Reconstruction_Type::GEOMETRY && switchDrawingSide()) {			
 			HRESULT result2 = BaseDirect3DDevice9::DrawIndexedPrimitive(PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices, startIndex, primCount);
 			if (result != result2)
-				OutputDebugString("moop\n");
+				BLOG2("DrawIndexedPrimitive: right side result 0x%08x differs from left side 0x%08x", result2, result);
 		}
 	}
 
@@ -1626,6 +1681,8 @@ HRESULT WINAPI D3DProxyDevice::DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType,UI
 	if(bSkipFrame)
 		return D3D_OK;
 
+	m_frameDrawCalls++;
+
 	//If we shouldn't draw this shader, then just return immediately
 	if (m_bDoNotDrawVShader || m_bDoNotDrawPShader)
 		return S_OK;
@@ -1652,6 +1709,8 @@ HRESULT WINAPI D3DProxyDevice::DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE Primitive
 	if(bSkipFrame)
 		return D3D_OK;
 
+	m_frameDrawCalls++;
+
 	//If we shouldn't draw this shader, then just return immediately
 	if (m_bDoNotDrawVShader || m_bDoNotDrawPShader)
 		return S_OK;
@@ -1788,7 +1847,7 @@ HRESULT WINAPI D3DProxyDevice::CreateVertexShader(CONST DWORD* pFunction,IDirect
 		ProxyHelper ph;
 		std::string shaderCodeFilename = ph.GetBaseDir() + std::string("shader_replacements\\") + shaderReplacementCode;
 		OutputDebugString(("ReplaceShaderCode: " + shaderCodeFilename).c_str());
-		HRESULT hr = D3DXAssembleShaderFromFile(shaderCodeFilename.c_str(), NULL, NULL, 0, &pBuffer, NULL);
+		HRESULT hr = EffectCache::AssembleShaderFromFile(shaderCodeFilename, NULL, 0, &pBuffer);
 		if (FAILED(hr))
 		{
 			OutputDebugString("ReplaceShaderCode - FAILED - Using original Shader");
@@ -1798,6 +1857,7 @@ HRESULT WINAPI D3DProxyDevice::CreateVertexShader(CONST DWORD* pFunction,IDirect
 			pActualVShader->Release();
 			pActualVShader = NULL;
 			creationResult = BaseDirect3DDevice9::CreateVertexShader((const DWORD*)pBuffer->GetBufferPointer(), &pActualVShader);
+			pBuffer->Release();
 		}
 	}
 
@@ -2207,6 +2267,8 @@ HRESULT WINAPI D3DProxyDevice::DrawRectPatch(UINT Handle,CONST float* pNumSegs,C
 	if(bSkipFrame)
 		return D3D_OK;
 
+	m_frameDrawCalls++;
+
 	m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
 
 	HRESULT result;
@@ -2229,6 +2291,8 @@ HRESULT WINAPI D3DProxyDevice::DrawTriPatch(UINT Handle,CONST float* pNumSegs,CO
 	if(bSkipFrame)
 		return D3D_OK;
 
+	m_frameDrawCalls++;
+
 	m_spManagedShaderRegisters->ApplyAllDirty(m_currentRenderingSide);
 
 	HRESULT result;
@@ -2263,6 +2327,7 @@ HRESULT WINAPI D3DProxyDevice::CreateQuery(D3DQUERYTYPE Type,IDirect3DQuery9** p
 
 /**
 * Creates proxy (wrapped) render target, if swapchain buffer returns StereoBackBuffer, otherwise D3D9ProxySurface.
+* Swapchain buffers are created as render target textures where possible (sampled directly by the stereo view).
 * Duplicates render target if game handler agrees.
 * @see GameHandler::ShouldDuplicateRenderTarget()
 * @see StereoBackBuffer
@@ -2279,6 +2344,47 @@ HRESULT WINAPI D3DProxyDevice::CreateRenderTarget(UINT Width, UINT Height, D3DFO
 	if(bSkipFrame)
 		return D3D_OK;
 
+	// Swap chain back buffers are created as render target textures if possible, so the stereo view can sample 
+	// the eye images directly instead of copying them. Multisampled back buffers, formats not supported as 
+	// render target texture and shared surfaces fall back to plain render targets (copied by the stereo view).
+	if (isSwapChainBackBuffer && (MultiSample == D3DMULTISAMPLE_NONE) && !Lockable && (pSharedHandle == NULL)) {
+		IDirect3DTexture9* pLeftTexture = NULL;
+		IDirect3DTexture9* pRightTexture = NULL;
+
+		if (SUCCEEDED(BaseDirect3DDevice9::CreateTexture(Width, Height, 1, D3DUSAGE_RENDERTARGET, Format, D3DPOOL_DEFAULT, &pLeftTexture, NULL))) {
+
+			if (m_3DReconstructionMode == Reconstruction_Type::GEOMETRY && m_pGameHandler->ShouldDuplicateRenderTarget(Width, Height, Format, MultiSample, MultisampleQuality, Lockable, isSwapChainBackBuffer))
+			{
+				if (FAILED(BaseDirect3DDevice9::CreateTexture(Width, Height, 1, D3DUSAGE_RENDERTARGET, Format, D3DPOOL_DEFAULT, &pRightTexture, NULL))) {
+					OutputDebugString("Failed to create right eye back buffer texture while attempting to create stereo pair, falling back to mono\n");
+					pRightTexture = NULL;
+				}
+			}
+
+			if (pRightTexture && FAILED(pRightTexture->GetSurfaceLevel(0, &pRightRenderTarget))) {
+				OutputDebugString("Failed to get right eye back buffer texture surface, falling back to mono\n");
+				pRightTexture->Release();
+				pRightTexture = NULL;
+				pRightRenderTarget = NULL;
+			}
+
+			if (SUCCEEDED(pLeftTexture->GetSurfaceLevel(0, &pLeftRenderTarget))) {
+				*ppSurface = new StereoBackBuffer(pLeftRenderTarget, pRightRenderTarget, this, pLeftTexture, pRightTexture);
+				return D3D_OK;
+			}
+
+			if (pRightRenderTarget)
+				pRightRenderTarget->Release();
+			pRightRenderTarget = NULL;
+			if (pRightTexture)
+				pRightTexture->Release();
+			pLeftTexture->Release();
+			pLeftRenderTarget = NULL;
+		}
+
+		OutputDebugString("Back buffer not supported as render target texture, falling back to render target\n");
+	}
+
 	// create left/mono
 	if (SUCCEEDED(creationResult = BaseDirect3DDevice9::CreateRenderTarget(Width, Height, Format, MultiSample, MultisampleQuality, Lockable, &pLeftRenderTarget, pSharedHandle))) {
 
@@ -2325,6 +2431,10 @@ void D3DProxyDevice::Init(ProxyConfig& cfg)
 	config = cfg;
 	m_configBackup = cfg;
 
+	// log file in release builds too
+	if (config.logFile)
+		BinaryLog::SetFileOutput(true);
+
 	m_bfloatingMenu = false;
 	m_bfloatingScreen = false;
 	m_bSurpressHeadtracking = false;
@@ -2334,7 +2444,12 @@ void D3DProxyDevice::Init(ProxyConfig& cfg)
 
 	// first time configuration
 	m_spShaderViewAdjustment->Load(config);
-	m_pGameHandler->Load(config, m_spShaderViewAdjustment);
+
+	// shader rules (xml) load meanwhile, joined before the device objects are created
+	InitTaskGraph configuration;
+	configuration.Add("Shader rules", [this]() { m_pGameHandler->Load(config, m_spShaderViewAdjustment); });
+	configuration.Start();
+
 	stereoView = StereoViewFactory::Get(&config, m_spShaderViewAdjustment->HMDInfo());
 	stereoView->HeadYOffset = 0;
 	stereoView->HeadZOffset = FLT_MAX;
@@ -2343,6 +2458,7 @@ void D3DProxyDevice::Init(ProxyConfig& cfg)
 	m_maxDistortionScale = config.DistortionScale;
 
 	VPMENU_UpdateDeviceSettings();
+	configuration.WaitAll();
 	OnCreateOrRestore();
 	
 	//Check HMD is ok
@@ -2355,11 +2471,23 @@ void D3DProxyDevice::Init(ProxyConfig& cfg)
 
 /**
 * Creates HUD according to viewport height.
+* After a device reset the HUD fonts and sprites are restored instead of created again.
 ***/
 void D3DProxyDevice::SetupHUD()
 {
 	SHOW_CALL("SetupHUD");
 	
+	if (hudFont)
+	{
+		hudFont->OnResetDevice();
+		errorFont->OnResetDevice();
+		for (int fontSize = 0; fontSize < 27; ++fontSize)
+			popupFont[fontSize]->OnResetDevice();
+		hudMainMenu->OnResetDevice();
+		hudTextBox->OnResetDevice();
+		return;
+	}
+
 	D3DXCreateFont( this, 32, 0, FW_BOLD, 4, FALSE, DEFAULT_CHARSET, OUT_TT_ONLY_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, "Calibri", &hudFont );
 	D3DXCreateFont( this, 26, 0, FW_BOLD, 4, FALSE, DEFAULT_CHARSET, OUT_TT_ONLY_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, "Courier New", &errorFont );
 
@@ -2371,6 +2499,36 @@ void D3DProxyDevice::SetupHUD()
 	D3DXCreateSprite(this, &hudTextBox);
 }
 
+/**
+* Releases HUD fonts and sprites.
+* @see SetupHUD()
+***/
+void D3DProxyDevice::ReleaseHUD()
+{
+	SHOW_CALL("ReleaseHUD");
+
+	if (hudFont)
+	{
+		hudFont->Release();
+		hudFont = NULL;
+
+		errorFont->Release();
+		errorFont = NULL;
+
+		for (int fontSize = 0; fontSize < 27; ++fontSize)
+		{
+			popupFont[fontSize]->Release();
+			popupFont[fontSize] = NULL;
+		}
+
+		hudMainMenu->Release();
+		hudMainMenu = NULL;
+
+		hudTextBox->Release();
+		hudTextBox = NULL;
+	}
+}
+
 
 //Persist, just to the registry for now
 void D3DProxyDevice::DuckAndCover::SaveToRegistry()
@@ -2417,27 +2575,36 @@ void D3DProxyDevice::DuckAndCover::LoadFromRegistry()
 
 void D3DProxyDevice::HandleLandmarkMoment(DeviceBehavior::WhenToDo when)
 {
+	// tracker calls are serialized with the tracking worker
+	EnterCriticalSection(&m_trackerLock);
+
 	// handle controls 
 	if (m_deviceBehavior.whenToHandleHeadTracking == when)
 		HandleTracking();
 
 	// draw menu
 	if (m_deviceBehavior.whenToRenderVPMENU == when) {
+		GPU_PROFILE_MARK(m_gpuProfiler, GPS_HUD);
 		VPMENU();
+		GPU_PROFILE_MARK(m_gpuProfiler, GPS_OTHER);
 	}
+
+	LeaveCriticalSection(&m_trackerLock);
 }
 
 /**
-* Updates selected motion tracker orientation.
+* Updates selected motion tracker orientation (m_trackerLock held).
 ***/
 void D3DProxyDevice::HandleTracking()
 {
 	SHOW_CALL("HandleTracking");
+	PROFILE_SCOPE("HandleTracking");
 
 	if(!tracker)
 	{
 		InitTracker();
 	}
+	UpdateTracker();
 
 	if(!tracker || tracker->getStatus() < MTS_OK)
 	{
@@ -2472,15 +2639,38 @@ void D3DProxyDevice::HandleTracking()
 		}
 
 		tracker->currentRoll = 0;
+
+		// keep menu changes to the view adjustment visible without tracking
+		m_spShaderViewAdjustment->ComputeViewTransforms();
+		m_spShaderViewAdjustment->AcquireViewTransforms();
 		return;
 	}
 
-	float xPos=0, yPos=0, zPos=0;
-	float yaw=0, pitch=0, roll=0;
+	// settings the view adjustment update applies, the worker copies them under m_trackerLock
+	m_trackingSettings.positionTracking = m_bPosTrackingToggle && !m_bSurpressPositionaltracking;
+	m_trackingSettings.reducedY = (m_DuckAndCover.dfcStatus >= DAC_STANDING);
+	m_trackingSettings.translateX = VRBoostValue[VRboostAxis::CameraTranslateX] / 20.0f;
+	m_trackingSettings.translateY = VRBoostValue[VRboostAxis::CameraTranslateY] / 20.0f;
+	m_trackingSettings.translateZ = VRBoostValue[VRboostAxis::CameraTranslateZ] / 20.0f;
+
+	if (config.trackingWorker && !m_hTrackingThread)
+		StartTrackingWorker();
 
 	if(tracker->getStatus() >= MTS_OK)
 	{
-		tracker->updateOrientationAndPosition();
+		// poll the tracker and compute the view transforms here if there is no tracking worker
+		if (!m_hTrackingThread)
+		{
+			tracker->updateOrientationAndPosition();
+
+			LARGE_INTEGER sampleTick;
+			QueryPerformanceCounter(&sampleTick);
+			InterlockedExchange64(&m_orientationSampleTick, sampleTick.QuadPart);
+
+			TrackingInput input;
+			GetTrackingInput(&input);
+			UpdateViewAdjustment(input);
+		}
 
 		if (tracker->getStatus() == MTS_OK)
 		{
@@ -2525,50 +2715,8 @@ void D3DProxyDevice::HandleTracking()
 			}
 		}
 
-		// update view adjustment class
 		if (tracker->getStatus() >= MTS_OK)
 		{
-			//Roll implementation
-			switch (config.rollImpl)
-			{
-			case 0:
-				{
-					//Ensure this is 0, presumably VRBoost taking care of business
-					stereoView->m_rotation = 0.0f;
-				}
-			case 1:
-				{
-					if (tracker)
-						m_spShaderViewAdjustment->UpdateRoll(tracker->currentRoll);
-					stereoView->m_rotation = 0.0f;
-				}
-				break;
-			case 2:
-				{
-					//Set rotation on the stereo view and on the shader adjustment
-					if (tracker)
-					{
-						stereoView->m_rotation = tracker->currentRoll;
-						m_spShaderViewAdjustment->UpdateRoll(tracker->currentRoll);
-					}
-				}
-				break;
-			}
-
-			if (m_bPosTrackingToggle && tracker->getStatus() != MTS_LOSTPOSITIONAL
-				&& !m_bSurpressPositionaltracking)
-			{
-				//Use reduced Y-position tracking in DFC mode, user should be triggering crouch by moving up and down
-				float yPosition = (VRBoostValue[VRboostAxis::CameraTranslateY] / 20.0f) + tracker->primaryY;
-				if (m_DuckAndCover.dfcStatus >= DAC_STANDING)
-					yPosition *= 0.25f;
-
-				m_spShaderViewAdjustment->UpdatePosition(tracker->primaryYaw, tracker->primaryPitch, tracker->primaryRoll,
-					(VRBoostValue[VRboostAxis::CameraTranslateX] / 20.0f) + tracker->primaryX, 
-					yPosition,
-					(VRBoostValue[VRboostAxis::CameraTranslateZ] / 20.0f) + tracker->primaryZ);
-			}
-
 			//Now we test for whether we are using "duck for cover" (for crouch and prone)
 			if (m_DuckAndCover.dfcStatus == DAC_STANDING)
 			{
@@ -2713,7 +2861,14 @@ void D3DProxyDevice::HandleTracking()
 		stereoView->PostReset();
 	}
 
-	m_spShaderViewAdjustment->ComputeViewTransforms();
+	// use the latest view transforms for this frame
+	m_spShaderViewAdjustment->AcquireViewTransforms();
+
+	//Roll on the stereo view (pixel shader roll), no rotation otherwise
+	if (config.rollImpl == 2)
+		stereoView->m_rotation = m_spShaderViewAdjustment->Roll();
+	else
+		stereoView->m_rotation = 0.0f;
 
 	m_isFirstBeginSceneOfFrame = false;
 
@@ -3067,6 +3222,162 @@ void D3DProxyDevice::HandleTracking()
 	}
 }
 
+/**
+* Re-samples the head orientation just before composition and sets the rotational reprojection 
+* of the eye images (delta between the orientation of the frame's view snapshot and the present time 
+* orientation) on the stereo view.
+***/
+void D3DProxyDevice::HandleLateLatch()
+{
+	SHOW_CALL("HandleLateLatch");
+	PROFILE_SCOPE("HandleLateLatch");
+
+	stereoView->m_reprojection = Reprojection::Identity();
+
+	if (!config.lateLatchReprojection || !tracker || (tracker->getStatus() < MTS_OK))
+		return;
+
+	float yaw, pitch, roll;
+	if (!tracker->sampleOrientation(&yaw, &pitch, &roll))
+		return;
+
+	LARGE_INTEGER sampleTick;
+	QueryPerformanceCounter(&sampleTick);
+	InterlockedExchange64(&m_orientationSampleTick, sampleTick.QuadPart);
+
+	// delta against the orientation of the view snapshot acquired for this frame, no roll delta if roll isn't applied at all
+	D3DXVECTOR3 renderOrientation = m_spShaderViewAdjustment->Orientation();
+	if (config.rollImpl == 0)
+		renderOrientation.z = roll;
+
+	stereoView->m_reprojection = Reprojection::Compute(renderOrientation.x, renderOrientation.y, renderOrientation.z,
+		yaw, pitch, roll, config.PFOV, (float)stereoView->viewport.Width / (float)stereoView->viewport.Height);
+}
+
+/**
+* Copies the tracker pose and the render thread settings set by HandleTracking() (m_trackerLock held).
+***/
+void D3DProxyDevice::GetTrackingInput(TrackingInput* pInput)
+{
+	*pInput = m_trackingSettings;
+	pInput->status = tracker->getStatus();
+	pInput->yaw = tracker->primaryYaw;
+	pInput->pitch = tracker->primaryPitch;
+	pInput->roll = tracker->primaryRoll;
+	pInput->x = tracker->primaryX;
+	pInput->y = tracker->primaryY;
+	pInput->z = tracker->primaryZ;
+	pInput->currentRoll = tracker->currentRoll;
+}
+
+/**
+* Updates the view adjustment (roll, position) and publishes the view transforms.
+* Called by HandleTracking() or by the tracking worker, uses the given input only (the view
+* adjustment guards itself).
+***/
+void D3DProxyDevice::UpdateViewAdjustment(const TrackingInput& input)
+{
+	if (input.status >= MTS_OK)
+	{
+		m_spShaderViewAdjustment->UpdateOrientation(input.yaw, input.pitch, input.roll);
+
+		// every roll implementation rolls the view adjustment, the stereo view rotation is set per frame
+		m_spShaderViewAdjustment->UpdateRoll(input.currentRoll);
+
+		if (input.positionTracking && input.status != MTS_LOSTPOSITIONAL)
+		{
+			//Use reduced Y-position tracking in DFC mode, user should be triggering crouch by moving up and down
+			float yPosition = input.translateY + input.y;
+			if (input.reducedY)
+				yPosition *= 0.25f;
+
+			m_spShaderViewAdjustment->UpdatePosition(input.yaw, input.pitch, input.roll,
+				input.translateX + input.x, 
+				yPosition,
+				input.translateZ + input.z);
+		}
+	}
+
+	m_spShaderViewAdjustment->ComputeViewTransforms();
+}
+
+/**
+* Starts the tracking worker : tracker polling and view transform computation move off the render thread.
+* @return False if the thread could not be created (tracking stays in HandleTracking()).
+***/
+bool D3DProxyDevice::StartTrackingWorker()
+{
+	if (m_hTrackingThread)
+		return true;
+
+	m_hTrackingStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!m_hTrackingStopEvent)
+		return false;
+
+	m_hTrackingThread = CreateThread(NULL, 0, TrackingWorkerThread, this, 0, NULL);
+	if (!m_hTrackingThread)
+	{
+		OutputDebugString("Could not create tracking worker thread\n");
+		CloseHandle(m_hTrackingStopEvent);
+		m_hTrackingStopEvent = NULL;
+		return false;
+	}
+
+	SetThreadPriority(m_hTrackingThread, THREAD_PRIORITY_ABOVE_NORMAL);
+	return true;
+}
+
+/**
+* Stops the tracking worker, before the tracker or the view adjustment are released.
+* Must not be called with m_trackerLock held, the worker takes it.
+***/
+void D3DProxyDevice::StopTrackingWorker()
+{
+	if (!m_hTrackingThread)
+		return;
+
+	SetEvent(m_hTrackingStopEvent);
+	WaitForSingleObject(m_hTrackingThread, INFINITE);
+	CloseHandle(m_hTrackingThread);
+	CloseHandle(m_hTrackingStopEvent);
+	m_hTrackingThread = NULL;
+	m_hTrackingStopEvent = NULL;
+}
+
+/**
+* Tracking worker thread : polls the tracker and publishes a view transform snapshot every
+* TRACKING_WORKER_INTERVAL_MS, so the snapshot acquired at the start of a frame is at most that old.
+* The tracker is polled under m_trackerLock, the view transforms are computed from the copied input
+* after releasing it.
+***/
+DWORD WINAPI D3DProxyDevice::TrackingWorkerThread(LPVOID pParam)
+{
+	D3DProxyDevice* pDevice = (D3DProxyDevice*)pParam;
+
+	timeBeginPeriod(1);
+	while (WaitForSingleObject(pDevice->m_hTrackingStopEvent, TRACKING_WORKER_INTERVAL_MS) == WAIT_TIMEOUT)
+	{
+		TrackingInput input;
+
+		EnterCriticalSection(&pDevice->m_trackerLock);
+		if (pDevice->tracker->getStatus() >= MTS_OK)
+		{
+			pDevice->tracker->updateOrientationAndPosition();
+
+			LARGE_INTEGER sampleTick;
+			QueryPerformanceCounter(&sampleTick);
+			InterlockedExchange64(&pDevice->m_orientationSampleTick, sampleTick.QuadPart);
+		}
+		pDevice->GetTrackingInput(&input);
+		LeaveCriticalSection(&pDevice->m_trackerLock);
+
+		pDevice->UpdateViewAdjustment(input);
+	}
+	timeEndPeriod(1);
+
+	return 0;
+}
+
 /**
 * Handles all updates if Present() is called in an extern swap chain.
 ***/
@@ -3149,6 +3460,7 @@ void D3DProxyDevice::OnCreateOrRestore()
 
 	m_spShaderViewAdjustment->UpdateProjectionMatrices((float)stereoView->viewport.Width/(float)stereoView->viewport.Height, config.PFOV);
 	m_spShaderViewAdjustment->ComputeViewTransforms();
+	m_spShaderViewAdjustment->AcquireViewTransforms();
 
 	// set VP main values
 	viewportWidth = stereoView->viewport.Width;
@@ -3175,6 +3487,7 @@ void D3DProxyDevice::OnCreateOrRestore()
 bool D3DProxyDevice::setDrawingSide(vireio::RenderPosition side)
 {
 	SHOW_CALL("SetDrawingSide");
+	PROFILE_SCOPE("setDrawingSide");
 	
 	// Already on the correct eye
 	if (side == m_currentRenderingSide) {
@@ -3189,6 +3502,8 @@ bool D3DProxyDevice::setDrawingSide(vireio::RenderPosition side)
 	// Everything hasn't changed yet but we set this first so we don't accidentally use the member instead of the local and break
 	// things, as I have already managed twice.
 	m_currentRenderingSide = side;
+	m_frameEyeSwitches++;
+	GPU_PROFILE_MARK(m_gpuProfiler, (side == vireio::Left) ? GPS_LEFT_EYE : GPS_RIGHT_EYE);
 
 	// switch render targets to new side
 	bool renderTargetChanged = false;
@@ -3434,37 +3749,126 @@ float D3DProxyDevice::CalcFPS()
     return FPS;
 }
 
+/**
+* Creates the telemetry shared memory (replaces the former FPS registry value).
+* Telemetry is optional, the proxy runs without it if the mapping fails.
+***/
+void D3DProxyDevice::OpenTelemetry()
+{
+	ZeroMemory(&m_telemetry, sizeof(TelemetryData));
+	m_telemetry.processId = GetCurrentProcessId();
+	m_frameDrawCalls = 0;
+	m_frameEyeSwitches = 0;
+	m_orientationSampleTick = 0;
+	m_lastPresentTick = 0;
+	m_pTelemetry = NULL;
+
+	// unique among all proxy devices of all processes
+	static volatile LONG telemetryDevices = 0;
+	m_telemetryWriterId = ((LONGLONG)GetCurrentProcessId() << 32) | (ULONG)InterlockedIncrement(&telemetryDevices);
+
+	m_hTelemetryMapping = CreateFileMapping(
+		INVALID_HANDLE_VALUE,	// use paging file
+		NULL,					// default security
+		PAGE_READWRITE,			// read/write access
+		0,						// maximum object size (high-order DWORD)
+		sizeof(TelemetryData),	// maximum object size (low-order DWORD)
+		TELEMETRY_SHARED_MEMORY_NAME);
+	if (m_hTelemetryMapping == NULL)
+	{
+		OutputDebugString("Could not create telemetry file mapping.\n");
+		return;
+	}
+
+	m_pTelemetry = (TelemetryData*)MapViewOfFile(m_hTelemetryMapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TelemetryData));
+	if (m_pTelemetry == NULL)
+	{
+		OutputDebugString("Could not map telemetry view of file.\n");
+		CloseHandle(m_hTelemetryMapping);
+		m_hTelemetryMapping = NULL;
+	}
+}
+
+/**
+* Unmaps and closes the telemetry shared memory.
+***/
+void D3DProxyDevice::CloseTelemetry()
+{
+	if (m_pTelemetry)
+	{
+		TelemetryRelease(m_pTelemetry, m_telemetryWriterId);
+		UnmapViewOfFile(m_pTelemetry);
+		m_pTelemetry = NULL;
+	}
+	if (m_hTelemetryMapping)
+	{
+		CloseHandle(m_hTelemetryMapping);
+		m_hTelemetryMapping = NULL;
+	}
+}
+
+/**
+* Publishes the frame statistics to the telemetry shared memory, called every Present.
+* No registry or file access here, just a copy into the mapped block.
+***/
+void D3DProxyDevice::UpdateTelemetry()
+{
+	static LARGE_INTEGER perffreq = {0};
+	if (perffreq.QuadPart == 0)
+		QueryPerformanceFrequency(&perffreq);
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	if (m_lastPresentTick != 0)
+	{
+		m_telemetry.frameTimeMs = (float)((double)(now.QuadPart - m_lastPresentTick) * 1000.0 / (double)perffreq.QuadPart);
+		m_telemetry.frameTimeHistogram[TelemetryHistogramBucket(m_telemetry.frameTimeMs)]++;
+	}
+	m_lastPresentTick = now.QuadPart;
+
+	LONGLONG orientationSampleTick = InterlockedCompareExchange64(&m_orientationSampleTick, 0, 0);
+	if (orientationSampleTick != 0)
+		m_telemetry.trackerLatencyMs = (float)((double)(now.QuadPart - orientationSampleTick) * 1000.0 / (double)perffreq.QuadPart);
+	else
+		m_telemetry.trackerLatencyMs = 0.0f;
+
+	m_telemetry.fps = fps;
+	m_telemetry.frameCount++;
+	m_telemetry.tickCount = GetTickCount();
+	m_telemetry.drawCalls = m_frameDrawCalls;
+	m_telemetry.eyeSwitches = m_frameEyeSwitches;
+
+	m_frameDrawCalls = 0;
+	m_frameEyeSwitches = 0;
+
+	// only one device publishes, see TelemetryClaim()
+	if (m_pTelemetry && TelemetryClaim(m_pTelemetry, m_telemetryWriterId))
+		TelemetryWrite(m_pTelemetry, m_telemetry);
+}
+
 
 /**
-* Releases HUD font, shader registers, render targets, texture stages, vertex buffers, depth stencils, indices, shaders, declarations.
+* Releases shader registers, render targets, texture stages, vertex buffers, depth stencils, indices, shaders, declarations.
+* The HUD fonts and sprites are kept (lost device), restored by SetupHUD() and released by ReleaseHUD().
 ***/
 void D3DProxyDevice::ReleaseEverything()
 {
 	SHOW_CALL("ReleaseEverything");
 	
-	// Fonts and any other D3DX interfaces should be released first.
+	m_gpuProfiler.ReleaseEverything();
+
+	// Fonts and any other D3DX interfaces should be handled first.
 	// They frequently hold stateblocks which are holding further references to other resources.
 	if(hudFont) {
-		hudFont->Release();
-		hudFont = NULL;
+		hudFont->OnLostDevice();
+		errorFont->OnLostDevice();
 
 		for (int fontSize = 0; fontSize < 27; ++fontSize)
-		{
-			popupFont[fontSize]->Release();
-			popupFont[fontSize] = NULL;
-		}
-	}
+			popupFont[fontSize]->OnLostDevice();
 
-	if (hudMainMenu)
-	{
-		hudMainMenu->Release();
-		hudMainMenu = NULL;
-	}
-
-	if (hudTextBox)
-	{
-		hudTextBox->Release();
-		hudTextBox = NULL;
+		hudMainMenu->OnLostDevice();
+		hudTextBox->OnLostDevice();
 	}
 
 	m_spManagedShaderRegisters->ReleaseResources();
@@ -3651,6 +4055,7 @@ void D3DProxyDevice::SetGUIViewport()
 	float floatMultiplier = 4;
 	int originalX = (int)(vOut.x+centerX);
 	int originalY = (int)(vOut.y+centerY);
+	EnterCriticalSection(&m_trackerLock);
 	if(m_bfloatingMenu && (tracker->getStatus() >= MTS_OK))
 	{
 		/*char buf[64];
@@ -3665,6 +4070,7 @@ void D3DProxyDevice::SetGUIViewport()
 		m_ViewportIfSquished.X = (int)(vOut.x+centerX);
 		m_ViewportIfSquished.Y = (int)(vOut.y+centerY);
 	}
+	LeaveCriticalSection(&m_trackerLock);
 
 	// get right/bottom viewport sides
 	vIn = D3DXVECTOR3((FLOAT)(stereoView->viewport.Width+stereoView->viewport.X)-centerX, (FLOAT)(stereoView->viewport.Height+stereoView->viewport.Y)-centerY,1);
@@ -3774,8 +4180,8 @@ bool D3DProxyDevice::InitVRBoost()
 }
 
 /*
- * Initializes the tracker, setting the tracker initialized status.
- * @return true if tracker was initialized, false otherwise
+ * Initializes the tracker : starts creating the configured tracker, a neutral tracker is used meanwhile.
+ * @return true if the tracker is already usable, false otherwise
  */
 bool D3DProxyDevice::InitTracker()
 {
@@ -3784,27 +4190,102 @@ bool D3DProxyDevice::InitTracker()
 	// VRboost rules present ?
 	if (config.VRboostPath != "") m_VRboostRulesPresent = true; else m_VRboostRulesPresent = false;
  
+	// one recording per session, reconnected trackers continue it
+	if (!config.trackerRecordPath.empty() && !m_poseRecorder.IsOpen())
+		m_poseRecorder.Open(config.trackerRecordPath.c_str());
+
 	OutputDebugString("GB - Try to init Tracker\n");
-	tracker.reset(MotionTrackerFactory::Get(config));
-	if (tracker && tracker->getStatus() >= MTS_OK)
+	tracker.reset(m_trackerConnection.Start(&config));
+	OutputDebugString("Setting Multipliers\n");
+	tracker->setMultipliers(config.yaw_multiplier, config.pitch_multiplier, config.roll_multiplier);
+	if (m_trackerConnection.GetState() == TCS_ACTIVE)
+	{
+		// no probe thread, tracker created synchronously
+		ConfigureTracker();
+		return (tracker->getStatus() >= MTS_OK);
+	}
+
+	return false;
+}
+
+/*
+ * Switches the tracker if it connected or got lost (once per frame, m_trackerLock held).
+ */
+void D3DProxyDevice::UpdateTracker()
+{
+	SHOW_CALL("UpdateTracker");
+
+	// read before the update, a switch may delete the current tracker
+	float yawMultiplier = tracker->multiplierYaw;
+	float pitchMultiplier = tracker->multiplierPitch;
+	float rollMultiplier = tracker->multiplierRoll;
+
+	MotionTracker* pNewTracker = m_trackerConnection.Update(tracker.get());
+	if (!pNewTracker)
+		return;
+
+	// the connection owns (and releases) the old tracker now, don't touch it anymore; the worker
+	// polls the new one under m_trackerLock (held by the caller)
+	tracker.release();
+	tracker.reset(pNewTracker);
+	tracker->setMultipliers(yawMultiplier, pitchMultiplier, rollMultiplier);
+
+	if (m_trackerConnection.GetState() == TCS_ACTIVE)
 	{
 		OutputDebugString("Tracker Got\n");
-		OutputDebugString("Setting Multipliers\n");
-		tracker->setMultipliers(config.yaw_multiplier, config.pitch_multiplier, config.roll_multiplier);
-		OutputDebugString("Setting Mouse EMu\n");
-		tracker->setMouseEmulation((!m_VRboostRulesPresent) || (hmVRboost==NULL));
+		ConfigureTracker();
+	}
+	else
+	{
+		// neutral pose until the tracker is back
+		m_spShaderViewAdjustment->UpdateOrientation(0.0f, 0.0f, 0.0f);
+		m_spShaderViewAdjustment->UpdateRoll(0.0f);
+		m_spShaderViewAdjustment->UpdatePosition(0.0f, 0.0f, 0.0f);
+	}
 
-		//Set the default timewarp prediction behaviour for this game - this will have no effect on non-Oculus trackers
-		tracker->useSDKPosePrediction = config.useSDKPosePrediction;
+	// publish on the switch frame, even if the new tracker is not polled before the frame acquires
+	m_spShaderViewAdjustment->ComputeViewTransforms();
+}
 
-		//Only advise calibration for positional tracking on DK2
-		if (tracker->SupportsPositionTracking())
-			calibrate_tracker = true;
+/*
+ * Applies the game configuration to a connected tracker.
+ */
+void D3DProxyDevice::ConfigureTracker()
+{
+	SHOW_CALL("ConfigureTracker");
 
-		return true;
+	// an initialising tracker gets the same setup, it reports MTS_OK once ready
+	OutputDebugString("Setting Mouse EMu\n");
+	tracker->setMouseEmulation((!m_VRboostRulesPresent) || (hmVRboost==NULL));
+
+	//Set the default timewarp prediction behaviour for this game - this will have no effect on non-Oculus trackers
+	tracker->useSDKPosePrediction = config.useSDKPosePrediction;
+
+	//Read the device on the sampling thread, if the tracker supports it
+	if (config.trackerSampling)
+		tracker->startSampling();
+
+	//Pose prediction - this will have no effect on the Oculus tracker (SDK prediction)
+	tracker->setPrediction(config.predictionMs, config.predictionVelocityFilter, config.predictionAccelerationFilter);
+
+	//Mouse emulation on its own timer, resampling the sampled poses if sampling
+	if (config.mouseEmulationRate > 0.0f)
+	{
+		MouseAxisCurve yawCurve, pitchCurve;
+		yawCurve.deadzone = config.mouseYawDeadzone;
+		yawCurve.exponent = config.mouseYawExponent;
+		pitchCurve.deadzone = config.mousePitchDeadzone;
+		pitchCurve.exponent = config.mousePitchExponent;
+		tracker->startMouseEmulation(config.mouseEmulationRate, yawCurve, pitchCurve);
 	}
 
-	return false;
+	//Record the raw poses
+	if (m_poseRecorder.IsOpen())
+		tracker->setRecorder(&m_poseRecorder);
+
+	//Only advise calibration for positional tracking on DK2
+	if (tracker->SupportsPositionTracking())
+		calibrate_tracker = true;
 }
 
 
@@ -56,6 +56,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ProxyHelper.h"
 #include "StereoView.h"
 #include "MotionTracker.h"
+#include "MotionTrackerConnection.h"
+#include "ConfigSaver.h"
 #include <d3dx9.h>
 #include <XInput.h>
 #include <stdio.h>
@@ -79,6 +81,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "VireioPopup.h"
 #include "ConfigDefaults.h"
 #include "InGameMenus.h"
+#include "FrameProfiler.h"
+#include "BinaryLog.h"
+#include "Telemetry.h"
+#include "GpuProfiler.h"
 
 #define _SAFE_RELEASE(x) if(x) { x->Release(); x = NULL; } 
 #define RECT_WIDTH(x) (x.right - x.left)
@@ -90,7 +96,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define COOLDOWN_EXTRA_LONG 10.0f
 
 
-// Define SHOW_CALLS to have each method output a debug string when it is invoked
+// Define SHOW_CALLS to have each method log (binary log, see BinaryLog) when it is invoked
 //#define SHOW_CALLS
 
 class StereoView;
@@ -101,10 +107,10 @@ struct HMDisplayInfo;
 
 struct CallLogger
 {
-	CallLogger(std::string call) {OutputDebugString(("Called " + call).c_str()); m_call = call;}
-	~CallLogger() {OutputDebugString(("Exited " + m_call).c_str());}
+	CallLogger(const char* call) : m_call(call) { BLOG1("Called %s", m_call); }
+	~CallLogger() { BLOG1("Exited %s", m_call); }
 private:
-	std::string m_call;
+	const char* m_call;
 };
 
 #ifdef SHOW_CALLS
@@ -198,6 +204,7 @@ public:
 	void           SetupHUD();
 	virtual void   HandleControls(void);
 	void           HandleTracking(void);
+	void           HandleLateLatch(void);
 	void           HandleUpdateExtern();
 	void		   SetGameWindow(HWND hMainGameWindow);
 	
@@ -326,6 +333,17 @@ public:
 	**/
 	std::unique_ptr<MotionTracker> tracker;
 	/**
+	* Creates the tracker asynchronously, switches the tracker on connect and loss.
+	* @see MotionTrackerConnection
+	**/
+	MotionTrackerConnection m_trackerConnection;
+	/**
+	* Records the tracker poses if config.trackerRecordPath is set, kept across tracker switches.
+	* Written on the tracker poll (worker or render thread) under m_trackerLock, one pose per poll.
+	* @see PoseRecorder
+	**/
+	PoseRecorder m_poseRecorder;
+	/**
 	* HUD font to be used for SHOCT.
 	**/
 	ID3DXFont *hudFont;
@@ -387,6 +405,10 @@ protected:
 	/// Timer used to indicate that an adjuster changed a config value and when
 	/// timer expires, config should be saved
 	DWORD m_saveConfigTimer;
+
+	/// Writes the configuration snapshots on its own thread, so saving never
+	/// blocks the render thread on disk I/O.
+	ConfigSaver m_configSaver;
 	
 	/// Indicate that the configuration needs to be saved, but don't do it
 	/// immediately.
@@ -657,6 +679,7 @@ protected:
 private:
 	/*** D3DProxyDevice private methods ***/
 	void    ReleaseEverything();
+	void    ReleaseHUD();
 	bool    isViewportDefaultForMainRT(CONST D3DVIEWPORT9* pViewport);
 	HRESULT SetStereoViewTransform(D3DXMATRIX pLeftMatrix, D3DXMATRIX pRightMatrix, bool apply);
 	HRESULT SetStereoProjectionTransform(D3DXMATRIX pLeftMatrix, D3DXMATRIX pRightMatrix, bool apply);
@@ -664,10 +687,93 @@ private:
 	float   RoundVireioValue(float val);
 	bool	InitVRBoost();
 	bool	InitTracker();
+	void    UpdateTracker();
+	void    ConfigureTracker();
+
+	/**
+	* Everything UpdateViewAdjustment() applies : the tracker pose plus the render thread settings.
+	* Copied under m_trackerLock, so the view adjustment update never reads device state.
+	***/
+	struct TrackingInput
+	{
+		MotionTrackerStatus status;
+		float yaw, pitch, roll;       /**< Primary orientation, radians */
+		float x, y, z;                /**< Primary position */
+		float currentRoll;            /**< Roll to apply, radians */
+		bool  positionTracking;       /**< Position tracking toggled on and not suppressed */
+		bool  reducedY;               /**< Duck and cover active, reduced Y position */
+		float translateX, translateY, translateZ;   /**< VRboost camera translation */
+	};
+
+	void    GetTrackingInput(TrackingInput* pInput);
+	void    UpdateViewAdjustment(const TrackingInput& input);
+	bool    StartTrackingWorker();
+	void    StopTrackingWorker();
+	static DWORD WINAPI TrackingWorkerThread(LPVOID pParam);
+
+	/**
+	* Tracking worker thread (NULL : tracking runs in HandleTracking()) and its stop event.
+	* The worker polls the tracker and publishes view transform snapshots, the render thread
+	* acquires the latest snapshot once per frame.
+	***/
+	HANDLE m_hTrackingThread;
+	HANDLE m_hTrackingStopEvent;
+	/**
+	* Guards the tracker (every call, its members and the tracker switch) and m_trackingSettings.
+	* Taken by the tracking worker for each poll, by the render thread around tracking, hotkeys and menus.
+	* Never held while stopping the worker.
+	***/
+	CRITICAL_SECTION m_trackerLock;
+	/**
+	* Render thread settings of the next TrackingInput, set by HandleTracking() once per frame 
+	* (status and pose members unused).
+	***/
+	TrackingInput m_trackingSettings;
 
 	//Calculate FPS, called every Present
 	float fps;
 	float CalcFPS();
+	void  OpenTelemetry();
+	void  CloseTelemetry();
+	void  UpdateTelemetry();
+
+	/**
+	* Telemetry file mapping handle.
+	***/
+	HANDLE m_hTelemetryMapping;
+	/**
+	* Telemetry shared block (mapped view), NULL if not available.
+	***/
+	TelemetryData* m_pTelemetry;
+	/**
+	* Telemetry values, published to the shared block once per frame.
+	***/
+	TelemetryData m_telemetry;
+	/**
+	* Writer id of this device for the telemetry writer claim (process id, device number).
+	***/
+	LONGLONG m_telemetryWriterId;
+	/**
+	* Game draw calls since last Present().
+	***/
+	UINT m_frameDrawCalls;
+	/**
+	* Render side switches since last Present().
+	***/
+	UINT m_frameEyeSwitches;
+	/**
+	* Performance counter at the last head orientation sample (zero if none).
+	* Written by the tracking worker as well, InterlockedExchange64() only (atomic on x86 too).
+	***/
+	volatile LONGLONG m_orientationSampleTick;
+	/**
+	* Performance counter at the last Present() (zero if none).
+	***/
+	LONGLONG m_lastPresentTick;
+	/**
+	* GPU timestamp profiler (active if PROFILE_GPU is defined).
+	***/
+	GpuProfiler m_gpuProfiler;
 	
 
 
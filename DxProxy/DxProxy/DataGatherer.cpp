@@ -1399,7 +1399,6 @@ void DataGatherer::saveShaderRules()
 	
 	m_pGameHandler->Save(config, m_spShaderViewAdjustment);
 
-	ProxyHelper* helper = new ProxyHelper();
-	helper->SaveConfig(config);
-	delete helper;
+	// the game configuration is written on the saver thread
+	m_configSaver.Submit(config);
 }
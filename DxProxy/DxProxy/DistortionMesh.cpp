@@ -0,0 +1,275 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <DistortionMesh.cpp> and
+Class <DistortionMesh> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "DistortionMesh.h"
+#include <math.h>
+#include <xmmintrin.h>
+
+/**
+* Warps four texture coordinates of one color channel.
+* Same steps as HmdWarp(), rotatePoint(), the unmirroring, viewport offset and ScalePoint() in 
+* OculusRift.fx.
+* @param px Mirrored (for the right eye) screen x coordinates.
+* @param py Screen y coordinates.
+* @param chromaX Chromatic aberration coefficient 0 of the channel.
+* @param chromaY Chromatic aberration coefficient 1 of the channel.
+* @param sinAngle Sine of the eye rotation.
+* @param cosAngle Cosine of the eye rotation.
+* @param rightEye True to unmirror the result.
+***/
+static void WarpChannel4(const DistortionParameters& p, __m128 px, __m128 py, float chromaX, float chromaY,
+						 float sinAngle, float cosAngle, bool rightEye, __m128* pOutX, __m128* pOutY)
+{
+	// HmdWarp
+	__m128 thetaX = _mm_mul_ps(_mm_sub_ps(px, _mm_set1_ps(p.LensCenter[0])), _mm_set1_ps(p.ScaleIn[0]));
+	__m128 thetaY = _mm_mul_ps(_mm_sub_ps(py, _mm_set1_ps(p.LensCenter[1])), _mm_set1_ps(p.ScaleIn[1]));
+	__m128 rSq = _mm_add_ps(_mm_mul_ps(thetaX, thetaX), _mm_mul_ps(thetaY, thetaY));
+	__m128 rSq2 = _mm_mul_ps(rSq, rSq);
+	__m128 rSq3 = _mm_mul_ps(rSq2, rSq);
+
+	__m128 chroma = _mm_add_ps(_mm_set1_ps(1.0f + chromaX), _mm_mul_ps(_mm_set1_ps(chromaY), rSq));
+	__m128 warp = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_set1_ps(p.HmdWarpParam[0]),
+		_mm_mul_ps(_mm_set1_ps(p.HmdWarpParam[1]), rSq)),
+		_mm_mul_ps(_mm_set1_ps(p.HmdWarpParam[2]), rSq2)),
+		_mm_mul_ps(_mm_set1_ps(p.HmdWarpParam[3]), rSq3));
+
+	thetaX = _mm_mul_ps(_mm_mul_ps(thetaX, chroma), warp);
+	thetaY = _mm_mul_ps(_mm_mul_ps(thetaY, chroma), warp);
+
+	__m128 x = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.Scale[0]), thetaX), _mm_set1_ps(p.LensCenter[0]));
+	__m128 y = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.Scale[1]), thetaY), _mm_set1_ps(p.LensCenter[1]));
+	x = _mm_sub_ps(x, _mm_set1_ps(p.LensCenter[0] - 0.25f));
+	y = _mm_sub_ps(y, _mm_set1_ps(p.LensCenter[1] - 0.5f));
+	x = _mm_mul_ps(x, _mm_set1_ps(2.0f));
+
+	__m128 centerY = _mm_set1_ps(1.0f - p.LensCenter[1]);
+
+	// rotatePoint
+	if (p.Rotation != 0.0f) {
+		__m128 aspect = _mm_set1_ps(p.Resolution[0] / p.Resolution[1]);
+		__m128 sinA = _mm_set1_ps(sinAngle);
+		__m128 cosA = _mm_set1_ps(cosAngle);
+
+		__m128 newX = _mm_sub_ps(x, _mm_set1_ps(0.5f));
+		__m128 newY = _mm_div_ps(_mm_sub_ps(y, centerY), aspect);
+		x = _mm_sub_ps(_mm_mul_ps(newX, cosA), _mm_mul_ps(newY, sinA));
+		y = _mm_add_ps(_mm_mul_ps(newX, sinA), _mm_mul_ps(newY, cosA));
+		y = _mm_mul_ps(y, aspect);
+
+		x = _mm_add_ps(x, _mm_set1_ps(0.5f));
+		y = _mm_add_ps(y, centerY);
+	}
+
+	if (rightEye)
+		x = _mm_sub_ps(_mm_set1_ps(1.0f), x);
+
+	x = _mm_sub_ps(x, _mm_set1_ps(p.ViewportXOffset));
+	y = _mm_sub_ps(y, _mm_set1_ps(p.ViewportYOffset));
+
+	// ScalePoint
+	__m128 zoom = _mm_set1_ps(p.ZoomScale);
+	*pOutX = _mm_add_ps(_mm_div_ps(_mm_sub_ps(x, _mm_set1_ps(0.5f)), zoom), _mm_set1_ps(0.5f));
+	*pOutY = _mm_add_ps(_mm_div_ps(_mm_sub_ps(y, centerY), zoom), centerY);
+}
+
+/**
+* Scalar version of WarpChannel4(), for one texture coordinate.
+***/
+static void WarpChannel(const DistortionParameters& p, float px, float py, float chromaX, float chromaY,
+						float angle, bool rightEye, float* pOut)
+{
+	float thetaX = (px - p.LensCenter[0]) * p.ScaleIn[0];
+	float thetaY = (py - p.LensCenter[1]) * p.ScaleIn[1];
+	float rSq = thetaX * thetaX + thetaY * thetaY;
+	float rSq2 = rSq * rSq;
+	float rSq3 = rSq2 * rSq;
+
+	float chroma = (1.0f + chromaX) + chromaY * rSq;
+	float warp = p.HmdWarpParam[0] + p.HmdWarpParam[1] * rSq + p.HmdWarpParam[2] * rSq2 + p.HmdWarpParam[3] * rSq3;
+
+	thetaX = thetaX * chroma * warp;
+	thetaY = thetaY * chroma * warp;
+
+	float x = (p.Scale[0] * thetaX) + p.LensCenter[0];
+	float y = (p.Scale[1] * thetaY) + p.LensCenter[1];
+	x = x - (p.LensCenter[0] - 0.25f);
+	y = y - (p.LensCenter[1] - 0.5f);
+	x *= 2.0f;
+
+	float centerY = 1.0f - p.LensCenter[1];
+
+	if (angle != 0.0f) {
+		float aspect = p.Resolution[0] / p.Resolution[1];
+		float s = sinf(angle);
+		float c = cosf(angle);
+
+		float newX = x - 0.5f;
+		float newY = (y - centerY) / aspect;
+		x = newX * c - newY * s;
+		y = (newX * s + newY * c) * aspect;
+
+		x += 0.5f;
+		y += centerY;
+	}
+
+	if (rightEye)
+		x = 1.0f - x;
+
+	x = x - p.ViewportXOffset;
+	y = y - p.ViewportYOffset;
+
+	pOut[0] = ((x - 0.5f) / p.ZoomScale) + 0.5f;
+	pOut[1] = ((y - centerY) / p.ZoomScale) + centerY;
+}
+
+/**
+* Builds the vertices of both eye grids.
+* Vertices are ordered by eye, row, column. The texture coordinates of four vertices of a row are 
+* warped at once.
+* @param params The distortion parameters.
+* @param vertices Receives VertexCount() vertices.
+***/
+void DistortionMesh::BuildVertices(const DistortionParameters& params, std::vector<DISTORTIONVERTEX>& vertices)
+{
+	const UINT columnVertices = DISTORTION_MESH_COLUMNS + 1;
+
+	vertices.resize(VertexCount());
+	DISTORTIONVERTEX* pVertex = &vertices[0];
+
+	for (UINT eye = 0; eye < 2; eye++) {
+		// right eye is mirrored and rotated the other way
+		bool rightEye = (eye == 1);
+		float angle = rightEye ? -params.Rotation : params.Rotation;
+		float sinAngle = sinf(angle);
+		float cosAngle = cosf(angle);
+
+		for (UINT row = 0; row <= DISTORTION_MESH_ROWS; row++) {
+			float v = (float)row / (float)DISTORTION_MESH_ROWS;
+			__m128 py = _mm_set1_ps(v);
+
+			for (UINT column = 0; column < columnVertices; column += 4) {
+				// lanes past the end of the row are computed but not stored
+				float u[4];
+				float mirroredU[4];
+				for (UINT lane = 0; lane < 4; lane++) {
+					u[lane] = (eye * 0.5f) + (0.5f * (float)(column + lane) / (float)DISTORTION_MESH_COLUMNS);
+					mirroredU[lane] = rightEye ? (1.0f - u[lane]) : u[lane];
+				}
+				__m128 px = _mm_loadu_ps(mirroredU);
+
+				__m128 redX, redY, greenX, greenY, blueX, blueY;
+				WarpChannel4(params, px, py, params.Chroma[0], params.Chroma[1], sinAngle, cosAngle, rightEye, &redX, &redY);
+				WarpChannel4(params, px, py, 0.0f, 0.0f, sinAngle, cosAngle, rightEye, &greenX, &greenY);
+				WarpChannel4(params, px, py, params.Chroma[2], params.Chroma[3], sinAngle, cosAngle, rightEye, &blueX, &blueY);
+
+				float red[2][4], green[2][4], blue[2][4];
+				_mm_storeu_ps(red[0], redX);
+				_mm_storeu_ps(red[1], redY);
+				_mm_storeu_ps(green[0], greenX);
+				_mm_storeu_ps(green[1], greenY);
+				_mm_storeu_ps(blue[0], blueX);
+				_mm_storeu_ps(blue[1], blueY);
+
+				UINT lanes = columnVertices - column;
+				if (lanes > 4)
+					lanes = 4;
+
+				for (UINT lane = 0; lane < lanes; lane++) {
+					pVertex->x = (u[lane] * params.TargetWidth) - 0.5f;
+					pVertex->y = (v * params.TargetHeight) - 0.5f;
+					pVertex->z = 0.0f;
+					pVertex->rhw = 1.0f;
+					pVertex->u = u[lane];
+					pVertex->v = v;
+					pVertex->redU = red[0][lane];
+					pVertex->redV = red[1][lane];
+					pVertex->greenU = green[0][lane];
+					pVertex->greenV = green[1][lane];
+					pVertex->blueU = blue[0][lane];
+					pVertex->blueV = blue[1][lane];
+					++pVertex;
+				}
+			}
+		}
+	}
+}
+
+/**
+* Builds the triangle list indices of both eye grids.
+* Only depends on the grid size, so only needs to be built once.
+* @param indices Receives IndexCount() indices.
+***/
+void DistortionMesh::BuildIndices(std::vector<WORD>& indices)
+{
+	const UINT columnVertices = DISTORTION_MESH_COLUMNS + 1;
+	const UINT eyeVertices = columnVertices * (DISTORTION_MESH_ROWS + 1);
+
+	indices.clear();
+	indices.reserve(IndexCount());
+
+	for (UINT eye = 0; eye < 2; eye++) {
+		for (UINT row = 0; row < DISTORTION_MESH_ROWS; row++) {
+			for (UINT column = 0; column < DISTORTION_MESH_COLUMNS; column++) {
+				WORD topLeft = (WORD)(eye * eyeVertices + row * columnVertices + column);
+				WORD topRight = topLeft + 1;
+				WORD bottomLeft = (WORD)(topLeft + columnVertices);
+				WORD bottomRight = bottomLeft + 1;
+
+				indices.push_back(topLeft);
+				indices.push_back(topRight);
+				indices.push_back(bottomLeft);
+
+				indices.push_back(topRight);
+				indices.push_back(bottomRight);
+				indices.push_back(bottomLeft);
+			}
+		}
+	}
+}
+
+/**
+* Warps one screen texture coordinate the way the per pixel effect does.
+* Reference for the mesh vertices (which should match it at the grid points).
+* @param params The distortion parameters.
+* @param u Screen texture coordinate, both eyes side by side (0..1).
+* @param v Screen texture coordinate (0..1).
+* @param red Receives the red channel texture coordinate (2 floats).
+* @param green Receives the green channel texture coordinate (2 floats).
+* @param blue Receives the blue channel texture coordinate (2 floats).
+***/
+void DistortionMesh::WarpTexCoords(const DistortionParameters& params, float u, float v, float* red, float* green, float* blue)
+{
+	bool rightEye = (u > 0.5f);
+	float mirroredU = rightEye ? (1.0f - u) : u;
+	float angle = rightEye ? -params.Rotation : params.Rotation;
+
+	WarpChannel(params, mirroredU, v, params.Chroma[0], params.Chroma[1], angle, rightEye, red);
+	WarpChannel(params, mirroredU, v, 0.0f, 0.0f, angle, rightEye, green);
+	WarpChannel(params, mirroredU, v, params.Chroma[2], params.Chroma[3], angle, rightEye, blue);
+}
@@ -0,0 +1,113 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <DistortionMesh.h> and
+Class <DistortionMesh> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef DISTORTIONMESH_H_INCLUDED
+#define DISTORTIONMESH_H_INCLUDED
+
+#include <d3d9.h>
+#include <vector>
+
+/**
+* Grid cells of the distortion mesh, per eye.
+***/
+#define DISTORTION_MESH_COLUMNS 32
+#define DISTORTION_MESH_ROWS    32
+
+/**
+* Declaration of distortion mesh vertex.
+***/
+const DWORD D3DFVF_DISTORTIONVERTEX = D3DFVF_XYZRHW | D3DFVF_TEX4;
+/**
+* Distortion mesh vertex.
+* Screen position, screen texture coordinate and the warped texture coordinates for each color channel.
+***/
+struct DISTORTIONVERTEX
+{
+	float x;
+	float y;
+	float z;
+	float rhw;
+	float u;
+	float v;
+	float redU;
+	float redV;
+	float greenU;
+	float greenV;
+	float blueU;
+	float blueV;
+};
+
+/**
+* Distortion parameters.
+* Same values as the Oculus Rift effect variables of the same name (OculusRift.fx), plus the size
+* of the render target.
+***/
+struct DistortionParameters
+{
+	float LensCenter[2];
+	float Scale[2];
+	float ScaleIn[2];
+	float HmdWarpParam[4];
+	float Chroma[4];
+	float Resolution[2];
+	float Rotation;
+	float ViewportXOffset;
+	float ViewportYOffset;
+	float ZoomScale;
+	float TargetWidth;
+	float TargetHeight;
+};
+
+/**
+* Distortion mesh builder.
+* Computes the barrel distortion and chromatic aberration correction of the Oculus Rift effect per
+* vertex (four vertices at a time using SSE) instead of per pixel. No device needed, results only 
+* depend on the parameters.
+*/
+class DistortionMesh
+{
+public:
+	static void BuildVertices(const DistortionParameters& params, std::vector<DISTORTIONVERTEX>& vertices);
+	static void BuildIndices(std::vector<WORD>& indices);
+	static void WarpTexCoords(const DistortionParameters& params, float u, float v, float* red, float* green, float* blue);
+
+	/**
+	* Vertices of both eye grids.
+	***/
+	static UINT VertexCount() { return 2 * (DISTORTION_MESH_COLUMNS + 1) * (DISTORTION_MESH_ROWS + 1); }
+	/**
+	* Indices of both eye grids (triangle list).
+	***/
+	static UINT IndexCount() { return 2 * DISTORTION_MESH_COLUMNS * DISTORTION_MESH_ROWS * 6; }
+	/**
+	* Triangles of both eye grids.
+	***/
+	static UINT PrimitiveCount() { return 2 * DISTORTION_MESH_COLUMNS * DISTORTION_MESH_ROWS * 2; }
+};
+#endif
@@ -0,0 +1,200 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <EffectCache.cpp> and
+Class <EffectCache> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "EffectCache.h"
+#include "ProxyHelper.h"
+#include <fstream>
+
+/**
+* Cache file magic ("VPFX").
+***/
+#define EFFECTCACHE_MAGIC 0x58465056
+
+/**
+* Creates an effect from file, loading the compiled effect from the cache if the key matches.
+* @param compileFlags D3DXSHADER flags used to compile the effect.
+* @param effectFlags D3DXFX flags used to create the effect.
+* @see D3DXCreateEffectFromFile()
+***/
+HRESULT EffectCache::CreateEffectFromFile(IDirect3DDevice9* pDevice, const std::string& path, const D3DXMACRO* pDefines,
+										  DWORD compileFlags, DWORD effectFlags, LPD3DXEFFECT* ppEffect)
+{
+	std::vector<BYTE> source;
+	if (ReadSource(path, source))
+	{
+		CacheKey key = ComputeKey(source, "fx", pDefines, compileFlags);
+		std::string cachePath = CachePath(path, ".fxo");
+
+		std::vector<BYTE> compiled;
+		if (Load(cachePath, key, compiled))
+		{
+			if (SUCCEEDED(D3DXCreateEffect(pDevice, &compiled[0], (UINT)compiled.size(), NULL, NULL, effectFlags, NULL, ppEffect, NULL)))
+				return D3D_OK;
+			OutputDebugString("EffectCache: Cached effect creation failed, recompiling\n");
+		}
+
+		LPD3DXEFFECTCOMPILER pCompiler = NULL;
+		LPD3DXBUFFER pCompiled = NULL;
+		if (SUCCEEDED(D3DXCreateEffectCompiler((LPCSTR)&source[0], (UINT)source.size(), pDefines, NULL, compileFlags, &pCompiler, NULL)))
+		{
+			if (SUCCEEDED(pCompiler->CompileEffect(compileFlags, &pCompiled, NULL)))
+			{
+				HRESULT hr = D3DXCreateEffect(pDevice, pCompiled->GetBufferPointer(), pCompiled->GetBufferSize(), NULL, NULL, effectFlags, NULL, ppEffect, NULL);
+				if (SUCCEEDED(hr))
+					Store(cachePath, key, pCompiled->GetBufferPointer(), pCompiled->GetBufferSize());
+
+				pCompiled->Release();
+				pCompiler->Release();
+				if (SUCCEEDED(hr))
+					return hr;
+			}
+			else
+				pCompiler->Release();
+		}
+		OutputDebugString("EffectCache: Compiling from memory failed, compiling from file\n");
+	}
+
+	return D3DXCreateEffectFromFile(pDevice, path.c_str(), pDefines, NULL, compileFlags | effectFlags, NULL, ppEffect, NULL);
+}
+
+/**
+* Assembles a shader from file, loading the byte code from the cache if the key matches.
+* @see D3DXAssembleShaderFromFile()
+***/
+HRESULT EffectCache::AssembleShaderFromFile(const std::string& path, const D3DXMACRO* pDefines, DWORD flags, LPD3DXBUFFER* ppShader)
+{
+	std::vector<BYTE> source;
+	if (ReadSource(path, source))
+	{
+		CacheKey key = ComputeKey(source, "asm", pDefines, flags);
+		std::string cachePath = CachePath(path, ".vso");
+
+		std::vector<BYTE> compiled;
+		if (Load(cachePath, key, compiled) && SUCCEEDED(D3DXCreateBuffer((DWORD)compiled.size(), ppShader)))
+		{
+			memcpy((*ppShader)->GetBufferPointer(), &compiled[0], compiled.size());
+			return D3D_OK;
+		}
+
+		if (SUCCEEDED(D3DXAssembleShader((LPCSTR)&source[0], (UINT)source.size(), pDefines, NULL, flags, ppShader, NULL)))
+		{
+			Store(cachePath, key, (*ppShader)->GetBufferPointer(), (*ppShader)->GetBufferSize());
+			return D3D_OK;
+		}
+		OutputDebugString("EffectCache: Assembling from memory failed, assembling from file\n");
+	}
+
+	return D3DXAssembleShaderFromFile(path.c_str(), pDefines, NULL, flags, ppShader, NULL);
+}
+
+/**
+* Cache file path for a source file : <base>\cfg\cache\<cache file name>, see CacheFileName().
+* Creates the cache folder if needed.
+***/
+std::string EffectCache::CachePath(const std::string& sourcePath, const char* extension)
+{
+	ProxyHelper helper = ProxyHelper();
+	std::string cacheDir = helper.GetPath("cfg\\cache\\");
+	CreateDirectory(cacheDir.c_str(), NULL);
+
+	return cacheDir + CacheFileName(sourcePath, extension);
+}
+
+/**
+* Reads a whole file.
+***/
+bool EffectCache::ReadSource(const std::string& path, std::vector<BYTE>& data)
+{
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	file.seekg(0, std::ios::end);
+	std::streamoff size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	if (size <= 0)
+		return false;
+
+	data.resize((size_t)size);
+	file.read((char*)&data[0], size);
+	return !file.fail();
+}
+
+/**
+* Loads compiled data from a cache file if its key matches.
+***/
+bool EffectCache::Load(const std::string& cachePath, const CacheKey& key, std::vector<BYTE>& data)
+{
+	std::ifstream file(cachePath.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	DWORD magic = 0;
+	CacheKey storedKey;
+	DWORD size = 0;
+	file.read((char*)&magic, sizeof(magic));
+	file.read((char*)&storedKey, sizeof(storedKey));
+	file.read((char*)&size, sizeof(size));
+	if (file.fail() || (magic != EFFECTCACHE_MAGIC) || !KeysEqual(key, storedKey) || (size == 0))
+		return false;
+
+	data.resize(size);
+	file.read((char*)&data[0], size);
+	return !file.fail();
+}
+
+/**
+* Stores compiled data in a cache file (written to a temporary file first, so no partial file
+* is ever loaded).
+***/
+void EffectCache::Store(const std::string& cachePath, const CacheKey& key, const void* pData, DWORD size)
+{
+	std::string tempPath = cachePath + ".tmp";
+	{
+		std::ofstream file(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return;
+
+		DWORD magic = EFFECTCACHE_MAGIC;
+		file.write((const char*)&magic, sizeof(magic));
+		file.write((const char*)&key, sizeof(key));
+		file.write((const char*)&size, sizeof(size));
+		file.write((const char*)pData, size);
+		if (file.fail())
+		{
+			file.close();
+			DeleteFile(tempPath.c_str());
+			return;
+		}
+	}
+
+	if (!MoveFileEx(tempPath.c_str(), cachePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+		DeleteFile(tempPath.c_str());
+}
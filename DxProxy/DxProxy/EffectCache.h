@@ -0,0 +1,87 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <EffectCache.h> and
+Class <EffectCache> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef EFFECTCACHE_H_INCLUDED
+#define EFFECTCACHE_H_INCLUDED
+
+#include <d3d9.h>
+#include <d3dx9.h>
+#include <string>
+#include <vector>
+#include "MurmurHash3.h"
+
+/**
+* Cache file format version, increase if the compiled data changes for the same source
+* (compiler or format change). The D3DX SDK version is part of the key as well.
+***/
+#define EFFECTCACHE_VERSION 2
+
+/**
+* Compiled effect and shader cache.
+* Effects (and assembled replacement shaders) are compiled once and the byte code is stored in
+* the cache folder (cfg\cache\), keyed by source hash, compile flags and macros. As long as the key
+* matches, the byte code is loaded instead of compiling from source. Any cache failure falls back to
+* compiling from file as before.
+* Only the source file itself is hashed, sources with #include are not cached (compile fails without 
+* include handler and falls back).
+*/
+class EffectCache
+{
+public:
+	/**
+	* Cache key. 
+	* Identifies source, compile options, cache and D3DX version.
+	***/
+	struct CacheKey
+	{
+		DWORD version;
+		DWORD sdkVersion;
+		DWORD sourceSize;
+		uint32_t sourceHash;
+		uint32_t optionsHash;
+	};
+
+	/*** EffectCache public methods ***/
+	static HRESULT CreateEffectFromFile(IDirect3DDevice9* pDevice, const std::string& path, const D3DXMACRO* pDefines,
+		DWORD compileFlags, DWORD effectFlags, LPD3DXEFFECT* ppEffect);
+	static HRESULT AssembleShaderFromFile(const std::string& path, const D3DXMACRO* pDefines, DWORD flags, LPD3DXBUFFER* ppShader);
+	static CacheKey ComputeKey(const std::vector<BYTE>& source, const char* kind, const D3DXMACRO* pDefines, DWORD flags);
+	static bool KeysEqual(const CacheKey& a, const CacheKey& b);
+	static std::string CachePath(const std::string& sourcePath, const char* extension);
+	static std::string CacheFileName(const std::string& sourcePath, const char* extension);
+
+private:
+	/*** EffectCache private methods ***/
+	static bool ReadSource(const std::string& path, std::vector<BYTE>& data);
+	static bool Load(const std::string& cachePath, const CacheKey& key, std::vector<BYTE>& data);
+	static void Store(const std::string& cachePath, const CacheKey& key, const void* pData, DWORD size);
+};
+
+#endif
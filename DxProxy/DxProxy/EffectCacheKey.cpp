@@ -0,0 +1,116 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <EffectCacheKey.cpp> and
+Class <EffectCache> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#include "EffectCache.h"
+#include "VireioUtil.h"
+#include <ctype.h>
+
+/**
+* Second hash seed, source hashed twice to make collisions unlikely.
+***/
+#define EFFECTCACHE_SEED_OPTIONS 54321
+
+/**
+* Computes the cache key of a source.
+* @param kind Compile target ("fx", "asm"), part of the options.
+* @param pDefines Macros (NULL terminated array, or NULL), part of the options.
+* @param flags Compile flags, part of the options.
+***/
+EffectCache::CacheKey EffectCache::ComputeKey(const std::vector<BYTE>& source, const char* kind, const D3DXMACRO* pDefines, DWORD flags)
+{
+	CacheKey key;
+	key.version = EFFECTCACHE_VERSION;
+	key.sdkVersion = D3DX_SDK_VERSION;
+	key.sourceSize = (DWORD)source.size();
+	key.sourceHash = 0;
+	if (!source.empty())
+		MurmurHash3_x86_32(&source[0], (int)source.size(), VIREIO_SEED, &key.sourceHash);
+
+	// options as string : kind, flags, macros (name=value;)
+	std::string options = vireio::retprintf("%s|%08x|", kind, flags);
+	if (pDefines)
+	{
+		for (const D3DXMACRO* pMacro = pDefines; pMacro->Name; pMacro++)
+		{
+			options += pMacro->Name;
+			options += "=";
+			if (pMacro->Definition)
+				options += pMacro->Definition;
+			options += ";";
+		}
+	}
+
+	// source hashed again with the options as seed
+	uint32_t seed;
+	MurmurHash3_x86_32(options.c_str(), (int)options.size(), EFFECTCACHE_SEED_OPTIONS, &seed);
+	key.optionsHash = seed;
+	if (!source.empty())
+		MurmurHash3_x86_32(&source[0], (int)source.size(), seed, &key.optionsHash);
+
+	return key;
+}
+
+/**
+* True if both keys are equal.
+***/
+bool EffectCache::KeysEqual(const CacheKey& a, const CacheKey& b)
+{
+	return (a.version == b.version) && (a.sdkVersion == b.sdkVersion) && (a.sourceSize == b.sourceSize) &&
+		(a.sourceHash == b.sourceHash) && (a.optionsHash == b.optionsHash);
+}
+
+/**
+* Cache file name for a source file : <source file name>.<full path hash><extension>.
+* The full path is hashed case insensitive and with either separator, so equally named sources in 
+* different folders get different cache files.
+***/
+std::string EffectCache::CacheFileName(const std::string& sourcePath, const char* extension)
+{
+	std::string normalized = sourcePath;
+	for (size_t i = 0; i < normalized.size(); i++)
+	{
+		if (normalized[i] == '/')
+			normalized[i] = '\\';
+		else
+			normalized[i] = (char)tolower((unsigned char)normalized[i]);
+	}
+
+	uint32_t pathHash = 0;
+	if (!normalized.empty())
+		MurmurHash3_x86_32(normalized.c_str(), (int)normalized.size(), VIREIO_SEED, &pathHash);
+
+	std::string fileName = sourcePath;
+	size_t pos = fileName.find_last_of("\\/");
+	if (pos != std::string::npos)
+		fileName = fileName.substr(pos + 1);
+
+	return fileName + vireio::retprintf(".%08x", pathHash) + extension;
+}
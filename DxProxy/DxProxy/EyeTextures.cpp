@@ -0,0 +1,109 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <EyeTextures.cpp> and
+Class <EyeTextures> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "EyeTextures.h"
+
+/**
+* Constructor.
+***/
+EyeTextures::EyeTextures() :
+	m_pLeftTexture(NULL),
+	m_pRightTexture(NULL),
+	m_pLeftSurface(NULL),
+	m_pRightSurface(NULL),
+	m_bCreationFailed(false)
+{
+}
+
+/**
+* Destructor, releases the textures.
+***/
+EyeTextures::~EyeTextures()
+{
+	ReleaseEverything();
+}
+
+/**
+* Selects the input of the next composition, creates the eye textures if they are needed first.
+* @param pDevice Actual device the textures are created on.
+* @param desc Back buffer description, size and format of the textures.
+* @param eyesSampleable True if both eye back buffers can be sampled directly.
+***/
+EyeInput EyeTextures::SelectInput(IDirect3DDevice9* pDevice, const D3DSURFACE_DESC& desc, bool eyesSampleable)
+{
+	if (eyesSampleable)
+		return EYE_INPUT_DIRECT;
+
+	if (!m_pLeftTexture && !m_bCreationFailed)
+		m_bCreationFailed = !Create(pDevice, desc);
+
+	return m_bCreationFailed ? EYE_INPUT_BACK_BUFFER : EYE_INPUT_COPY;
+}
+
+/**
+* Releases the textures, creation is tried again on the next use.
+***/
+void EyeTextures::ReleaseEverything()
+{
+	if (m_pLeftSurface)
+		m_pLeftSurface->Release();
+	m_pLeftSurface = NULL;
+
+	if (m_pRightSurface)
+		m_pRightSurface->Release();
+	m_pRightSurface = NULL;
+
+	if (m_pLeftTexture)
+		m_pLeftTexture->Release();
+	m_pLeftTexture = NULL;
+
+	if (m_pRightTexture)
+		m_pRightTexture->Release();
+	m_pRightTexture = NULL;
+
+	m_bCreationFailed = false;
+}
+
+/**
+* Creates both textures and gets their surfaces.
+* @return False if any of them could not be created, nothing is kept then.
+***/
+bool EyeTextures::Create(IDirect3DDevice9* pDevice, const D3DSURFACE_DESC& desc)
+{
+	if (FAILED(pDevice->CreateTexture(desc.Width, desc.Height, 0, D3DUSAGE_RENDERTARGET, desc.Format, D3DPOOL_DEFAULT, &m_pLeftTexture, NULL)) ||
+		FAILED(m_pLeftTexture->GetSurfaceLevel(0, &m_pLeftSurface)) ||
+		FAILED(pDevice->CreateTexture(desc.Width, desc.Height, 0, D3DUSAGE_RENDERTARGET, desc.Format, D3DPOOL_DEFAULT, &m_pRightTexture, NULL)) ||
+		FAILED(m_pRightTexture->GetSurfaceLevel(0, &m_pRightSurface))) {
+			OutputDebugString("Eye texture creation failed\n");
+			ReleaseEverything();
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,93 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <EyeTextures.h> and
+Class <EyeTextures> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef EYETEXTURES_H_INCLUDED
+#define EYETEXTURES_H_INCLUDED
+
+#include <d3d9.h>
+
+/**
+* Input the stereo view composes the frame from.
+***/
+enum EyeInput
+{
+	EYE_INPUT_DIRECT,      /**< Eye back buffers are render target textures, sampled directly */
+	EYE_INPUT_COPY,        /**< Eye images are copied to the eye textures */
+	EYE_INPUT_BACK_BUFFER  /**< Eye textures not available, the left image is copied to the back buffer (no composition) */
+};
+
+/**
+* Left and right eye textures of the stereo view.
+* The eye images are copied to these textures if the eye back buffers can't be sampled directly
+* (multisampled back buffer or format not supported as render target texture). Created on first 
+* use, a failed creation releases everything created so far and is not retried before the next 
+* ReleaseEverything() (device reset).
+*/
+class EyeTextures
+{
+public:
+	EyeTextures();
+	virtual ~EyeTextures();
+
+	/*** EyeTextures public methods ***/
+	EyeInput           SelectInput(IDirect3DDevice9* pDevice, const D3DSURFACE_DESC& desc, bool eyesSampleable);
+	void               ReleaseEverything();
+	IDirect3DTexture9* GetLeftTexture() { return m_pLeftTexture; }
+	IDirect3DTexture9* GetRightTexture() { return m_pRightTexture; }
+	IDirect3DSurface9* GetLeftSurface() { return m_pLeftSurface; }
+	IDirect3DSurface9* GetRightSurface() { return m_pRightSurface; }
+
+private:
+	/*** EyeTextures private methods ***/
+	bool Create(IDirect3DDevice9* pDevice, const D3DSURFACE_DESC& desc);
+
+	/**
+	* Left eye (or upper) texture, back buffer size and format.
+	***/
+	IDirect3DTexture9* m_pLeftTexture;
+	/**
+	* Right eye (or lower) texture, back buffer size and format.
+	***/
+	IDirect3DTexture9* m_pRightTexture;
+	/**
+	* Surface of the left eye texture.
+	***/
+	IDirect3DSurface9* m_pLeftSurface;
+	/**
+	* Surface of the right eye texture.
+	***/
+	IDirect3DSurface9* m_pRightSurface;
+	/**
+	* True if the creation failed, not retried until ReleaseEverything().
+	***/
+	bool m_bCreationFailed;
+};
+
+#endif
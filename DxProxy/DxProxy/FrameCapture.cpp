@@ -0,0 +1,552 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <FrameCapture.cpp> and
+Class <FrameCapture> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "FrameCapture.h"
+#include <stdio.h>
+
+/**
+* Constructor.
+* Writer thread is started with the first capture read back.
+***/
+FrameCapture::FrameCapture() :
+	m_pActualDevice(NULL),
+	m_screenCount(0),
+	m_burstCount(0),
+	m_burstFrame(0),
+	m_bBurstActive(false),
+	m_droppedCount(0),
+	m_dropRun(0),
+	m_dropReason(NULL),
+	m_writtenCount(0),
+	m_queuedBytes(0),
+	m_hThread(NULL),
+	m_bQuit(false)
+{
+	for (int i = 0; i < FRAMECAPTURE_RING_SIZE; i++)
+	{
+		m_slots[i].state = SLOT_FREE;
+		m_slots[i].framesPending = 0;
+		m_slots[i].pQuery = NULL;
+		for (int j = 0; j < CAPTURE_IMAGES; j++)
+		{
+			m_slots[i].pStaging[j] = NULL;
+			m_slots[i].pSystemMemory[j] = NULL;
+			m_slots[i].captured[j] = false;
+		}
+	}
+
+	InitializeCriticalSection(&m_queueLock);
+	m_hJobEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+}
+
+/**
+* Destructor.
+* Writes all images still queued before returning.
+***/
+FrameCapture::~FrameCapture()
+{
+	ReleaseEverything();
+	StopWriter();
+
+	// writer thread could not be started
+	while (!m_writeQueue.empty())
+	{
+		delete m_writeQueue.front();
+		m_writeQueue.pop_front();
+	}
+
+	DeleteCriticalSection(&m_queueLock);
+	if (m_hJobEvent)
+		CloseHandle(m_hJobEvent);
+}
+
+/**
+* Sets the device to capture from.
+* @param pActualDevice The actual, unwrapped device.
+***/
+void FrameCapture::Init(IDirect3DDevice9* pActualDevice)
+{
+	m_pActualDevice = pActualDevice;
+}
+
+/**
+* Reads back captures in flight (forced) and releases all device resources.
+***/
+void FrameCapture::ReleaseEverything()
+{
+	for (int i = 0; i < FRAMECAPTURE_RING_SIZE; i++)
+	{
+		if (m_slots[i].state == SLOT_PENDING)
+			ReadBack(m_slots[i], true);
+		ReleaseSlot(m_slots[i]);
+	}
+	ReportDrops();
+}
+
+/**
+* Captures left, right and final image as screenshot (numbered bitmaps).
+* Any image may be NULL.
+* @return False if the capture was dropped.
+***/
+bool FrameCapture::CaptureScreen(IDirect3DSurface9* pLeft, IDirect3DSurface9* pRight, IDirect3DSurface9* pFinal)
+{
+	++m_screenCount;
+
+	char fileName[64];
+	std::string fileNames[CAPTURE_IMAGES];
+	sprintf_s(fileName, "%d_left.bmp", m_screenCount);
+	fileNames[LEFT_IMAGE] = fileName;
+	sprintf_s(fileName, "%d_right.bmp", m_screenCount);
+	fileNames[RIGHT_IMAGE] = fileName;
+	sprintf_s(fileName, "%d_final.bmp", m_screenCount);
+	fileNames[FINAL_IMAGE] = fileName;
+
+#ifdef _DEBUG
+	OutputDebugString(fileName);
+	OutputDebugString("\n");
+#endif
+
+	IDirect3DSurface9* sources[CAPTURE_IMAGES] = {pLeft, pRight, pFinal};
+	return Capture(sources, fileNames);
+}
+
+/**
+* Captures both eye images as the next frame of the active burst.
+* @return False if the frame was dropped (or no burst active).
+***/
+bool FrameCapture::CaptureBurstFrame(IDirect3DSurface9* pLeft, IDirect3DSurface9* pRight)
+{
+	if (!m_bBurstActive)
+		return false;
+
+	++m_burstFrame;
+
+	char fileName[64];
+	std::string fileNames[CAPTURE_IMAGES];
+	sprintf_s(fileName, "burst%d_%06d_left.bmp", m_burstCount, m_burstFrame);
+	fileNames[LEFT_IMAGE] = fileName;
+	sprintf_s(fileName, "burst%d_%06d_right.bmp", m_burstCount, m_burstFrame);
+	fileNames[RIGHT_IMAGE] = fileName;
+
+	IDirect3DSurface9* sources[CAPTURE_IMAGES] = {pLeft, pRight, NULL};
+	return Capture(sources, fileNames);
+}
+
+/**
+* Reads back captures the device has finished, to be called once per frame.
+* Captures pending for FRAMECAPTURE_MAX_PENDING_FRAMES frames are read back forced.
+***/
+void FrameCapture::Update()
+{
+	for (int i = 0; i < FRAMECAPTURE_RING_SIZE; i++)
+	{
+		if (m_slots[i].state == SLOT_PENDING)
+		{
+			m_slots[i].framesPending++;
+			ReadBack(m_slots[i], m_slots[i].framesPending >= FRAMECAPTURE_MAX_PENDING_FRAMES);
+		}
+	}
+}
+
+/**
+* Starts a new burst (both eyes captured each frame).
+***/
+void FrameCapture::StartBurst()
+{
+	++m_burstCount;
+	m_burstFrame = 0;
+	m_bBurstActive = true;
+}
+
+/**
+* Stops the active burst. Frames in flight are still written.
+***/
+void FrameCapture::StopBurst()
+{
+	if (!m_bBurstActive)
+		return;
+	m_bBurstActive = false;
+	ReportDrops();
+
+	char buf[128];
+	sprintf_s(buf, "Burst capture %d stopped: %d frames, %u dropped total\n", m_burstCount, m_burstFrame, m_droppedCount);
+	OutputDebugString(buf);
+}
+
+/**
+* Copies the images to a free capture slot and issues the read back.
+* @param ppSources Images to capture (CAPTURE_IMAGES, NULL to skip).
+* @param pFileNames File names of the images.
+***/
+bool FrameCapture::Capture(IDirect3DSurface9** ppSources, const std::string* pFileNames)
+{
+	if (!m_pActualDevice)
+		return false;
+
+	CaptureSlot* pSlot = NULL;
+	for (int i = 0; i < FRAMECAPTURE_RING_SIZE; i++)
+	{
+		if (m_slots[i].state == SLOT_FREE)
+		{
+			pSlot = &m_slots[i];
+			break;
+		}
+	}
+
+	if (!pSlot)
+	{
+		Dropped("no free capture slot");
+		return false;
+	}
+
+	bool anyCaptured = false;
+	for (int i = 0; i < CAPTURE_IMAGES; i++)
+	{
+		pSlot->captured[i] = false;
+		if (!ppSources[i])
+			continue;
+
+		if (CopyImage(*pSlot, i, ppSources[i]))
+		{
+			pSlot->captured[i] = true;
+			pSlot->fileName[i] = pFileNames[i];
+			anyCaptured = true;
+		}
+		else
+			Dropped("image copy failed");
+	}
+
+	if (!anyCaptured)
+		return false;
+
+	// end of a run of dropped captures
+	ReportDrops();
+
+	// without query the read back just waits for the lock
+	if (!pSlot->pQuery)
+		m_pActualDevice->CreateQuery(D3DQUERYTYPE_EVENT, &pSlot->pQuery);
+	if (pSlot->pQuery)
+		pSlot->pQuery->Issue(D3DISSUE_END);
+
+	pSlot->state = SLOT_PENDING;
+	pSlot->framesPending = 0;
+	return true;
+}
+
+/**
+* Counts a dropped capture (or single image). Drops are reported once per run by ReportDrops(), 
+* not per frame.
+* @param reason Reason of the drop, reported for the first drop of a run.
+***/
+void FrameCapture::Dropped(const char* reason)
+{
+	m_droppedCount++;
+	if (m_dropRun++ == 0)
+		m_dropReason = reason;
+}
+
+/**
+* Reports the current run of dropped captures, if any.
+***/
+void FrameCapture::ReportDrops()
+{
+	if (m_dropRun == 0)
+		return;
+
+	char buf[128];
+	sprintf_s(buf, "Frame capture dropped %u images (%s)\n", m_dropRun, m_dropReason);
+	OutputDebugString(buf);
+	m_dropRun = 0;
+}
+
+/**
+* Copies one image to the slot surfaces (created or recreated if size changed).
+* The device resolves multisampling and converts the format to X8R8G8B8, the copy to system memory
+* is only queued here.
+***/
+bool FrameCapture::CopyImage(CaptureSlot& slot, int image, IDirect3DSurface9* pSource)
+{
+	D3DSURFACE_DESC desc;
+	if (FAILED(pSource->GetDesc(&desc)))
+		return false;
+
+	if (slot.pStaging[image])
+	{
+		D3DSURFACE_DESC stagingDesc;
+		slot.pStaging[image]->GetDesc(&stagingDesc);
+		if ((stagingDesc.Width != desc.Width) || (stagingDesc.Height != desc.Height))
+		{
+			slot.pStaging[image]->Release();
+			slot.pStaging[image] = NULL;
+			slot.pSystemMemory[image]->Release();
+			slot.pSystemMemory[image] = NULL;
+		}
+	}
+
+	if (!slot.pStaging[image])
+	{
+		if (FAILED(m_pActualDevice->CreateRenderTarget(desc.Width, desc.Height, D3DFMT_X8R8G8B8, D3DMULTISAMPLE_NONE, 0, FALSE, &slot.pStaging[image], NULL)))
+		{
+			slot.pStaging[image] = NULL;
+			return false;
+		}
+
+		if (FAILED(m_pActualDevice->CreateOffscreenPlainSurface(desc.Width, desc.Height, D3DFMT_X8R8G8B8, D3DPOOL_SYSTEMMEM, &slot.pSystemMemory[image], NULL)))
+		{
+			slot.pSystemMemory[image] = NULL;
+			slot.pStaging[image]->Release();
+			slot.pStaging[image] = NULL;
+			return false;
+		}
+	}
+
+	if (FAILED(m_pActualDevice->StretchRect(pSource, NULL, slot.pStaging[image], NULL, D3DTEXF_NONE)))
+		return false;
+
+	return SUCCEEDED(m_pActualDevice->GetRenderTargetData(slot.pStaging[image], slot.pSystemMemory[image]));
+}
+
+/**
+* Reads back the images of a slot and queues them for writing.
+* @param force True to wait for the device if it isn't finished.
+* @return True if the slot is free again.
+***/
+bool FrameCapture::ReadBack(CaptureSlot& slot, bool force)
+{
+	if (slot.pQuery)
+	{
+		HRESULT hr = slot.pQuery->GetData(NULL, 0, force ? D3DGETDATA_FLUSH : 0);
+		if ((hr == S_FALSE) && !force)
+			return false;
+
+		if (FAILED(hr))
+		{
+			// device lost, captures are gone
+			for (int i = 0; i < CAPTURE_IMAGES; i++)
+			{
+				if (slot.captured[i])
+					Dropped("device lost");
+				slot.captured[i] = false;
+			}
+			slot.state = SLOT_FREE;
+			return true;
+		}
+	}
+
+	for (int i = 0; i < CAPTURE_IMAGES; i++)
+	{
+		if (!slot.captured[i])
+			continue;
+
+		D3DLOCKED_RECT lockedRect;
+		HRESULT hr = slot.pSystemMemory[i]->LockRect(&lockedRect, NULL, D3DLOCK_READONLY | (force ? 0 : D3DLOCK_DONOTWAIT));
+		if (hr == D3DERR_WASSTILLDRAWING)
+			return false;
+
+		slot.captured[i] = false;
+		if (FAILED(hr))
+		{
+			Dropped("read back failed");
+			continue;
+		}
+
+		D3DSURFACE_DESC desc;
+		slot.pSystemMemory[i]->GetDesc(&desc);
+		UINT rowSize = desc.Width * 4;
+		UINT size = rowSize * desc.Height;
+
+		if ((UINT)m_queuedBytes + size > FRAMECAPTURE_MEMORY_BUDGET)
+		{
+			slot.pSystemMemory[i]->UnlockRect();
+			Dropped("memory budget exceeded");
+			continue;
+		}
+
+		WriteJob* pJob = new WriteJob();
+		pJob->fileName = slot.fileName[i];
+		pJob->width = desc.Width;
+		pJob->height = desc.Height;
+		pJob->pixels.resize(size);
+		for (UINT y = 0; y < desc.Height; y++)
+			memcpy(&pJob->pixels[y * rowSize], (BYTE*)lockedRect.pBits + y * lockedRect.Pitch, rowSize);
+
+		slot.pSystemMemory[i]->UnlockRect();
+
+		if (!m_hThread && !StartWriter())
+		{
+			// no writer thread, write here
+			if (WriteBitmap(*pJob))
+				InterlockedIncrement(&m_writtenCount);
+			delete pJob;
+			continue;
+		}
+
+		InterlockedExchangeAdd(&m_queuedBytes, (LONG)size);
+		EnterCriticalSection(&m_queueLock);
+		m_writeQueue.push_back(pJob);
+		LeaveCriticalSection(&m_queueLock);
+		SetEvent(m_hJobEvent);
+	}
+
+	slot.state = SLOT_FREE;
+	return true;
+}
+
+/**
+* Releases the device resources of a slot.
+***/
+void FrameCapture::ReleaseSlot(CaptureSlot& slot)
+{
+	if (slot.pQuery)
+		slot.pQuery->Release();
+	slot.pQuery = NULL;
+
+	for (int i = 0; i < CAPTURE_IMAGES; i++)
+	{
+		if (slot.pStaging[i])
+			slot.pStaging[i]->Release();
+		slot.pStaging[i] = NULL;
+
+		if (slot.pSystemMemory[i])
+			slot.pSystemMemory[i]->Release();
+		slot.pSystemMemory[i] = NULL;
+
+		slot.captured[i] = false;
+	}
+
+	slot.state = SLOT_FREE;
+}
+
+/**
+* Starts the writer thread.
+***/
+bool FrameCapture::StartWriter()
+{
+	if (!m_hJobEvent)
+		return false;
+
+	m_bQuit = false;
+	m_hThread = CreateThread(0, 0, WriterThread, this, 0, NULL);
+	if (!m_hThread)
+	{
+		OutputDebugString("Frame capture writer thread creation failed\n");
+		return false;
+	}
+	return true;
+}
+
+/**
+* Stops the writer thread after all queued images are written.
+***/
+void FrameCapture::StopWriter()
+{
+	if (!m_hThread)
+		return;
+
+	m_bQuit = true;
+	SetEvent(m_hJobEvent);
+	WaitForSingleObject(m_hThread, INFINITE);
+	CloseHandle(m_hThread);
+	m_hThread = NULL;
+}
+
+/**
+* Writer thread, writes queued images until told to quit.
+***/
+DWORD WINAPI FrameCapture::WriterThread(LPVOID pvParam)
+{
+	FrameCapture* pCapture = (FrameCapture*)pvParam;
+
+	for (;;)
+	{
+		WaitForSingleObject(pCapture->m_hJobEvent, INFINITE);
+
+		for (;;)
+		{
+			EnterCriticalSection(&pCapture->m_queueLock);
+			if (pCapture->m_writeQueue.empty())
+			{
+				LeaveCriticalSection(&pCapture->m_queueLock);
+				break;
+			}
+			WriteJob* pJob = pCapture->m_writeQueue.front();
+			pCapture->m_writeQueue.pop_front();
+			LeaveCriticalSection(&pCapture->m_queueLock);
+
+			if (WriteBitmap(*pJob))
+				InterlockedIncrement(&pCapture->m_writtenCount);
+			else
+				OutputDebugString("Frame capture write failed\n");
+
+			InterlockedExchangeAdd(&pCapture->m_queuedBytes, -(LONG)pJob->pixels.size());
+			delete pJob;
+		}
+
+		if (pCapture->m_bQuit)
+			break;
+	}
+
+	return 0;
+}
+
+/**
+* Writes a 32 bit (X8R8G8B8, top-down) bitmap file.
+***/
+bool FrameCapture::WriteBitmap(const WriteJob& job)
+{
+	BITMAPFILEHEADER fileHeader;
+	BITMAPINFOHEADER infoHeader;
+	ZeroMemory(&fileHeader, sizeof(fileHeader));
+	ZeroMemory(&infoHeader, sizeof(infoHeader));
+
+	infoHeader.biSize = sizeof(BITMAPINFOHEADER);
+	infoHeader.biWidth = (LONG)job.width;
+	infoHeader.biHeight = -(LONG)job.height;
+	infoHeader.biPlanes = 1;
+	infoHeader.biBitCount = 32;
+	infoHeader.biCompression = BI_RGB;
+	infoHeader.biSizeImage = (DWORD)job.pixels.size();
+
+	fileHeader.bfType = 0x4D42; // "BM"
+	fileHeader.bfOffBits = sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER);
+	fileHeader.bfSize = fileHeader.bfOffBits + infoHeader.biSizeImage;
+
+	HANDLE hFile = CreateFile(job.fileName.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD written;
+	bool success = WriteFile(hFile, &fileHeader, sizeof(fileHeader), &written, NULL) &&
+		WriteFile(hFile, &infoHeader, sizeof(infoHeader), &written, NULL) &&
+		WriteFile(hFile, &job.pixels[0], infoHeader.biSizeImage, &written, NULL);
+
+	CloseHandle(hFile);
+	return success;
+}
@@ -0,0 +1,191 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <FrameCapture.h> and
+Class <FrameCapture> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef FRAMECAPTURE_H_INCLUDED
+#define FRAMECAPTURE_H_INCLUDED
+
+#include <d3d9.h>
+#include <string>
+#include <vector>
+#include <deque>
+
+/**
+* Number of captures in flight (copied on the device, not yet read back).
+***/
+#define FRAMECAPTURE_RING_SIZE 4
+/**
+* Frames a capture may wait for the device before the read back is forced.
+***/
+#define FRAMECAPTURE_MAX_PENDING_FRAMES 8
+/**
+* Memory budget (in bytes) for captured images read back but not yet written.
+***/
+#define FRAMECAPTURE_MEMORY_BUDGET (256 * 1024 * 1024)
+
+/**
+* Asynchronous screenshot and frame capture.
+* Images are copied on the device to off-screen system memory surfaces (a ring of them) and read
+* back some frames later without stalling. Writing to file is done on a background thread.
+* Burst mode captures both eye images each frame (numbered bitmaps, for video), within a bounded
+* memory budget. Captures that find no free slot or exceed the budget are dropped (and counted).
+*/
+class FrameCapture
+{
+public:
+	FrameCapture();
+	virtual ~FrameCapture();
+
+	/**
+	* Images of one capture.
+	***/
+	enum CaptureImages
+	{
+		LEFT_IMAGE,
+		RIGHT_IMAGE,
+		FINAL_IMAGE,
+		CAPTURE_IMAGES
+	};
+
+	/*** FrameCapture public methods ***/
+	void Init(IDirect3DDevice9* pActualDevice);
+	void ReleaseEverything();
+	bool CaptureScreen(IDirect3DSurface9* pLeft, IDirect3DSurface9* pRight, IDirect3DSurface9* pFinal);
+	bool CaptureBurstFrame(IDirect3DSurface9* pLeft, IDirect3DSurface9* pRight);
+	void Update();
+	void StartBurst();
+	void StopBurst();
+	bool IsBurstActive() { return m_bBurstActive; }
+	UINT GetDroppedCount() { return m_droppedCount; }
+	UINT GetWrittenCount() { return (UINT)m_writtenCount; }
+
+private:
+	/**
+	* Capture slot states.
+	***/
+	enum SlotState
+	{
+		SLOT_FREE,
+		SLOT_PENDING
+	};
+	/**
+	* One capture in flight. 
+	* Surfaces are kept and reused as long as size matches.
+	***/
+	struct CaptureSlot
+	{
+		SlotState state;
+		UINT framesPending;
+		IDirect3DQuery9* pQuery;
+		IDirect3DSurface9* pStaging[CAPTURE_IMAGES];
+		IDirect3DSurface9* pSystemMemory[CAPTURE_IMAGES];
+		bool captured[CAPTURE_IMAGES];
+		std::string fileName[CAPTURE_IMAGES];
+	};
+	/**
+	* Image read back, to be written by the writer thread.
+	***/
+	struct WriteJob
+	{
+		std::string fileName;
+		UINT width;
+		UINT height;
+		std::vector<BYTE> pixels;
+	};
+
+	/*** FrameCapture private methods ***/
+	bool Capture(IDirect3DSurface9** ppSources, const std::string* pFileNames);
+	bool CopyImage(CaptureSlot& slot, int image, IDirect3DSurface9* pSource);
+	bool ReadBack(CaptureSlot& slot, bool force);
+	void Dropped(const char* reason);
+	void ReportDrops();
+	void ReleaseSlot(CaptureSlot& slot);
+	bool StartWriter();
+	void StopWriter();
+	static DWORD WINAPI WriterThread(LPVOID pvParam);
+	static bool WriteBitmap(const WriteJob& job);
+
+	/**
+	* The actual, unwrapped Direct3D Device.
+	***/
+	IDirect3DDevice9* m_pActualDevice;
+	/**
+	* Capture ring.
+	***/
+	CaptureSlot m_slots[FRAMECAPTURE_RING_SIZE];
+	/**
+	* Screenshot number (file name).
+	***/
+	int m_screenCount;
+	/**
+	* Burst number (file name).
+	***/
+	int m_burstCount;
+	/**
+	* Frame number within the current burst (file name).
+	***/
+	int m_burstFrame;
+	/**
+	* True if burst capture is active.
+	***/
+	bool m_bBurstActive;
+	/**
+	* Captures (or single images) dropped since creation.
+	***/
+	UINT m_droppedCount;
+	/**
+	* Drops since the last report, see ReportDrops().
+	***/
+	UINT m_dropRun;
+	/**
+	* Reason of the first drop of the current run.
+	***/
+	const char* m_dropReason;
+	/**
+	* Images written since creation (writer thread).
+	***/
+	volatile LONG m_writtenCount;
+	/**
+	* Bytes read back and not yet written (writer thread).
+	***/
+	volatile LONG m_queuedBytes;
+	/**
+	* Write jobs, protected by m_queueLock.
+	***/
+	std::deque<WriteJob*> m_writeQueue;
+	CRITICAL_SECTION m_queueLock;
+	/**
+	* Signalled when jobs are queued or the writer should quit.
+	***/
+	HANDLE m_hJobEvent;
+	HANDLE m_hThread;
+	volatile bool m_bQuit;
+};
+
+#endif
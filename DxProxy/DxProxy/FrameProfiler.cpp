@@ -0,0 +1,189 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <FrameProfiler.cpp> and
+Class <FrameProfiler> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "FrameProfiler.h"
+#include <stdio.h>
+#include <vector>
+
+ThreadRings<ProfileEvent, FRAMEPROFILER_RING_SIZE, FRAMEPROFILER_MAX_THREADS> FrameProfiler::m_rings;
+volatile LONG FrameProfiler::m_droppedCount = 0;
+int FrameProfiler::m_captureFramesLeft = 0;
+LONGLONG FrameProfiler::m_frameStart = 0;
+
+namespace
+{
+	/**
+	* Event of a capture, with the thread it was recorded on.
+	***/
+	struct CapturedEvent
+	{
+		DWORD threadId;
+		ProfileEvent event;
+	};
+
+	/**
+	* Events of the current capture (present thread only).
+	***/
+	std::vector<CapturedEvent> capturedEvents;
+
+	/**
+	* Capture number (file name).
+	***/
+	int captureCount = 0;
+}
+
+/**
+* Records a timed scope on the calling thread.
+* Lock free, the event is dropped if the ring of the thread is full.
+***/
+void FrameProfiler::Record(const char* name, LONGLONG begin, LONGLONG end)
+{
+	ThreadRing<ProfileEvent, FRAMEPROFILER_RING_SIZE>* pRing = m_rings.Get();
+	ProfileEvent* pEvent = pRing ? pRing->BeginWrite() : NULL;
+	if (!pEvent)
+	{
+		InterlockedIncrement(&m_droppedCount);
+		return;
+	}
+
+	pEvent->name = name;
+	pEvent->begin = begin;
+	pEvent->end = end;
+	pRing->EndWrite();
+}
+
+/**
+* Ends the frame, to be called once per frame on the present thread.
+* Records the frame, drains all rings and writes the capture once complete.
+***/
+void FrameProfiler::EndFrame()
+{
+	LONGLONG now = Now();
+	if (m_frameStart)
+		Record("Frame", m_frameStart, now);
+	m_frameStart = now;
+
+	Drain(m_captureFramesLeft > 0);
+
+	if (m_captureFramesLeft > 0)
+	{
+		m_captureFramesLeft--;
+		if (m_captureFramesLeft == 0)
+			WriteCapture();
+	}
+}
+
+/**
+* Captures the next FRAMEPROFILER_CAPTURE_FRAMES frames.
+***/
+void FrameProfiler::StartCapture()
+{
+	if (m_captureFramesLeft > 0)
+		return;
+
+	capturedEvents.clear();
+	capturedEvents.reserve(FRAMEPROFILER_CAPTURE_FRAMES * 64);
+	m_captureFramesLeft = FRAMEPROFILER_CAPTURE_FRAMES;
+}
+
+/**
+* True while a capture is recorded.
+***/
+bool FrameProfiler::IsCapturing()
+{
+	return m_captureFramesLeft > 0;
+}
+
+/**
+* Reads all events recorded since the last drain.
+* @param keep True to add the events to the capture.
+***/
+void FrameProfiler::Drain(bool keep)
+{
+	m_rings.DrainAll([keep](DWORD threadId, const ProfileEvent& event)
+	{
+		if (keep)
+		{
+			CapturedEvent captured;
+			captured.threadId = threadId;
+			captured.event = event;
+			capturedEvents.push_back(captured);
+		}
+	});
+}
+
+/**
+* Writes the captured events as Chrome trace events (complete events, microseconds) to
+* frame_profile_<n>.json.
+***/
+void FrameProfiler::WriteCapture()
+{
+	++captureCount;
+
+	char fileName[64];
+	sprintf_s(fileName, "frame_profile_%d.json", captureCount);
+
+	FILE* pFile = NULL;
+	if ((fopen_s(&pFile, fileName, "w") != 0) || !pFile)
+	{
+		OutputDebugString("FrameProfiler: Failed to write capture\n");
+		capturedEvents.clear();
+		return;
+	}
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	double toMicroseconds = 1000000.0 / (double)frequency.QuadPart;
+
+	LONGLONG origin = 0;
+	for (size_t i = 0; i < capturedEvents.size(); i++)
+	{
+		if ((origin == 0) || (capturedEvents[i].event.begin < origin))
+			origin = capturedEvents[i].event.begin;
+	}
+
+	fprintf(pFile, "{\"traceEvents\":[\n");
+	for (size_t i = 0; i < capturedEvents.size(); i++)
+	{
+		const ProfileEvent& event = capturedEvents[i].event;
+		fprintf(pFile, "%s{\"name\":\"%s\",\"cat\":\"vireio\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u}\n",
+			(i == 0) ? "" : ",", event.name,
+			(double)(event.begin - origin) * toMicroseconds, (double)(event.end - event.begin) * toMicroseconds,
+			GetCurrentProcessId(), capturedEvents[i].threadId);
+	}
+	fprintf(pFile, "],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(pFile);
+
+	char buf[128];
+	sprintf_s(buf, "FrameProfiler: %s written, %u events, %d dropped\n", fileName, (UINT)capturedEvents.size(), m_droppedCount);
+	OutputDebugString(buf);
+
+	capturedEvents.clear();
+}
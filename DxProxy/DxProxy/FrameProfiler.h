@@ -0,0 +1,127 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <FrameProfiler.h> and
+Class <FrameProfiler> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef FRAMEPROFILER_H_INCLUDED
+#define FRAMEPROFILER_H_INCLUDED
+
+#include <windows.h>
+#include "ThreadRings.h"
+
+// Define PROFILE_FRAMES to record frame timelines (scoped markers compile out otherwise)
+//#define PROFILE_FRAMES
+
+/**
+* Events per thread ring buffer (power of two).
+***/
+#define FRAMEPROFILER_RING_SIZE 8192
+/**
+* Maximum number of threads recording markers.
+***/
+#define FRAMEPROFILER_MAX_THREADS 32
+/**
+* Frames recorded per capture.
+***/
+#define FRAMEPROFILER_CAPTURE_FRAMES 120
+
+/**
+* One timed scope (or frame, name NULL).
+***/
+struct ProfileEvent
+{
+	const char* name;
+	LONGLONG begin;
+	LONGLONG end;
+};
+
+/**
+* Frame timeline profiler.
+* Scoped markers record begin/end timestamps into a ring buffer per thread (single producer, single
+* consumer, no locks). Once per frame the rings are drained on the present thread; when a capture is
+* requested the events of the next frames are exported to a file in Chrome trace event format 
+* (chrome://tracing, about://tracing or any trace viewer reading that format).
+* Events are dropped (and counted) if a ring is full.
+*/
+class FrameProfiler
+{
+public:
+	/*** FrameProfiler public methods ***/
+	static void Record(const char* name, LONGLONG begin, LONGLONG end);
+	static void EndFrame();
+	static void StartCapture();
+	static bool IsCapturing();
+	static LONGLONG Now() { LARGE_INTEGER t; QueryPerformanceCounter(&t); return t.QuadPart; }
+	static LONG GetDroppedCount() { return m_droppedCount; }
+
+private:
+	/*** FrameProfiler private methods ***/
+	static void Drain(bool keep);
+	static void WriteCapture();
+
+	/**
+	* Event rings of the threads recording markers, read on the present thread only.
+	***/
+	static ThreadRings<ProfileEvent, FRAMEPROFILER_RING_SIZE, FRAMEPROFILER_MAX_THREADS> m_rings;
+	/**
+	* Events dropped (ring full or too many threads).
+	***/
+	static volatile LONG m_droppedCount;
+	/**
+	* Frames left in the current capture (0 if none).
+	***/
+	static int m_captureFramesLeft;
+	/**
+	* Start of the last frame.
+	***/
+	static LONGLONG m_frameStart;
+};
+
+/**
+* Scoped marker, records the time from construction to destruction.
+***/
+class ProfileScope
+{
+public:
+	ProfileScope(const char* name) : m_name(name), m_begin(FrameProfiler::Now()) {}
+	~ProfileScope() { FrameProfiler::Record(m_name, m_begin, FrameProfiler::Now()); }
+
+private:
+	const char* m_name;
+	LONGLONG m_begin;
+};
+
+#ifdef PROFILE_FRAMES
+	#define PROFILE_SCOPE(name) ProfileScope profileScope(name)
+	#define PROFILE_END_FRAME() FrameProfiler::EndFrame()
+#else
+	#define PROFILE_SCOPE(name)
+	#define PROFILE_END_FRAME()
+#endif
+
+#endif
@@ -50,10 +50,11 @@ FreeSpaceTracker::FreeSpaceTracker(void):MotionTracker()
 
 /**
 * Destructor.
-* Calls close function.
+* Stops sampling, calls close function.
 ***/
 FreeSpaceTracker::~FreeSpaceTracker(void)
 {
+	stopSampling();
 	close();
 }
 
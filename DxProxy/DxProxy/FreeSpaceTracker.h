@@ -49,6 +49,7 @@ public:
 	int  getOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z);
 	MotionTrackerStatus getStatus();
 	virtual char* GetTrackerDescription() {return "FreeSpaceTracker";}
+	virtual bool SupportsSampling() {return true;}
 
 private:
 	/*** FreeSpaceTracker public methods ***/
@@ -42,10 +42,11 @@ FreeTrackTracker::FreeTrackTracker(void):MotionTracker()
 
 /**
 * Destructor.
-* Calls FreeTrack FreeLibrary function.
+* Stops sampling, calls FreeTrack FreeLibrary function.
 ***/
 FreeTrackTracker::~FreeTrackTracker(void)
 {
+	stopSampling();
 	FreeLibrary(hinstLib);
 }
 
@@ -50,6 +50,8 @@ public:
 	int  getOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z);
 	MotionTrackerStatus getStatus();
 	virtual char* GetTrackerDescription() {return "FreeTrackTracker";}
+	virtual bool SupportsSampling() {return true;}
+	virtual DWORD GetSamplingInterval() {return 4;}
 	
 private:
 	/**
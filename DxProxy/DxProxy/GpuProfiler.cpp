@@ -0,0 +1,309 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <GpuProfiler.cpp> and
+Class <GpuProfiler> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "GpuProfiler.h"
+#include <stdio.h>
+
+/**
+* Constructor.
+***/
+GpuProfiler::GpuProfiler() :
+	m_pDevice(NULL),
+	m_currentFrame(0),
+	m_inFrame(false),
+	m_unsupported(false),
+	m_sumFrames(0),
+	m_droppedCount(0),
+	m_overflowCount(0)
+{
+	ZeroMemory(m_frames, sizeof(m_frames));
+	ZeroMemory(m_sumMs, sizeof(m_sumMs));
+	ZeroMemory(m_averageMs, sizeof(m_averageMs));
+}
+
+/**
+* Destructor, releases all queries.
+***/
+GpuProfiler::~GpuProfiler()
+{
+	ReleaseEverything();
+}
+
+/**
+* Sets the device the queries are created on. Queries are created on first use.
+* @param pDevice The device, use the actual device.
+***/
+void GpuProfiler::Init(IDirect3DDevice9* pDevice)
+{
+	m_pDevice = pDevice;
+}
+
+/**
+* Releases all queries (device reset), pending results are dropped.
+***/
+void GpuProfiler::ReleaseEverything()
+{
+	for (int i = 0; i < GPUPROFILER_FRAMES; i++)
+		ReleaseQueries(&m_frames[i]);
+	m_inFrame = false;
+}
+
+/**
+* Starts a section : all GPU work issued until the next marker is attributed to it.
+* Starts the frame if this is the first marker since EndFrame(). Once the eye switch budget of the 
+* frame is used up, eye sections continue as GPS_BOTH_EYES.
+***/
+void GpuProfiler::Mark(GpuProfileSection section)
+{
+	if (!m_inFrame)
+	{
+		BeginFrame();
+		if (!m_inFrame)
+			return;
+	}
+
+	FrameQueries* pFrame = &m_frames[m_currentFrame];
+
+	// keep markers for the frame level sections
+	if (((section == GPS_LEFT_EYE) || (section == GPS_RIGHT_EYE)) && 
+		(pFrame->markCount >= GPUPROFILER_MAX_MARKS - GPUPROFILER_FRAME_MARKS))
+	{
+		section = GPS_BOTH_EYES;
+		pFrame->overflow = true;
+	}
+
+	if ((pFrame->markCount > 0) && (pFrame->sections[pFrame->markCount - 1] == section))
+		return;
+
+	// last one is kept for EndFrame()
+	if (pFrame->markCount >= GPUPROFILER_MAX_MARKS - 1)
+	{
+		pFrame->overflow = true;
+		return;
+	}
+
+	IssueMark(section);
+}
+
+/**
+* Issues the timestamp of a marker in the current frame.
+***/
+void GpuProfiler::IssueMark(GpuProfileSection section)
+{
+	FrameQueries* pFrame = &m_frames[m_currentFrame];
+	IDirect3DQuery9** ppTimestamp = &pFrame->pTimestamps[pFrame->markCount];
+	if (!*ppTimestamp)
+	{
+		if (FAILED(m_pDevice->CreateQuery(D3DQUERYTYPE_TIMESTAMP, ppTimestamp)))
+		{
+			*ppTimestamp = NULL;
+			return;
+		}
+	}
+
+	(*ppTimestamp)->Issue(D3DISSUE_END);
+	pFrame->sections[pFrame->markCount] = section;
+	pFrame->markCount++;
+}
+
+/**
+* Ends the frame (call before the actual Present) and resolves finished earlier frames.
+***/
+void GpuProfiler::EndFrame()
+{
+	if (!m_inFrame)
+		return;
+
+	// closing timestamp, ends the last section
+	IssueMark(GPS_COUNT);
+
+	FrameQueries* pFrame = &m_frames[m_currentFrame];
+	pFrame->pFrequency->Issue(D3DISSUE_END);
+	pFrame->pDisjoint->Issue(D3DISSUE_END);
+	pFrame->pending = true;
+	if (pFrame->overflow)
+		m_overflowCount++;
+
+	m_inFrame = false;
+	m_currentFrame = (m_currentFrame + 1) % GPUPROFILER_FRAMES;
+
+	// resolve in issue order (oldest first), stop at the first frame not ready yet
+	for (UINT i = 0; i < GPUPROFILER_FRAMES; i++)
+	{
+		FrameQueries* pPending = &m_frames[(m_currentFrame + i) % GPUPROFILER_FRAMES];
+		if (pPending->pending && !Resolve(pPending, false))
+			break;
+	}
+}
+
+/**
+* Computes the section times of a frame from its timestamps.
+* Marker i starts section pSections[i], which lasts until timestamp i + 1.
+* @param pTimestamps Timestamps of the markers.
+* @param pSections Sections started at the markers (GPS_COUNT for the closing marker).
+* @param markCount Number of markers.
+* @param frequency Timestamp frequency (ticks per second).
+* @param pSectionMs [out] Time per section in milliseconds, GPS_COUNT entries.
+* @return False if the timestamps are invalid (zero frequency, clock going backwards).
+***/
+bool GpuProfiler::ResolveFrame(const UINT64* pTimestamps, const GpuProfileSection* pSections, UINT markCount, UINT64 frequency, float* pSectionMs)
+{
+	for (int i = 0; i < GPS_COUNT; i++)
+		pSectionMs[i] = 0.0f;
+
+	if (frequency == 0)
+		return false;
+
+	for (UINT i = 0; i + 1 < markCount; i++)
+	{
+		if (pTimestamps[i + 1] < pTimestamps[i])
+			return false;
+		if (pSections[i] < GPS_COUNT)
+			pSectionMs[pSections[i]] += (float)((double)(pTimestamps[i + 1] - pTimestamps[i]) * 1000.0 / (double)frequency);
+	}
+	return true;
+}
+
+/**
+* Creates the per frame queries (the timestamps are created on first use).
+* @return False if the device doesn't support timestamp queries.
+***/
+bool GpuProfiler::CreateQueries(FrameQueries* pFrame)
+{
+	IDirect3DQuery9* pDisjoint = NULL;
+	IDirect3DQuery9* pFrequency = NULL;
+	if (FAILED(m_pDevice->CreateQuery(D3DQUERYTYPE_TIMESTAMPDISJOINT, &pDisjoint)))
+		return false;
+	if (FAILED(m_pDevice->CreateQuery(D3DQUERYTYPE_TIMESTAMPFREQ, &pFrequency)))
+	{
+		pDisjoint->Release();
+		return false;
+	}
+
+	pFrame->pDisjoint = pDisjoint;
+	pFrame->pFrequency = pFrequency;
+	return true;
+}
+
+/**
+* Releases the queries of a frame.
+***/
+void GpuProfiler::ReleaseQueries(FrameQueries* pFrame)
+{
+	if (pFrame->pDisjoint)
+		pFrame->pDisjoint->Release();
+	if (pFrame->pFrequency)
+		pFrame->pFrequency->Release();
+	for (int i = 0; i < GPUPROFILER_MAX_MARKS; i++)
+	{
+		if (pFrame->pTimestamps[i])
+			pFrame->pTimestamps[i]->Release();
+	}
+	ZeroMemory(pFrame, sizeof(FrameQueries));
+}
+
+/**
+* Starts recording the current frame. Frame queries still pending (issued GPUPROFILER_FRAMES
+* frames ago) get a last chance to resolve, otherwise they are dropped.
+***/
+void GpuProfiler::BeginFrame()
+{
+	if (!m_pDevice || m_unsupported)
+		return;
+
+	FrameQueries* pFrame = &m_frames[m_currentFrame];
+	if (pFrame->pending)
+		Resolve(pFrame, true);
+
+	if (!pFrame->pDisjoint && !CreateQueries(pFrame))
+	{
+		OutputDebugString("GpuProfiler: Timestamp queries not supported.\n");
+		m_unsupported = true;
+		return;
+	}
+
+	pFrame->markCount = 0;
+	pFrame->overflow = false;
+	pFrame->pDisjoint->Issue(D3DISSUE_BEGIN);
+	m_inFrame = true;
+}
+
+/**
+* Reads the results of a frame without flushing or waiting.
+* @param pFrame The frame.
+* @param last True if the query set is needed now, drops the frame if not ready.
+* @return True if the frame is done (resolved or dropped).
+***/
+bool GpuProfiler::Resolve(FrameQueries* pFrame, bool last)
+{
+	BOOL disjoint = FALSE;
+	UINT64 frequency = 0;
+	UINT64 timestamps[GPUPROFILER_MAX_MARKS];
+
+	HRESULT hr = pFrame->pDisjoint->GetData(&disjoint, sizeof(BOOL), 0);
+	if (hr == S_OK)
+		hr = pFrame->pFrequency->GetData(&frequency, sizeof(UINT64), 0);
+	for (UINT i = 0; (hr == S_OK) && (i < pFrame->markCount); i++)
+		hr = pFrame->pTimestamps[i]->GetData(&timestamps[i], sizeof(UINT64), 0);
+
+	// not ready yet
+	if ((hr == S_FALSE) && !last)
+		return false;
+
+	pFrame->pending = false;
+
+	float sectionMs[GPS_COUNT];
+	if ((hr != S_OK) || disjoint || !ResolveFrame(timestamps, pFrame->sections, pFrame->markCount, frequency, sectionMs))
+	{
+		m_droppedCount++;
+		return true;
+	}
+
+	for (int i = 0; i < GPS_COUNT; i++)
+		m_sumMs[i] += sectionMs[i];
+	m_sumFrames++;
+
+	if (m_sumFrames >= GPUPROFILER_LOG_FRAMES)
+	{
+		for (int i = 0; i < GPS_COUNT; i++)
+		{
+			m_averageMs[i] = m_sumMs[i] / (float)m_sumFrames;
+			m_sumMs[i] = 0.0f;
+		}
+		m_sumFrames = 0;
+
+		char buffer[256];
+		sprintf_s(buffer, "GPU ms : left %.2f right %.2f both eyes %.2f composition %.2f hud %.2f other %.2f (%u dropped, %u overflowed)\n",
+			m_averageMs[GPS_LEFT_EYE], m_averageMs[GPS_RIGHT_EYE], m_averageMs[GPS_BOTH_EYES], m_averageMs[GPS_COMPOSITION],
+			m_averageMs[GPS_HUD], m_averageMs[GPS_OTHER], m_droppedCount, m_overflowCount);
+		OutputDebugString(buffer);
+	}
+	return true;
+}
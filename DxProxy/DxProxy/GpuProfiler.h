@@ -0,0 +1,166 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <GpuProfiler.h> and
+Class <GpuProfiler> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef GPUPROFILER_H_INCLUDED
+#define GPUPROFILER_H_INCLUDED
+
+#include <d3d9.h>
+
+// Define PROFILE_GPU to time the stereo GPU work with timestamp queries (markers compile out otherwise)
+//#define PROFILE_GPU
+
+/**
+* Frames in flight : results are resolved this many frames after they were issued.
+***/
+#define GPUPROFILER_FRAMES 4
+/**
+* Maximum number of markers (timestamps) per frame.
+***/
+#define GPUPROFILER_MAX_MARKS 64
+/**
+* Markers reserved for the frame level sections (composition, HUD, other and the closing marker).
+* Eye switches (one per setDrawingSide) use the rest, further switches of a frame are merged into
+* GPS_BOTH_EYES.
+***/
+#define GPUPROFILER_FRAME_MARKS 8
+/**
+* Resolved frames averaged per debug output.
+***/
+#define GPUPROFILER_LOG_FRAMES 60
+
+/**
+* GPU work sections, a marker starts a section that lasts until the next marker.
+***/
+enum GpuProfileSection
+{
+	GPS_OTHER,       /**< Unattributed work */
+	GPS_LEFT_EYE,    /**< Game draws, left side */
+	GPS_RIGHT_EYE,   /**< Game draws, right side (the stereo duplicate) */
+	GPS_BOTH_EYES,   /**< Game draws after the eye switch budget of the frame ran out */
+	GPS_COMPOSITION, /**< Stereo view composition */
+	GPS_HUD,         /**< Vireio menu and popups */
+	GPS_COUNT
+};
+
+/**
+* GPU timestamp profiler.
+* Brackets the stereo work of a frame with D3DQUERYTYPE_TIMESTAMP queries inside a 
+* D3DQUERYTYPE_TIMESTAMPDISJOINT range. Query results are never waited for : each frame uses 
+* its own set of queries and is resolved (without flushing) GPUPROFILER_FRAMES frames later, 
+* frames that are still not ready then are dropped. Disjoint frames (clock changed) are discarded.
+* Frames with more eye switches than markers (GPUPROFILER_FRAME_MARKS) are counted as overflowed.
+* Queries are created on the device passed to Init() and never exposed to the game.
+*/
+class GpuProfiler
+{
+public:
+	GpuProfiler();
+	virtual ~GpuProfiler();
+
+	/*** GpuProfiler public methods ***/
+	void  Init(IDirect3DDevice9* pDevice);
+	void  ReleaseEverything();
+	void  Mark(GpuProfileSection section);
+	void  EndFrame();
+	float GetSectionMs(GpuProfileSection section) { return m_averageMs[section]; }
+	UINT  GetDroppedCount() { return m_droppedCount; }
+	UINT  GetOverflowCount() { return m_overflowCount; }
+	static bool ResolveFrame(const UINT64* pTimestamps, const GpuProfileSection* pSections, UINT markCount, UINT64 frequency, float* pSectionMs);
+
+private:
+	/**
+	* Queries and markers of one frame.
+	***/
+	struct FrameQueries
+	{
+		IDirect3DQuery9* pDisjoint;
+		IDirect3DQuery9* pFrequency;
+		IDirect3DQuery9* pTimestamps[GPUPROFILER_MAX_MARKS];
+		GpuProfileSection sections[GPUPROFILER_MAX_MARKS];
+		UINT markCount;
+		bool overflow;
+		bool pending;
+	};
+
+	/*** GpuProfiler private methods ***/
+	bool CreateQueries(FrameQueries* pFrame);
+	void ReleaseQueries(FrameQueries* pFrame);
+	void BeginFrame();
+	void IssueMark(GpuProfileSection section);
+	bool Resolve(FrameQueries* pFrame, bool last);
+
+	/**
+	* Device the queries are created on (not add-refed).
+	***/
+	IDirect3DDevice9* m_pDevice;
+	/**
+	* Frame query sets, used round robin.
+	***/
+	FrameQueries m_frames[GPUPROFILER_FRAMES];
+	/**
+	* Index of the frame currently recorded.
+	***/
+	UINT m_currentFrame;
+	/**
+	* True between the first marker of a frame and EndFrame().
+	***/
+	bool m_inFrame;
+	/**
+	* True if the device doesn't support timestamp queries.
+	***/
+	bool m_unsupported;
+	/**
+	* Section times summed over the resolved frames since the last output.
+	***/
+	float m_sumMs[GPS_COUNT];
+	UINT  m_sumFrames;
+	/**
+	* Section times averaged over the last output period.
+	***/
+	float m_averageMs[GPS_COUNT];
+	/**
+	* Frames dropped (not ready in time or disjoint).
+	***/
+	UINT m_droppedCount;
+	/**
+	* Frames that ran out of markers (eye switches merged or markers ignored).
+	***/
+	UINT m_overflowCount;
+};
+
+#ifdef PROFILE_GPU
+	#define GPU_PROFILE_MARK(profiler, section) (profiler).Mark(section)
+	#define GPU_PROFILE_END_FRAME(profiler) (profiler).EndFrame()
+#else
+	#define GPU_PROFILE_MARK(profiler, section)
+	#define GPU_PROFILE_END_FRAME(profiler)
+#endif
+
+#endif
@@ -88,6 +88,7 @@ InputBindingRef hotkeyWheelZoomScale = LCtrl;
 void D3DProxyDevice::HandleControls()
 {
 	SHOW_CALL("HandleControls");
+	PROFILE_SCOPE("HandleControls");
 	
 	controls.UpdateInputs();
 
@@ -964,6 +965,31 @@ void D3DProxyDevice::HandleControls()
 			// render 3 frames to get screenshots
 			screenshot = 3;
 		}
+
+		// burst capture (both eyes each frame) - <RCONTROL>+</>
+		if(config.HotkeyBurstCapture->IsPressed(controls) && HotkeysActive())
+		{
+			if (stereoView->m_frameCapture.IsBurstActive())
+			{
+				stereoView->m_frameCapture.StopBurst();
+				ShowPopup(VPT_NOTIFICATION, VPS_TOAST, 1200,
+					retprintf("Burst Capture Stopped (%u dropped)", stereoView->m_frameCapture.GetDroppedCount()));
+			}
+			else
+			{
+				stereoView->m_frameCapture.StartBurst();
+				ShowPopup(VPT_NOTIFICATION, VPS_TOAST, 1200, "Burst Capture Started");
+			}
+		}
+
+#ifdef PROFILE_FRAMES
+		// frame timeline capture - <RCONTROL>+<->
+		if(config.HotkeyFrameProfile->IsPressed(controls) && HotkeysActive() && !FrameProfiler::IsCapturing())
+		{
+			FrameProfiler::StartCapture();
+			ShowPopup(VPT_NOTIFICATION, VPS_TOAST, 1200, "Frame Profile Capture Started");
+		}
+#endif
 	
 		//Telescopic mode - use ALT + Mouse Wheel CLick
 		if (config.HotkeyTelescopeMode->IsPressed(controls) && HotkeysActive())
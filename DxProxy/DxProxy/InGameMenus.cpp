@@ -1360,6 +1360,7 @@ void D3DProxyDevice::VPMENU_Hotkeys()
 	menu->AddKeybind("Reset Orientation",   &config.HotkeyResetOrientation, defaultConfig.HotkeyResetOrientation);
 	menu->AddKeybind("Show FPS Hotkey",     &config.HotkeyShowFPS, defaultConfig.HotkeyShowFPS);
 	menu->AddKeybind("Screenshot",          &config.HotkeyScreenshot, defaultConfig.HotkeyScreenshot);
+	menu->AddKeybind("Burst Capture",       &config.HotkeyBurstCapture, defaultConfig.HotkeyBurstCapture);
 	menu->AddKeybind("Telescope Mode",      &config.HotkeyTelescopeMode, defaultConfig.HotkeyTelescopeMode);
 	
 	menu->AddKeybind("Toggle Free Pitch",   &config.HotkeyToggleFreePitch, defaultConfig.HotkeyToggleFreePitch);
@@ -1572,13 +1573,12 @@ void D3DProxyDevice::VPMENU_UpdateBorder(int menuEntryCount)
 
 /**
 * Updates the current config based on the current device settings.
+* Saves a snapshot of the config in the background.
 ***/
 void D3DProxyDevice::VPMENU_UpdateConfigSettings()
 {
 	SHOW_CALL("VPMENU_UpdateConfigSettings");
 	
-	ProxyHelper* helper = new ProxyHelper();
-
 	config.roll_multiplier = tracker->multiplierRoll;
 	config.yaw_multiplier = tracker->multiplierYaw;
 	config.pitch_multiplier = tracker->multiplierPitch;
@@ -1598,8 +1598,7 @@ void D3DProxyDevice::VPMENU_UpdateConfigSettings()
 	config.ConstantValue3 = VRBoostValue[VRboostAxis::ConstantValue3];
 
 	m_spShaderViewAdjustment->Save(config);
-	helper->SaveConfig(config);
-	delete helper;
+	m_configSaver.Submit(config);
 }
 
 /**
@@ -0,0 +1,277 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <InitTaskGraph.cpp> and
+Class <InitTaskGraph> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#include "InitTaskGraph.h"
+#include <stdio.h>
+
+/**
+* Constructor.
+* @param maxWorkers Worker threads at most (also limited by the processors and the tasks).
+***/
+InitTaskGraph::InitTaskGraph(UINT maxWorkers) :
+	m_hReady(NULL),
+	m_maxWorkers(maxWorkers),
+	m_tasksLeft(0),
+	m_started(false)
+{
+	InitializeCriticalSection(&m_cs);
+}
+
+/**
+* Destructor, waits for all tasks.
+***/
+InitTaskGraph::~InitTaskGraph()
+{
+	WaitAll();
+	for (size_t i = 0; i < m_tasks.size(); i++)
+	{
+		if (m_tasks[i].hDoneEvent)
+			CloseHandle(m_tasks[i].hDoneEvent);
+	}
+	DeleteCriticalSection(&m_cs);
+}
+
+/**
+* Adds a task, to be called before Start().
+* @param name Task name, for the debug output.
+* @param task The task.
+* @return The task index, for DependsOn() and Wait().
+***/
+int InitTaskGraph::Add(const char* name, std::function<void()> task)
+{
+	Task newTask;
+	newTask.name = name;
+	newTask.run = task;
+	newTask.dependenciesLeft = 0;
+	newTask.hDoneEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	m_tasks.push_back(newTask);
+	return (int)m_tasks.size() - 1;
+}
+
+/**
+* Lets a task wait for another one, to be called before Start().
+* The dependency has to be added before the task, so the graph never has a cycle.
+***/
+void InitTaskGraph::DependsOn(int task, int dependency)
+{
+	if ((task < 0) || (task >= (int)m_tasks.size()) || (dependency < 0) || (dependency >= task))
+	{
+		OutputDebugString("InitTaskGraph : Invalid dependency ignored\n");
+		return;
+	}
+	m_tasks[task].dependenciesLeft++;
+	m_tasks[dependency].dependents.push_back(task);
+}
+
+/**
+* Starts the workers with the tasks that have no dependencies.
+* @return False if the tasks were run on the calling thread instead.
+***/
+bool InitTaskGraph::Start()
+{
+	if (m_started)
+		return true;
+	m_started = true;
+	m_tasksLeft = (LONG)m_tasks.size();
+	if (m_tasks.empty())
+		return true;
+
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	if (m_maxWorkers > systemInfo.dwNumberOfProcessors)
+		m_maxWorkers = systemInfo.dwNumberOfProcessors;
+	if (m_maxWorkers > m_tasks.size())
+		m_maxWorkers = (UINT)m_tasks.size();
+	if (m_maxWorkers < 1)
+		m_maxWorkers = 1;
+
+	bool eventsCreated = true;
+	for (size_t i = 0; i < m_tasks.size(); i++)
+	{
+		if (!m_tasks[i].hDoneEvent)
+			eventsCreated = false;
+		else if (m_tasks[i].dependenciesLeft == 0)
+			m_ready.push_back((int)i);
+	}
+
+	if (eventsCreated)
+		m_hReady = CreateSemaphore(NULL, (LONG)m_ready.size(), MAXLONG, NULL);
+
+	if (m_hReady)
+	{
+		for (UINT i = 0; i < m_maxWorkers; i++)
+		{
+			HANDLE hThread = CreateThread(NULL, 0, WorkerThread, this, 0, NULL);
+			if (hThread)
+				m_workers.push_back(hThread);
+		}
+	}
+
+	if (m_workers.empty())
+	{
+		OutputDebugString("InitTaskGraph : Could not start the workers, running the tasks synchronously\n");
+		RunInline();
+		return false;
+	}
+	return true;
+}
+
+/**
+* Waits until a task is done, starts the graph if not started yet.
+***/
+void InitTaskGraph::Wait(int task)
+{
+	if (!m_started)
+		Start();
+	if ((task >= 0) && (task < (int)m_tasks.size()) && (m_tasks[task].hDoneEvent))
+		WaitForSingleObject(m_tasks[task].hDoneEvent, INFINITE);
+}
+
+/**
+* Waits until all tasks are done and ends the workers.
+***/
+void InitTaskGraph::WaitAll()
+{
+	if (!m_started)
+		Start();
+	for (size_t i = 0; i < m_tasks.size(); i++)
+		Wait((int)i);
+	StopWorkers();
+}
+
+/**
+* Runs a task and releases the tasks waiting for it.
+***/
+void InitTaskGraph::RunTask(int task)
+{
+	LARGE_INTEGER start, end, frequency;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+
+	m_tasks[task].run();
+
+	QueryPerformanceCounter(&end);
+	char buf[128];
+	sprintf_s(buf, "InitTaskGraph : %s done in %.2f ms\n", m_tasks[task].name.c_str(), 
+		(double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)frequency.QuadPart);
+	OutputDebugString(buf);
+
+	Finish(task);
+}
+
+/**
+* Marks a task done, queues the tasks it was the last dependency of.
+* Wakes all workers (to end) once the last task is done.
+***/
+void InitTaskGraph::Finish(int task)
+{
+	LONG released = 0;
+	EnterCriticalSection(&m_cs);
+	for (size_t i = 0; i < m_tasks[task].dependents.size(); i++)
+	{
+		int dependent = m_tasks[task].dependents[i];
+		if (--m_tasks[dependent].dependenciesLeft == 0)
+		{
+			m_ready.push_back(dependent);
+			released++;
+		}
+	}
+	LeaveCriticalSection(&m_cs);
+
+	if (m_tasks[task].hDoneEvent)
+		SetEvent(m_tasks[task].hDoneEvent);
+
+	// the last task : one empty wake up per worker
+	if (InterlockedDecrement(&m_tasksLeft) == 0)
+		released += (LONG)m_maxWorkers;
+
+	if (m_hReady && released)
+		ReleaseSemaphore(m_hReady, released, NULL);
+}
+
+/**
+* Runs all tasks on the calling thread, in the order they were added (dependencies first).
+***/
+void InitTaskGraph::RunInline()
+{
+	if (m_hReady)
+	{
+		CloseHandle(m_hReady);
+		m_hReady = NULL;
+	}
+	m_ready.clear();
+	for (size_t i = 0; i < m_tasks.size(); i++)
+		RunTask((int)i);
+}
+
+/**
+* Ends the workers, all tasks have to be done.
+***/
+void InitTaskGraph::StopWorkers()
+{
+	if (!m_workers.empty())
+	{
+		WaitForMultipleObjects((DWORD)m_workers.size(), &m_workers[0], TRUE, INFINITE);
+		for (size_t i = 0; i < m_workers.size(); i++)
+			CloseHandle(m_workers[i]);
+		m_workers.clear();
+	}
+	if (m_hReady)
+	{
+		CloseHandle(m_hReady);
+		m_hReady = NULL;
+	}
+}
+
+/**
+* Worker thread : runs ready tasks, ends on a wake up without a ready task.
+***/
+DWORD WINAPI InitTaskGraph::WorkerThread(LPVOID pParam)
+{
+	InitTaskGraph* pGraph = (InitTaskGraph*)pParam;
+
+	for (;;)
+	{
+		WaitForSingleObject(pGraph->m_hReady, INFINITE);
+
+		EnterCriticalSection(&pGraph->m_cs);
+		if (pGraph->m_ready.empty())
+		{
+			LeaveCriticalSection(&pGraph->m_cs);
+			return 0;
+		}
+		int task = pGraph->m_ready.front();
+		pGraph->m_ready.pop_front();
+		LeaveCriticalSection(&pGraph->m_cs);
+
+		pGraph->RunTask(task);
+	}
+}
@@ -0,0 +1,104 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <InitTaskGraph.h> and
+Class <InitTaskGraph> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#ifndef INITTASKGRAPH_H_INCLUDED
+#define INITTASKGRAPH_H_INCLUDED
+
+#include <windows.h>
+#include <functional>
+#include <vector>
+#include <deque>
+#include <string>
+
+/**
+* Small task graph for device initialization.
+* Tasks are added with their dependencies, Start() runs them on a few worker threads (a task 
+* starts once all its dependencies are done), Wait() joins a single task and WaitAll() the whole
+* graph. Tasks must not touch the D3D device, work that needs it stays on the device thread and 
+* waits for the tasks it depends on. Runs the tasks on the calling thread if no worker could be
+* started.
+***/
+class InitTaskGraph
+{
+public:
+	InitTaskGraph(UINT maxWorkers = 4);
+	virtual ~InitTaskGraph();
+
+	/*** InitTaskGraph public methods ***/
+	int  Add(const char* name, std::function<void()> task);
+	void DependsOn(int task, int dependency);
+	bool Start();
+	void Wait(int task);
+	void WaitAll();
+
+private:
+	/**
+	* One task, its dependencies left and the tasks waiting for it.
+	***/
+	struct Task
+	{
+		std::string name;
+		std::function<void()> run;
+		int dependenciesLeft;
+		std::vector<int> dependents;
+		HANDLE hDoneEvent;
+	};
+
+	/*** InitTaskGraph private methods ***/
+	void RunTask(int task);
+	void Finish(int task);
+	void RunInline();
+	void StopWorkers();
+	static DWORD WINAPI WorkerThread(LPVOID pParam);
+
+	/**
+	* Tasks, in the order they were added.
+	***/
+	std::vector<Task> m_tasks;
+	/**
+	* Tasks ready to run, guarded by m_cs. m_hReady counts them (plus one per worker to end it).
+	***/
+	CRITICAL_SECTION m_cs;
+	std::deque<int> m_ready;
+	HANDLE m_hReady;
+	/**
+	* Worker threads.
+	***/
+	std::vector<HANDLE> m_workers;
+	UINT m_maxWorkers;
+	/**
+	* Tasks not done yet, true once Start() was called.
+	***/
+	LONG m_tasksLeft;
+	bool m_started;
+};
+
+#endif
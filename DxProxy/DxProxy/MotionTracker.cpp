@@ -28,24 +28,31 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "MotionTracker.h"
-#include "D3DProxyDevice.h"
+#include "ConfigDefaults.h"
 
 /**
 * Constructor.
 * Calls init function.
 ***/ 
 MotionTracker::MotionTracker() :
-	useSDKPosePrediction(true)
+	useSDKPosePrediction(true),
+	mouseEmulation(false),
+	sampler(NULL),
+	sampleTime(0),
+	mouseEmulator(NULL),
+	recorder(NULL)
 {
 	OutputDebugString("Motion Tracker Created\n");
 	init();
 }
 
 /**
-* Empty destructor.
+* Destructor, stops sampling and mouse emulation.
 ***/
 MotionTracker::~MotionTracker()
 {
+	stopSampling();
+	stopMouseEmulation();
 }
 
 /**
@@ -111,8 +118,8 @@ void MotionTracker::updateOrientationAndPosition()
 #ifdef _DEBUG
 	OutputDebugString("Motion Tracker updateOrientationAndPosition\n");
 #endif
-	// Get orientation from derived tracker.
-	if(getOrientationAndPosition(&yaw, &pitch, &roll, &x, &y, &z) == 0)
+	// Get orientation from derived tracker (or the latest sampled pose).
+	if(readOrientationAndPosition(&yaw, &pitch, &roll, &x, &y, &z) == 0)
 	{
 #ifdef _DEBUG
 		OutputDebugString("Motion Tracker getOrientation == 0\n");
@@ -120,34 +127,41 @@ void MotionTracker::updateOrientationAndPosition()
 		// Skip empty input data.
 		if(!isEqual(currentYaw, 0.0f) && !isEqual(currentPitch, 0.0f))
 		{
+			// Mouse emulation engine sends the motion on its own timer.
+			if (mouseEmulator)
+				mouseEmulator->SubmitPose(RADIANS_TO_DEGREES(yaw), -RADIANS_TO_DEGREES(pitch));
+
 			// Convert yaw, pitch to positive degrees, multiply by multiplier.
 			// (-180.0f...0.0f -> 180.0f....360.0f)
 			// (0.0f...180.0f -> 0.0f...180.0f)
 			yaw = fmodf(RADIANS_TO_DEGREES(yaw) + 360.0f, 360.0f)*multiplierYaw;
 			pitch = -fmodf(RADIANS_TO_DEGREES(pitch) + 360.0f, 360.0f)*multiplierPitch;
 
-			// Get difference.
-			deltaYaw += yaw - currentYaw;
-			deltaPitch += pitch - currentPitch;
+			if (!mouseEmulator)
+			{
+				// Get difference.
+				deltaYaw += yaw - currentYaw;
+				deltaPitch += pitch - currentPitch;
 
-			// Set limits.
-			if(fabs(deltaYaw) > 100.0f) deltaYaw = 0.0f;
-			if(fabs(deltaPitch) > 100.0f) deltaPitch = 0.0f;
+				// Set limits.
+				if(fabs(deltaYaw) > 100.0f) deltaYaw = 0.0f;
+				if(fabs(deltaPitch) > 100.0f) deltaPitch = 0.0f;
 
-			// Pass to mouse data (long integer).
-			mouseData.mi.dx = (long)(deltaYaw);
-			mouseData.mi.dy = (long)(deltaPitch);
+				// Pass to mouse data (long integer).
+				mouseData.mi.dx = (long)(deltaYaw);
+				mouseData.mi.dy = (long)(deltaPitch);
 
-			// Keep fractional difference in the delta so it's added to the next update.
-			deltaYaw -= (float)mouseData.mi.dx;
-			deltaPitch -= (float)mouseData.mi.dy;
+				// Keep fractional difference in the delta so it's added to the next update.
+				deltaYaw -= (float)mouseData.mi.dx;
+				deltaPitch -= (float)mouseData.mi.dy;
 
 #ifdef _DEBUG
-			//OutputDebugString("Motion Tracker SendInput\n");
+				//OutputDebugString("Motion Tracker SendInput\n");
 #endif
-			// Send to mouse input.
-			if (mouseEmulation)
-				SendInput(1, &mouseData, sizeof(INPUT));
+				// Send to mouse input.
+				if (mouseEmulation)
+					SendInput(1, &mouseData, sizeof(INPUT));
+			}
 		}
 
 		// Set current data.
@@ -179,6 +193,8 @@ void MotionTracker::setMultipliers(float yaw, float pitch, float roll)
 	multiplierYaw = yaw;
 	multiplierPitch = pitch;
 	multiplierRoll = roll;
+	if (mouseEmulator)
+		mouseEmulator->SetMultipliers(yaw, pitch);
 	currentYaw = 0.0f;
 	currentPitch = 0.0f;
 	currentRoll = 0.0f;
@@ -192,6 +208,8 @@ bool MotionTracker::setMouseEmulation(bool emulateMouse)
 {
 	bool temp = mouseEmulation;
 	mouseEmulation = emulateMouse;
+	if (mouseEmulator)
+		mouseEmulator->SetEnabled(emulateMouse);
 	return temp;
 }
 
@@ -201,4 +219,156 @@ bool MotionTracker::setMouseEmulation(bool emulateMouse)
 bool MotionTracker::getMouseEmulation()
 {
 	return mouseEmulation;
+}
+
+/**
+* Starts reading the device on a dedicated sampling thread.
+* getOrientationAndPosition() is then only called on that thread, the render thread uses the sampled poses.
+* @return False if the tracker doesn't support sampling or the thread could not be started.
+***/
+bool MotionTracker::startSampling()
+{
+	if (sampler)
+		return true;
+	if (!SupportsSampling())
+		return false;
+
+	sampler = new TrackerSampler(this);
+	if (!sampler->Start())
+	{
+		delete sampler;
+		sampler = NULL;
+		return false;
+	}
+
+	OutputDebugString("Motion Tracker sampling thread started\n");
+	return true;
+}
+
+/**
+* Stops the sampling thread, the device is read on the render thread again.
+* Stops the mouse emulation, it may resample the pose history.
+***/
+void MotionTracker::stopSampling()
+{
+	if (sampler)
+	{
+		stopMouseEmulation();
+		delete sampler;
+		sampler = NULL;
+	}
+}
+
+/**
+* Returns the sampled pose at the given time (interpolated).
+* @param time Performance counter time.
+* @return False if not sampling or no pose sampled yet.
+***/
+bool MotionTracker::getSampledPoseAt(LONGLONG time, TrackerPose* pPose)
+{
+	return sampler && sampler->GetAt(time, pPose);
+}
+
+/**
+* Reads orientation and position : the latest sampled pose if sampling, from the device otherwise.
+* The pose is recorded if recording and predicted to the expected display time if prediction is enabled.
+* Same outputs and return value as getOrientationAndPosition().
+***/
+int MotionTracker::readOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z)
+{
+	TrackerPose pose;
+	if (sampler)
+	{
+		if (!sampler->GetLatest(&pose))
+			return -1;
+	}
+	else
+	{
+		sampleTime = 0;
+		int result = getOrientationAndPosition(yaw, pitch, roll, x, y, z);
+		if ((result != 0) || (!predictor.IsEnabled() && !recorder))
+			return result;
+
+		if (sampleTime == 0)
+		{
+			LARGE_INTEGER now;
+			QueryPerformanceCounter(&now);
+			sampleTime = now.QuadPart;
+		}
+		pose.time = sampleTime;
+		pose.yaw = *yaw;
+		pose.pitch = *pitch;
+		pose.roll = *roll;
+		pose.x = *x;
+		pose.y = *y;
+		pose.z = *z;
+	}
+
+	if (recorder)
+		recorder->Record(pose, (float)(2.0 * PI) / GetFullTurn(), getStatus());
+
+	if (predictor.IsEnabled())
+	{
+		predictor.AddSample(pose);
+		predictor.PredictAhead(&pose);
+	}
+
+	*yaw = pose.yaw;
+	*pitch = pose.pitch;
+	*roll = pose.roll;
+	*x = pose.x;
+	*y = pose.y;
+	*z = pose.z;
+	return 0;
+}
+
+/**
+* Sets the pose prediction of trackers without SDK prediction.
+* @param predictionMs Time from reading the pose to displaying it, 0 disables prediction.
+* @param velocitySmoothing Weight of the previous velocity estimate [0..1).
+* @param accelerationSmoothing Weight of the previous acceleration estimate [0..1], 1 disables acceleration.
+***/
+void MotionTracker::setPrediction(float predictionMs, float velocitySmoothing, float accelerationSmoothing)
+{
+	predictor.SetFullTurn(GetFullTurn());
+	predictor.SetFilters(predictionMs, velocitySmoothing, accelerationSmoothing);
+}
+
+/**
+* Starts the mouse emulation engine : the mouse motion is sent on its own timer, resampled from the
+* pose history if sampling (call after startSampling()) or from the updated orientation otherwise.
+* @param rateHz Mouse updates per second.
+* @param yawCurve Yaw response curve.
+* @param pitchCurve Pitch response curve.
+* @return False if the emulation thread could not be started.
+***/
+bool MotionTracker::startMouseEmulation(float rateHz, const MouseAxisCurve& yawCurve, const MouseAxisCurve& pitchCurve)
+{
+	stopMouseEmulation();
+
+	mouseEmulator = new MouseEmulator(NULL);
+	mouseEmulator->SetCurves(yawCurve, pitchCurve);
+	mouseEmulator->SetMultipliers(multiplierYaw, multiplierPitch);
+	mouseEmulator->SetEnabled(mouseEmulation);
+	if (!mouseEmulator->Start(rateHz, sampler, GetFullTurn()))
+	{
+		delete mouseEmulator;
+		mouseEmulator = NULL;
+		return false;
+	}
+
+	OutputDebugString("Motion Tracker mouse emulation thread started\n");
+	return true;
+}
+
+/**
+* Stops the mouse emulation engine, the mouse motion is sent once per update again.
+***/
+void MotionTracker::stopMouseEmulation()
+{
+	if (mouseEmulator)
+	{
+		delete mouseEmulator;
+		mouseEmulator = NULL;
+	}
 }
\ No newline at end of file
@@ -35,6 +35,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <math.h>
 #include <windows.h>
+#include "TrackerSampler.h"
+#include "PosePredictor.h"
+#include "MouseEmulator.h"
+#include "PoseRecorder.h"
 
 enum MotionTrackerStatus
 {
@@ -65,6 +69,7 @@ public:
 	virtual void resetOrientationAndPosition() {}
 	virtual void resetPosition() {}
 	virtual int  getOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z);
+	virtual bool sampleOrientation(float* yaw, float* pitch, float* roll) {return false;}
 	virtual void updateOrientationAndPosition();
 	virtual MotionTrackerStatus getStatus();
 	virtual void setMultipliers(float yaw, float pitch, float roll);
@@ -75,9 +80,21 @@ public:
 	virtual void EndFrame() {}
 	virtual char* GetTrackerDescription() {return "No Tracker";}
 	virtual bool SupportsPositionTracking() {return false;}
+	virtual bool SupportsSampling() {return false;}
+	virtual DWORD GetSamplingInterval() {return 0;}
+	virtual float GetFullTurn() {return (float)(2.0 * PI);}
 
 	/*** MotionTracker public methods ***/
 	bool isEqual(float a, float b){ return abs(a-b) < 0.001; };
+	bool startSampling();
+	void stopSampling();
+	bool isSampling() {return sampler != NULL;}
+	virtual bool getSampledPoseAt(LONGLONG time, TrackerPose* pPose);
+	int  readOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z);
+	void setPrediction(float predictionMs, float velocitySmoothing, float accelerationSmoothing);
+	bool startMouseEmulation(float rateHz, const MouseAxisCurve& yawCurve, const MouseAxisCurve& pitchCurve);
+	void stopMouseEmulation();
+	void setRecorder(PoseRecorder* pRecorder) {recorder = pRecorder;}
 
 	/**
 	* Orientation, as received from tracker.
@@ -150,13 +167,15 @@ public:
 	/**
 	* Currently supported tracker types enumeration.
 	***/
-	static enum TrackerTypes
+	enum TrackerTypes
 	{
 		DISABLED = 0,         /**< Tracking disabled. */
 		HILLCREST = 10,       /**< Hillcrest Labs. Freespace. */
 		FREETRACK = 20,       /**< FreeTrack optical motion tracking. */
 		SHAREDMEMTRACK = 30,  /**< Shared memory tracking. */
-		OCULUSTRACK = 40      /**< Oculus Rift tracking. */
+		OCULUSTRACK = 40,     /**< Oculus Rift tracking. */
+		SOCKETTRACK = 50,     /**< Socket tracking (binary UDP datagrams). */
+		REPLAYTRACK = 60      /**< Replay of a pose recording. */
 	};
 
 protected:
@@ -164,6 +183,31 @@ protected:
 	* True if mouse emulation is on.
 	***/
 	bool mouseEmulation;
+	/**
+	* Tracker sampling service, NULL if the device is read on the render thread.
+	* Trackers supporting sampling must call stopSampling() in their destructor before closing the device.
+	***/
+	TrackerSampler* sampler;
+	/**
+	* Pose prediction, applied in readOrientationAndPosition() if enabled.
+	***/
+	PosePredictor predictor;
+	/**
+	* Time of the sample returned by getOrientationAndPosition(), set by trackers providing 
+	* timestamped samples (zero : read time).
+	***/
+	LONGLONG sampleTime;
+	/**
+	* Mouse emulation engine, NULL if the mouse input is sent once per update.
+	* Trackers pass their orientation with mouseEmulator->SubmitPose() instead of sending it if set.
+	***/
+	MouseEmulator* mouseEmulator;
+	/**
+	* Pose recorder (not owned), NULL if not recording.
+	* Raw poses read in readOrientationAndPosition() are recorded, trackers reading the device 
+	* elsewhere record their poses themselves.
+	***/
+	PoseRecorder* recorder;
 };
 
 #endif
\ No newline at end of file
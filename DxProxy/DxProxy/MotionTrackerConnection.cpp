@@ -0,0 +1,261 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <MotionTrackerConnection.cpp> and
+Class <MotionTrackerConnection> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#include "MotionTrackerConnection.h"
+#include "MotionTrackerFactory.h"
+
+/**
+* Constructor.
+***/
+MotionTrackerConnection::MotionTrackerConnection() :
+	m_pConfig(NULL),
+	m_state(TCS_IDLE),
+	m_hThread(NULL),
+	m_pProbe(NULL),
+	m_pRetired(NULL),
+	m_pPending(NULL),
+	m_lostSince(0)
+{
+}
+
+/**
+* Destructor, stops probing.
+***/
+MotionTrackerConnection::~MotionTrackerConnection()
+{
+	Stop();
+}
+
+/**
+* Starts creating the configured tracker.
+* @param pConfig Game configuration, must outlive the connection.
+* @return The neutral tracker to use meanwhile, owned by the caller.
+***/
+MotionTracker* MotionTrackerConnection::Start(ProxyConfig* pConfig)
+{
+	m_pConfig = pConfig;
+	m_pPending = new PendingTracker(MTS_INITIALISING);
+	if (!StartProbe(NULL, TCS_PROBING))
+	{
+		// no probe thread, create the tracker right here
+		MotionTracker* pTracker = MotionTrackerFactory::Get(*pConfig);
+		delete m_pPending;
+		m_pPending = NULL;
+		m_state = TCS_ACTIVE;
+		return pTracker;
+	}
+	return m_pPending;
+}
+
+/**
+* Advances the connection state (render thread, once per frame).
+* @param pCurrent The tracker in use.
+* @return The tracker to switch to, NULL to keep the current one. If a tracker is returned the
+* connection takes ownership of pCurrent and the caller of the returned tracker, pCurrent may be
+* deleted already and must not be used after the call.
+***/
+MotionTracker* MotionTrackerConnection::Update(MotionTracker* pCurrent)
+{
+	switch (m_state)
+	{
+	case TCS_LOST:
+		// the lost tracker is out of use now, release it on the probe thread (may block as well)
+		if (!m_pProbe && !StartProbe(m_pRetired, TCS_LOST))
+			return NULL;
+		if (!m_pProbe->pRetired)
+			m_state = TCS_RECONNECTING;
+		// fall through : the probe may have a tracker ready already
+	case TCS_PROBING:
+	case TCS_RECONNECTING:
+		{
+			MotionTracker* pReady = (MotionTracker*)InterlockedExchangePointer((PVOID volatile*)&m_pProbe->pReady, NULL);
+			if (!pReady)
+				return NULL;
+
+			// the probe thread ends after publishing the tracker, no need to wait for it
+			DetachProbe();
+
+			if (pCurrent == m_pPending)
+				m_pPending = NULL;
+			delete pCurrent;
+
+			OutputDebugString("Motion Tracker Connection : tracker active\n");
+			m_lostSince = 0;
+			m_state = TCS_ACTIVE;
+			return pReady;
+		}
+	case TCS_ACTIVE:
+		{
+			if (!IsLostStatus(pCurrent->getStatus()))
+			{
+				m_lostSince = 0;
+				return NULL;
+			}
+
+			DWORD now = GetTickCount();
+			if (m_lostSince == 0)
+				m_lostSince = now ? now : 1;
+			if (now - m_lostSince < TRACKERCONNECTION_LOST_MS)
+				return NULL;
+
+			// the probe starts on the next call, once the caller switched to the neutral tracker
+			OutputDebugString("Motion Tracker Connection : tracker lost, reconnecting\n");
+			m_pRetired = pCurrent;
+			m_state = TCS_LOST;
+			m_pPending = new PendingTracker(MTS_NOHMDDETECTED);
+			return m_pPending;
+		}
+	default:
+		return NULL;
+	}
+}
+
+/**
+* Stops probing, releases trackers not handed out.
+* A probe thread still creating the device after TRACKERCONNECTION_STOP_MS is abandoned, it releases
+* its tracker and ends on its own.
+***/
+void MotionTrackerConnection::Stop()
+{
+	if (m_pProbe)
+	{
+		SetEvent(m_pProbe->hStopEvent);
+		if (WaitForSingleObject(m_hThread, TRACKERCONNECTION_STOP_MS) != WAIT_OBJECT_0)
+			OutputDebugString("Motion Tracker Connection : probe thread not responding, abandoned\n");
+		DetachProbe();
+	}
+
+	delete m_pRetired;
+	m_pRetired = NULL;
+	m_state = TCS_IDLE;
+}
+
+/**
+* Starts the probe thread.
+* @param pRetired Lost tracker to release first, NULL if none. Owned by the probe if started.
+* @param state State while probing.
+* @return False if the thread could not be created.
+***/
+bool MotionTrackerConnection::StartProbe(MotionTracker* pRetired, TrackerConnectionState state)
+{
+	TrackerProbe* pProbe = new TrackerProbe();
+	pProbe->references = 2;
+	pProbe->config = *m_pConfig;
+	pProbe->pRetired = pRetired;
+	pProbe->pReady = NULL;
+	pProbe->hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!pProbe->hStopEvent)
+	{
+		delete pProbe;
+		return false;
+	}
+
+	m_hThread = CreateThread(NULL, 0, ProbeThread, pProbe, 0, NULL);
+	if (!m_hThread)
+	{
+		OutputDebugString("Motion Tracker Connection : Could not create probe thread\n");
+		CloseHandle(pProbe->hStopEvent);
+		delete pProbe;
+		return false;
+	}
+
+	m_pProbe = pProbe;
+	m_pRetired = NULL;
+	m_state = state;
+	return true;
+}
+
+/**
+* Lets go of the probe thread, which ended or ends on its own.
+***/
+void MotionTrackerConnection::DetachProbe()
+{
+	CloseHandle(m_hThread);
+	m_hThread = NULL;
+	ReleaseProbe(m_pProbe);
+	m_pProbe = NULL;
+}
+
+/**
+* Drops one reference to the probe, the last owner releases the trackers left in it.
+***/
+void MotionTrackerConnection::ReleaseProbe(TrackerProbe* pProbe)
+{
+	if (InterlockedDecrement(&pProbe->references) != 0)
+		return;
+
+	delete pProbe->pRetired;
+	delete pProbe->pReady;
+	CloseHandle(pProbe->hStopEvent);
+	delete pProbe;
+}
+
+/**
+* True if the status means the device is gone (as opposed to tracking issues of a working device).
+***/
+bool MotionTrackerConnection::IsLostStatus(MotionTrackerStatus status)
+{
+	return (status == MTS_NOTINIT) || (status == MTS_NOHMDDETECTED) || 
+		(status == MTS_INITFAIL) || (status == MTS_DRIVERFAIL);
+}
+
+/**
+* Probe thread : releases the lost tracker, then creates the tracker until it is usable.
+***/
+DWORD WINAPI MotionTrackerConnection::ProbeThread(LPVOID pParam)
+{
+	TrackerProbe* pProbe = (TrackerProbe*)pParam;
+
+	if (pProbe->pRetired)
+	{
+		delete pProbe->pRetired;
+		InterlockedExchangePointer((PVOID volatile*)&pProbe->pRetired, NULL);
+	}
+
+	for (;;)
+	{
+		MotionTracker* pTracker = MotionTrackerFactory::Get(pProbe->config);
+		MotionTrackerStatus status = pTracker->getStatus();
+		if ((status >= MTS_OK) || (status == MTS_INITIALISING))
+		{
+			// publish (full barrier), picked up by Update() or released with the probe
+			InterlockedExchangePointer((PVOID volatile*)&pProbe->pReady, pTracker);
+			break;
+		}
+		delete pTracker;
+
+		if (WaitForSingleObject(pProbe->hStopEvent, TRACKERCONNECTION_RETRY_MS) != WAIT_TIMEOUT)
+			break;
+	}
+
+	ReleaseProbe(pProbe);
+	return 0;
+}
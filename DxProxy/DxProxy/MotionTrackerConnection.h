@@ -0,0 +1,164 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <MotionTrackerConnection.h> and
+Class <MotionTrackerConnection> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#ifndef MOTIONTRACKERCONNECTION_H_INCLUDED
+#define MOTIONTRACKERCONNECTION_H_INCLUDED
+
+#include "ProxyHelper.h"
+#include "MotionTracker.h"
+
+/**
+* Wait between failed tracker creations.
+***/
+#define TRACKERCONNECTION_RETRY_MS 2000
+/**
+* A tracker reporting a device failure this long is considered lost.
+***/
+#define TRACKERCONNECTION_LOST_MS 3000
+/**
+* Stop() waits this long for the probe thread, then abandons it (device creation hanging in a driver).
+***/
+#define TRACKERCONNECTION_STOP_MS 1000
+
+/**
+* Tracker connection states.
+***/
+enum TrackerConnectionState
+{
+	TCS_IDLE,          /**< Not started. */
+	TCS_PROBING,       /**< First tracker being created. */
+	TCS_ACTIVE,        /**< Tracker in use. */
+	TCS_LOST,          /**< Tracker lost, being released. */
+	TCS_RECONNECTING   /**< Tracker being created again after a loss. */
+};
+
+/**
+* Neutral tracker used while the real tracker is created : no orientation, given status.
+***/
+class PendingTracker : public MotionTracker
+{
+public:
+	PendingTracker(MotionTrackerStatus status) : status(status) {}
+	virtual MotionTrackerStatus getStatus() {return status;}
+	virtual char* GetTrackerDescription() {return "PendingTracker";}
+
+private:
+	/**
+	* Reported status (MTS_INITIALISING or MTS_NOHMDDETECTED).
+	***/
+	MotionTrackerStatus status;
+};
+
+/**
+* State shared by the connection and a probe thread, released by the last of both.
+* An abandoned probe thread keeps running on it after the connection is gone.
+***/
+struct TrackerProbe
+{
+	/**
+	* Owners : the connection and the probe thread.
+	***/
+	volatile LONG references;
+	/**
+	* Copy of the game configuration the tracker is created for.
+	***/
+	ProxyConfig config;
+	/**
+	* Signaled to stop probing.
+	***/
+	HANDLE hStopEvent;
+	/**
+	* Lost tracker, released on the probe thread before the device is opened again (NULL once released).
+	***/
+	MotionTracker* volatile pRetired;
+	/**
+	* Tracker created by the probe thread, not picked up by Update() yet.
+	***/
+	MotionTracker* volatile pReady;
+};
+
+/**
+* Motion tracker connection.
+* Creates the configured tracker through the MotionTrackerFactory on a probe thread, so slow device
+* initialization doesn't stall rendering, and recreates it if the device is lost (unplugged).
+* Meanwhile the render thread uses a PendingTracker (neutral pose).
+* Update() is called by the render thread once per frame and returns the tracker to switch to.
+* Neither Update() nor Stop() blocks on a probe thread for long : a finished probe is detached, a probe
+* still creating the device on Stop() is abandoned after TRACKERCONNECTION_STOP_MS.
+***/
+class MotionTrackerConnection
+{
+public:
+	MotionTrackerConnection();
+	virtual ~MotionTrackerConnection();
+
+	/*** MotionTrackerConnection public methods ***/
+	MotionTracker* Start(ProxyConfig* pConfig);
+	MotionTracker* Update(MotionTracker* pCurrent);
+	void           Stop();
+	TrackerConnectionState GetState() {return (TrackerConnectionState)m_state;}
+
+private:
+	/*** MotionTrackerConnection private methods ***/
+	bool StartProbe(MotionTracker* pRetired, TrackerConnectionState state);
+	void DetachProbe();
+	bool IsLostStatus(MotionTrackerStatus status);
+	static void  ReleaseProbe(TrackerProbe* pProbe);
+	static DWORD WINAPI ProbeThread(LPVOID pParam);
+
+	/**
+	* Game configuration, selects the tracker.
+	***/
+	ProxyConfig* m_pConfig;
+	/**
+	* Connection state, TrackerConnectionState.
+	***/
+	volatile LONG m_state;
+	/**
+	* Probe thread and its shared state, NULL if not probing.
+	***/
+	HANDLE m_hThread;
+	TrackerProbe* m_pProbe;
+	/**
+	* Lost tracker, handed to the probe thread on the next Update().
+	***/
+	MotionTracker* m_pRetired;
+	/**
+	* Neutral tracker handed out by the connection, NULL if the real tracker is in use.
+	***/
+	MotionTracker* m_pPending;
+	/**
+	* Tick count since the active tracker reports a device failure, zero if it doesn't.
+	***/
+	DWORD m_lostSince;
+};
+
+#endif
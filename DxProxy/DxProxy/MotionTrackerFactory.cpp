@@ -43,6 +43,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "FreeTrackTracker.h"
 #include "SharedMemoryTracker.h"
 #include "OculusTracker.h"
+#include "SocketTracker.h"
+#include "ReplayTracker.h"
 
 /**
 *  Get motion tracker. 
@@ -71,6 +73,12 @@ MotionTracker* MotionTrackerFactory::Get(ProxyConfig& config)
 	case MotionTracker::OCULUSTRACK:
 		newTracker = new OculusTracker();
 		break;
+	case MotionTracker::SOCKETTRACK:
+		newTracker = new SocketTracker(STM_UDP_BINARY);
+		break;
+	case MotionTracker::REPLAYTRACK:
+		newTracker = new ReplayTracker(config.trackerReplayPath.c_str(), config.trackerReplaySpeed);
+		break;
 	default:
 		newTracker = new MotionTracker();
 		break;
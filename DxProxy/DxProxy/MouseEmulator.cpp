@@ -0,0 +1,329 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <MouseEmulator.cpp> and
+Class <MouseEmulator> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#include "MouseEmulator.h"
+#include <math.h>
+#include <mmsystem.h>
+
+/**
+* Sends the motion with SendInput().
+***/
+void MouseInjector::Move(LONG dx, LONG dy)
+{
+	INPUT mouseData;
+	ZeroMemory(&mouseData, sizeof(mouseData));
+	mouseData.type = INPUT_MOUSE;
+	mouseData.mi.dx = dx;
+	mouseData.mi.dy = dy;
+	mouseData.mi.dwFlags = MOUSEEVENTF_MOVE;
+	SendInput(1, &mouseData, sizeof(INPUT));
+}
+
+/**
+* Constructor.
+* @param pInjector The mouse input target, NULL for SendInput(). Not owned.
+***/
+MouseEmulator::MouseEmulator(MouseInjector* pInjector) :
+	m_pInjector(pInjector ? pInjector : &m_defaultInjector),
+	m_hThread(NULL),
+	m_hStopEvent(NULL),
+	m_interval(4),
+	m_pSampler(NULL),
+	m_toDegrees(1.0f),
+	m_multiplierYaw(1.0f),
+	m_multiplierPitch(1.0f),
+	m_enabled(true),
+	m_submitYaw(0.0f),
+	m_submitPitch(0.0f),
+	m_submitTime(0),
+	m_submitInterval(0),
+	m_hasEmitted(false),
+	m_emittedYaw(0.0f),
+	m_emittedPitch(0.0f),
+	m_remainderX(0.0f),
+	m_remainderY(0.0f),
+	m_lastTick(0)
+{
+	m_yawCurve.deadzone = 0.0f;
+	m_yawCurve.exponent = 1.0f;
+	m_pitchCurve = m_yawCurve;
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_frequency = frequency.QuadPart;
+
+	InitializeCriticalSection(&m_submitLock);
+}
+
+/**
+* Destructor, stops the emulation thread.
+***/
+MouseEmulator::~MouseEmulator()
+{
+	Stop();
+	DeleteCriticalSection(&m_submitLock);
+}
+
+/**
+* Starts the emulation thread.
+* @param rateHz Mouse updates per second.
+* @param pSampler Pose history to resample (sampled trackers), NULL if the poses are submitted by 
+* SubmitPose(). Must outlive the emulation thread.
+* @param fullTurn A full turn in pose history units (2 PI for radians).
+* @return False if the thread could not be created.
+***/
+bool MouseEmulator::Start(float rateHz, TrackerSampler* pSampler, float fullTurn)
+{
+	if (m_hThread)
+		return true;
+
+	if (rateHz < MOUSEEMULATOR_MIN_RATE) rateHz = MOUSEEMULATOR_MIN_RATE;
+	if (rateHz > MOUSEEMULATOR_MAX_RATE) rateHz = MOUSEEMULATOR_MAX_RATE;
+	m_interval = (DWORD)(1000.0f / rateHz + 0.5f);
+	m_pSampler = pSampler;
+	m_toDegrees = 360.0f / fullTurn;
+	m_hasEmitted = false;
+	m_lastTick = 0;
+
+	m_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!m_hStopEvent)
+		return false;
+
+	m_hThread = CreateThread(NULL, 0, EmulationThread, this, 0, NULL);
+	if (!m_hThread)
+	{
+		OutputDebugString("MouseEmulator: Could not create emulation thread\n");
+		CloseHandle(m_hStopEvent);
+		m_hStopEvent = NULL;
+		return false;
+	}
+
+	SetThreadPriority(m_hThread, THREAD_PRIORITY_ABOVE_NORMAL);
+	return true;
+}
+
+/**
+* Stops the emulation thread.
+***/
+void MouseEmulator::Stop()
+{
+	if (!m_hThread)
+		return;
+
+	SetEvent(m_hStopEvent);
+	WaitForSingleObject(m_hThread, INFINITE);
+	CloseHandle(m_hThread);
+	CloseHandle(m_hStopEvent);
+	m_hThread = NULL;
+	m_hStopEvent = NULL;
+	m_pSampler = NULL;
+}
+
+/**
+* Sets the response curves, before Start().
+***/
+void MouseEmulator::SetCurves(const MouseAxisCurve& yawCurve, const MouseAxisCurve& pitchCurve)
+{
+	m_yawCurve = yawCurve;
+	m_pitchCurve = pitchCurve;
+}
+
+/**
+* Sets the game specific mouse units per degree.
+***/
+void MouseEmulator::SetMultipliers(float yaw, float pitch)
+{
+	m_multiplierYaw = yaw;
+	m_multiplierPitch = pitch;
+}
+
+/**
+* Turns the mouse motion on or off, the pose is still followed so turning it on doesn't jump.
+***/
+void MouseEmulator::SetEnabled(bool enabled)
+{
+	m_enabled = enabled;
+}
+
+/**
+* Submits the latest pose (render thread, trackers without pose history).
+* @param yaw Yaw, degrees, positive right.
+* @param pitch Pitch, degrees, positive down.
+***/
+void MouseEmulator::SubmitPose(float yaw, float pitch)
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	EnterCriticalSection(&m_submitLock);
+	if (m_submitTime)
+	{
+		// smoothed frame time, ignore stalls
+		LONGLONG interval = now.QuadPart - m_submitTime;
+		if ((interval > 0) && (interval < m_frequency / 4))
+			m_submitInterval = m_submitInterval ? (m_submitInterval * 3 + interval) / 4 : interval;
+	}
+	m_submitYaw = yaw;
+	m_submitPitch = pitch;
+	m_submitTime = now.QuadPart;
+	LeaveCriticalSection(&m_submitLock);
+}
+
+/**
+* Emits the mouse motion from the last tick to now (emulation thread).
+* @param now Performance counter time.
+***/
+void MouseEmulator::Tick(LONGLONG now)
+{
+	float targetYaw, targetPitch;
+	LONGLONG deadline;
+	LONGLONG lastTick = m_lastTick;
+	m_lastTick = now;
+	if (!GetTarget(now, &targetYaw, &targetPitch, &deadline))
+		return;
+
+	float remainingYaw = WrapDegrees(targetYaw - m_emittedYaw);
+	float remainingPitch = WrapDegrees(targetPitch - m_emittedPitch);
+
+	// first pose, disabled or reset : follow without motion
+	if (!m_hasEmitted || !m_enabled || (lastTick == 0) || (now <= lastTick) ||
+		(fabs(remainingYaw) > MOUSEEMULATOR_MAX_JUMP_DEGREES) || (fabs(remainingPitch) > MOUSEEMULATOR_MAX_JUMP_DEGREES))
+	{
+		m_emittedYaw = targetYaw;
+		m_emittedPitch = targetPitch;
+		m_remainderX = 0.0f;
+		m_remainderY = 0.0f;
+		m_hasEmitted = true;
+		return;
+	}
+
+	// spread the remaining motion linearly until the target is due
+	float fraction = 1.0f;
+	if (deadline > now)
+		fraction = (float)(now - lastTick) / (float)(deadline - lastTick);
+	float stepYaw = remainingYaw * fraction;
+	float stepPitch = remainingPitch * fraction;
+	m_emittedYaw = WrapDegrees(m_emittedYaw + stepYaw);
+	m_emittedPitch = WrapDegrees(m_emittedPitch + stepPitch);
+
+	// curves, then mouse units with the fractional part carried
+	float seconds = (float)(now - lastTick) / (float)m_frequency;
+	float unitsX = ApplyCurve(m_yawCurve, stepYaw, seconds) * m_multiplierYaw + m_remainderX;
+	float unitsY = ApplyCurve(m_pitchCurve, stepPitch, seconds) * m_multiplierPitch + m_remainderY;
+	LONG dx = (LONG)unitsX;
+	LONG dy = (LONG)unitsY;
+	m_remainderX = unitsX - (float)dx;
+	m_remainderY = unitsY - (float)dy;
+
+	if (dx || dy)
+		m_pInjector->Move(dx, dy);
+}
+
+/**
+* Returns the pose to move to and when it is due.
+* @return False if there is no pose yet.
+***/
+bool MouseEmulator::GetTarget(LONGLONG now, float* pYaw, float* pPitch, LONGLONG* pDeadline)
+{
+	if (m_pSampler)
+	{
+		TrackerPose pose;
+		if (!m_pSampler->GetAt(now, &pose))
+			return false;
+		*pYaw = pose.yaw * m_toDegrees;
+		*pPitch = -pose.pitch * m_toDegrees;
+		*pDeadline = now;
+		return true;
+	}
+
+	bool hasPose = false;
+	EnterCriticalSection(&m_submitLock);
+	if (m_submitTime)
+	{
+		*pYaw = m_submitYaw;
+		*pPitch = m_submitPitch;
+		*pDeadline = m_submitTime + m_submitInterval;
+		hasPose = true;
+	}
+	LeaveCriticalSection(&m_submitLock);
+	return hasPose;
+}
+
+/**
+* Applies a response curve.
+* @param curve The curve.
+* @param degrees Motion within the tick.
+* @param seconds Tick duration.
+* @return The motion after the curve, degrees.
+***/
+float MouseEmulator::ApplyCurve(const MouseAxisCurve& curve, float degrees, float seconds)
+{
+	float speed = fabs(degrees) / seconds;
+	if (speed <= curve.deadzone)
+		return 0.0f;
+	speed -= curve.deadzone;
+
+	if (curve.exponent != 1.0f)
+		speed = powf(speed / MOUSEEMULATOR_CURVE_REFERENCE, curve.exponent) * MOUSEEMULATOR_CURVE_REFERENCE;
+
+	return (degrees < 0.0f) ? -speed * seconds : speed * seconds;
+}
+
+/**
+* Wraps an angle to [-180, 180) degrees.
+***/
+float MouseEmulator::WrapDegrees(float degrees)
+{
+	degrees = fmodf(degrees + 180.0f, 360.0f);
+	if (degrees < 0.0f)
+		degrees += 360.0f;
+	return degrees - 180.0f;
+}
+
+/**
+* Emulation thread, ticks at the configured rate.
+***/
+DWORD WINAPI MouseEmulator::EmulationThread(LPVOID pParam)
+{
+	MouseEmulator* pEmulator = (MouseEmulator*)pParam;
+
+	// 1ms timer resolution, or the waits round up to the 15.6ms system tick
+	timeBeginPeriod(1);
+	while (WaitForSingleObject(pEmulator->m_hStopEvent, pEmulator->m_interval) == WAIT_TIMEOUT)
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		pEmulator->Tick(now.QuadPart);
+	}
+	timeEndPeriod(1);
+
+	return 0;
+}
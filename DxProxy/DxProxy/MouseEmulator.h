@@ -0,0 +1,150 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <MouseEmulator.h> and
+Class <MouseEmulator> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#ifndef MOUSEEMULATOR_H_INCLUDED
+#define MOUSEEMULATOR_H_INCLUDED
+
+#include <windows.h>
+#include "TrackerSampler.h"
+
+/**
+* Poses further apart than this (degrees) are a reset/recenter, not a head turn : no mouse motion.
+***/
+#define MOUSEEMULATOR_MAX_JUMP_DEGREES 45.0f
+/**
+* Angular speed (degrees per second) mapped to itself by the response curves.
+***/
+#define MOUSEEMULATOR_CURVE_REFERENCE 90.0f
+/**
+* Tick rate limits (Hz).
+***/
+#define MOUSEEMULATOR_MIN_RATE 30.0f
+#define MOUSEEMULATOR_MAX_RATE 1000.0f
+
+/**
+* Response curve of one mouse axis, applied to the angular speed.
+***/
+struct MouseAxisCurve
+{
+	float deadzone;  /**< Speeds below this (degrees per second) don't move the mouse, removes drift */
+	float exponent;  /**< 1 : linear, > 1 : finer slow turns, faster fast turns */
+};
+
+/**
+* Mouse input target, SendInput() by default. Override to redirect the mouse motion.
+***/
+class MouseInjector
+{
+public:
+	virtual ~MouseInjector() {}
+	virtual void Move(LONG dx, LONG dy);
+};
+
+/**
+* Mouse emulation engine.
+* Emits the head motion as relative mouse motion on its own timer, independent of the game frame
+* rate. The pose stream is resampled per tick : sampled trackers are read from the pose history at
+* the tick time, poses submitted by the render thread are spread linearly over the expected time 
+* of the next submit. Per axis curves and deadzones are applied to the angular speed, fractional
+* mouse units are carried to the next tick.
+* Angles in "mouse degrees" : yaw positive right, pitch positive down.
+***/
+class MouseEmulator
+{
+public:
+	MouseEmulator(MouseInjector* pInjector);
+	virtual ~MouseEmulator();
+
+	/*** MouseEmulator public methods ***/
+	bool Start(float rateHz, TrackerSampler* pSampler, float fullTurn);
+	void Stop();
+	bool IsRunning() {return m_hThread != NULL;}
+	void SetCurves(const MouseAxisCurve& yawCurve, const MouseAxisCurve& pitchCurve);
+	void SetMultipliers(float yaw, float pitch);
+	void SetEnabled(bool enabled);
+	void SubmitPose(float yaw, float pitch);
+	void Tick(LONGLONG now);
+
+private:
+	/*** MouseEmulator private methods ***/
+	bool GetTarget(LONGLONG now, float* pYaw, float* pPitch, LONGLONG* pDeadline);
+	float ApplyCurve(const MouseAxisCurve& curve, float degrees, float seconds);
+	static float WrapDegrees(float degrees);
+	static DWORD WINAPI EmulationThread(LPVOID pParam);
+
+	/**
+	* Mouse input target, default SendInput() injector if none is given.
+	***/
+	MouseInjector* m_pInjector;
+	MouseInjector m_defaultInjector;
+	/**
+	* Emulation thread, its stop event and the tick interval (ms).
+	***/
+	HANDLE m_hThread;
+	HANDLE m_hStopEvent;
+	DWORD m_interval;
+	/**
+	* Pose history of a sampled tracker (NULL : poses are submitted) and the scale to degrees.
+	***/
+	TrackerSampler* m_pSampler;
+	float m_toDegrees;
+	/**
+	* Response curves, set before Start().
+	***/
+	MouseAxisCurve m_yawCurve;
+	MouseAxisCurve m_pitchCurve;
+	/**
+	* Mouse units per degree.
+	***/
+	volatile float m_multiplierYaw;
+	volatile float m_multiplierPitch;
+	/**
+	* True if the motion is sent, the pose is followed silently otherwise.
+	***/
+	volatile bool m_enabled;
+	/**
+	* Latest submitted pose, its arrival and the (smoothed) submit interval, guarded by m_submitLock.
+	***/
+	CRITICAL_SECTION m_submitLock;
+	float m_submitYaw, m_submitPitch;
+	LONGLONG m_submitTime;
+	LONGLONG m_submitInterval;
+	/**
+	* Emulation state (tick only) : pose the mouse motion was sent for, fractional units not sent yet.
+	***/
+	bool m_hasEmitted;
+	float m_emittedYaw, m_emittedPitch;
+	float m_remainderX, m_remainderY;
+	LONGLONG m_lastTick;
+	LONGLONG m_frequency;
+};
+
+#endif
@@ -43,19 +43,39 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 OculusRiftView::OculusRiftView(ProxyConfig *config, HMDisplayInfo *hmd) : StereoView(config),
 	hmdInfo(hmd),
 	m_logoTexture(NULL),
-	m_prevTexture(NULL)
+	m_prevTexture(NULL),
+	m_bDistortionMesh(false),
+	m_bDistortionMeshValid(false),
+	m_distortionVertices(),
+	m_pDistortionVertexBuffer(NULL),
+	m_pDistortionIndexBuffer(NULL)
 {
 	OutputDebugString("Created OculusRiftView\n");
 }
 
-void OculusRiftView::ReleaseEverything()
+/**
+* Destructor, releases the logo texture (managed, kept over device resets).
+***/
+OculusRiftView::~OculusRiftView()
 {
-	//Release the texture we loaded
 	if (m_logoTexture)
-	{
 		m_logoTexture->Release();
-		m_logoTexture = NULL;
+}
+
+void OculusRiftView::ReleaseEverything()
+{
+	if (m_pDistortionVertexBuffer)
+	{
+		m_pDistortionVertexBuffer->Release();
+		m_pDistortionVertexBuffer = NULL;
+	}
+
+	if (m_pDistortionIndexBuffer)
+	{
+		m_pDistortionIndexBuffer->Release();
+		m_pDistortionIndexBuffer = NULL;
 	}
+	m_bDistortionMeshValid = false;
 
 	//Call base class
 	StereoView::ReleaseEverything();
@@ -73,8 +93,8 @@ void OculusRiftView::SetViewEffectInitialValues()
 	viewEffect->SetFloatArray("Scale", Scale, 2);
 	viewEffect->SetFloatArray("ScaleIn", ScaleIn, 2);
 	viewEffect->SetFloat("ZoomScale", m_zoom);
-	viewEffect->SetFloat("ViewportXOffset", -ViewportXOffset);
-	viewEffect->SetFloat("ViewportYOffset", -ViewportYOffset);
+	viewEffect->SetFloat("ViewportXOffset", -ViewportXOffset + m_reprojection.offsetX);
+	viewEffect->SetFloat("ViewportYOffset", -ViewportYOffset + m_reprojection.offsetY);
 	if (chromaticAberrationCorrection)
 		viewEffect->SetFloatArray("Chroma", hmdInfo->GetDistortionCoefficientsChroma(), 4);
 	else
@@ -86,8 +106,8 @@ void OculusRiftView::SetViewEffectInitialValues()
 	viewEffect->SetFloatArray("Resolution", Resolution, 2);
 	viewEffect->SetFloatArray("HmdWarpParam", hmdInfo->GetDistortionCoefficients(), 4);
 
-	//Set rotation, this will only be non-zero if we have pixel shader roll enabled
-	viewEffect->SetFloat("Rotation", m_rotation);
+	//Set rotation, this will only be non-zero if we have pixel shader roll enabled (or reprojected roll)
+	viewEffect->SetFloat("Rotation", m_rotation + m_reprojection.rotation);
 
 	//Set the black smear corection - 0.0f will do nothing
 	viewEffect->SetFloat("SmearCorrection", m_blackSmearCorrection);
@@ -184,8 +204,8 @@ void OculusRiftView::CalculateShaderVariables()
 	ViewportYOffset = HeadYOffset;
 	
 
-	D3DSURFACE_DESC eyeTextureDescriptor;
-	leftSurface->GetDesc(&eyeTextureDescriptor);
+	// eye textures and eye back buffers have the back buffer size
+	D3DSURFACE_DESC eyeTextureDescriptor = backBufferDesc;
 
 	float inputTextureAspectRatio = (float)eyeTextureDescriptor.Width / (float)eyeTextureDescriptor.Height;
 
@@ -256,7 +276,145 @@ void OculusRiftView::InitShaderEffects()
 	ProxyHelper helper = ProxyHelper();
 	std::string viewPath = helper.GetPath("fx\\") + shaderEffect[config->stereo_mode];
 
-	D3DXCreateEffectFromFile(m_pActualDevice, viewPath.c_str(), NULL, NULL, 0, NULL, &viewEffect, NULL);
+	// kept over device resets (lost and restored), loaded again (from the effect cache) if the file changed
+	if (!viewEffect || (viewEffectPath != viewPath))
+	{
+		if (viewEffect)
+			viewEffect->Release();
+		viewEffect = NULL;
+		viewEffectPath = viewPath;
+
+		EffectCache::CreateEffectFromFile(m_pActualDevice, viewPath, NULL, 0, 0, &viewEffect);
+	}
+
+	// older effect files only have the per pixel technique
+	m_bDistortionMesh = (viewEffect != NULL) && (viewEffect->GetTechniqueByName("ViewShaderMesh") != NULL);
+}
+
+/**
+* Creates the distortion mesh buffers (in addition to the fullscreen quad).
+* Falls back to the per pixel distortion if the buffers can't be created.
+***/
+void OculusRiftView::InitVertexBuffers()
+{
+	StereoView::InitVertexBuffers();
+
+	m_bDistortionMeshValid = false;
+	if (!m_bDistortionMesh)
+		return;
+
+	if (FAILED(m_pActualDevice->CreateVertexBuffer(sizeof(DISTORTIONVERTEX) * DistortionMesh::VertexCount(), D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY,
+		D3DFVF_DISTORTIONVERTEX, D3DPOOL_DEFAULT, &m_pDistortionVertexBuffer, NULL)) ||
+		FAILED(m_pActualDevice->CreateIndexBuffer(sizeof(WORD) * DistortionMesh::IndexCount(), D3DUSAGE_WRITEONLY,
+		D3DFMT_INDEX16, D3DPOOL_DEFAULT, &m_pDistortionIndexBuffer, NULL))) {
+			OutputDebugString("Distortion mesh creation failed, using per pixel distortion\n");
+			m_bDistortionMesh = false;
+			return;
+	}
+
+	// indices only depend on the grid size
+	std::vector<WORD> indices;
+	DistortionMesh::BuildIndices(indices);
+
+	WORD* pIndices;
+	if (SUCCEEDED(m_pDistortionIndexBuffer->Lock(0, 0, (void**)&pIndices, 0))) {
+		memcpy(pIndices, &indices[0], sizeof(WORD) * indices.size());
+		m_pDistortionIndexBuffer->Unlock();
+	}
+	else {
+		OutputDebugString("Distortion mesh index buffer lock failed, using per pixel distortion\n");
+		m_bDistortionMesh = false;
+	}
+}
+
+/**
+* Sets the distortion mesh (rebuilt if needed) and mesh technique, or the fullscreen quad if no mesh.
+***/
+void OculusRiftView::SetViewGeometry()
+{
+	if (!m_bDistortionMesh || !m_pDistortionVertexBuffer) {
+		StereoView::SetViewGeometry();
+		return;
+	}
+
+	UpdateDistortionMesh();
+
+	m_pActualDevice->SetFVF(D3DFVF_DISTORTIONVERTEX);
+
+	if (FAILED(m_pActualDevice->SetStreamSource(0, m_pDistortionVertexBuffer, 0, sizeof(DISTORTIONVERTEX)))) {
+		OutputDebugString("SetStreamSource failed\n");
+	}
+
+	if (FAILED(viewEffect->SetTechnique("ViewShaderMesh"))) {
+		OutputDebugString("SetTechnique failed\n");
+	}
+}
+
+/**
+* Draws the distortion mesh, or the fullscreen quad if no mesh.
+* Index buffer is not part of the saved render states, so the game index buffer is restored here.
+***/
+void OculusRiftView::DrawViewGeometry()
+{
+	if (!m_bDistortionMesh || !m_pDistortionVertexBuffer) {
+		StereoView::DrawViewGeometry();
+		return;
+	}
+
+	IDirect3DIndexBuffer9* pPrevIndices = NULL;
+	m_pActualDevice->GetIndices(&pPrevIndices);
+	m_pActualDevice->SetIndices(m_pDistortionIndexBuffer);
+
+	if (FAILED(m_pActualDevice->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, DistortionMesh::VertexCount(), 0, DistortionMesh::PrimitiveCount()))) {
+		OutputDebugString("Draw failed\n");
+	}
+
+	m_pActualDevice->SetIndices(pPrevIndices);
+	if (pPrevIndices)
+		pPrevIndices->Release();
+}
+
+/**
+* Rebuilds the distortion mesh if any of the distortion parameters changed (display info, lens center,
+* scale, target size). Rotation, viewport offsets and zoom change per frame (roll, reprojection, telescope),
+* they are left out of the mesh and applied by the mesh technique from the effect values.
+***/
+void OculusRiftView::UpdateDistortionMesh()
+{
+	DistortionParameters params;
+	ZeroMemory(&params, sizeof(params));
+
+	memcpy(params.LensCenter, LensCenter, sizeof(params.LensCenter));
+	memcpy(params.Scale, Scale, sizeof(params.Scale));
+	memcpy(params.ScaleIn, ScaleIn, sizeof(params.ScaleIn));
+	memcpy(params.HmdWarpParam, hmdInfo->GetDistortionCoefficients(), sizeof(params.HmdWarpParam));
+	if (chromaticAberrationCorrection)
+		memcpy(params.Chroma, hmdInfo->GetDistortionCoefficientsChroma(), sizeof(params.Chroma));
+	memcpy(params.Resolution, Resolution, sizeof(params.Resolution));
+	// applied by the mesh technique (MeshPoint() in OculusRift.fx)
+	params.Rotation = 0.0f;
+	params.ViewportXOffset = 0.0f;
+	params.ViewportYOffset = 0.0f;
+	params.ZoomScale = 1.0f;
+	params.TargetWidth = (float)viewport.Width;
+	params.TargetHeight = (float)viewport.Height;
+
+	if (m_bDistortionMeshValid && (memcmp(&params, &m_distortionParameters, sizeof(params)) == 0))
+		return;
+
+	DistortionMesh::BuildVertices(params, m_distortionVertices);
+
+	DISTORTIONVERTEX* pVertices;
+	if (SUCCEEDED(m_pDistortionVertexBuffer->Lock(0, 0, (void**)&pVertices, D3DLOCK_DISCARD))) {
+		memcpy(pVertices, &m_distortionVertices[0], sizeof(DISTORTIONVERTEX) * m_distortionVertices.size());
+		m_pDistortionVertexBuffer->Unlock();
+
+		m_distortionParameters = params;
+		m_bDistortionMeshValid = true;
+	}
+	else {
+		OutputDebugString("Distortion mesh vertex buffer lock failed\n");
+	}
 }
 
 
@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "StereoView.h"
 #include "HMDisplayInfo.h"
+#include "DistortionMesh.h"
 
 /**
 * Oculus rift render class.
@@ -41,6 +42,7 @@ class OculusRiftView : public StereoView
 {
 public:
 	OculusRiftView(ProxyConfig *config, HMDisplayInfo *hmd);
+	virtual ~OculusRiftView();
 	
 	/*** OculusRiftView public methods ***/
 	virtual void SetViewEffectInitialValues();
@@ -50,7 +52,14 @@ public:
 	virtual void ReleaseEverything();
 	virtual void SetVRMouseSquish(float squish);
 
+protected:
+	virtual void InitVertexBuffers();
+	virtual void SetViewGeometry();
+	virtual void DrawViewGeometry();
+
 private:
+	void UpdateDistortionMesh();
+
 	/**
 	* Lens center position, Oculus Rift vertex shader constant.
 	***/
@@ -96,6 +105,32 @@ private:
 
 	IDirect3DTexture9 *m_logoTexture;
 	IDirect3DBaseTexture9 *m_prevTexture;
+
+	/**
+	* True if the effect has a distortion mesh technique and the mesh buffers were created.
+	* Otherwise the distortion is computed per pixel on a fullscreen quad.
+	***/
+	bool m_bDistortionMesh;
+	/**
+	* True if the vertex buffer holds the mesh for m_distortionParameters.
+	***/
+	bool m_bDistortionMeshValid;
+	/**
+	* Parameters the distortion mesh was last built with.
+	***/
+	DistortionParameters m_distortionParameters;
+	/**
+	* Distortion mesh vertices (CPU side), kept to avoid reallocation on rebuild.
+	***/
+	std::vector<DISTORTIONVERTEX> m_distortionVertices;
+	/**
+	* Distortion mesh vertex buffer (dynamic).
+	***/
+	IDirect3DVertexBuffer9* m_pDistortionVertexBuffer;
+	/**
+	* Distortion mesh index buffer.
+	***/
+	IDirect3DIndexBuffer9* m_pDistortionIndexBuffer;
 };
 
 #endif
\ No newline at end of file
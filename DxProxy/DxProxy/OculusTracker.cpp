@@ -300,6 +300,31 @@ int OculusTracker::getOrientationAndPosition(float* yaw, float* pitch, float* ro
 	return (int)status; 
 }
 
+/**
+* Samples the current head orientation without updating the tracker state (no mouse input, primary
+* orientation untouched), used to late latch the orientation at composition time.
+* Orientation in radians, same convention as the primary orientation.
+* @return False if the orientation is not tracked.
+***/
+bool OculusTracker::sampleOrientation(float* yaw, float* pitch, float* roll)
+{
+	SHOW_CALL("OculusTracker sampleOrientation\n");
+
+	if (status < MTS_OK)
+		return false;
+
+	ovrTrackingState ts = ovrHmd_GetTrackingState(hmd, useSDKPosePrediction ? FrameRef.ScanoutMidpointSeconds : ovr_GetTimeInSeconds());
+
+	if (!(ts.StatusFlags & ovrStatus_OrientationTracked))
+		return false;
+
+	Quatf hmdOrient=ts.HeadPose.ThePose.Orientation;
+	hmdOrient.GetEulerAngles<Axis_Y,Axis_X,Axis_Z>(yaw, pitch, roll);
+	*yaw = *yaw - offsetYaw;
+
+	return true;
+}
+
 /**
 * Update Oculus tracker orientation.
 * Updates tracker orientation and passes it to game mouse input accordingly.
@@ -311,34 +336,56 @@ void OculusTracker::updateOrientationAndPosition()
 	// Get orientation from Oculus tracker.
 	if (getOrientationAndPosition(&yaw, &pitch, &roll, &x, &y, &z) >= MTS_OK)
 	{
+		// Record the raw pose (degrees)
+		if (recorder)
+		{
+			LARGE_INTEGER now;
+			QueryPerformanceCounter(&now);
+			TrackerPose pose;
+			pose.time = now.QuadPart;
+			pose.yaw = yaw;
+			pose.pitch = pitch;
+			pose.roll = roll;
+			pose.x = x;
+			pose.y = y;
+			pose.z = z;
+			recorder->Record(pose, (float)(PI / 180.0), status);
+		}
+
 		// Convert yaw, pitch to positive degrees
 		// (-180.0f...0.0f -> 180.0f....360.0f)
 		// (0.0f...180.0f -> 0.0f...180.0f)
 		yaw = fmodf(yaw + 360.0f, 360.0f);
 		pitch = -fmodf(pitch + 360.0f, 360.0f);
 
-		// Get difference.
-		deltaYaw += yaw - currentYaw;
-		deltaPitch += pitch - currentPitch;
+		// Mouse emulation engine sends the motion on its own timer (wraps over 360/0 itself).
+		if (mouseEmulator)
+			mouseEmulator->SubmitPose(yaw, pitch);
+		else
+		{
+			// Get difference.
+			deltaYaw += yaw - currentYaw;
+			deltaPitch += pitch - currentPitch;
 
-		// hack to avoid errors while translating over 360/0
-		if(fabs(deltaYaw) > 4.0f) deltaYaw = 0.0f;
-		if(fabs(deltaPitch) > 4.0f) deltaPitch = 0.0f;
+			// hack to avoid errors while translating over 360/0
+			if(fabs(deltaYaw) > 4.0f) deltaYaw = 0.0f;
+			if(fabs(deltaPitch) > 4.0f) deltaPitch = 0.0f;
 
-		// Pass to mouse data (long integer).
-		mouseData.mi.dx = (long)(deltaYaw*multiplierYaw);
-		mouseData.mi.dy = (long)(deltaPitch*multiplierPitch);
+			// Pass to mouse data (long integer).
+			mouseData.mi.dx = (long)(deltaYaw*multiplierYaw);
+			mouseData.mi.dy = (long)(deltaPitch*multiplierPitch);
 
-		// Keep fractional difference in the delta so it's added to the next update.
-		deltaYaw -= ((float)mouseData.mi.dx)/multiplierYaw;
-		deltaPitch -= ((float)mouseData.mi.dy)/multiplierPitch;
+			// Keep fractional difference in the delta so it's added to the next update.
+			deltaYaw -= ((float)mouseData.mi.dx)/multiplierYaw;
+			deltaPitch -= ((float)mouseData.mi.dy)/multiplierPitch;
 
 #ifdef SHOW_CALLS
-		OutputDebugString("Motion Tracker SendInput\n");
+			OutputDebugString("Motion Tracker SendInput\n");
 #endif
-		// Send to mouse input.
-		if (mouseEmulation)
-			SendInput(1, &mouseData, sizeof(INPUT));
+			// Send to mouse input.
+			if (mouseEmulation)
+				SendInput(1, &mouseData, sizeof(INPUT));
+		}
 
 		// Set current data.
 		currentYaw = yaw;
@@ -60,6 +60,7 @@ public:
 	void resetOrientationAndPosition();
 	void resetPosition();
 	int  getOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z);
+	bool sampleOrientation(float* yaw, float* pitch, float* roll);
 	void updateOrientationAndPosition();
 	MotionTrackerStatus getStatus();	
 	virtual char* GetTrackerDescription();
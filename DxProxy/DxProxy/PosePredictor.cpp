@@ -0,0 +1,221 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <PosePredictor.cpp> and
+Class <PosePredictor> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "PosePredictor.h"
+#include "MotionTracker.h"
+
+/**
+* Constructor, prediction disabled.
+***/
+PosePredictor::PosePredictor() :
+	m_predictionSeconds(0.0),
+	m_velocitySmoothing(0.5f),
+	m_accelerationSmoothing(0.8f),
+	m_fullTurn((float)(2.0 * PI)),
+	m_sampleCount(0),
+	m_interval(0.0)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_toSeconds = 1.0 / (double)frequency.QuadPart;
+
+	ZeroMemory(&m_last, sizeof(TrackerPose));
+	ZeroMemory(m_velocity, sizeof(m_velocity));
+	ZeroMemory(m_acceleration, sizeof(m_acceleration));
+}
+
+/**
+* Empty destructor.
+***/
+PosePredictor::~PosePredictor()
+{
+}
+
+/**
+* Sets prediction time and filters.
+* @param predictionMs Time from reading the pose to displaying it, 0 disables prediction.
+* @param velocitySmoothing Weight of the previous velocity estimate [0..1), higher is smoother but lags.
+* @param accelerationSmoothing Weight of the previous acceleration estimate [0..1), 1 disables acceleration.
+***/
+void PosePredictor::SetFilters(float predictionMs, float velocitySmoothing, float accelerationSmoothing)
+{
+	m_predictionSeconds = (double)predictionMs / 1000.0;
+	m_velocitySmoothing = (velocitySmoothing < 0.0f) ? 0.0f : ((velocitySmoothing > 0.99f) ? 0.99f : velocitySmoothing);
+	m_accelerationSmoothing = (accelerationSmoothing < 0.0f) ? 0.0f : ((accelerationSmoothing > 1.0f) ? 1.0f : accelerationSmoothing);
+	Reset();
+}
+
+/**
+* Adds a sample, updates the velocity and acceleration estimates.
+***/
+void PosePredictor::AddSample(const TrackerPose& pose)
+{
+	float channels[CHANNELS];
+	float lastChannels[CHANNELS];
+	GetChannels(pose, channels);
+	GetChannels(m_last, lastChannels);
+
+	if (m_sampleCount > 0)
+	{
+		double seconds = (double)(pose.time - m_last.time) * m_toSeconds;
+
+		// no new data, the head is still after some missed intervals : the estimate restarts from 
+		// this sample (still at this time)
+		if (memcmp(channels, lastChannels, sizeof(channels)) == 0)
+		{
+			if ((m_interval > 0.0) && (seconds > m_interval * POSEPREDICTOR_STILL_INTERVALS))
+			{
+				ZeroMemory(m_velocity, sizeof(m_velocity));
+				ZeroMemory(m_acceleration, sizeof(m_acceleration));
+				m_last.time = pose.time;
+				m_sampleCount = 1;
+			}
+			return;
+		}
+
+		if (seconds <= 0.0)
+			return;
+
+		if (seconds > POSEPREDICTOR_GAP_SECONDS)
+		{
+			m_sampleCount = 0;
+			m_interval = 0.0;
+		}
+		else
+		{
+			m_interval = (m_interval > 0.0) ? (m_interval * 0.9 + seconds * 0.1) : seconds;
+
+			for (int i = 0; i < CHANNELS; i++)
+			{
+				float delta = channels[i] - lastChannels[i];
+				if (i < ANGLES)
+					delta = WrapAngle(delta);
+
+				float velocity = (float)(delta / seconds);
+				if (m_sampleCount > 1)
+				{
+					float acceleration = (float)((velocity - m_velocity[i]) / seconds);
+					m_acceleration[i] = m_acceleration[i] * m_accelerationSmoothing + acceleration * (1.0f - m_accelerationSmoothing);
+					m_velocity[i] = m_velocity[i] * m_velocitySmoothing + velocity * (1.0f - m_velocitySmoothing);
+				}
+				else
+				{
+					m_velocity[i] = velocity;
+					m_acceleration[i] = 0.0f;
+				}
+			}
+		}
+	}
+
+	if (m_sampleCount == 0)
+	{
+		ZeroMemory(m_velocity, sizeof(m_velocity));
+		ZeroMemory(m_acceleration, sizeof(m_acceleration));
+	}
+
+	m_last = pose;
+	m_sampleCount++;
+}
+
+/**
+* Extrapolates the latest sample to a time.
+* @param time Performance counter time, extrapolation is limited to POSEPREDICTOR_MAX_SECONDS.
+* @param pPose [out] The predicted pose.
+* @return False if there is no sample.
+***/
+bool PosePredictor::Predict(LONGLONG time, TrackerPose* pPose)
+{
+	if (m_sampleCount == 0)
+		return false;
+
+	double seconds = (double)(time - m_last.time) * m_toSeconds;
+	if (seconds < 0.0) seconds = 0.0;
+	if (seconds > POSEPREDICTOR_MAX_SECONDS) seconds = POSEPREDICTOR_MAX_SECONDS;
+
+	float channels[CHANNELS];
+	GetChannels(m_last, channels);
+	for (int i = 0; i < CHANNELS; i++)
+	{
+		channels[i] += (float)(m_velocity[i] * seconds + 0.5 * m_acceleration[i] * seconds * seconds);
+		if (i < ANGLES)
+			channels[i] = WrapAngle(channels[i]);
+	}
+
+	SetChannels(channels, pPose);
+	pPose->time = time;
+	return true;
+}
+
+/**
+* Extrapolates the latest sample to the expected display time (now plus the prediction time).
+***/
+bool PosePredictor::PredictAhead(TrackerPose* pPose)
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return Predict(now.QuadPart + (LONGLONG)(m_predictionSeconds / m_toSeconds), pPose);
+}
+
+/**
+* Wraps an angle into half a turn around zero.
+***/
+float PosePredictor::WrapAngle(float angle)
+{
+	float half = m_fullTurn * 0.5f;
+	while (angle > half) angle -= m_fullTurn;
+	while (angle < -half) angle += m_fullTurn;
+	return angle;
+}
+
+/**
+* Pose channels : yaw, pitch, roll, x, y, z.
+***/
+void PosePredictor::GetChannels(const TrackerPose& pose, float* pChannels)
+{
+	pChannels[0] = pose.yaw;
+	pChannels[1] = pose.pitch;
+	pChannels[2] = pose.roll;
+	pChannels[3] = pose.x;
+	pChannels[4] = pose.y;
+	pChannels[5] = pose.z;
+}
+
+/**
+* Sets the pose channels : yaw, pitch, roll, x, y, z.
+***/
+void PosePredictor::SetChannels(const float* pChannels, TrackerPose* pPose)
+{
+	pPose->yaw = pChannels[0];
+	pPose->pitch = pChannels[1];
+	pPose->roll = pChannels[2];
+	pPose->x = pChannels[3];
+	pPose->y = pChannels[4];
+	pPose->z = pChannels[5];
+}
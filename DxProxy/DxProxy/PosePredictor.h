@@ -0,0 +1,114 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <PosePredictor.h> and
+Class <PosePredictor> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef POSEPREDICTOR_H_INCLUDED
+#define POSEPREDICTOR_H_INCLUDED
+
+#include "TrackerSampler.h"
+
+/**
+* Maximum extrapolation, beyond that the velocity estimate isn't worth anything.
+***/
+#define POSEPREDICTOR_MAX_SECONDS 0.1
+/**
+* Samples older than this reset the estimate (tracker stalled or resumed).
+***/
+#define POSEPREDICTOR_GAP_SECONDS 0.25
+/**
+* Sample intervals without new data after which the head is taken as still (velocity zeroed).
+***/
+#define POSEPREDICTOR_STILL_INTERVALS 2.0
+
+/**
+* Pose prediction.
+* Estimates velocity and acceleration of each pose channel from the timestamped samples (both
+* exponentially filtered) and extrapolates the latest sample to the expected display time.
+* Angles are wrapped with the full turn of the tracker units (2*PI for radians, 360 for degrees).
+* Repeated samples (same values, tracker had no new data) are not used for the estimate, but if
+* there is no new data for POSEPREDICTOR_STILL_INTERVALS sample intervals the velocity and 
+* acceleration are zeroed, so a stopped head isn't extrapolated along its last movement.
+*/
+class PosePredictor
+{
+public:
+	PosePredictor();
+	virtual ~PosePredictor();
+
+	/*** PosePredictor public methods ***/
+	void SetFilters(float predictionMs, float velocitySmoothing, float accelerationSmoothing);
+	void SetFullTurn(float fullTurn) { m_fullTurn = fullTurn; }
+	bool IsEnabled() { return m_predictionSeconds > 0.0; }
+	void Reset() { m_sampleCount = 0; m_interval = 0.0; }
+	void AddSample(const TrackerPose& pose);
+	bool Predict(LONGLONG time, TrackerPose* pPose);
+	bool PredictAhead(TrackerPose* pPose);
+
+private:
+	enum { CHANNELS = 6, ANGLES = 3 };
+
+	/*** PosePredictor private methods ***/
+	float WrapAngle(float angle);
+	static void GetChannels(const TrackerPose& pose, float* pChannels);
+	static void SetChannels(const float* pChannels, TrackerPose* pPose);
+
+	/**
+	* Prediction time (from the read to the display), seconds.
+	***/
+	double m_predictionSeconds;
+	/**
+	* Weight of the previous velocity / acceleration estimate [0..1).
+	***/
+	float m_velocitySmoothing;
+	float m_accelerationSmoothing;
+	/**
+	* Full turn of the angles (tracker units).
+	***/
+	float m_fullTurn;
+	/**
+	* Seconds per performance counter tick.
+	***/
+	double m_toSeconds;
+	/**
+	* Latest sample and number of samples since reset.
+	***/
+	TrackerPose m_last;
+	UINT m_sampleCount;
+	/**
+	* Filtered interval between samples with new data, seconds (0 = unknown).
+	***/
+	double m_interval;
+	/**
+	* Filtered velocity and acceleration per channel (yaw, pitch, roll, x, y, z), per second.
+	***/
+	float m_velocity[CHANNELS];
+	float m_acceleration[CHANNELS];
+};
+
+#endif
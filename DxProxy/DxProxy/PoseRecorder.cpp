@@ -0,0 +1,131 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <PoseRecorder.cpp> and
+Class <PoseRecorder> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#include "PoseRecorder.h"
+
+/**
+* Constructor.
+***/
+PoseRecorder::PoseRecorder() :
+	m_pFile(NULL),
+	m_startTime(0),
+	m_frequency(1),
+	m_lastTime(0)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_frequency = frequency.QuadPart;
+}
+
+/**
+* Destructor, closes the recording.
+***/
+PoseRecorder::~PoseRecorder()
+{
+	Close();
+}
+
+/**
+* Starts a new recording (overwrites the file).
+* @param path The recording file.
+* @return False if the file could not be created.
+***/
+bool PoseRecorder::Open(const char* path)
+{
+	Close();
+
+	if ((fopen_s(&m_pFile, path, "wb") != 0) || !m_pFile)
+	{
+		OutputDebugString("Pose Recorder : Could not create recording file\n");
+		m_pFile = NULL;
+		return false;
+	}
+	setvbuf(m_pFile, NULL, _IOFBF, POSERECORDER_BUFFER_SIZE);
+
+	if (!PoseRecordingWriteHeader(m_pFile))
+	{
+		Close();
+		return false;
+	}
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	m_startTime = now.QuadPart;
+	m_lastTime = 0;
+	return true;
+}
+
+/**
+* Flushes and closes the recording.
+***/
+void PoseRecorder::Close()
+{
+	if (m_pFile)
+	{
+		fclose(m_pFile);
+		m_pFile = NULL;
+	}
+}
+
+/**
+* Records a pose.
+* @param pose The raw tracker pose, time is the performance counter at the sample (times before
+* Open() are recorded as 0).
+* @param toRadians Scale of the tracker orientation units to radians.
+* @param status The tracker status (MotionTrackerStatus).
+***/
+void PoseRecorder::Record(const TrackerPose& pose, float toRadians, int status)
+{
+	if (!m_pFile || (pose.time == m_lastTime))
+		return;
+	m_lastTime = pose.time;
+
+	// poses sampled before Open() (polled right after) start the recording
+	LONGLONG elapsed = pose.time - m_startTime;
+	if (elapsed < 0)
+		elapsed = 0;
+
+	PoseRecord record;
+	record.timeUs = (elapsed * 1000000) / m_frequency;
+	record.yaw = pose.yaw * toRadians;
+	record.pitch = pose.pitch * toRadians;
+	record.roll = pose.roll * toRadians;
+	record.x = pose.x;
+	record.y = pose.y;
+	record.z = pose.z;
+	record.status = status;
+
+	if (fwrite(&record, sizeof(record), 1, m_pFile) != 1)
+	{
+		OutputDebugString("Pose Recorder : Write failed, recording stopped\n");
+		Close();
+	}
+}
@@ -0,0 +1,87 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <PoseRecorder.h> and
+Class <PoseRecorder> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#ifndef POSERECORDER_H_INCLUDED
+#define POSERECORDER_H_INCLUDED
+
+#include <windows.h>
+#include <stdio.h>
+#include "TrackerSampler.h"
+#include "PoseRecording.h"
+
+/**
+* Write buffer of the recording file (about 450 poses).
+***/
+#define POSERECORDER_BUFFER_SIZE 16384
+
+/**
+* Pose recorder.
+* Logs the raw tracker poses (before prediction) with their sample time to a compact binary file
+* (PoseRecording.h), to be replayed by the ReplayTracker or analysed offline. Records are written
+* buffered, so recording doesn't add file I/O to every frame.
+*
+* Not thread safe. Record() runs in MotionTracker::updateOrientationAndPosition(), on the tracking 
+* worker if D3DProxyDevice runs one (render thread otherwise), always with D3DProxyDevice::m_trackerLock 
+* held. Open() is called under the same lock, Close() (destructor) once the worker is stopped.
+*
+* Decimation : one pose per tracker poll, so one per worker tick (TRACKING_WORKER_INTERVAL_MS) or one
+* per frame without worker. Poses the sampling thread reads in between are not recorded, a pose polled
+* twice is recorded once.
+***/
+class PoseRecorder
+{
+public:
+	PoseRecorder();
+	virtual ~PoseRecorder();
+
+	/*** PoseRecorder public methods ***/
+	bool Open(const char* path);
+	void Close();
+	bool IsOpen() {return m_pFile != NULL;}
+	void Record(const TrackerPose& pose, float toRadians, int status);
+
+private:
+	/**
+	* Recording file, NULL if not recording.
+	***/
+	FILE* m_pFile;
+	/**
+	* Performance counter at Open() and its frequency, record times are relative to Open().
+	***/
+	LONGLONG m_startTime;
+	LONGLONG m_frequency;
+	/**
+	* Sample time of the last record, poses read more than once are recorded once.
+	***/
+	LONGLONG m_lastTime;
+};
+
+#endif
@@ -0,0 +1,74 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <RegisterSnapshot.h> and
+Struct <RegisterSnapshot> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef REGISTERSNAPSHOT_H_INCLUDED
+#define REGISTERSNAPSHOT_H_INCLUDED
+
+#define VECTOR_LENGTH 4
+#define RegisterIndex(x) (x * VECTOR_LENGTH)
+#define REGISTER_PAGE_SIZE 16
+#define RegisterPageIndex(x) (x / REGISTER_PAGE_SIZE)
+
+#include <d3d9.h>
+#include <vector>
+#include <memory>
+
+/**
+* One page (REGISTER_PAGE_SIZE registers) of a shader constant register file.
+***/
+struct RegisterPage
+{
+	float registers[REGISTER_PAGE_SIZE * VECTOR_LENGTH];
+};
+
+/**
+* Page granular copy of a shader constant register file, as stored by state blocks.
+* Pages are reference counted and shared with the ShaderRegisters they were captured from; a page 
+* that is referenced from more than one place is never written, writers copy it first.
+***/
+struct RegisterSnapshot
+{
+	RegisterSnapshot() : partial(false) {}
+	void Clear() { pages.clear(); }
+	void ClearAll() { pages.clear(); selected.clear(); partial = false; }
+
+	/**
+	* Captured pages, NULL if the page was never captured.
+	***/
+	std::vector<std::shared_ptr<RegisterPage>> pages;
+	/**
+	* Register masks per page (bit n = register n of that page). Only used if partial is true.
+	***/
+	std::vector<WORD> selected;
+	/**
+	* True if only the registers in selected are part of the snapshot (Cap_Type_Selected).
+	***/
+	bool partial;
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ReplayTracker.cpp> and
+Class <ReplayTracker> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#include "ReplayTracker.h"
+
+/**
+* Constructor, loads the recording.
+* @param path The recording file.
+* @param speed Playback speed, 1 = recorded timing, 0 = one pose per update.
+***/
+ReplayTracker::ReplayTracker(const char* path, float speed) :
+	speed((speed > 0.0f) ? speed : 0.0f),
+	current(0),
+	startTime(0),
+	frequency(1)
+{
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	frequency = freq.QuadPart;
+
+	status = load(path) ? MTS_OK : MTS_INITFAIL;
+}
+
+/**
+* Destructor.
+***/
+ReplayTracker::~ReplayTracker(void)
+{
+}
+
+/**
+* Reads the whole recording.
+* @return False if the file is missing, of another version or empty.
+***/
+bool ReplayTracker::load(const char* path)
+{
+	FILE* pFile = NULL;
+	if ((fopen_s(&pFile, path, "rb") != 0) || !pFile)
+	{
+		OutputDebugString("Replay Tracker : Could not open recording\n");
+		return false;
+	}
+
+	if (PoseRecordingReadHeader(pFile))
+	{
+		PoseRecord record;
+		while (fread(&record, sizeof(record), 1, pFile) == 1)
+			records.push_back(record);
+	}
+	else
+		OutputDebugString("Replay Tracker : Not a pose recording (or another version)\n");
+	fclose(pFile);
+
+	return !records.empty();
+}
+
+/**
+* Retrieve the replayed orientation and position.
+* Returns the pose in the recorded tracker convention (radians), the sample time mapped to the
+* local clock. The primary orientation is set as by the Oculus tracker (yaw and roll negated back).
+***/
+int ReplayTracker::getOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z)
+{
+	if (status != MTS_OK)
+		return -1;
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	if (speed <= 0.0f)
+	{
+		// frame-deterministic : next pose per update
+		if (startTime != 0)
+			current = (current + 1) % records.size();
+		startTime = now.QuadPart;
+		sampleTime = now.QuadPart;
+	}
+	else
+	{
+		if (startTime == 0)
+			startTime = now.QuadPart;
+
+		// recorded time to play now
+		LONGLONG playUs = records[0].timeUs + (LONGLONG)((double)(now.QuadPart - startTime) * 1000000.0 * speed / (double)frequency);
+		if (playUs > records.back().timeUs)
+		{
+			// loop
+			startTime = now.QuadPart;
+			current = 0;
+			playUs = records[0].timeUs;
+		}
+		else if (playUs < records[current].timeUs)
+			current = 0;
+		while ((current + 1 < records.size()) && (records[current + 1].timeUs <= playUs))
+			current++;
+
+		sampleTime = startTime + (LONGLONG)((double)(records[current].timeUs - records[0].timeUs) * (double)frequency / (1000000.0 * speed));
+	}
+
+	const PoseRecord& record = records[current];
+	if (record.status < MTS_OK)
+		return 1;						// tracker had no pose
+
+	*yaw = record.yaw;
+	*pitch = record.pitch;
+	*roll = record.roll;
+	*x = primaryX = record.x;
+	*y = primaryY = record.y;
+	*z = primaryZ = record.z;
+	primaryYaw = -record.yaw;
+	primaryPitch = record.pitch;
+	primaryRoll = -record.roll;
+
+	return 0;
+}
+
+/**
+* Returns the replay status.
+***/
+MotionTrackerStatus ReplayTracker::getStatus()
+{
+	return status;
+}
@@ -0,0 +1,86 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ReplayTracker.h> and
+Class <ReplayTracker> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#ifndef REPLAYTRACKER_H_INCLUDED
+#define REPLAYTRACKER_H_INCLUDED
+
+#include "MotionTracker.h"
+#include "PoseRecording.h"
+
+#include <vector>
+
+/**
+* Replay tracker class.
+* Plays back a pose recording (PoseRecorder) through the regular tracking pipeline, so prediction,
+* smoothing, roll and comfort mode settings can be tuned and benchmarked on the same head motion.
+* Plays at the recorded timing (scaled by the speed) and loops at the end, or steps one pose per
+* update (speed 0) for frame-deterministic runs.
+***/
+class ReplayTracker : public MotionTracker
+{
+public:
+	ReplayTracker(const char* path, float speed);
+	~ReplayTracker(void);
+
+	/*** ReplayTracker public methods ***/
+	int  getOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z);
+	MotionTrackerStatus getStatus();
+	virtual char* GetTrackerDescription() {return "ReplayTracker";}
+	virtual bool SupportsPositionTracking() {return true;}
+
+private:
+	/*** ReplayTracker private methods ***/
+	bool load(const char* path);
+
+	/**
+	* The recorded poses.
+	***/
+	std::vector<PoseRecord> records;
+	/**
+	* Playback speed, 1 = recorded timing, 0 = one pose per update.
+	***/
+	float speed;
+	/**
+	* Index of the current pose.
+	***/
+	size_t current;
+	/**
+	* Performance counter at the start of the current loop (0 : not started) and its frequency.
+	***/
+	LONGLONG startTime;
+	LONGLONG frequency;
+	/**
+	* MTS_OK if the recording was loaded, MTS_INITFAIL otherwise.
+	***/
+	MotionTrackerStatus status;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <Reprojection.cpp> and
+Class <Reprojection> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "Reprojection.h"
+#include <float.h>
+#include <math.h>
+
+#define REPROJECTION_PI 3.14159265358979f
+
+const float Reprojection::MaxDelta = 0.5f;
+
+/**
+* No reprojection.
+***/
+ReprojectionWarp Reprojection::Identity()
+{
+	ReprojectionWarp warp;
+	warp.offsetX = 0.0f;
+	warp.offsetY = 0.0f;
+	warp.rotation = 0.0f;
+	return warp;
+}
+
+/**
+* Computes the warp for the rotation between render time and present time orientation.
+* Orientations in radians, as the primary tracker orientation (yaw left, pitch up and roll 
+* left positive). For small deltas a rotation of the head maps to a shift of the image (yaw, 
+* pitch) and an image rotation around the lens center (roll).
+* @param fovHorizontal Horizontal field of view of the eye images, in degrees.
+* @param aspectRatio Width / height of the eye images.
+* @return Identity for an invalid field of view or aspect ratio, invalid orientations or deltas 
+* beyond MaxDelta.
+***/
+ReprojectionWarp Reprojection::Compute(float renderYaw, float renderPitch, float renderRoll,
+									   float presentYaw, float presentPitch, float presentRoll, float fovHorizontal, float aspectRatio)
+{
+	ReprojectionWarp warp = Identity();
+
+	// written to fail for NaN as well
+	if (!((fovHorizontal > 0.0f) && (fovHorizontal < 180.0f)) || !((aspectRatio > 0.0f) && (aspectRatio < FLT_MAX)))
+		return warp;
+
+	float deltaYaw = AngleDelta(renderYaw, presentYaw);
+	float deltaPitch = AngleDelta(renderPitch, presentPitch);
+	float deltaRoll = AngleDelta(renderRoll, presentRoll);
+
+	if (!(fabs(deltaYaw) <= MaxDelta) || !(fabs(deltaPitch) <= MaxDelta) || !(fabs(deltaRoll) <= MaxDelta))
+		return warp;
+
+	// half width of the image plane at distance 1
+	float tanHalfHorizontal = tanf(fovHorizontal * REPROJECTION_PI / 360.0f);
+	float tanHalfVertical = tanHalfHorizontal / aspectRatio;
+
+	// turning left moves the image right, looking up moves it down (texture v points down),
+	// the image plane spans 2 * tanHalf in texture units of 1
+	warp.offsetX = tanf(deltaYaw) / (2.0f * tanHalfHorizontal);
+	warp.offsetY = tanf(deltaPitch) / (2.0f * tanHalfVertical);
+
+	// view effect rotation turns against the head roll
+	warp.rotation = -deltaRoll;
+
+	return warp;
+}
+
+/**
+* Shortest signed angle from one angle to another, in radians.
+***/
+float Reprojection::AngleDelta(float from, float to)
+{
+	float delta = fmodf(to - from, 2.0f * REPROJECTION_PI);
+	if (delta > REPROJECTION_PI)
+		delta -= 2.0f * REPROJECTION_PI;
+	else if (delta < -REPROJECTION_PI)
+		delta += 2.0f * REPROJECTION_PI;
+	return delta;
+}
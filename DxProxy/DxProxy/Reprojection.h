@@ -0,0 +1,65 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <Reprojection.h> and
+Class <Reprojection> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef REPROJECTION_H_INCLUDED
+#define REPROJECTION_H_INCLUDED
+
+/**
+* Image space warp correcting the eye images for head rotation since they were rendered.
+* Offsets are in eye texture coordinates (added to the view effect viewport offsets), rotation 
+* in radians (added to the view effect rotation). Zero for no reprojection.
+***/
+struct ReprojectionWarp
+{
+	float offsetX;
+	float offsetY;
+	float rotation;
+};
+
+/**
+* Rotational reprojection math.
+* No device or tracker needed, results only depend on the orientations and the field of view.
+*/
+class Reprojection
+{
+public:
+	static ReprojectionWarp Identity();
+	static ReprojectionWarp Compute(float renderYaw, float renderPitch, float renderRoll,
+		float presentYaw, float presentPitch, float presentRoll, float fovHorizontal, float aspectRatio);
+	static float AngleDelta(float from, float to);
+
+	/**
+	* Deltas beyond this (in radians) are dropped, those are a tracker reset or jump rather than
+	* head movement.
+	***/
+	static const float MaxDelta;
+};
+
+#endif
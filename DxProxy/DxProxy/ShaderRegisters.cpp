@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ********************************************************************/
 
 #include "ShaderRegisters.h"
+#include "FrameProfiler.h"
 #include "vireio.h"
 #include <assert.h>
 
@@ -43,6 +44,8 @@ ShaderRegisters::ShaderRegisters(DWORD maxPSConstantRegistersF, DWORD maxVSConst
 	m_maxVSConstantRegistersF(maxVSConstantRegistersF),
 	m_psRegistersF(maxPSConstantRegistersF * VECTOR_LENGTH, 0), // VECTOR_LENGTH floats per register
 	m_vsRegistersF(maxVSConstantRegistersF * VECTOR_LENGTH, 0), // VECTOR_LENGTH floats per register
+	psSnapshotStore(maxPSConstantRegistersF),
+	vsSnapshotStore(maxVSConstantRegistersF),
 	m_pActualDevice(pActualDevice),
 	m_pActivePixelShader(NULL),
 	m_pActiveVertexShader(NULL)
@@ -88,6 +91,7 @@ HRESULT WINAPI ShaderRegisters::SetVertexShaderConstantF(UINT StartRegister, con
 
 	// Mark registers dirty
 	dirtyVSRegisters.MarkRangeDirty(StartRegister, Vector4fCount);
+	vsSnapshotStore.MarkRangeWritten(StartRegister, Vector4fCount);
 
 	return D3D_OK;
 }
@@ -128,6 +132,7 @@ HRESULT WINAPI ShaderRegisters::SetPixelShaderConstantF(UINT StartRegister, cons
 
 	// Mark registers dirty
 	dirtyPSRegisters.MarkRangeDirty(StartRegister, Vector4fCount);
+	psSnapshotStore.MarkRangeWritten(StartRegister, Vector4fCount);
 
 	return D3D_OK;
 }
@@ -219,98 +224,92 @@ void ShaderRegisters::SetFromStateBlockPixelShader(D3D9ProxyPixelShader* storedP
 * stateblock textures for further thoughts.
 * The only time you restore all registers is when the whole vertex shader state is saved, in which
 * case there will always be a vertex shader to go with the registers (it may be null).
-* @param storedPSRegisters Pointer to stored pixel shader register map.
-* @param storedVSRegisters Pointer to stored vertex shader register map.
+* Only pages that differ from the current register file are copied.
+* @param storedVSRegisters Pointer to stored vertex shader register snapshot (NULL if not captured).
+* @param storedPSRegisters Pointer to stored pixel shader register snapshot (NULL if not captured).
 ***/
-void ShaderRegisters::SetFromStateBlockData(std::map<UINT, D3DXVECTOR4> * storedVSRegisters, std::map<UINT, D3DXVECTOR4> * storedPSRegisters)
-{
-	// vertex shader registers
-	auto itNewRegsVS = storedVSRegisters->begin();
-	while (itNewRegsVS != storedVSRegisters->end()) {
-
-		if ((RegisterIndex(itNewRegsVS->first) + VECTOR_LENGTH) >= m_vsRegistersF.size())
-			throw std::out_of_range("Register from stateblock is out of range, implosion imminent");
-
-		//std::copy(static_cast<float*>(itNewRegsVS->second), static_cast<float*>(itNewRegsVS->second) + VECTOR_LENGTH,  &m_vsRegistersF[RegisterIndex(itNewRegsVS->first)]);
-		// copy produces warnings, this does not.
-		int regStartIndexInVector = RegisterIndex(itNewRegsVS->first);
-		m_vsRegistersF[regStartIndexInVector	] = itNewRegsVS->second.x;
-		m_vsRegistersF[regStartIndexInVector + 1] = itNewRegsVS->second.y;
-		m_vsRegistersF[regStartIndexInVector + 2] = itNewRegsVS->second.z;
-		m_vsRegistersF[regStartIndexInVector + 3] = itNewRegsVS->second.w;
-
-		// register is clean (now matches device state - unless it's stereo in which case it might not, that is handled at the end)
-		dirtyVSRegisters.MarkClean(itNewRegsVS->first);
-		++itNewRegsVS;
-	}
+void ShaderRegisters::SetFromStateBlockData(const RegisterSnapshot* storedVSRegisters, const RegisterSnapshot* storedPSRegisters)
+{
+	if (storedVSRegisters)
+	{
+		if (storedVSRegisters->partial) {
+			// selected registers are clean (now match device state - unless it's stereo in which case it might not, that is handled next)
+			vsSnapshotStore.RestoreSelected(*storedVSRegisters, m_vsRegistersF, dirtyVSRegisters);
+		}
+		else {
+			vsSnapshotStore.Restore(*storedVSRegisters, m_vsRegistersF);
 
-	MarkAllVSStereoConstantsDirty();
+			// Data should match registers that are already on device (unless it's stereo in which case it might not, that is handled next)
+			dirtyVSRegisters.MarkAllClean();
+		}
 
-	// pixel shader registers
-	auto itNewRegsPS = storedPSRegisters->begin();
-	while (itNewRegsPS != storedPSRegisters->end()) {
+		MarkAllVSStereoConstantsDirty();
+	}
 
-		if ((RegisterIndex(itNewRegsPS->first) + VECTOR_LENGTH) >= m_psRegistersF.size())
-			throw std::out_of_range("Register from stateblock is out of range, implosion imminent");
+	if (storedPSRegisters)
+	{
+		if (storedPSRegisters->partial) {
+			psSnapshotStore.RestoreSelected(*storedPSRegisters, m_psRegistersF, dirtyPSRegisters);
+		}
+		else {
+			psSnapshotStore.Restore(*storedPSRegisters, m_psRegistersF);
 
-		// copy produces warnings, this does not.
-		int regStartIndexInVector = RegisterIndex(itNewRegsPS->first);
-		m_psRegistersF[regStartIndexInVector	] = itNewRegsPS->second.x;
-		m_psRegistersF[regStartIndexInVector + 1] = itNewRegsPS->second.y;
-		m_psRegistersF[regStartIndexInVector + 2] = itNewRegsPS->second.z;
-		m_psRegistersF[regStartIndexInVector + 3] = itNewRegsPS->second.w;
+			// Data should match registers that are already on device (unless it's stereo in which case it might not, that is handled next)
+			dirtyPSRegisters.MarkAllClean();
+		}
 
-		// register is clean (now matches device state - unless it's stereo in which case it might not, that is handled at the end)
-		dirtyPSRegisters.MarkClean(itNewRegsPS->first);
-		++itNewRegsPS;
+		MarkAllPSStereoConstantsDirty();
 	}
-
-	MarkAllPSStereoConstantsDirty();
 }
 
 /**
-* For restoring states from D3DProxyStateBlock.
-* If sides during capture were mixed or the current device side doesn't match side at time of
-* capture then updateStereoConstants should be true.
-* (basically if it's possible that the actual device values for the register don't match the
-* appropriate stereo versin then updateStereoConstants should be set to true)
-* NOTE: Above is irrelevant; Due to questionable lack of copying of vertex shader into stateblock we
-* have no idea what the state of the constants might be so updating isn't optional. Fix? See
-* stateblock textures for further thoughts.
-* The only time you restore all registers is when the whole vertex shader state is saved, in which
-* case there will always be a vertex shader to go with the registers (it may be null).
-* @param storedPSRegisters Pointer to stored pixel shader register vector.
-* @param storedVSRegisters Pointer to stored vertex shader register vector.
-* @param storedPShader Pointer to stored pixel shader.
-* @param storedVShader Pointer to stored vertex shader.
+* Captures the vertex shader registers to a state block snapshot.
+* Unchanged pages are shared with previous snapshots, only pages written since then are copied.
+* @param pSnapshot The snapshot to capture to. Selection (if partial) is kept.
 ***/
-void ShaderRegisters::SetFromStateBlockData(std::vector<float> * storedVSRegisters, std::vector<float> *storedPSRegisters)
+void ShaderRegisters::CaptureVSSnapshot(RegisterSnapshot* pSnapshot)
 {
-	if (storedVSRegisters)
-	{
-		// Full register capture should always match the size of the existing register set as size is fixed and register was captured from this
-		assert(storedVSRegisters->size() == m_vsRegistersF.size());
+	vsSnapshotStore.Share(m_vsRegistersF, pSnapshot);
+}
 
-		std::copy(storedVSRegisters->begin(), storedVSRegisters->end(), m_vsRegistersF.begin());
+/**
+* Captures the pixel shader registers to a state block snapshot.
+* Unchanged pages are shared with previous snapshots, only pages written since then are copied.
+* @param pSnapshot The snapshot to capture to. Selection (if partial) is kept.
+***/
+void ShaderRegisters::CapturePSSnapshot(RegisterSnapshot* pSnapshot)
+{
+	psSnapshotStore.Share(m_psRegistersF, pSnapshot);
+}
 
-		// Data should match registers that are already on device (unless it's stereo in which case it might not, that is handled next)
-		dirtyVSRegisters.MarkAllClean();
+/**
+* Records vertex shader constants set between Begin/EndStateBlock to a (partial) snapshot.
+* Return D3DERR_INVALIDCALL if any registers out of internal range.
+* @param pSnapshot The snapshot of the recording state block.
+***/
+HRESULT ShaderRegisters::RecordVSSnapshot(RegisterSnapshot* pSnapshot, UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
+{
+	if ((StartRegister >= m_maxVSConstantRegistersF) || ((StartRegister + Vector4fCount) >= m_maxVSConstantRegistersF))
+		return D3DERR_INVALIDCALL;
 
-		MarkAllVSStereoConstantsDirty();
-	}
+	RegisterSnapshotStore::Record(pSnapshot, m_maxVSConstantRegistersF, StartRegister, pConstantData, Vector4fCount);
 
-	if (storedPSRegisters)
-	{
-		// Full register capture should always match the size of the existing register set as size is fixed and register was captured from this
-		assert(storedPSRegisters->size() == m_psRegistersF.size());
+	return D3D_OK;
+}
 
-		std::copy(storedPSRegisters->begin(), storedPSRegisters->end(), m_psRegistersF.begin());
+/**
+* Records pixel shader constants set between Begin/EndStateBlock to a (partial) snapshot.
+* Return D3DERR_INVALIDCALL if any registers out of internal range.
+* @param pSnapshot The snapshot of the recording state block.
+***/
+HRESULT ShaderRegisters::RecordPSSnapshot(RegisterSnapshot* pSnapshot, UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
+{
+	if ((StartRegister >= m_maxPSConstantRegistersF) || ((StartRegister + Vector4fCount) >= m_maxPSConstantRegistersF))
+		return D3DERR_INVALIDCALL;
 
-		// Data should match registers that are already on device (unless it's stereo in which case it might not, that is handled next)
-		dirtyPSRegisters.MarkAllClean();
+	RegisterSnapshotStore::Record(pSnapshot, m_maxPSConstantRegistersF, StartRegister, pConstantData, Vector4fCount);
 
-		MarkAllPSStereoConstantsDirty();
-	}
+	return D3D_OK;
 }
 
 /**
@@ -322,6 +321,8 @@ void ShaderRegisters::SetFromStateBlockData(std::vector<float> * storedVSRegiste
 ***/
 void ShaderRegisters::ApplyAllDirty(vireio::RenderPosition currentSide) 
 {
+	PROFILE_SCOPE("ApplyAllDirty");
+
 	int start = 0;
 	
 	// vertex shader
@@ -721,3 +722,157 @@ void RegisterDirtyStore::Expand(UINT capacity)
 		dirtyRegisters.push_back(0);
 	}
 }
+
+
+/**
+* Constructor.
+* @param registerCount Number of registers in the register file.
+***/
+RegisterSnapshotStore::RegisterSnapshotStore(UINT registerCount) :
+	m_registerCount(registerCount),
+	m_published(),
+	m_written()
+{
+	m_published.resize(PageCount());
+	m_written.resize(PageCount(), 1);
+}
+
+/**
+* Marks all pages overlapping the register range as written, so they get copied on next share.
+***/
+void RegisterSnapshotStore::MarkRangeWritten(UINT start, UINT count)
+{
+	if (count == 0)
+		return;
+
+	UINT lastPage = RegisterPageIndex(start + count - 1);
+	if (lastPage >= m_written.size())
+		lastPage = m_written.size() - 1;
+
+	for (UINT page = RegisterPageIndex(start); page <= lastPage; page++)
+		m_written[page] = 1;
+}
+
+/**
+* Shares all pages of the register file with the snapshot.
+* Pages that were written since they were last published are copied to a new page first; pages 
+* that are still referenced by older snapshots are never modified.
+* @param registers The register file (must hold m_registerCount registers).
+* @param pSnapshot The snapshot to share the pages with.
+***/
+void RegisterSnapshotStore::Share(const std::vector<float>& registers, RegisterSnapshot* pSnapshot)
+{
+	UINT pageCount = PageCount();
+	pSnapshot->pages.resize(pageCount);
+
+	for (UINT page = 0; page < pageCount; page++) {
+		if (m_written[page] || !m_published[page]) {
+			std::shared_ptr<RegisterPage> newPage = std::make_shared<RegisterPage>();
+			const float* pSource = &registers[RegisterIndex(page * REGISTER_PAGE_SIZE)];
+			std::copy(pSource, pSource + RegisterIndex(RegistersInPage(page)), newPage->registers);
+
+			m_published[page] = newPage;
+			m_written[page] = 0;
+		}
+
+		pSnapshot->pages[page] = m_published[page];
+	}
+}
+
+/**
+* Restores all captured pages of a full snapshot to the register file.
+* Pages that are identical to the published version (and have not been written since) are skipped.
+***/
+void RegisterSnapshotStore::Restore(const RegisterSnapshot& snapshot, std::vector<float>& registers)
+{
+	UINT pageCount = PageCount();
+	if (snapshot.pages.size() < pageCount)
+		pageCount = snapshot.pages.size();
+
+	for (UINT page = 0; page < pageCount; page++) {
+		const std::shared_ptr<RegisterPage>& storedPage = snapshot.pages[page];
+		if (!storedPage)
+			continue;
+
+		// unchanged since capture
+		if ((storedPage == m_published[page]) && !m_written[page])
+			continue;
+
+		std::copy(storedPage->registers, storedPage->registers + RegisterIndex(RegistersInPage(page)), &registers[RegisterIndex(page * REGISTER_PAGE_SIZE)]);
+
+		m_published[page] = storedPage;
+		m_written[page] = 0;
+	}
+}
+
+/**
+* Restores the selected registers of a partial snapshot to the register file.
+* Marks restored registers clean in the dirty store (the actual state block applied them).
+***/
+void RegisterSnapshotStore::RestoreSelected(const RegisterSnapshot& snapshot, std::vector<float>& registers, RegisterDirtyStore& dirty)
+{
+	UINT pageCount = PageCount();
+	if (snapshot.pages.size() < pageCount)
+		pageCount = snapshot.pages.size();
+	if (snapshot.selected.size() < pageCount)
+		pageCount = snapshot.selected.size();
+
+	for (UINT page = 0; page < pageCount; page++) {
+		WORD mask = snapshot.selected[page];
+		const std::shared_ptr<RegisterPage>& storedPage = snapshot.pages[page];
+		if (!mask || !storedPage)
+			continue;
+
+		UINT firstRegister = page * REGISTER_PAGE_SIZE;
+
+		// unchanged since capture, registers still need to be marked clean
+		bool unchanged = ((storedPage == m_published[page]) && !m_written[page]);
+
+		for (UINT i = 0; i < RegistersInPage(page); i++) {
+			if (mask & (1 << i)) {
+				if (!unchanged)
+					std::copy(&storedPage->registers[RegisterIndex(i)], &storedPage->registers[RegisterIndex(i)] + VECTOR_LENGTH, &registers[RegisterIndex(firstRegister + i)]);
+
+				dirty.MarkClean(firstRegister + i);
+			}
+		}
+
+		// page now partly differs from the published one
+		if (!unchanged)
+			m_written[page] = 1;
+	}
+}
+
+/**
+* Writes registers to a snapshot and adds them to its selection (copy on write).
+* Used while recording a state block (Begin/EndStateBlock), the register file itself is not changed.
+* @param pSnapshot The recording snapshot.
+* @param registerCount Number of registers in the register file.
+***/
+void RegisterSnapshotStore::Record(RegisterSnapshot* pSnapshot, UINT registerCount, UINT start, const float* pData, UINT count)
+{
+	UINT pageCount = (registerCount + REGISTER_PAGE_SIZE - 1) / REGISTER_PAGE_SIZE;
+	pSnapshot->partial = true;
+	pSnapshot->pages.resize(pageCount);
+	pSnapshot->selected.resize(pageCount, 0);
+
+	for (UINT reg = start; reg < start + count; reg++) {
+		UINT page = RegisterPageIndex(reg);
+		std::shared_ptr<RegisterPage>& storedPage = pSnapshot->pages[page];
+
+		// never write a page that is shared
+		if (!storedPage) {
+			storedPage = std::make_shared<RegisterPage>();
+			std::fill(storedPage->registers, storedPage->registers + RegisterIndex(REGISTER_PAGE_SIZE), 0.0f);
+		}
+		else if (!storedPage.unique()) {
+			storedPage = std::make_shared<RegisterPage>(*storedPage);
+		}
+
+		UINT i = reg - page * REGISTER_PAGE_SIZE;
+		std::copy(pData, pData + VECTOR_LENGTH, &storedPage->registers[RegisterIndex(i)]);
+		pSnapshot->selected[page] |= (WORD)(1 << i);
+
+		pData += VECTOR_LENGTH;
+	}
+}
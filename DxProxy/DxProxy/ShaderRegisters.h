@@ -30,9 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef SHADERREGISTERS_H_INCLUDED
 #define SHADERREGISTERS_H_INCLUDED
 
-#define VECTOR_LENGTH 4
-#define RegisterIndex(x) (x * VECTOR_LENGTH)
-
+#include "RegisterSnapshot.h"
 #include "d3d9.h"
 #include "d3dx9.h"
 #include <vector>
@@ -69,6 +67,39 @@ public:
 	UINT lastDirtyReg;
 };
 
+/**
+* Publishes the pages of one register file to snapshots.
+* Tracks which pages have been written since they were last shared, so capturing only copies
+* pages that actually changed and restoring only copies pages that differ.
+***/
+class RegisterSnapshotStore
+{
+public:
+	RegisterSnapshotStore(UINT registerCount);
+	void MarkRangeWritten(UINT start, UINT count);
+	void Share(const std::vector<float>& registers, RegisterSnapshot* pSnapshot);
+	void Restore(const RegisterSnapshot& snapshot, std::vector<float>& registers);
+	void RestoreSelected(const RegisterSnapshot& snapshot, std::vector<float>& registers, RegisterDirtyStore& dirty);
+	static void Record(RegisterSnapshot* pSnapshot, UINT registerCount, UINT start, const float* pData, UINT count);
+
+private:
+	UINT PageCount() { return (m_registerCount + REGISTER_PAGE_SIZE - 1) / REGISTER_PAGE_SIZE; }
+	UINT RegistersInPage(UINT page) { UINT left = m_registerCount - page * REGISTER_PAGE_SIZE; return (left < REGISTER_PAGE_SIZE) ? left : REGISTER_PAGE_SIZE; }
+
+	/**
+	* Number of registers in the register file.
+	***/
+	UINT m_registerCount;
+	/**
+	* Last shared (or restored) version of each page. Matches the register file unless written.
+	***/
+	std::vector<std::shared_ptr<RegisterPage>> m_published;
+	/**
+	* Pages written since last published.
+	***/
+	std::vector<char> m_written;
+};
+
 /**
 * Managed shader register class.
 * All shader registers stored, updated and applied to device here. 
@@ -89,8 +120,11 @@ public:
 	std::vector<float> GetAllPSConstantRegistersF();	
 	void               SetFromStateBlockVertexShader(D3D9ProxyVertexShader* storedVShader);
 	void               SetFromStateBlockPixelShader(D3D9ProxyPixelShader* storedPShader);
-	void               SetFromStateBlockData(std::map<UINT, D3DXVECTOR4> * storedVSRegisters, std::map<UINT, D3DXVECTOR4> * storedPSRegisters);
-	void               SetFromStateBlockData(std::vector<float> * storedVSRegisters, std::vector<float> * storedPSRegisters);
+	void               SetFromStateBlockData(const RegisterSnapshot* storedVSRegisters, const RegisterSnapshot* storedPSRegisters);
+	void               CaptureVSSnapshot(RegisterSnapshot* pSnapshot);
+	void               CapturePSSnapshot(RegisterSnapshot* pSnapshot);
+	HRESULT            RecordVSSnapshot(RegisterSnapshot* pSnapshot, UINT StartRegister, const float* pConstantData, UINT Vector4fCount);
+	HRESULT            RecordPSSnapshot(RegisterSnapshot* pSnapshot, UINT StartRegister, const float* pConstantData, UINT Vector4fCount);
 	bool               AnyDirtyVS(UINT start, UINT count);
 	bool               AnyDirtyPS(UINT start, UINT count);
 	void               ApplyAllDirty(vireio::RenderPosition currentSide);
@@ -108,6 +142,8 @@ private:
 
 	RegisterDirtyStore dirtyPSRegisters;
 	RegisterDirtyStore dirtyVSRegisters;
+	RegisterSnapshotStore vsSnapshotStore;
+	RegisterSnapshotStore psSnapshotStore;
 
 	/**
 	* Currently active vertex shader.
@@ -36,7 +36,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /**
 * Name of mapping object.
 ***/
-TCHAR szName[]=TEXT("VireioSMTrack");
+TCHAR szName[]=TEXT(TRACKDATA_SHARED_MEMORY_NAME);
 
 /**
 * Constructor.
@@ -47,6 +47,7 @@ SharedMemoryTracker::SharedMemoryTracker(void):MotionTracker()
 	OutputDebugString("Socket Tracker Created\n");
 	hMapFile = NULL;
 	pTrackBuf = NULL;
+	pTrackBufV2 = NULL;
 	init();
 }
 
@@ -83,14 +84,34 @@ int  SharedMemoryTracker::getOrientationAndPosition(float* yaw, float* pitch, fl
 	if(pTrackBuf == NULL)
 		return 1;						// error no buffer
 
+	// v2 writer : consistent sample including position, v1 writer : fields as they are
+	TrackDataV2 data;
+	TrackSample sample;
+	if (pTrackBufV2 && (pTrackBufV2->magic == TRACKDATA_V2_MAGIC))
+	{
+		if (!TrackDataReadV2(pTrackBufV2, &data) || !TrackDataLatestSample(data, &sample))
+			return 1;					// error no consistent sample
+
+		*x = primaryX = sample.x;
+		*y = primaryY = sample.y;
+		*z = primaryZ = sample.z;
+		sampleTime = sample.timestamp;
+	}
+	else
+	{
+		sample.yaw = pTrackBuf->Yaw;
+		sample.pitch = pTrackBuf->Pitch;
+		sample.roll = pTrackBuf->Roll;
+	}
+
 	//Initial values should now be in radians to match OVR and VRBoost requirements
-	primaryYaw = pTrackBuf->Yaw;
-	primaryPitch = pTrackBuf->Pitch;
-	primaryRoll = pTrackBuf->Roll;
+	primaryYaw = sample.yaw;
+	primaryPitch = sample.pitch;
+	primaryRoll = sample.roll;
 	// Then converted to Degrees
-	*yaw = -RADIANS_TO_DEGREES(pTrackBuf->Yaw);
-	*pitch = RADIANS_TO_DEGREES(pTrackBuf->Pitch);
-	*roll = -RADIANS_TO_DEGREES(pTrackBuf->Roll);
+	*yaw = -RADIANS_TO_DEGREES(sample.yaw);
+	*pitch = RADIANS_TO_DEGREES(sample.pitch);
+	*roll = -RADIANS_TO_DEGREES(sample.roll);
 
 
 	return 0; 
@@ -106,37 +127,51 @@ void SharedMemoryTracker::updateOrientationAndPosition()
 	OutputDebugString("Motion Tracker updateOrientation\n");
 #endif
 
-	// Get orientation from shared memory.
-	if(getOrientationAndPosition(&yaw, &pitch, &roll, &x, &y, &z) == 0)
+	// Get orientation from shared memory (predicted if enabled).
+	if(readOrientationAndPosition(&yaw, &pitch, &roll, &x, &y, &z) == 0)
 	{
+		// VRBoost reads the primary orientation (radians), keep it in line with the prediction
+		if (predictor.IsEnabled())
+		{
+			primaryYaw = -yaw * (float)(PI / 180.0);
+			primaryPitch = pitch * (float)(PI / 180.0);
+			primaryRoll = -roll * (float)(PI / 180.0);
+		}
+
 		// Convert yaw, pitch to positive degrees.
 		// (-180.0f...0.0f -> 180.0f....360.0f)
 		// (0.0f...180.0f -> 0.0f...180.0f)
 		yaw = fmodf(yaw + 360.0f, 360.0f);
 		pitch = -fmodf(pitch + 360.0f, 360.0f);
 
-		// Get difference.
-		deltaYaw += yaw - currentYaw;
-		deltaPitch += pitch - currentPitch;
+		// Mouse emulation engine sends the motion on its own timer (wraps over 360/0 itself).
+		if (mouseEmulator)
+			mouseEmulator->SubmitPose(yaw, pitch);
+		else
+		{
+			// Get difference.
+			deltaYaw += yaw - currentYaw;
+			deltaPitch += pitch - currentPitch;
 
-		// hack to avoid errors while translating over 360/0
-		if(fabs(deltaYaw) > 4.0f) deltaYaw = 0.0f;
-		if(fabs(deltaPitch) > 4.0f) deltaPitch = 0.0f;
+			// hack to avoid errors while translating over 360/0
+			if(fabs(deltaYaw) > 4.0f) deltaYaw = 0.0f;
+			if(fabs(deltaPitch) > 4.0f) deltaPitch = 0.0f;
 
-		// Pass to mouse data (long integer).
-		mouseData.mi.dx = (long)(deltaYaw*multiplierYaw);
-		mouseData.mi.dy = (long)(deltaPitch*multiplierPitch);
+			// Pass to mouse data (long integer).
+			mouseData.mi.dx = (long)(deltaYaw*multiplierYaw);
+			mouseData.mi.dy = (long)(deltaPitch*multiplierPitch);
 
-		// Keep fractional difference in the delta so it's added to the next update.
-		deltaYaw -= ((float)mouseData.mi.dx)/multiplierYaw;
-		deltaPitch -= ((float)mouseData.mi.dy)/multiplierPitch;
+			// Keep fractional difference in the delta so it's added to the next update.
+			deltaYaw -= ((float)mouseData.mi.dx)/multiplierYaw;
+			deltaPitch -= ((float)mouseData.mi.dy)/multiplierPitch;
 
 #ifdef _DEBUG
-		OutputDebugString("Motion Tracker SendInput\n");
+			OutputDebugString("Motion Tracker SendInput\n");
 #endif
-		// Send to mouse input
-		if (mouseEmulation)
-			SendInput(1, &mouseData, sizeof(INPUT));
+			// Send to mouse input
+			if (mouseEmulation)
+				SendInput(1, &mouseData, sizeof(INPUT));
+		}
 
 		// Set current data.
 		currentYaw = yaw;
@@ -154,6 +189,49 @@ MotionTrackerStatus SharedMemoryTracker::getStatus()
 	return MTS_OK;
 }
 
+/**
+* Returns the pose at a given time, interpolated between the timestamped samples of a v2 writer.
+* Orientation in radians (as written to the shared memory).
+* @param time Performance counter time.
+* @return False if the writer doesn't provide timestamped samples (v1 layout) or there is no sample yet.
+***/
+bool SharedMemoryTracker::getSampledPoseAt(LONGLONG time, TrackerPose* pPose)
+{
+	if (!pTrackBufV2 || (pTrackBufV2->magic != TRACKDATA_V2_MAGIC))
+		return false;
+
+	TrackDataV2 data;
+	if (!TrackDataReadV2(pTrackBufV2, &data) || (data.sampleCount <= 0))
+		return false;
+
+	LONG count = (data.sampleCount < TRACKDATA_V2_SAMPLES) ? data.sampleCount : TRACKDATA_V2_SAMPLES;
+	TrackerPose newer, older;
+	ZeroMemory(&newer, sizeof(TrackerPose));
+	for (LONG age = 1; age <= count; age++)
+	{
+		const TrackSample& sample = data.samples[(data.sampleCount - age) % TRACKDATA_V2_SAMPLES];
+		older.time = sample.timestamp;
+		older.yaw = sample.yaw;
+		older.pitch = sample.pitch;
+		older.roll = sample.roll;
+		older.x = sample.x;
+		older.y = sample.y;
+		older.z = sample.z;
+
+		// latest sample at or before the time, or the oldest sample
+		if ((older.time <= time) || (age == count))
+		{
+			if ((age == 1) || (older.time > time))
+				*pPose = older;
+			else
+				TrackerSampler::Interpolate(older, newer, time, pPose);
+			return true;
+		}
+		newer = older;
+	}
+	return false;
+}
+
 /**
 *  Open shared memory file mapping object. 
 *  Creates a file mapping object ("VireioSMTrack") to be provided with tracking data.
@@ -165,17 +243,23 @@ bool SharedMemoryTracker::openSharedMemory()
 		NULL,					// default security
 		PAGE_READWRITE,			// read/write access
 		0,						// maximum object size (high-order DWORD)
-		sizeof(TrackData),		// maximum object size (low-order DWORD)
+		sizeof(TrackDataV2),	// maximum object size (low-order DWORD)
 		szName);				// name of mapping object
 
 	if (hMapFile == NULL)										// Could not create file mapping object
 		return false;
 
-	pTrackBuf = (TrackData*) MapViewOfFile(hMapFile,			// handle to map object
+	pTrackBufV2 = (TrackDataV2*) MapViewOfFile(hMapFile,		// handle to map object
 		FILE_MAP_ALL_ACCESS,									// read/write permission
 		0,
 		0,
-		sizeof(TrackData));
+		sizeof(TrackDataV2));
+
+	// mapping created by a v1 writer keeps the v1 size
+	if (pTrackBufV2)
+		pTrackBuf = &pTrackBufV2->legacy;
+	else
+		pTrackBuf = (TrackData*) MapViewOfFile(hMapFile, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TrackData));
 
 	if (pTrackBuf == NULL)										// Could not map view of file
 	{
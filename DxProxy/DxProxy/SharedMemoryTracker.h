@@ -33,28 +33,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define RADIANS_TO_DEGREES(rad) ((float) rad * (float) (180.0 / PI))
 
 #include "MotionTracker.h"
+#include "TrackingSharedMemory.h"
 
 #include <string>
 
-/**
-* Shared memory tracking data structure.
-***/
-struct TrackData
-{
-	int DataID;	/**< increased every time data has been sent */
-
-	float Yaw;
-	float Pitch;
-	float Roll;
-
-	float X;
-	float Y;
-	float Z;
-};
-
 /**
 * Shared memory tracking class.
 * Retrieves data from external tracking sources.
+* Reads the seqlock versioned v2 layout (timestamped samples, position) if the writer provides it,
+* the v1 layout otherwise.
 */
 class SharedMemoryTracker : public MotionTracker
 {
@@ -67,6 +54,8 @@ public:
 	int  getOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z);
 	void updateOrientationAndPosition();
 	MotionTrackerStatus getStatus();
+	bool getSampledPoseAt(LONGLONG time, TrackerPose* pPose);
+	float GetFullTurn() {return 360.0f;}
 	char* GetTrackerDescription() {return "SharedMemoryTracker";}
 	
 private:
@@ -81,6 +70,10 @@ private:
 	* Pointer to tracking data source.
 	***/
 	TrackData* pTrackBuf;
+	/**
+	* Pointer to tracking data source, v2 layout. NULL if the mapping only holds the v1 layout.
+	***/
+	TrackDataV2* pTrackBufV2;
 };
 
 
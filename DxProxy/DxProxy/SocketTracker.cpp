@@ -26,92 +26,139 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <sstream>							// for stringstream
 
 #define DEFAULT_BUFLEN 512
-#define DEFAULT_PORT 49015
-
-SocketTracker::SocketTracker(void):MotionTracker()
+#define DEFAULT_PORT TRACKING_DATAGRAM_PORT
+
+/**
+* Datagrams older than this (relative to the fastest recent datagram) are dropped as stale.
+***/
+#define SOCKETTRACKER_STALE_MS 100
+/**
+* Without datagrams for this long the sender is considered restarted (sequence restarts) or lost.
+***/
+#define SOCKETTRACKER_TIMEOUT_MS 1000
+/**
+* Clock offset window.
+***/
+#define SOCKETTRACKER_OFFSET_WINDOW_MS 2000
+
+SocketTracker::SocketTracker(SocketTrackerMode mode):MotionTracker(),
+	mode(mode),
+	ListenSocket(INVALID_SOCKET),
+	ClientSocket(INVALID_SOCKET),
+	UdpSocket(INVALID_SOCKET),
+	m_dwThreadID(0),
+	m_hThread(0),
+	m_hStopEvent(NULL),
+	textYaw(0.0f),
+	textPitch(0.0f),
+	textRoll(0.0f),
+	lastSequence(0),
+	lastArrival(0),
+	offsetCurrent(0),
+	offsetPrevious(0),
+	offsetWindowStart(0),
+	droppedCount(0)
 {
 	OutputDebugString("Socket Tracker Created\n");
+
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	frequency = freq.QuadPart;
+
 	init();
 }
 
 SocketTracker::~SocketTracker(void)
 {
+	if (m_hStopEvent)
+	{
+		// UDP receiver : ends on the stop event
+		SetEvent(m_hStopEvent);
+		WaitForSingleObject(m_hThread, INFINITE);
+		CloseHandle(m_hStopEvent);
+		m_hStopEvent = NULL;
+	}
 	CloseHandle(m_hThread);									// close thread
 
+	// the pose history is filled by the receiver, no sampling thread to stop
+	stopSampling();
+
 	closesocket(ListenSocket);
 	closesocket(ClientSocket);
+	closesocket(UdpSocket);
 
 	WSACleanup();
 }
 
-int SocketTracker::init()
+/**
+* Starts Winsock and the receiver, getStatus() is MTS_NOTINIT if that failed.
+* (overrides MotionTracker::init(), called by the constructor)
+***/
+void SocketTracker::init()
 {
 	OutputDebugString("Socket Tracker Init\n");
 
-	// add init code
-    m_dwThreadID = 0;
-    m_hThread    = 0;
-
-	ListenSocket = INVALID_SOCKET;
-	ClientSocket = INVALID_SOCKET;
-
 	WSADATA wsaData;
 	int result = WSAStartup(MAKEWORD(2, 2), &wsaData);		// starts Winsock version 2.2 and initializes wsaData
 
 	if(result != 0)											// Winsock failed to launch
-		return false;
+		return;
 	
 	if(wsaData.wVersion != MAKEWORD(2, 2))					// winsock is not version 2.2
 	{
 		WSACleanup();
-		return false;
+		return;
 	}
 
 	// change to support other ports
-	return ListenOnPort(DEFAULT_PORT);
+	if (!ListenOnPort(DEFAULT_PORT))
+		OutputDebugString("Socket Tracker : Could not listen on the default port\n");
 }
 
-
-int SocketTracker::getOrientation(float* yaw, float* pitch, float* roll) 
+/**
+* Returns the latest orientation received in TCP text mode.
+* In UDP binary mode the receiver fills the pose history, read through readOrientationAndPosition().
+***/
+int SocketTracker::getOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z)
 {
-	OutputDebugString("Socket Tracker getOrient\n");
-
-	*roll = this->roll;
-	*pitch = this->pitch;
-	*yaw = this->yaw;
+	if (mode != STM_TCP_TEXT)
+		return -1;
+
+	*yaw = textYaw;
+	*pitch = textPitch;
+	*roll = textRoll;
+	*x = 0.0f;
+	*y = 0.0f;
+	*z = 0.0f;
 	return 0; 
 }
 
-bool SocketTracker::isAvailable()
-{
-	// change to connection status
-	return true;
-}
-
-void SocketTracker::updateOrientation()
+/**
+* Not initialised if the receiver isn't running, no orientation if the sender is silent.
+***/
+MotionTrackerStatus SocketTracker::getStatus()
 {
-	OutputDebugString("Motion Tracker updateOrientation\n");
-
-	// need to add multipliers...
-
-	if(getOrientation(&yaw, &pitch, &roll) == 0)
-	{
-		deltaYaw = yaw - currentYaw;
-		deltaPitch = pitch - currentPitch;
-
-		mouseData.mi.dx = (long)(deltaYaw);
-		mouseData.mi.dy = (long)(deltaPitch);
-		
-		OutputDebugString("Motion Tracker SendInput\n");
-		SendInput(1, &mouseData, sizeof(INPUT));
-		currentYaw = yaw;
-		currentPitch = pitch;
-		currentRoll = roll;
-	}
+	if (!m_hThread)
+		return MTS_NOTINIT;
+	if (mode != STM_UDP_BINARY)
+		return MTS_OK;
+
+	LONGLONG arrival = lastArrival;
+	if (arrival == 0)
+		return MTS_NOORIENTATION;
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	if ((now.QuadPart - arrival) * 1000 > frequency * SOCKETTRACKER_TIMEOUT_MS)
+		return MTS_NOORIENTATION;
+	return MTS_OK;
 }
 
 bool SocketTracker::ListenOnPort(int portNum)
 {
+	if (mode == STM_UDP_BINARY)
+		return CreateUdpThread(portNum);
+
 	// convert int portNum to string
 	std::stringstream ss;
 	ss << portNum;
@@ -131,7 +178,195 @@ bool SocketTracker::CreateMsgThread()
 	return true;              
 }
 
+/**
+* Binds the UDP socket and starts the receiver thread.
+* The poses go to the pose history, the receiver is the single producer.
+***/
+bool SocketTracker::CreateUdpThread(int portNum)
+{
+	if(m_hThread != 0)
+		return false;					// thread already exists
+
+	UdpSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (UdpSocket == INVALID_SOCKET)
+	{
+		OutputDebugString("Socket Tracker : UDP socket failed\n");
+		return false;
+	}
+
+	sockaddr_in address;
+	ZeroMemory(&address, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons((u_short)portNum);
+	if (bind(UdpSocket, (sockaddr*)&address, sizeof(address)) == SOCKET_ERROR)
+	{
+		OutputDebugString("Socket Tracker : UDP bind failed\n");
+		closesocket(UdpSocket);
+		UdpSocket = INVALID_SOCKET;
+		return false;
+	}
+
+	sampler = new TrackerSampler(this);
+	if (sampler)
+		m_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (m_hStopEvent)
+		m_hThread = CreateThread(0, 0, UdpThread, this, 0, &m_dwThreadID);
+	if (!m_hThread)
+	{
+		// nothing left behind, the port can be listened on again
+		OutputDebugString("Socket Tracker : Could not start the UDP receiver\n");
+		if (m_hStopEvent)
+			CloseHandle(m_hStopEvent);
+		m_hStopEvent = NULL;
+		stopSampling();
+		closesocket(UdpSocket);
+		UdpSocket = INVALID_SOCKET;
+		return false;
+	}
+
+	SetThreadPriority(m_hThread, THREAD_PRIORITY_ABOVE_NORMAL);
+	return true;
+}
+
+/**
+* Validates a datagram and adds its pose to the history (receiver thread only).
+* Drops datagrams older than the last accepted one (sequence) and datagrams that spent much longer
+* in transit than the fastest recent ones (stale).
+* @param datagram The (valid) datagram.
+* @param arrival Local performance counter at reception.
+***/
+void SocketTracker::HandleDatagram(const TrackingDatagram& datagram, LONGLONG arrival)
+{
+	LONGLONG previousArrival = lastArrival;
+	bool restart = (previousArrival == 0) || 
+		((arrival - previousArrival) * 1000 > frequency * SOCKETTRACKER_TIMEOUT_MS);
+
+	// out of order or duplicate (sequence wraps), unless the sender restarted
+	if (!restart && ((LONG)(datagram.sequence - lastSequence) <= 0))
+	{
+		InterlockedIncrement(&droppedCount);
+		return;
+	}
+
+	// sender time to local time, offset = min(arrival - sender time) over two windows
+	LONGLONG senderTime = (LONGLONG)((datagram.timestampUs / 1000000) * (UINT64)frequency +
+		((datagram.timestampUs % 1000000) * (UINT64)frequency) / 1000000);
+	LONGLONG offset = arrival - senderTime;
+	if (restart)
+	{
+		offsetCurrent = offset;
+		offsetPrevious = offset;
+		offsetWindowStart = arrival;
+	}
+	else if ((arrival - offsetWindowStart) * 1000 > frequency * SOCKETTRACKER_OFFSET_WINDOW_MS)
+	{
+		offsetPrevious = offsetCurrent;
+		offsetCurrent = offset;
+		offsetWindowStart = arrival;
+	}
+	else if (offset < offsetCurrent)
+		offsetCurrent = offset;
+	LONGLONG minOffset = (offsetCurrent < offsetPrevious) ? offsetCurrent : offsetPrevious;
+
+	// stale : delayed well beyond the fastest datagram
+	if ((offset - minOffset) * 1000 > frequency * SOCKETTRACKER_STALE_MS)
+	{
+		InterlockedIncrement(&droppedCount);
+		return;
+	}
+
+	// normalize quaternion
+	float qw = datagram.qw, qx = datagram.qx, qy = datagram.qy, qz = datagram.qz;
+	float length = sqrtf(qw*qw + qx*qx + qy*qy + qz*qz);
+	if (!(length > 0.0001f))
+	{
+		InterlockedIncrement(&droppedCount);
+		return;
+	}
+	qw /= length; qx /= length; qy /= length; qz /= length;
+
+	// to yaw (Y), pitch (X), roll (Z) euler angles, same as the Oculus tracker
+	TrackerPose pose;
+	pose.time = senderTime + minOffset;
+	float sinPitch = 2.0f * (qw*qx - qy*qz);
+	if (sinPitch > 1.0f) sinPitch = 1.0f;
+	if (sinPitch < -1.0f) sinPitch = -1.0f;
+	pose.pitch = asinf(sinPitch);
+	pose.yaw = atan2f(2.0f * (qw*qy + qx*qz), 1.0f - 2.0f * (qx*qx + qy*qy));
+	pose.roll = atan2f(2.0f * (qw*qz + qx*qy), 1.0f - 2.0f * (qx*qx + qz*qz));
+	if (datagram.flags & TRACKING_DATAGRAM_POSITION)
+	{
+		pose.x = datagram.x;
+		pose.y = datagram.y;
+		pose.z = datagram.z;
+	}
+	else
+	{
+		pose.x = 0.0f;
+		pose.y = 0.0f;
+		pose.z = 0.0f;
+	}
+
+	sampler->Push(pose);
+	lastSequence = datagram.sequence;
+	lastArrival = arrival;
+}
+
+/**
+* UDP receiver thread.
+* Sleeps on the socket event (FD_READ) and the stop event, then drains all pending datagrams.
+***/
+DWORD WINAPI SocketTracker::UdpThread(LPVOID pvParam)
+{
+	SocketTracker* sockTrackPtr = (SocketTracker*)pvParam;				// pointer to parent SocketTracker
+
+	// WSAEventSelect also makes the socket non-blocking
+	WSAEVENT dataEvent = WSACreateEvent();
+	if ((dataEvent == WSA_INVALID_EVENT) || 
+		(WSAEventSelect(sockTrackPtr->UdpSocket, dataEvent, FD_READ) == SOCKET_ERROR))
+	{
+		OutputDebugString("Socket Tracker : WSAEventSelect failed\n");
+		if (dataEvent != WSA_INVALID_EVENT)
+			WSACloseEvent(dataEvent);
+		return 1;
+	}
+
+	HANDLE handles[2] = {sockTrackPtr->m_hStopEvent, dataEvent};
+	char recvbuf[DEFAULT_BUFLEN];
 
+	while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1)
+	{
+		WSAResetEvent(dataEvent);
+
+		// drain, FD_READ is signaled again only after a recvfrom
+		for (;;)
+		{
+			int size = recvfrom(sockTrackPtr->UdpSocket, recvbuf, DEFAULT_BUFLEN, 0, NULL, NULL);
+			if (size == SOCKET_ERROR)
+			{
+				// WSAEWOULDBLOCK : drained, WSAECONNRESET (ICMP) and others : wait for the next datagram
+				break;
+			}
+
+			LARGE_INTEGER arrival;
+			QueryPerformanceCounter(&arrival);
+
+			if (!TrackingDatagramIsValid(recvbuf, size))
+			{
+				InterlockedIncrement(&sockTrackPtr->droppedCount);
+				continue;
+			}
+
+			TrackingDatagram datagram;
+			memcpy(&datagram, recvbuf, sizeof(TrackingDatagram));
+			sockTrackPtr->HandleDatagram(datagram, arrival.QuadPart);
+		}
+	}
+
+	WSACloseEvent(dataEvent);
+	return 0;
+}
 
 DWORD WINAPI SocketTracker::MsgThread(LPVOID pvParam)
 {
@@ -222,7 +457,7 @@ DWORD WINAPI SocketTracker::MsgThread(LPVOID pvParam)
 				tmpStr = tmpSt.substr(lastS,lastE);
 				if(lastS < 0 || lastE < 0 || lastS+lastE > iResult)
 					continue;											// error reading tag
-				sockTrackPtr->yaw = (float)atof(tmpStr.c_str());
+				sockTrackPtr->textYaw = (float)atof(tmpStr.c_str());
 
 				// read pitch
 				lastS = tmpSt.rfind("<pitch>");
@@ -232,7 +467,7 @@ DWORD WINAPI SocketTracker::MsgThread(LPVOID pvParam)
 				tmpStr = tmpSt.substr(lastS,lastE);
 				if(lastS < 0 || lastE < 0 || lastS+lastE > iResult)
 					continue;											// error reading tag
-				sockTrackPtr->pitch = (float)atof(tmpStr.c_str());
+				sockTrackPtr->textPitch = (float)atof(tmpStr.c_str());
 
 				// read roll
 				lastS = tmpSt.rfind("<roll>");
@@ -242,7 +477,7 @@ DWORD WINAPI SocketTracker::MsgThread(LPVOID pvParam)
 				tmpStr = tmpSt.substr(lastS,lastE);
 				if(lastS < 0 || lastE < 0 || lastS+lastE > iResult)
 					continue;											// error reading tag
-				sockTrackPtr->roll = (float)atof(tmpStr.c_str());
+				sockTrackPtr->textRoll = (float)atof(tmpStr.c_str());
 			}
 
 		} while (iResult > 0);											// while still receiving data from client
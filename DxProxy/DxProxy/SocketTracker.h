@@ -20,38 +20,100 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "MotionTracker.h"
+#include "TrackingDatagram.h"
 
 #include <string>
 
+/**
+* Socket tracker protocols.
+***/
+enum SocketTrackerMode
+{
+	STM_TCP_TEXT,   /**< Legacy : TCP stream, <VST><yaw>..</yaw><pitch>..</pitch><roll>..</roll></VST>, radians. */
+	STM_UDP_BINARY  /**< TrackingDatagram per UDP packet, see TrackingDatagram.h. */
+};
+
+/**
+* Socket tracker class.
+* Receives the head orientation from another process or machine. In binary UDP mode an event driven
+* receiver thread validates the datagrams, drops stale and out of order ones, maps the sender
+* timestamps to the local clock and pushes the poses directly into the tracker pose history.
+***/
 class SocketTracker : public MotionTracker
 {
 public:
-	SocketTracker(void);
+	SocketTracker(SocketTrackerMode mode);
 	~SocketTracker(void);
 
-
-	int getOrientation(float* yaw, float* pitch, float* roll);
-	bool isAvailable();
-	void updateOrientation();
-	int init();
-
+	/*** SocketTracker public methods ***/
+	int  getOrientationAndPosition(float* yaw, float* pitch, float* roll, float* x, float* y, float* z);
+	MotionTrackerStatus getStatus();
+	virtual char* GetTrackerDescription() {return "SocketTracker";}
+	virtual bool SupportsPositionTracking() {return mode == STM_UDP_BINARY;}
+	void init();
 	bool ListenOnPort(int portNum);
+	LONG GetDroppedCount() {return droppedCount;}
 
 private:
-	SOCKET ListenSocket;
-	SOCKET ClientSocket;
-
-    DWORD m_dwThreadID;
-    HANDLE m_hThread;
-
-	std::string port;															// port number to listen on
-
-
-	bool SocketTracker::CreateSockets();
-
+	/*** SocketTracker private methods ***/
+	bool CreateSockets();
 	bool CreateMsgThread();
+	bool CreateUdpThread(int portNum);
+	void HandleDatagram(const TrackingDatagram& datagram, LONGLONG arrival);
 	static DWORD WINAPI MsgThread(LPVOID pvParam);
+	static DWORD WINAPI UdpThread(LPVOID pvParam);
+
+	/**
+	* Protocol of this tracker.
+	***/
+	SocketTrackerMode mode;
+	/**
+	* TCP text mode sockets.
+	***/
+	SOCKET ListenSocket;
+	SOCKET ClientSocket;
+	/**
+	* UDP binary mode socket.
+	***/
+	SOCKET UdpSocket;
+	/**
+	* Receiver thread, the stop event ends the UDP thread.
+	***/
+	DWORD m_dwThreadID;
+	HANDLE m_hThread;
+	HANDLE m_hStopEvent;
+	/**
+	* Port number to listen on (TCP text mode).
+	***/
+	std::string port;
+	/**
+	* Latest orientation received in TCP text mode, radians.
+	***/
+	volatile float textYaw, textPitch, textRoll;
+	/**
+	* Sequence number of the last accepted datagram (receiver thread only).
+	***/
+	DWORD lastSequence;
+	/**
+	* Local time of the last accepted datagram, zero if none yet.
+	***/
+	volatile LONGLONG lastArrival;
+	/**
+	* Performance counter frequency.
+	***/
+	LONGLONG frequency;
+	/**
+	* Sender to local clock offset (performance counter ticks) : minimum of (arrival - sender time)
+	* over the current and the previous window, so network jitter doesn't move the timestamps and
+	* clock drift is followed within two windows.
+	***/
+	LONGLONG offsetCurrent, offsetPrevious;
+	LONGLONG offsetWindowStart;
+	/**
+	* Datagrams dropped (invalid, out of order or stale).
+	***/
+	volatile LONG droppedCount;
 };
 
 
-#endif
\ No newline at end of file
+#endif
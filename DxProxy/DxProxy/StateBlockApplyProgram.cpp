@@ -0,0 +1,107 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StateBlockApplyProgram.cpp> and
+Class <StateBlockApplyProgram> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "StateBlockApplyProgram.h"
+
+/**
+* Adds an operation to the program.
+***/
+static void AddOperation(std::vector<StateBlockApplyProgram::Operation>& program, ApplyStep step, UINT index)
+{
+	StateBlockApplyProgram::Operation operation;
+	operation.step = step;
+	operation.index = index;
+	program.push_back(operation);
+}
+
+/**
+* Builds the list of operations of a state block apply.
+* Order: non-indexed states, vertex buffers, managed shader registers (according to capture type),
+* textures. Stereo states are compiled to re-apply on the actual device if the sides are mixed.
+* @param shaders Shaders applied, according to capture type.
+* @param selectedStates Selected non-indexed states, one bit per D3D9ProxyStateBlock::CaptureableState.
+* @param vertexBufferMask Streams holding a captured vertex buffer, one bit per stream.
+* @param textureMask Sampler slots holding a captured texture, one bit per slot.
+* @param reApplyStereo True if stereo states were captured on mixed sides.
+* @param program Receives the operations.
+***/
+void StateBlockApplyProgram::Compile(ApplyShaders shaders, DWORD selectedStates, DWORD vertexBufferMask, DWORD textureMask, bool reApplyStereo, std::vector<Operation>& program)
+{
+	program.clear();
+
+	// Non-indexed states
+	for (int step = APPLY_INDEX_BUFFER; step <= APPLY_VERTEX_DECLARATION; step++) {
+		if (selectedStates & (1 << step))
+			AddOperation(program, (ApplyStep)step, reApplyStereo ? 1 : 0);
+	}
+
+	// Non-stereo indexed states
+	for (UINT stream = 0; stream < STATEBLOCK_VERTEX_STREAMS; stream++) {
+		if (vertexBufferMask & (1 << stream))
+			AddOperation(program, APPLY_VERTEX_BUFFER, stream);
+	}
+
+	// Shader constants
+	switch (shaders)
+	{
+	case APPLY_SHADERS_SELECTED:
+		if (selectedStates & (1 << APPLY_VERTEX_SHADER))
+			AddOperation(program, APPLY_MANAGED_VERTEX_SHADER, 0);
+		if (selectedStates & (1 << APPLY_PIXEL_SHADER))
+			AddOperation(program, APPLY_MANAGED_PIXEL_SHADER, 0);
+		AddOperation(program, APPLY_VERTEX_SHADER_REGISTERS, 0);
+		AddOperation(program, APPLY_PIXEL_SHADER_REGISTERS, 0);
+		break;
+
+	case APPLY_SHADERS_ALL:
+		AddOperation(program, APPLY_MANAGED_VERTEX_SHADER, 0);
+		AddOperation(program, APPLY_MANAGED_PIXEL_SHADER, 0);
+		AddOperation(program, APPLY_VERTEX_SHADER_REGISTERS, 0);
+		AddOperation(program, APPLY_PIXEL_SHADER_REGISTERS, 0);
+		break;
+
+	case APPLY_SHADERS_VERTEX:
+		AddOperation(program, APPLY_MANAGED_VERTEX_SHADER, 0);
+		AddOperation(program, APPLY_VERTEX_SHADER_REGISTERS, 0);
+		break;
+
+	case APPLY_SHADERS_PIXEL:
+	default:
+		AddOperation(program, APPLY_MANAGED_PIXEL_SHADER, 0);
+		AddOperation(program, APPLY_PIXEL_SHADER_REGISTERS, 0);
+		break;
+	}
+
+	// Stereo indexed states
+	for (UINT slot = 0; slot < STATEBLOCK_TEXTURE_SLOTS; slot++) {
+		if (textureMask & (1 << slot))
+			AddOperation(program, reApplyStereo ? APPLY_TEXTURE_STEREO : APPLY_TEXTURE, slot);
+	}
+}
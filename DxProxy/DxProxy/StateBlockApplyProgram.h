@@ -0,0 +1,103 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StateBlockApplyProgram.h> and
+Class <StateBlockApplyProgram> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef STATEBLOCKAPPLYPROGRAM_H_INCLUDED
+#define STATEBLOCKAPPLYPROGRAM_H_INCLUDED
+
+#include <d3d9.h>
+#include <vector>
+
+/**
+* Number of texture sampler slots tracked by a proxy state block.
+* Standard samplers 0-15, displacement map sampler and vertex samplers 0-3.
+* @see D3D9ProxyStateBlock::TextureSlot()
+***/
+#define STATEBLOCK_TEXTURE_SLOTS 21
+/**
+* Number of vertex streams tracked by a proxy state block.
+***/
+#define STATEBLOCK_VERTEX_STREAMS 16
+
+/**
+* Steps of a proxy state block apply program, one per D3D9ProxyStateBlock apply method.
+* The non-indexed steps come first, in order of D3D9ProxyStateBlock::CaptureableState.
+***/
+enum ApplyStep
+{
+	APPLY_INDEX_BUFFER,             /**< Index is the reapply stereo flag, same for all non-indexed steps **/
+	APPLY_VIEWPORT,
+	APPLY_VIEW_MATRICES,
+	APPLY_PROJECTION_MATRICES,
+	APPLY_PIXEL_SHADER,
+	APPLY_VERTEX_SHADER,
+	APPLY_VERTEX_DECLARATION,
+	APPLY_VERTEX_BUFFER,            /**< Index is the stream **/
+	APPLY_MANAGED_VERTEX_SHADER,
+	APPLY_MANAGED_PIXEL_SHADER,
+	APPLY_VERTEX_SHADER_REGISTERS,
+	APPLY_PIXEL_SHADER_REGISTERS,
+	APPLY_TEXTURE,                  /**< Index is the sampler slot, proxy device only **/
+	APPLY_TEXTURE_STEREO,           /**< Index is the sampler slot, set again on the actual device **/
+	APPLY_STEP_COUNT
+};
+
+/**
+* Shaders and shader registers applied, according to the state block capture type.
+***/
+enum ApplyShaders
+{
+	APPLY_SHADERS_SELECTED,  /**< Selected shaders, all registers (Cap_Type_Selected) **/
+	APPLY_SHADERS_ALL,       /**< Both shaders and their registers (Cap_Type_Full) **/
+	APPLY_SHADERS_VERTEX,    /**< Vertex shader and registers (Cap_Type_Vertex) **/
+	APPLY_SHADERS_PIXEL      /**< Pixel shader and registers (Cap_Type_Pixel) **/
+};
+
+/**
+* Apply program compiler of the proxy state block.
+* Turns the captured layout (selected states, stored vertex buffers and textures) into the list of
+* operations D3D9ProxyStateBlock::Apply() runs. No device needed, the program only depends on the 
+* layout.
+*/
+class StateBlockApplyProgram
+{
+public:
+	/**
+	* One operation of the apply program, the step is run with the index stored along with it.
+	***/
+	struct Operation
+	{
+		ApplyStep step;
+		UINT      index;
+	};
+
+	static void Compile(ApplyShaders shaders, DWORD selectedStates, DWORD vertexBufferMask, DWORD textureMask, bool reApplyStereo, std::vector<Operation>& program);
+};
+
+#endif
@@ -32,17 +32,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 /**
 * Constructor, creates parent D3D9ProxySurface.
+* Takes ownership of the textures (if any), the surfaces must be level 0 of these textures.
 ***/
-StereoBackBuffer::StereoBackBuffer(IDirect3DSurface9* pActualSurfaceLeft, IDirect3DSurface9* pActualSurfaceRight, BaseDirect3DDevice9* pOwningDevice) :
-	D3D9ProxySurface(pActualSurfaceLeft, pActualSurfaceRight, pOwningDevice, NULL)
+StereoBackBuffer::StereoBackBuffer(IDirect3DSurface9* pActualSurfaceLeft, IDirect3DSurface9* pActualSurfaceRight, BaseDirect3DDevice9* pOwningDevice,
+								   IDirect3DTexture9* pActualTextureLeft, IDirect3DTexture9* pActualTextureRight) :
+	D3D9ProxySurface(pActualSurfaceLeft, pActualSurfaceRight, pOwningDevice, NULL),
+	m_pActualTextureLeft(pActualTextureLeft),
+	m_pActualTextureRight(pActualTextureRight)
 {
 }
 
 /**
-* Empty destructor.
+* Destructor, releases the textures. 
+* (the surfaces keep their own reference to the textures until released by D3D9ProxySurface)
 ***/
 StereoBackBuffer::~StereoBackBuffer()
 {
+	if (m_pActualTextureLeft)
+		m_pActualTextureLeft->Release();
+
+	if (m_pActualTextureRight)
+		m_pActualTextureRight->Release();
 }
 
 /**
@@ -57,4 +67,23 @@ ULONG WINAPI StereoBackBuffer::Release()
 	}
 
 	return m_nRefCount;
-}
\ No newline at end of file
+}
+
+/**
+* Returns the texture containing the actual surface (left or right), NULL if the surface isn't 
+* part of a texture (back buffer not created as render target texture).
+* @param pActualSurface The actual left or right surface of this back buffer.
+***/
+IDirect3DTexture9* StereoBackBuffer::getActualTexture(IDirect3DSurface9* pActualSurface)
+{
+	if (pActualSurface == NULL)
+		return NULL;
+
+	if (pActualSurface == getActualLeft())
+		return m_pActualTextureLeft;
+
+	if (pActualSurface == getActualRight())
+		return m_pActualTextureRight;
+
+	return NULL;
+}
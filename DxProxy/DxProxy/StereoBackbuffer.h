@@ -43,14 +43,31 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 * If the Proxy surface is in a container it will have a combined ref count with it's container
 * and that count is managed by forwarding release and addref to the container. In this case the
 * container must delete this surface when the ref count reaches 0.
+*
+* If created as render target textures the actual surfaces are level 0 of the textures, so the
+* stereo view can sample them directly.
 */
 class StereoBackBuffer : public D3D9ProxySurface
 {
 public:
-	StereoBackBuffer(IDirect3DSurface9* pActualSurfaceLeft, IDirect3DSurface9* pActualSurfaceRight, BaseDirect3DDevice9* pOwningDevice);
+	StereoBackBuffer(IDirect3DSurface9* pActualSurfaceLeft, IDirect3DSurface9* pActualSurfaceRight, BaseDirect3DDevice9* pOwningDevice,
+		IDirect3DTexture9* pActualTextureLeft = NULL, IDirect3DTexture9* pActualTextureRight = NULL);
 	virtual ~StereoBackBuffer();
 	
 	/*** StereoBackBuffer public methods ***/
-	virtual ULONG WINAPI Release();
+	virtual ULONG WINAPI       Release();
+	virtual IDirect3DTexture9* getActualTexture(IDirect3DSurface9* pActualSurface);
+
+protected:
+	/**
+	* Texture containing the left (or mono) surface. 
+	* NULL if the back buffer could not be created as render target texture.
+	***/
+	IDirect3DTexture9* m_pActualTextureLeft;
+	/**
+	* Texture containing the right surface.
+	* NULL for back buffers that aren't being duplicated or not created as render target texture.
+	***/
+	IDirect3DTexture9* m_pActualTextureRight;
 };
 #endif
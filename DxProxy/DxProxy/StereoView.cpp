@@ -66,6 +66,7 @@ StereoView::StereoView(ProxyConfig *config)
 	chromaticAberrationCorrection = true;
 	m_vignetteStyle = NONE;
 	m_rotation = 0.0f;
+	m_reprojection = Reprojection::Identity();
 	m_blackSmearCorrection = 0.0f;
 	m_mousePos.x = 0;
 	m_mousePos.y = 0;
@@ -73,22 +74,14 @@ StereoView::StereoView(ProxyConfig *config)
 	// set all member pointers to NULL to prevent uninitialized objects being used
 	m_pActualDevice = NULL;
 	backBuffer = NULL;
-	leftTexture = NULL;
-	rightTexture = NULL;
-	
-	leftSurface = NULL;
-	rightSurface = NULL;	
+	ZeroMemory(&backBufferDesc, sizeof(backBufferDesc));
 
 	screenVertexBuffer = NULL;
-	lastVertexShader = NULL;
-	lastPixelShader = NULL;
-	lastTexture = NULL;
-	lastTexture1 = NULL;
-	lastVertexDeclaration = NULL;
-	lastRenderTarget0 = NULL;
-	lastRenderTarget1 = NULL;
 	viewEffect = NULL;
-	sb = NULL;
+	m_pStateSnapshot = NULL;
+	lastLeftImage = NULL;
+	lastRightImage = NULL;
+	m_bEyesSampledDirectly = false;
 	m_bLeftSideActive = false;
 
 	int value = 0;
@@ -101,6 +94,9 @@ StereoView::StereoView(ProxyConfig *config)
 		howToSaveRenderStates = HowToSaveRenderStates::STATE_BLOCK;
 	}
 
+	if (!ProxyHelper::ParseGameType(config->game_type, ProxyHelper::DeviceStateFlags, m_deviceStateFlags))
+		m_deviceStateFlags = 0;
+
 	if(howToSaveRenderStates == HowToSaveRenderStates::ALL_STATES_MANUALLY)
 	{
 		OutputDebugString( "HowToSaveRenderStates = ALL_STATES_MANUALLY");
@@ -121,10 +117,14 @@ StereoView::StereoView(ProxyConfig *config)
 }
 
 /**
-* Empty destructor.
+* Destructor, releases the resources kept over device resets.
 ***/
 StereoView::~StereoView()
 {
+	if (viewEffect)
+		viewEffect->Release();
+	if (screenVertexBuffer)
+		screenVertexBuffer->Release();
 	OutputDebugString("Destroyed SteroView\n");
 }
 
@@ -142,6 +142,8 @@ void StereoView::Init(IDirect3DDevice9* pActualDevice)
 	}
 
 	m_pActualDevice = pActualDevice;
+	m_frameCapture.Init(pActualDevice);
+	m_compositionStates.Init(pActualDevice, m_deviceStateFlags);
 	
 	InitShaderEffects();
 	InitTextureBuffers();
@@ -223,51 +225,21 @@ void StereoView::ReleaseEverything()
 		releaseCheck("backBuffer", backBuffer->Release());	
 	backBuffer = NULL;
 
-	if(leftTexture)
-		releaseCheck("leftTexture", leftTexture->Release());
-	leftTexture = NULL;
-
-	if(rightTexture)
-		releaseCheck("rightTexture", rightTexture->Release());
-	rightTexture = NULL;
-
-	if(leftSurface)
-		releaseCheck("leftSurface", leftSurface->Release());
-	leftSurface = NULL;
-
-	if(rightSurface)
-		releaseCheck("rightSurface", rightSurface->Release());
-	rightSurface = NULL;
-
-	if(lastVertexShader)
-		releaseCheck("lastVertexShader", lastVertexShader->Release());
-	lastVertexShader = NULL;
+	m_eyeTextures.ReleaseEverything();
+	m_compositionStates.ReleaseEverything();
 
-	if(lastPixelShader)
-		releaseCheck("lastPixelShader", lastPixelShader->Release());
-	lastPixelShader = NULL;
+	delete m_pStateSnapshot;
+	m_pStateSnapshot = NULL;
 
-	if(lastTexture)
-		releaseCheck("lastTexture", lastTexture->Release());
-	lastTexture = NULL;
+	m_frameCapture.ReleaseEverything();
 
-	if(lastTexture1)
-		releaseCheck("lastTexture1", lastTexture1->Release());
-	lastTexture1 = NULL;
+	// owned by the swap chain back buffer
+	lastLeftImage = NULL;
+	lastRightImage = NULL;
+	m_bEyesSampledDirectly = false;
 
-	if(lastVertexDeclaration)
-		releaseCheck("lastVertexDeclaration", lastVertexDeclaration->Release());
-	lastVertexDeclaration = NULL;
-
-	if(lastRenderTarget0)
-		releaseCheck("lastRenderTarget0", lastRenderTarget0->Release());
-	lastRenderTarget0 = NULL;
-
-	if(lastRenderTarget1)
-		releaseCheck("lastRenderTarget1", lastRenderTarget1->Release());
-	lastRenderTarget1 = NULL;
-
-	viewEffect->OnLostDevice();
+	if (viewEffect)
+		viewEffect->OnLostDevice();
 
 	initialized = false;
 }
@@ -277,6 +249,8 @@ void StereoView::ReleaseEverything()
 ***/
 void StereoView::Draw(D3D9ProxySurface* stereoCapableSurface)
 {
+	PROFILE_SCOPE("StereoView::Draw");
+
 	// Copy left and right surfaces to textures to use as shader input
 	// TODO match aspect ratio of source in target ? 
 	IDirect3DSurface9* leftImage;
@@ -300,21 +274,64 @@ void StereoView::Draw(D3D9ProxySurface* stereoCapableSurface)
 		rightImage = stereoCapableSurface->getActualRight();
 	}
 	
-	m_pActualDevice->StretchRect(leftImage, NULL, leftSurface, NULL, D3DTEXF_NONE);
-	if (stereoCapableSurface->IsStereo())
-		m_pActualDevice->StretchRect(rightImage, NULL, rightSurface, NULL, D3DTEXF_NONE);
-	else
-		m_pActualDevice->StretchRect(leftImage, NULL, rightSurface, NULL, D3DTEXF_NONE);
+	if (!stereoCapableSurface->IsStereo())
+		rightImage = leftImage;
+
+	// Sample the eye back buffers directly if they are render target textures, else copy them to the eye textures
+	// (multisampled back buffer or format not supported as render target texture)
+	IDirect3DTexture9* leftInput = NULL;
+	IDirect3DTexture9* rightInput = NULL;
+	StereoBackBuffer* stereoBackBuffer = dynamic_cast<StereoBackBuffer*>(stereoCapableSurface);
+	if (stereoBackBuffer)
+	{
+		leftInput = stereoBackBuffer->getActualTexture(leftImage);
+		rightInput = stereoBackBuffer->getActualTexture(rightImage);
+	}
+
+	EyeInput eyeInput = m_eyeTextures.SelectInput(m_pActualDevice, backBufferDesc, (leftInput != NULL) && (rightInput != NULL));
+	m_bEyesSampledDirectly = (eyeInput == EYE_INPUT_DIRECT);
+	lastLeftImage = leftImage;
+	lastRightImage = rightImage;
+
+	// no eye textures to compose from, show the left image as it is (no stereo composition)
+	if (eyeInput == EYE_INPUT_BACK_BUFFER)
+	{
+		if (FAILED(m_pActualDevice->StretchRect(leftImage, NULL, backBuffer, NULL, D3DTEXF_NONE))) {
+			OutputDebugString("StretchRect backbuffer failed\n");
+		}
+		m_frameCapture.Update();
+		return;
+	}
+
+	if (eyeInput == EYE_INPUT_COPY)
+	{
+		m_pActualDevice->StretchRect(leftImage, NULL, m_eyeTextures.GetLeftSurface(), NULL, D3DTEXF_NONE);
+		m_pActualDevice->StretchRect(rightImage, NULL, m_eyeTextures.GetRightSurface(), NULL, D3DTEXF_NONE);
+		leftInput = m_eyeTextures.GetLeftTexture();
+		rightInput = m_eyeTextures.GetRightTexture();
+	}
 
 
 	// how to save (backup) render states ?	
 	switch(howToSaveRenderStates)
 	{
 	case HowToSaveRenderStates::STATE_BLOCK:
-		m_pActualDevice->CreateStateBlock(D3DSBT_ALL, &sb);
+		// recorded once, only captures the states changed below
+		if (!m_compositionStates.HasStateBlock())
+		{
+			RecordStateBlock();
+#ifdef _DEBUG
+			if (m_compositionStates.HasStateBlock())
+			{
+				m_pStateSnapshot = new StateSnapshot();
+				GetStateSnapshot(m_pStateSnapshot);
+			}
+#endif
+		}
+		m_compositionStates.CaptureStateBlock();
 		break;
 	case HowToSaveRenderStates::SELECTED_STATES_MANUALLY:
-		SaveState();
+		m_compositionStates.SaveSelectedStates();
 		break;
 	case HowToSaveRenderStates::ALL_STATES_MANUALLY:
 		SaveAllRenderStates(m_pActualDevice);
@@ -326,21 +343,19 @@ void StereoView::Draw(D3D9ProxySurface* stereoCapableSurface)
 	
 
 	// set states for fullscreen render
-	SetState();
+	m_compositionStates.SetFullscreenStates();
 
 	// all render settings start here
-	m_pActualDevice->SetFVF(D3DFVF_TEXVERTEX);
-	
 	// swap eyes
 	if(!config->swap_eyes)
 	{
-		m_pActualDevice->SetTexture(0, leftTexture);
-		m_pActualDevice->SetTexture(1, rightTexture);
+		m_pActualDevice->SetTexture(0, leftInput);
+		m_pActualDevice->SetTexture(1, rightInput);
 	}
 	else 
 	{
-		m_pActualDevice->SetTexture(0, rightTexture);
-		m_pActualDevice->SetTexture(1, leftTexture);		
+		m_pActualDevice->SetTexture(0, rightInput);
+		m_pActualDevice->SetTexture(1, leftInput);		
 	}
 	/*LPDIRECT3DSURFACE9 pZBuffer;
 	m_pActualDevice->GetDepthStencilSurface( &pZBuffer );*/
@@ -349,16 +364,10 @@ void StereoView::Draw(D3D9ProxySurface* stereoCapableSurface)
 		OutputDebugString("SetRenderTarget backbuffer failed\n");
 	}
 
-	if (FAILED(m_pActualDevice->SetStreamSource(0, screenVertexBuffer, 0, sizeof(TEXVERTEX)))) {
-		OutputDebugString("SetStreamSource failed\n");
-	}
+	SetViewGeometry();
 
 	UINT iPass, cPasses;
 
-	if (FAILED(viewEffect->SetTechnique("ViewShader"))) {
-		OutputDebugString("SetTechnique failed\n");
-	}
-
 	SetViewEffectInitialValues();
 
 	// now, render
@@ -372,9 +381,7 @@ void StereoView::Draw(D3D9ProxySurface* stereoCapableSurface)
 			OutputDebugString("Beginpass failed\n");
 		}
 
-		if (FAILED(m_pActualDevice->DrawPrimitive(D3DPT_TRIANGLEFAN, 0, 2))) {
-			OutputDebugString("Draw failed\n");
-		}		
+		DrawViewGeometry();
 
 		if (FAILED(viewEffect->EndPass())) {
 			OutputDebugString("Beginpass failed\n");
@@ -392,12 +399,16 @@ void StereoView::Draw(D3D9ProxySurface* stereoCapableSurface)
 	{
 	case HowToSaveRenderStates::STATE_BLOCK:
 		// apply stored render states
-		sb->Apply();
-		sb->Release();
-		sb = NULL;
+		m_compositionStates.ApplyStateBlock();
+		if (m_pStateSnapshot)
+		{
+			VerifyStateBlock(*m_pStateSnapshot);
+			delete m_pStateSnapshot;
+			m_pStateSnapshot = NULL;
+		}
 		break;
 	case HowToSaveRenderStates::SELECTED_STATES_MANUALLY:
-		RestoreState();
+		m_compositionStates.RestoreSelectedStates();
 		break;
 	case HowToSaveRenderStates::ALL_STATES_MANUALLY:
 		RestoreAllRenderStates(m_pActualDevice);
@@ -406,6 +417,10 @@ void StereoView::Draw(D3D9ProxySurface* stereoCapableSurface)
 		break;
 	}
 
+	// capture both eyes if bursting, read back earlier captures
+	if (m_frameCapture.IsBurstActive())
+		m_frameCapture.CaptureBurstFrame(leftImage, rightImage);
+	m_frameCapture.Update();
 }
 
 void StereoView::SaveLastScreen()
@@ -415,27 +430,16 @@ void StereoView::SaveLastScreen()
 
 /**
 * Saves screenshot and shot of left and right surface.
+* Written asynchronously some frames later, @see FrameCapture.
 ***/
 void StereoView::SaveScreen()
 {
-	static int screenCount = 0;
-	++screenCount;
-
-	char fileName[32];
-	wsprintf(fileName, "%d_final.bmp", screenCount);
-	char fileNameLeft[32];
-	wsprintf(fileNameLeft, "%d_left.bmp", screenCount);
-	char fileNameRight[32];
-	wsprintf(fileNameRight, "%d_right.bmp", screenCount);
-
-#ifdef _DEBUG
-	OutputDebugString(fileName);
-	OutputDebugString("\n");
-#endif	
-
-	D3DXSaveSurfaceToFile(fileNameLeft, D3DXIFF_BMP, leftSurface, NULL, NULL);
-	D3DXSaveSurfaceToFile(fileNameRight, D3DXIFF_BMP, rightSurface, NULL, NULL);
-	D3DXSaveSurfaceToFile(fileName, D3DXIFF_BMP, backBuffer, NULL, NULL);
+	// eye textures are not updated while sampling the eye back buffers directly, capture last frame eye images
+	// (screenshots are saved before the first clear of the frame)
+	if (m_bEyesSampledDirectly && lastLeftImage && lastRightImage)
+		m_frameCapture.CaptureScreen(lastLeftImage, lastRightImage, backBuffer);
+	else if (m_eyeTextures.GetLeftSurface() && m_eyeTextures.GetRightSurface())
+		m_frameCapture.CaptureScreen(m_eyeTextures.GetLeftSurface(), m_eyeTextures.GetRightSurface(), backBuffer);
 }
 
 IDirect3DSurface9* StereoView::GetBackBuffer()
@@ -453,29 +457,23 @@ void StereoView::PostReset()
 }
 
 /**
-* Inits the left and right texture buffer.
-* Also gets viewport data and back buffer render target.
+* Gets viewport data and back buffer render target.
+* The left and right texture buffers are created on first use (@see EyeTextures), they are not needed
+* while the eye back buffers are sampled directly.
 ***/
 void StereoView::InitTextureBuffers()
 {
 	m_pActualDevice->GetViewport(&viewport);
-	D3DSURFACE_DESC pDesc = D3DSURFACE_DESC();
 	m_pActualDevice->GetBackBuffer(0, 0, D3DBACKBUFFER_TYPE_MONO, &backBuffer);
-	backBuffer->GetDesc(&pDesc);
+	backBuffer->GetDesc(&backBufferDesc);
 
 #ifdef _DEBUG
 	debugf("viewport width: %d",viewport.Width);
 	OutputDebugString("\n");
 
-	debugf("backbuffer width: %d",pDesc.Width);
+	debugf("backbuffer width: %d",backBufferDesc.Width);
 	OutputDebugString("\n");
 #endif
-
-	m_pActualDevice->CreateTexture(pDesc.Width, pDesc.Height, 0, D3DUSAGE_RENDERTARGET, pDesc.Format, D3DPOOL_DEFAULT, &leftTexture, NULL);
-	leftTexture->GetSurfaceLevel(0, &leftSurface);
-
-	m_pActualDevice->CreateTexture(pDesc.Width, pDesc.Height, 0, D3DUSAGE_RENDERTARGET, pDesc.Format, D3DPOOL_DEFAULT, &rightTexture, NULL);
-	rightTexture->GetSurfaceLevel(0, &rightSurface);
 }
 
 /**
@@ -485,8 +483,10 @@ void StereoView::InitVertexBuffers()
 {
 	OutputDebugString("SteroView initVertexBuffers\n");
 
-	m_pActualDevice->CreateVertexBuffer(sizeof(TEXVERTEX) * 4, NULL,
-		D3DFVF_TEXVERTEX, D3DPOOL_MANAGED, &screenVertexBuffer, NULL);
+	// managed, kept over device resets (vertices are set again, the viewport may have changed)
+	if (!screenVertexBuffer)
+		m_pActualDevice->CreateVertexBuffer(sizeof(TEXVERTEX) * 4, NULL,
+			D3DFVF_TEXVERTEX, D3DPOOL_MANAGED, &screenVertexBuffer, NULL);
 
 	TEXVERTEX* vertices;
 
@@ -554,11 +554,46 @@ void StereoView::InitShaderEffects()
 
 	std::string viewPath = helper.GetPath("fx\\") + shaderEffect[config->stereo_mode];
 
-	if (FAILED(D3DXCreateEffectFromFile(m_pActualDevice, viewPath.c_str(), NULL, NULL, D3DXFX_DONOTSAVESTATE, NULL, &viewEffect, NULL))) {
+	// kept over device resets (lost and restored), loaded again (from the effect cache) if the file changed
+	if (viewEffect && (viewEffectPath == viewPath))
+		return;
+
+	if (viewEffect)
+		viewEffect->Release();
+	viewEffect = NULL;
+	viewEffectPath = viewPath;
+
+	if (FAILED(EffectCache::CreateEffectFromFile(m_pActualDevice, viewPath, NULL, 0, D3DXFX_DONOTSAVESTATE, &viewEffect))) {
 		OutputDebugString("Effect creation failed\n");
 	}
 }
 
+/**
+* Sets vertex format, stream source and technique of the view effect for the fullscreen render.
+***/
+void StereoView::SetViewGeometry()
+{
+	m_pActualDevice->SetFVF(D3DFVF_TEXVERTEX);
+
+	if (FAILED(m_pActualDevice->SetStreamSource(0, screenVertexBuffer, 0, sizeof(TEXVERTEX)))) {
+		OutputDebugString("SetStreamSource failed\n");
+	}
+
+	if (FAILED(viewEffect->SetTechnique("ViewShader"))) {
+		OutputDebugString("SetTechnique failed\n");
+	}
+}
+
+/**
+* Draws the fullscreen quad, called for each pass of the view effect.
+***/
+void StereoView::DrawViewGeometry()
+{
+	if (FAILED(m_pActualDevice->DrawPrimitive(D3DPT_TRIANGLEFAN, 0, 2))) {
+		OutputDebugString("Draw failed\n");
+	}
+}
+
 /**
 * Empty in parent class.
 ***/
@@ -575,187 +610,182 @@ void StereoView::PostViewEffectCleanup()
 void StereoView::CalculateShaderVariables() {} 
 
 /**
-* Workaround for Half Life 2 for now.
+* Records the state block used to save and restore render states (STATE_BLOCK).
+* Records the device states set for the fullscreen render with plain state setting calls only (no effect
+* passes, no resource locks) : fullscreen states, eye textures, geometry and the states of the view effect shaders.
+* Capturing and applying that block each frame is far cheaper than creating a D3DSBT_ALL block.
+* Recorded values don't matter, the block is captured before each draw.
 ***/
-void StereoView::SaveState()
+void StereoView::RecordStateBlock()
 {
-	m_pActualDevice->GetTextureStageState(0, D3DTSS_COLOROP, &tssColorOp);
-	m_pActualDevice->GetTextureStageState(0, D3DTSS_COLORARG1, &tssColorArg1);
-	m_pActualDevice->GetTextureStageState(0, D3DTSS_ALPHAOP, &tssAlphaOp);
-	m_pActualDevice->GetTextureStageState(0, D3DTSS_ALPHAARG1, &tssAlphaArg1);
-	m_pActualDevice->GetTextureStageState(0, D3DTSS_CONSTANT, &tssConstant);
-
-	m_pActualDevice->GetRenderState(D3DRS_ALPHABLENDENABLE, &rsAlphaEnable);
-	m_pActualDevice->GetRenderState(D3DRS_ZWRITEENABLE, &rsZWriteEnable);
-	m_pActualDevice->GetRenderState(D3DRS_ZENABLE, &rsZEnable);
-	m_pActualDevice->GetRenderState(D3DRS_SRGBWRITEENABLE, &rsSrgbEnable);
-
-	m_pActualDevice->GetSamplerState(0, D3DSAMP_SRGBTEXTURE, &ssSrgb);
-	m_pActualDevice->GetSamplerState(1, D3DSAMP_SRGBTEXTURE, &ssSrgb1);
-	
-	m_pActualDevice->GetSamplerState(0, D3DSAMP_ADDRESSU, &ssAddressU);
-	m_pActualDevice->GetSamplerState(0, D3DSAMP_ADDRESSV, &ssAddressV);
-	m_pActualDevice->GetSamplerState(0, D3DSAMP_ADDRESSW, &ssAddressW);
-
-	m_pActualDevice->GetSamplerState(0, D3DSAMP_MAGFILTER, &ssMag0);
-	m_pActualDevice->GetSamplerState(1, D3DSAMP_MAGFILTER, &ssMag1);
-	m_pActualDevice->GetSamplerState(0, D3DSAMP_MINFILTER, &ssMin0);
-	m_pActualDevice->GetSamplerState(1, D3DSAMP_MINFILTER, &ssMin1);
-	m_pActualDevice->GetSamplerState(0, D3DSAMP_MIPFILTER, &ssMip0);
-	m_pActualDevice->GetSamplerState(1, D3DSAMP_MIPFILTER, &ssMip1);
+	if (!m_compositionStates.BeginRecord())
+		return;
 
-	m_pActualDevice->GetTexture(0, &lastTexture);
-	m_pActualDevice->GetTexture(1, &lastTexture1);
+	m_pActualDevice->SetTexture(0, m_eyeTextures.GetLeftTexture());
+	m_pActualDevice->SetTexture(1, m_eyeTextures.GetRightTexture());
 
-	m_pActualDevice->GetVertexShader(&lastVertexShader);
-	m_pActualDevice->GetPixelShader(&lastPixelShader);
+	// fullscreen quad or distortion mesh, same states (the index buffer is restored by the mesh draw)
+	m_pActualDevice->SetFVF(D3DFVF_TEXVERTEX);
+	m_pActualDevice->SetStreamSource(0, screenVertexBuffer, 0, sizeof(TEXVERTEX));
 
-	m_pActualDevice->GetVertexDeclaration(&lastVertexDeclaration);
+	RecordViewEffectStates();
 
-	m_pActualDevice->GetRenderTarget(0, &lastRenderTarget0);
-	m_pActualDevice->GetRenderTarget(1, &lastRenderTarget1);
+	m_compositionStates.EndRecord();
 }
 
 /**
-* Set all states and settings for fullscreen render.
-* Also sets identity world, view and projection matrix. 
+* Records the shader constants, textures and sampler states used by the view effect shaders (all techniques),
+* read from the shader constant tables. Shaders themselves are recorded by CompositionStates::SetFullscreenStates().
 ***/
-void StereoView::SetState()
+void StereoView::RecordViewEffectStates()
 {
-	D3DXMATRIX	identity;
-	m_pActualDevice->SetTransform(D3DTS_WORLD, D3DXMatrixIdentity(&identity));
-	m_pActualDevice->SetTransform(D3DTS_VIEW, &identity);
-	m_pActualDevice->SetTransform(D3DTS_PROJECTION, &identity);
-	m_pActualDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
-	m_pActualDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
-	m_pActualDevice->SetRenderState(D3DRS_ZENABLE,  D3DZB_TRUE);
-	m_pActualDevice->SetRenderState(D3DRS_ZWRITEENABLE, TRUE);
-	m_pActualDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, FALSE);
-	m_pActualDevice->SetRenderState(D3DRS_ALPHATESTENABLE, FALSE);// This fixed interior or car not being drawn in rFactor
-	m_pActualDevice->SetRenderState(D3DRS_STENCILENABLE, FALSE); 
-
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_ALPHAARG1, D3DTA_CONSTANT);
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_CONSTANT, 0xffffffff);
-
-	m_pActualDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, FALSE);
-	m_pActualDevice->SetRenderState(D3DRS_ZENABLE, D3DZB_TRUE);
-	m_pActualDevice->SetRenderState(D3DRS_ZWRITEENABLE, TRUE);
-	m_pActualDevice->SetRenderState(D3DRS_ALPHATESTENABLE, FALSE);  
+	static const D3DSAMPLERSTATETYPE samplerStates[] = {D3DSAMP_ADDRESSU, D3DSAMP_ADDRESSV, D3DSAMP_ADDRESSW, 
+		D3DSAMP_MAGFILTER, D3DSAMP_MINFILTER, D3DSAMP_MIPFILTER, D3DSAMP_SRGBTEXTURE};
 
-	int value = 0;
-	if (ProxyHelper::ParseGameType(config->game_type, ProxyHelper::DeviceStateFlags, value) && (value & 2))
+	D3DXEFFECT_DESC effectDesc;
+	if (!viewEffect || FAILED(viewEffect->GetDesc(&effectDesc)))
+		return;
+
+	for (UINT technique = 0; technique < effectDesc.Techniques; technique++)
 	{
-		m_pActualDevice->SetSamplerState(0, D3DSAMP_SRGBTEXTURE, ssSrgb);
-		m_pActualDevice->SetSamplerState(1, D3DSAMP_SRGBTEXTURE, ssSrgb);
+		D3DXHANDLE hTechnique = viewEffect->GetTechnique(technique);
+		D3DXTECHNIQUE_DESC techniqueDesc;
+		if (FAILED(viewEffect->GetTechniqueDesc(hTechnique, &techniqueDesc)))
+			continue;
+
+		for (UINT pass = 0; pass < techniqueDesc.Passes; pass++)
+		{
+			D3DXPASS_DESC passDesc;
+			if (FAILED(viewEffect->GetPassDesc(viewEffect->GetPass(hTechnique, pass), &passDesc)))
+				continue;
+
+			for (int shader = 0; shader < 2; shader++)
+			{
+				bool pixelShader = (shader == 1);
+				ID3DXConstantTable* pTable = NULL;
+				if (FAILED(D3DXGetShaderConstantTable(pixelShader ? passDesc.pPixelShaderFunction : passDesc.pVertexShaderFunction, &pTable)))
+					continue;
+
+				D3DXCONSTANTTABLE_DESC tableDesc;
+				pTable->GetDesc(&tableDesc);
+				for (UINT i = 0; i < tableDesc.Constants; i++)
+				{
+					D3DXCONSTANT_DESC desc;
+					UINT count = 1;
+					if (FAILED(pTable->GetConstantDesc(pTable->GetConstant(NULL, i), &desc, &count)))
+						continue;
+
+					// four values per register at most (float4, int4)
+					std::vector<float> values(desc.RegisterCount * 4, 0.0f);
+					switch (desc.RegisterSet)
+					{
+					case D3DXRS_FLOAT4:
+						if (pixelShader)
+							m_pActualDevice->SetPixelShaderConstantF(desc.RegisterIndex, &values[0], desc.RegisterCount);
+						else
+							m_pActualDevice->SetVertexShaderConstantF(desc.RegisterIndex, &values[0], desc.RegisterCount);
+						break;
+					case D3DXRS_INT4:
+						if (pixelShader)
+							m_pActualDevice->SetPixelShaderConstantI(desc.RegisterIndex, (int*)&values[0], desc.RegisterCount);
+						else
+							m_pActualDevice->SetVertexShaderConstantI(desc.RegisterIndex, (int*)&values[0], desc.RegisterCount);
+						break;
+					case D3DXRS_BOOL:
+						if (pixelShader)
+							m_pActualDevice->SetPixelShaderConstantB(desc.RegisterIndex, (BOOL*)&values[0], desc.RegisterCount);
+						else
+							m_pActualDevice->SetVertexShaderConstantB(desc.RegisterIndex, (BOOL*)&values[0], desc.RegisterCount);
+						break;
+					case D3DXRS_SAMPLER:
+						for (UINT r = 0; r < desc.RegisterCount; r++)
+						{
+							DWORD sampler = (pixelShader ? 0 : D3DVERTEXTEXTURESAMPLER0) + desc.RegisterIndex + r;
+							m_pActualDevice->SetTexture(sampler, NULL);
+							for (int s = 0; s < sizeof(samplerStates) / sizeof(samplerStates[0]); s++)
+								m_pActualDevice->SetSamplerState(sampler, samplerStates[s], 0);
+						}
+						break;
+					}
+				}
+				pTable->Release();
+			}
+		}
 	}
-	else
+}
+
+/**
+* Reads the device states changed by the fullscreen render.
+* @see VerifyStateBlock()
+***/
+void StereoView::GetStateSnapshot(StateSnapshot* pSnapshot)
+{
+	ZeroMemory(pSnapshot, sizeof(StateSnapshot));
+
+	SaveAllRenderStates(m_pActualDevice);
+	memcpy(pSnapshot->renderStates, renderStates, sizeof(pSnapshot->renderStates));
+
+	for (DWORD type = D3DTSS_COLOROP; type <= D3DTSS_CONSTANT; type++)
+		m_pActualDevice->GetTextureStageState(0, (D3DTEXTURESTAGESTATETYPE)type, &pSnapshot->textureStageStates[type]);
+
+	// only pointers are compared, the device keeps the objects bound
+	for (DWORD sampler = 0; sampler < 3; sampler++)
 	{
-		//Borderlands Dark Eye FIX
-		m_pActualDevice->SetSamplerState(0, D3DSAMP_SRGBTEXTURE, 0);
-		m_pActualDevice->SetSamplerState(1, D3DSAMP_SRGBTEXTURE, 0);
+		for (DWORD type = D3DSAMP_ADDRESSU; type <= D3DSAMP_DMAPOFFSET; type++)
+			m_pActualDevice->GetSamplerState(sampler, (D3DSAMPLERSTATETYPE)type, &pSnapshot->samplerStates[sampler][type]);
+		m_pActualDevice->GetTexture(sampler, &pSnapshot->textures[sampler]);
+		if (pSnapshot->textures[sampler])
+			pSnapshot->textures[sampler]->Release();
 	}
-	
 
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSU, D3DTADDRESS_CLAMP);
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSV, D3DTADDRESS_CLAMP);
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSW, D3DTADDRESS_CLAMP);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_ADDRESSU, D3DTADDRESS_CLAMP);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_ADDRESSV, D3DTADDRESS_CLAMP);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_ADDRESSW, D3DTADDRESS_CLAMP);
-
-	// TODO Need to check m_pActualDevice capabilities if we want a prefered order of fallback rather than 
-	// whatever the default is being used when a mode isn't supported.
-	// Example - GeForce 660 doesn't appear to support D3DTEXF_ANISOTROPIC on the MAGFILTER (at least
-	// according to the spam of error messages when running with the directx debug runtime)
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_ANISOTROPIC);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_MAGFILTER, D3DTEXF_ANISOTROPIC);
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_ANISOTROPIC);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_MINFILTER, D3DTEXF_ANISOTROPIC);
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_NONE);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_MIPFILTER, D3DTEXF_NONE);
-
-	//m_pActualDevice->SetTexture(0, NULL);
-	//m_pActualDevice->SetTexture(1, NULL);
-
-	m_pActualDevice->SetVertexShader(NULL);
-	m_pActualDevice->SetPixelShader(NULL);
-
-	m_pActualDevice->SetVertexDeclaration(NULL);
-
-	//It's a Direct3D9 error when using the debug runtine to set RenderTarget 0 to NULL
-	//m_pActualDevice->SetRenderTarget(0, NULL);
-	m_pActualDevice->SetRenderTarget(1, NULL);
-	m_pActualDevice->SetRenderTarget(2, NULL);
-	m_pActualDevice->SetRenderTarget(3, NULL);
+	m_pActualDevice->GetVertexShader(&pSnapshot->vertexShader);
+	if (pSnapshot->vertexShader)
+		pSnapshot->vertexShader->Release();
+	m_pActualDevice->GetPixelShader(&pSnapshot->pixelShader);
+	if (pSnapshot->pixelShader)
+		pSnapshot->pixelShader->Release();
+	m_pActualDevice->GetVertexDeclaration(&pSnapshot->vertexDeclaration);
+	if (pSnapshot->vertexDeclaration)
+		pSnapshot->vertexDeclaration->Release();
+	m_pActualDevice->GetFVF(&pSnapshot->fvf);
+	m_pActualDevice->GetStreamSource(0, &pSnapshot->streamSource, &pSnapshot->streamOffset, &pSnapshot->streamStride);
+	if (pSnapshot->streamSource)
+		pSnapshot->streamSource->Release();
+
+	m_pActualDevice->GetTransform(D3DTS_WORLD, &pSnapshot->transforms[0]);
+	m_pActualDevice->GetTransform(D3DTS_VIEW, &pSnapshot->transforms[1]);
+	m_pActualDevice->GetTransform(D3DTS_PROJECTION, &pSnapshot->transforms[2]);
+	m_pActualDevice->GetPixelShaderConstantF(0, &pSnapshot->pixelShaderConstants[0][0], 32);
 }
 
 /**
-* Workaround for Half Life 2 for now.
+* Compares the device states after the recorded state block is applied with the states read before the
+* draw, the states a D3DSBT_ALL block (as created each frame before) restores. Reports any state the
+* recorded block misses.
 ***/
-void StereoView::RestoreState()
+void StereoView::VerifyStateBlock(const StateSnapshot& before)
 {
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_COLOROP, tssColorOp);
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_COLORARG1, tssColorArg1);
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, tssAlphaOp);
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_ALPHAARG1, tssAlphaArg1);
-	m_pActualDevice->SetTextureStageState(0, D3DTSS_CONSTANT, tssConstant);
-
-	m_pActualDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, rsAlphaEnable);
-	m_pActualDevice->SetRenderState(D3DRS_ZWRITEENABLE, rsZWriteEnable);
-	m_pActualDevice->SetRenderState(D3DRS_ZENABLE, rsZEnable);
-	m_pActualDevice->SetRenderState(D3DRS_SRGBWRITEENABLE, rsSrgbEnable);
-
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_SRGBTEXTURE, ssSrgb);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_SRGBTEXTURE, ssSrgb1);
-
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSU, ssAddressU);
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSV, ssAddressV);
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_ADDRESSW, ssAddressW);
-
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, ssMag0);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_MAGFILTER, ssMag1);
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_MINFILTER, ssMin0);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_MINFILTER, ssMin1);
-	m_pActualDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, ssMip0);
-	m_pActualDevice->SetSamplerState(1, D3DSAMP_MIPFILTER, ssMip1);
-
-	m_pActualDevice->SetTexture(0, lastTexture);
-	if(lastTexture != NULL)
-		lastTexture->Release();
-	lastTexture = NULL;
-
-	m_pActualDevice->SetTexture(1, lastTexture1);
-	if(lastTexture1 != NULL)
-		lastTexture1->Release();
-	lastTexture1 = NULL;
-
-	m_pActualDevice->SetVertexShader(lastVertexShader);
-	if(lastVertexShader != NULL)
-		lastVertexShader->Release();
-	lastVertexShader = NULL;
-
-	m_pActualDevice->SetPixelShader(lastPixelShader);
-	if(lastPixelShader != NULL)
-		lastPixelShader->Release();
-	lastPixelShader = NULL;
-
-	m_pActualDevice->SetVertexDeclaration(lastVertexDeclaration);
-	if(lastVertexDeclaration != NULL)
-		lastVertexDeclaration->Release();
-	lastVertexDeclaration = NULL;
-
-	m_pActualDevice->SetRenderTarget(0, lastRenderTarget0);
-	if(lastRenderTarget0 != NULL)
-		lastRenderTarget0->Release();
-	lastRenderTarget0 = NULL;
-
-	m_pActualDevice->SetRenderTarget(1, lastRenderTarget1);
-	if(lastRenderTarget1 != NULL)
-		lastRenderTarget1->Release();
-	lastRenderTarget1 = NULL;
+	StateSnapshot after;
+	GetStateSnapshot(&after);
+
+	if (memcmp(before.renderStates, after.renderStates, sizeof(before.renderStates)) != 0)
+		OutputDebugString("StereoView : State block does not restore the render states\n");
+	if (memcmp(before.textureStageStates, after.textureStageStates, sizeof(before.textureStageStates)) != 0)
+		OutputDebugString("StereoView : State block does not restore the texture stage states\n");
+	if (memcmp(before.samplerStates, after.samplerStates, sizeof(before.samplerStates)) != 0)
+		OutputDebugString("StereoView : State block does not restore the sampler states\n");
+	if (memcmp(before.textures, after.textures, sizeof(before.textures)) != 0)
+		OutputDebugString("StereoView : State block does not restore the textures\n");
+	if ((before.vertexShader != after.vertexShader) || (before.pixelShader != after.pixelShader))
+		OutputDebugString("StereoView : State block does not restore the shaders\n");
+	if ((before.vertexDeclaration != after.vertexDeclaration) || (before.fvf != after.fvf))
+		OutputDebugString("StereoView : State block does not restore the vertex declaration\n");
+	if ((before.streamSource != after.streamSource) || (before.streamOffset != after.streamOffset) || (before.streamStride != after.streamStride))
+		OutputDebugString("StereoView : State block does not restore the stream source\n");
+	if (memcmp(before.transforms, after.transforms, sizeof(before.transforms)) != 0)
+		OutputDebugString("StereoView : State block does not restore the transforms\n");
+	if (memcmp(before.pixelShaderConstants, after.pixelShaderConstants, sizeof(before.pixelShaderConstants)) != 0)
+		OutputDebugString("StereoView : State block does not restore the pixel shader constants\n");
 }
 
 /**
@@ -32,6 +32,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "ProxyHelper.h"
 #include "D3DProxyDevice.h"
+#include "Reprojection.h"
+#include "FrameCapture.h"
+#include "EyeTextures.h"
+#include "CompositionStates.h"
+#include "EffectCache.h"
 #include <d3d9.h>
 #include <d3dx9.h>
 #include <map>
@@ -156,6 +161,12 @@ public:
 	//The amount of rotation to apply if using pixel shader implementation of roll
 	float m_rotation;
 
+	//Late latched rotational reprojection for this frame (identity if not used or not supported by the view)
+	ReprojectionWarp m_reprojection;
+
+	//Screenshot and burst capture (asynchronous)
+	FrameCapture m_frameCapture;
+
 	//DK2 black smear correction (0.0f if disabled)
 	float m_blackSmearCorrection;		
 
@@ -169,16 +180,41 @@ public:
 	bool m_bZBufferVisualisationMode;
 
 protected:
+	/**
+	* Device states changed by the fullscreen render.
+	* Read before the first draw with a new state block and compared after the block is applied (debug builds).
+	* @see VerifyStateBlock()
+	***/
+	struct StateSnapshot
+	{
+		DWORD renderStates[256];
+		DWORD textureStageStates[D3DTSS_CONSTANT + 1];
+		DWORD samplerStates[3][D3DSAMP_DMAPOFFSET + 1];
+		IDirect3DBaseTexture9* textures[3];
+		IDirect3DVertexShader9* vertexShader;
+		IDirect3DPixelShader9* pixelShader;
+		IDirect3DVertexDeclaration9* vertexDeclaration;
+		DWORD fvf;
+		IDirect3DVertexBuffer9* streamSource;
+		UINT streamOffset;
+		UINT streamStride;
+		D3DMATRIX transforms[3];
+		float pixelShaderConstants[32][4];
+	};
+
 	/*** StereoView protected methods ***/
 	virtual void InitTextureBuffers();
 	virtual void InitVertexBuffers();
 	virtual void InitShaderEffects();
+	virtual void SetViewGeometry();
+	virtual void DrawViewGeometry();
 	virtual void SetViewEffectInitialValues(); 
 	virtual void PostViewEffectCleanup(); 
 	virtual void CalculateShaderVariables();
-	virtual void SaveState();
-	virtual void SetState();
-	virtual void RestoreState();
+	virtual void RecordStateBlock();
+	virtual void RecordViewEffectStates();
+	void GetStateSnapshot(StateSnapshot* pSnapshot);
+	void VerifyStateBlock(const StateSnapshot& before);
 	virtual void SaveAllRenderStates(LPDIRECT3DDEVICE9 pDevice);
 	virtual void SetAllRenderStatesDefault(LPDIRECT3DDEVICE9 pDevice);
 	virtual void RestoreAllRenderStates(LPDIRECT3DDEVICE9 pDevice);
@@ -191,101 +227,67 @@ protected:
 	***/
 	IDirect3DDevice9* m_pActualDevice;
 	/**
-	* Saved game vertex shader to be restored after drawing stereoscopic.
-	***/
-	IDirect3DVertexShader9* lastVertexShader;
-	/**
-	* Saved game pixel shader to be restored after drawing stereoscopic.
-	***/
-	IDirect3DPixelShader9* lastPixelShader;
-	/**
-	* Saved game texture 0 to be restored after drawing stereoscopic.
-	***/
-	IDirect3DBaseTexture9* lastTexture;
-	/**
-	* Saved game texture 1 to be restored after drawing stereoscopic.
+	* Left and right target texture buffers.
+	* Surface data from D3D9ProxySurface is copied on these. To be swapped if swap_eyes set to true.
+	* Created on the first copy, not created as long as the eye back buffers are sampled directly.
 	***/
-	IDirect3DBaseTexture9* lastTexture1;
+	EyeTextures m_eyeTextures;
 	/**
-	* Saved game vertex declaration to be restored after drawing stereoscopic.
+	* Left eye image drawn last frame (actual back buffer surface, not referenced).
 	***/
-	IDirect3DVertexDeclaration9* lastVertexDeclaration;
+	IDirect3DSurface9* lastLeftImage;
 	/**
-	* Saved game render target 0 to be restored after drawing stereoscopic.
+	* Right eye image drawn last frame (actual back buffer surface, not referenced).
 	***/
-	IDirect3DSurface9* lastRenderTarget0;
+	IDirect3DSurface9* lastRightImage;
 	/**
-	* Saved game render target 1 to be restored after drawing stereoscopic.
+	* True if the eye back buffers were sampled directly last frame (eye textures not updated).
 	***/
-	IDirect3DSurface9* lastRenderTarget1;
-	/**
-	* Left eye (or upper) target texture buffer.
-	* Surface data from D3D9ProxySurface is copied on that. To be swapped with right texture if swap_eyes set to true.
-	***/
-	IDirect3DTexture9* leftTexture;
-	/**
-	* Right eye (or lower) target texture buffer.
-	* Surface data from D3D9ProxySurface is copied on that. To be swapped with left texture if swap_eyes set to true.
-	***/
-	IDirect3DTexture9* rightTexture;
+	bool m_bEyesSampledDirectly;
 	/**
 	* Current render target.
 	***/
 	IDirect3DSurface9* backBuffer;
 	/**
-	* Surface of the left eye texture.
-	***/
-	IDirect3DSurface9* leftSurface;
-	/**
-	* Surface of the right eye texture.
+	* Description of the back buffer, same size and format as the eye textures and eye back buffers.
 	***/
-	IDirect3DSurface9* rightSurface;
+	D3DSURFACE_DESC backBufferDesc;
 	/**
 	* Full screen render vertex buffer containing 4 vertices.
 	***/
 	IDirect3DVertexBuffer9* screenVertexBuffer;
 	/**
-	* Render state block.
-	* Stores all render states to be restored after drawing stereoscopic.
-	* To be renamed.
+	* Fullscreen render states, saved and restored game states.
+	* @see RecordStateBlock()
 	***/
-	IDirect3DStateBlock9* sb;
+	CompositionStates m_compositionStates;
+	/**
+	* States read before the first draw with a new state block (debug builds), NULL once verified.
+	***/
+	StateSnapshot* m_pStateSnapshot;
 	/**
 	* Stores render states.
 	* For games (Half Life 2?) that do not work with direct 3d state block for some reason.
 	***/
 	DWORD renderStates[256];
 	/**
+	* Device state flags of the game type, parsed once in constructor.
+	* @see ProxyHelper::DeviceStateFlags
+	***/
+	int m_deviceStateFlags;
+	/**
 	* View effect according to the stereo mode preset in stereo_mode.
 	***/
 	ID3DXEffect* viewEffect;
+	/**
+	* File the view effect was loaded from, the effect is kept over device resets while the file is the same.
+	***/
+	std::string viewEffectPath;
 	
 	/**
 	* Map of the shader effect file names.
 	***/
 	std::map<int, std::string> shaderEffect;
-	DWORD tssColorOp;            /**< Various states. */
-	DWORD tssColorArg1;          /**< Various states. */
-	DWORD tssAlphaOp;            /**< Various states. */
-	DWORD tssAlphaArg1;          /**< Various states. */
-	DWORD tssConstant;           /**< Various states. */
-	DWORD rsAlphaEnable;         /**< Various states. */
-	DWORD rsZEnable;             /**< Various states. */
-	DWORD rsZWriteEnable;        /**< Various states. */
-	DWORD rsDepthBias;           /**< Various states. */
-	DWORD rsSlopeScaleDepthBias; /**< Various states. */
-	DWORD rsSrgbEnable;          /**< Various states. */
-	DWORD ssSrgb;                /**< Various states. */  
-	DWORD ssSrgb1;               /**< Various states. */
-	DWORD ssAddressU;            /**< Various states. */
-	DWORD ssAddressV;            /**< Various states. */
-	DWORD ssAddressW;            /**< Various states. */
-	DWORD ssMag0;                /**< Various states. */
-	DWORD ssMag1;                /**< Various states. */
-	DWORD ssMin0;                /**< Various states. */
-	DWORD ssMin1;                /**< Various states. */
-	DWORD ssMip0;                /**< Various states. */
-	DWORD ssMip1;                /**< Various states. */
 	/**
 	* Determines how to save render states for stereo view output.
 	***/
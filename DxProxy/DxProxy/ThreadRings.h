@@ -0,0 +1,171 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ThreadRings.h> and
+Class <ThreadRings> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+
+#ifndef THREADRINGS_H_INCLUDED
+#define THREADRINGS_H_INCLUDED
+
+#include <windows.h>
+
+/**
+* Ring buffer of one thread (single producer, single consumer, no locks).
+* Written by the owning thread only, read by one consumer at a time only.
+* @param T Item type.
+* @param size Items per ring (power of two).
+*/
+template <class T, ULONG size> struct ThreadRing
+{
+	DWORD threadId;
+	volatile ULONG writeIndex;
+	volatile ULONG readIndex;
+	T items[size];
+
+	/**
+	* Returns the slot of the next item, NULL if the ring is full (owning thread only).
+	***/
+	T* BeginWrite()
+	{
+		ULONG write = writeIndex;
+		if (write - readIndex >= size)
+			return NULL;
+		return &items[write & (size - 1)];
+	}
+
+	/**
+	* Publishes the item written to the slot of BeginWrite() (owning thread only).
+	***/
+	void EndWrite()
+	{
+		// volatile write, release
+		writeIndex = writeIndex + 1;
+	}
+
+	/**
+	* Reads all items written since the last drain and frees their slots (consumer only).
+	* @param read Called as read(threadId, item) for each item, oldest first.
+	***/
+	template <class Reader> void Drain(Reader& read)
+	{
+		ULONG write = writeIndex;
+		for (ULONG index = readIndex; index != write; index++)
+			read(threadId, items[index & (size - 1)]);
+
+		// free the slots (volatile write, release)
+		readIndex = write;
+	}
+};
+
+/**
+* Thread ring registry.
+* Each thread gets its own ring on first use (thread local storage), rings are kept for the process
+* lifetime. Threads beyond maxThreads get no ring.
+* Only for objects of static storage duration : the rings and their count are zeroed before any
+* constructor runs, so threads writing during static initialisation keep their rings.
+* @param T Item type.
+* @param size Items per ring (power of two).
+* @param maxThreads Maximum number of rings.
+*/
+template <class T, ULONG size, LONG maxThreads> class ThreadRings
+{
+public:
+	typedef ThreadRing<T, size> Ring;
+
+	ThreadRings() : m_tlsIndex(TlsAlloc()) {}
+
+	/*** ThreadRings public methods ***/
+
+	/**
+	* Returns the ring of the calling thread, registers a new ring on first use.
+	* @return NULL if there are too many threads (or no thread local storage).
+	***/
+	Ring* Get()
+	{
+		if (m_tlsIndex == TLS_OUT_OF_INDEXES)
+			return NULL;
+
+		LPVOID pValue = TlsGetValue(m_tlsIndex);
+		if (pValue == NoRing())
+			return NULL;
+		if (pValue)
+			return (Ring*)pValue;
+
+		LONG slot = InterlockedIncrement(&m_ringCount) - 1;
+		if (slot >= maxThreads)
+		{
+			TlsSetValue(m_tlsIndex, NoRing());
+			return NULL;
+		}
+
+		Ring* pRing = new Ring();
+		pRing->threadId = GetCurrentThreadId();
+		pRing->writeIndex = 0;
+		pRing->readIndex = 0;
+		m_rings[slot] = pRing;
+		TlsSetValue(m_tlsIndex, pRing);
+		return pRing;
+	}
+
+	/**
+	* Drains the rings of all threads, ring by ring (consumer only).
+	* @param read Called as read(threadId, item) for each item.
+	***/
+	template <class Reader> void DrainAll(Reader read)
+	{
+		LONG ringCount = m_ringCount;
+		if (ringCount > maxThreads)
+			ringCount = maxThreads;
+
+		for (LONG i = 0; i < ringCount; i++)
+		{
+			// registered but not yet published
+			Ring* pRing = m_rings[i];
+			if (pRing)
+				pRing->Drain(read);
+		}
+	}
+
+private:
+	/**
+	* Thread local storage marker of threads beyond maxThreads.
+	***/
+	static LPVOID NoRing() { return (LPVOID)(INT_PTR)-1; }
+
+	/**
+	* Registered thread rings.
+	***/
+	Ring* volatile m_rings[maxThreads];
+	volatile LONG m_ringCount;
+	/**
+	* Thread local storage index of the thread ring.
+	***/
+	DWORD m_tlsIndex;
+};
+
+#endif
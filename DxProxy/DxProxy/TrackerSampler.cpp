@@ -0,0 +1,247 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <TrackerSampler.cpp> and
+Class <TrackerSampler> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#include "TrackerSampler.h"
+#include "MotionTracker.h"
+
+/**
+* Constructor.
+* @param pTracker The tracker to sample, must support sampling (see MotionTracker::SupportsSampling()).
+***/
+TrackerSampler::TrackerSampler(MotionTracker* pTracker) :
+	m_pTracker(pTracker),
+	m_hThread(NULL),
+	m_hStopEvent(NULL),
+	m_writeIndex(0)
+{
+	ZeroMemory(m_poses, sizeof(m_poses));
+}
+
+/**
+* Destructor, stops the sampling thread.
+***/
+TrackerSampler::~TrackerSampler()
+{
+	Stop();
+}
+
+/**
+* Starts the sampling thread.
+* @return False if the thread could not be created.
+***/
+bool TrackerSampler::Start()
+{
+	if (m_hThread)
+		return true;
+
+	m_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!m_hStopEvent)
+		return false;
+
+	m_hThread = CreateThread(NULL, 0, SamplingThread, this, 0, NULL);
+	if (!m_hThread)
+	{
+		OutputDebugString("TrackerSampler: Could not create sampling thread\n");
+		CloseHandle(m_hStopEvent);
+		m_hStopEvent = NULL;
+		return false;
+	}
+
+	// poses are latency critical
+	SetThreadPriority(m_hThread, THREAD_PRIORITY_ABOVE_NORMAL);
+	return true;
+}
+
+/**
+* Stops the sampling thread, waits for the current device read to finish.
+***/
+void TrackerSampler::Stop()
+{
+	if (!m_hThread)
+		return;
+
+	SetEvent(m_hStopEvent);
+	WaitForSingleObject(m_hThread, INFINITE);
+	CloseHandle(m_hThread);
+	CloseHandle(m_hStopEvent);
+	m_hThread = NULL;
+	m_hStopEvent = NULL;
+}
+
+/**
+* Adds a pose to the history (sampling thread only).
+***/
+void TrackerSampler::Push(const TrackerPose& pose)
+{
+	ULONG write = m_writeIndex;
+	m_poses[write & (TRACKERSAMPLER_RING_SIZE - 1)] = pose;
+
+	// publish (volatile write, release)
+	m_writeIndex = write + 1;
+}
+
+/**
+* Returns the latest pose.
+* @return False if there is no pose yet.
+***/
+bool TrackerSampler::GetLatest(TrackerPose* pPose)
+{
+	for (int i = 0; i < TRACKERSAMPLER_READ_RETRIES; i++)
+	{
+		ULONG write = m_writeIndex;
+		if (write == 0)
+			return false;
+
+		*pPose = m_poses[(write - 1) & (TRACKERSAMPLER_RING_SIZE - 1)];
+
+		// copy done before the index is read again
+		MemoryBarrier();
+
+		// slot not overwritten meanwhile
+		if (m_writeIndex - (write - 1) < TRACKERSAMPLER_RING_SIZE)
+			return true;
+	}
+	return false;
+}
+
+/**
+* Returns the pose at a given time, interpolated between the two poses around that time.
+* Times after the latest pose return the latest pose (no prediction), times before the history
+* return the oldest pose.
+* @param time Performance counter time.
+* @return False if there is no pose yet.
+***/
+bool TrackerSampler::GetAt(LONGLONG time, TrackerPose* pPose)
+{
+	for (int i = 0; i < TRACKERSAMPLER_READ_RETRIES; i++)
+	{
+		ULONG write = m_writeIndex;
+		if (write == 0)
+			return false;
+
+		// the slot currently written is kept out
+		ULONG count = (write < TRACKERSAMPLER_RING_SIZE - 1) ? write : TRACKERSAMPLER_RING_SIZE - 1;
+
+		TrackerPose newer = m_poses[(write - 1) & (TRACKERSAMPLER_RING_SIZE - 1)];
+		ULONG oldest = write - 1;
+		if (newer.time <= time)
+			*pPose = newer;
+		else
+		{
+			*pPose = newer;
+			for (ULONG age = 2; age <= count; age++)
+			{
+				TrackerPose older = m_poses[(write - age) & (TRACKERSAMPLER_RING_SIZE - 1)];
+				oldest = write - age;
+				if (older.time <= time)
+				{
+					Interpolate(older, newer, time, pPose);
+					break;
+				}
+				newer = older;
+				*pPose = older;
+			}
+		}
+
+		// copies done before the index is read again
+		MemoryBarrier();
+
+		// slots not overwritten meanwhile
+		if (m_writeIndex - oldest < TRACKERSAMPLER_RING_SIZE)
+			return true;
+	}
+	return false;
+}
+
+/**
+* Interpolates two poses, orientation along the shortest angle (result within +-PI).
+* @param older The pose before the time.
+* @param newer The pose after the time.
+* @param time The time to interpolate at.
+* @param pPose [out] The interpolated pose.
+***/
+void TrackerSampler::Interpolate(const TrackerPose& older, const TrackerPose& newer, LONGLONG time, TrackerPose* pPose)
+{
+	float t = 1.0f;
+	if (newer.time > older.time)
+		t = (float)((double)(time - older.time) / (double)(newer.time - older.time));
+	if (t < 0.0f) t = 0.0f;
+	if (t > 1.0f) t = 1.0f;
+
+	float angles[3][2] = {{older.yaw, newer.yaw}, {older.pitch, newer.pitch}, {older.roll, newer.roll}};
+	float result[3];
+	for (int i = 0; i < 3; i++)
+	{
+		float delta = angles[i][1] - angles[i][0];
+		if (delta > (float)PI) delta -= (float)(2.0 * PI);
+		if (delta < -(float)PI) delta += (float)(2.0 * PI);
+		result[i] = angles[i][0] + delta * t;
+
+		// back within +-PI if interpolated across
+		if (result[i] > (float)PI) result[i] -= (float)(2.0 * PI);
+		if (result[i] < -(float)PI) result[i] += (float)(2.0 * PI);
+	}
+
+	pPose->time = time;
+	pPose->yaw = result[0];
+	pPose->pitch = result[1];
+	pPose->roll = result[2];
+	pPose->x = older.x + (newer.x - older.x) * t;
+	pPose->y = older.y + (newer.y - older.y) * t;
+	pPose->z = older.z + (newer.z - older.z) * t;
+}
+
+/**
+* Sampling thread : reads the device until stopped.
+* Trackers with blocking reads (sampling interval 0) run at the device rate.
+***/
+DWORD WINAPI TrackerSampler::SamplingThread(LPVOID pParam)
+{
+	TrackerSampler* pSampler = (TrackerSampler*)pParam;
+	DWORD interval = pSampler->m_pTracker->GetSamplingInterval();
+	DWORD wait = interval;
+
+	while (WaitForSingleObject(pSampler->m_hStopEvent, wait) == WAIT_TIMEOUT)
+	{
+		TrackerPose pose;
+		ZeroMemory(&pose, sizeof(TrackerPose));
+		if (pSampler->m_pTracker->getOrientationAndPosition(&pose.yaw, &pose.pitch, &pose.roll, &pose.x, &pose.y, &pose.z) == 0)
+		{
+			LARGE_INTEGER now;
+			QueryPerformanceCounter(&now);
+			pose.time = now.QuadPart;
+			pSampler->Push(pose);
+			wait = interval;
+		}
+		else
+			wait = (interval > TRACKERSAMPLER_RETRY_MS) ? interval : TRACKERSAMPLER_RETRY_MS;
+	}
+	return 0;
+}
@@ -0,0 +1,103 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <TrackerSampler.h> and
+Class <TrackerSampler> :
+Copyright (C) 2013 Chris Drain
+
+Vireio Perception Version History:
+v1.0.0 2012 by Andres Hernandez
+v1.0.X 2013 by John Hicks, Neil Schneider
+v1.1.x 2013 by Primary Coding Author: Chris Drain
+Team Support: John Hicks, Phil Larkson, Neil Schneider
+v2.0.x 2013 by Denis Reischl, Neil Schneider, Joshua Brown
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+
+#ifndef TRACKERSAMPLER_H_INCLUDED
+#define TRACKERSAMPLER_H_INCLUDED
+
+#include <windows.h>
+
+/**
+* Pose history ring buffer size (power of two).
+***/
+#define TRACKERSAMPLER_RING_SIZE 64
+/**
+* Wait after a failed device read, so a lost device doesn't spin the sampling thread.
+***/
+#define TRACKERSAMPLER_RETRY_MS 10
+/**
+* Read attempts before a reader gives up (sampling thread overwrote the slots meanwhile).
+***/
+#define TRACKERSAMPLER_READ_RETRIES 4
+
+class MotionTracker;
+
+/**
+* Timestamped tracker pose, as returned by MotionTracker::getOrientationAndPosition().
+***/
+struct TrackerPose
+{
+	LONGLONG time;           /**< Performance counter at the sample */
+	float yaw, pitch, roll;  /**< Orientation, radians */
+	float x, y, z;           /**< Position */
+};
+
+/**
+* Tracker sampling service.
+* Polls the tracker device on its own thread at the device rate (blocking reads) or the tracker 
+* sampling interval and pushes timestamped poses into a lock-free ring buffer (single producer).
+* The render thread reads the latest pose or a pose interpolated at a given time, so tracker I/O
+* never stalls the frame. Readers never block the sampling thread : they copy the slots and retry
+* if the slots were overwritten meanwhile.
+*/
+class TrackerSampler
+{
+public:
+	TrackerSampler(MotionTracker* pTracker);
+	virtual ~TrackerSampler();
+
+	/*** TrackerSampler public methods ***/
+	bool Start();
+	void Stop();
+	void Push(const TrackerPose& pose);
+	bool GetLatest(TrackerPose* pPose);
+	bool GetAt(LONGLONG time, TrackerPose* pPose);
+	static void Interpolate(const TrackerPose& older, const TrackerPose& newer, LONGLONG time, TrackerPose* pPose);
+
+private:
+	/*** TrackerSampler private methods ***/
+	static DWORD WINAPI SamplingThread(LPVOID pParam);
+
+	/**
+	* The sampled tracker (device reads on the sampling thread only while sampling).
+	***/
+	MotionTracker* m_pTracker;
+	/**
+	* Sampling thread and its stop event.
+	***/
+	HANDLE m_hThread;
+	HANDLE m_hStopEvent;
+	/**
+	* Pose history, m_writeIndex is the index of the next pose (number of poses pushed).
+	***/
+	TrackerPose m_poses[TRACKERSAMPLER_RING_SIZE];
+	volatile ULONG m_writeIndex;
+};
+
+#endif
@@ -44,8 +44,14 @@ const float maxConvergence = 100.0f;
 ViewAdjustment::ViewAdjustment(HMDisplayInfo *displayInfo, ProxyConfig *config) :
 	config(config),
 	hmdInfo(displayInfo),
-	m_roll(0.0f)
+	m_frontSnapshot(0),
+	m_backSnapshot(1),
+	m_latestSnapshot(2),
+	m_roll(0.0f),
+	m_orientation(0.0f, 0.0f, 0.0f)
 {
+	InitializeCriticalSection(&m_cs);
+
 	convergence = 100.0f;
 
 	ipd = IPD_DEFAULT;
@@ -77,14 +83,17 @@ ViewAdjustment::ViewAdjustment(HMDisplayInfo *displayInfo, ProxyConfig *config)
 	UpdateProjectionMatrices(displayInfo->GetScreenAspectRatio(), 110.0f);
 	D3DXMatrixIdentity(&rollMatrix);
 	D3DXMatrixIdentity(&rollMatrixNegative);
+	D3DXMatrixIdentity(&rollMatrixHalf);
 	ComputeViewTransforms();
+	AcquireViewTransforms();
 }
 
 /**
-* Empty destructor.
+* Destructor.
 ***/
 ViewAdjustment::~ViewAdjustment() 
 {
+	DeleteCriticalSection(&m_cs);
 }
 
 /**
@@ -93,8 +102,10 @@ ViewAdjustment::~ViewAdjustment()
 ***/
 void ViewAdjustment::Load(ProxyConfig& cfg) 
 {
+	EnterCriticalSection(&m_cs);
 	convergence = cfg.convergence;
 	ipd = cfg.ipd;
+	LeaveCriticalSection(&m_cs);
 }
 
 /**
@@ -120,6 +131,8 @@ void ViewAdjustment::Save(ProxyConfig& cfg)
 ***/
 void ViewAdjustment::UpdateProjectionMatrices(float aspectRatio, float fov_horiz)
 {
+	EnterCriticalSection(&m_cs);
+
 	// Minimum (near) Z-value
 	float n = 0.1f;
 	// Maximum (far) Z-value
@@ -191,6 +204,8 @@ void ViewAdjustment::UpdateProjectionMatrices(float aspectRatio, float fov_horiz
 		//And left and right (identical in this case)
 		D3DXMatrixPerspectiveFovLH(&projectPFOV, fov_vert, aspectRatio, n, f);
 	}
+
+	LeaveCriticalSection(&m_cs);
 }
 
 /**
@@ -199,15 +214,34 @@ void ViewAdjustment::UpdateProjectionMatrices(float aspectRatio, float fov_horiz
 ***/
 void ViewAdjustment::UpdateRoll(float roll)
 {
+	EnterCriticalSection(&m_cs);
+
 	D3DXMatrixIdentity(&rollMatrix);
 	D3DXMatrixRotationZ(&rollMatrix, roll);
 	D3DXMatrixRotationZ(&rollMatrixNegative, -roll);
 	D3DXMatrixRotationZ(&rollMatrixHalf, roll * 0.5f);
 	m_roll = roll;
+
+	LeaveCriticalSection(&m_cs);
+}
+
+/**
+* Sets the tracker orientation the next published view transforms belong to.
+* @param yaw, pitch, roll Head orientation, in radians.
+***/
+void ViewAdjustment::UpdateOrientation(float yaw, float pitch, float roll)
+{
+	EnterCriticalSection(&m_cs);
+
+	m_orientation = D3DXVECTOR3(yaw, pitch, roll);
+
+	LeaveCriticalSection(&m_cs);
 }
 void ViewAdjustment::SetGameSpecificPositionalScaling(D3DXVECTOR3 scalingVec)
 {
+	EnterCriticalSection(&m_cs);
 	gameScaleVec  = scalingVec;
+	LeaveCriticalSection(&m_cs);
 }
 
 /**
@@ -215,6 +249,8 @@ void ViewAdjustment::SetGameSpecificPositionalScaling(D3DXVECTOR3 scalingVec)
 ***/
 void ViewAdjustment::UpdatePosition(float yaw, float pitch, float roll, float xPosition, float yPosition, float zPosition)
 {
+	EnterCriticalSection(&m_cs);
+
 	D3DXMATRIX rotationMatrixPitch;
 	D3DXMATRIX rotationMatrixYaw;
 	D3DXMATRIX rotationMatrixRoll;
@@ -250,6 +286,8 @@ void ViewAdjustment::UpdatePosition(float yaw, float pitch, float roll, float xP
 	D3DXVec3TransformNormal(&positionTransformVec, &positionTransformVec, &gamescalingmatrix);
 	
 	D3DXMatrixTranslation(&matPosition, positionTransformVec.x, positionTransformVec.y, positionTransformVec.z);
+
+	LeaveCriticalSection(&m_cs);
 }
 
 /**
@@ -260,6 +298,8 @@ void ViewAdjustment::UpdatePosition(float yaw, float pitch, float roll, float xP
 ***/
 void ViewAdjustment::ComputeViewTransforms()
 {
+	EnterCriticalSection(&m_cs);
+
 	//Pixel shader roll needs to apply stereo separation adjusted for the tilted horizon
 	if (config->rollImpl == 2)
 	{
@@ -362,12 +402,84 @@ void ViewAdjustment::ComputeViewTransforms()
 	matHudRight = matProjectionInv * matRightHud3DDepth * transformRight * matHudDistance * matBasicProjection;
 	matGuiLeft =  matProjectionInv * matLeftGui3DDepth * matSquash * matBasicProjection;
 	matGuiRight = matProjectionInv * matRightGui3DDepth * matSquash * matBasicProjection;
+
+	PublishViewTransforms();
+	LeaveCriticalSection(&m_cs);
+}
+
+/**
+* Copies the computed matrices to the back snapshot and publishes it (m_cs held).
+***/
+void ViewAdjustment::PublishViewTransforms()
+{
+	ViewTransformSnapshot* pSnapshot = &m_snapshots[m_backSnapshot];
+	pSnapshot->matPosition = matPosition;
+	pSnapshot->matBasicProjection = matBasicProjection;
+	pSnapshot->matProjectionInv = matProjectionInv;
+	pSnapshot->rollMatrix = rollMatrix;
+	pSnapshot->rollMatrixNegative = rollMatrixNegative;
+	pSnapshot->rollMatrixHalf = rollMatrixHalf;
+	pSnapshot->transformLeft = transformLeft;
+	pSnapshot->transformRight = transformRight;
+	pSnapshot->matViewProjLeft = matViewProjLeft;
+	pSnapshot->matViewProjRight = matViewProjRight;
+	pSnapshot->matViewProjTransformLeft = matViewProjTransformLeft;
+	pSnapshot->matViewProjTransformRight = matViewProjTransformRight;
+	pSnapshot->matViewProjTransformLeftNoRoll = matViewProjTransformLeftNoRoll;
+	pSnapshot->matViewProjTransformRightNoRoll = matViewProjTransformRightNoRoll;
+	pSnapshot->matHudLeft = matHudLeft;
+	pSnapshot->matHudRight = matHudRight;
+	pSnapshot->matGuiLeft = matGuiLeft;
+	pSnapshot->matGuiRight = matGuiRight;
+	pSnapshot->matSquash = matSquash;
+	pSnapshot->matHudDistance = matHudDistance;
+	pSnapshot->matLeftHud3DDepth = matLeftHud3DDepth;
+	pSnapshot->matRightHud3DDepth = matRightHud3DDepth;
+	pSnapshot->matLeftHud3DDepthShifted = matLeftHud3DDepthShifted;
+	pSnapshot->matRightHud3DDepthShifted = matRightHud3DDepthShifted;
+	pSnapshot->matLeftGui3DDepth = matLeftGui3DDepth;
+	pSnapshot->matRightGui3DDepth = matRightGui3DDepth;
+	pSnapshot->roll = m_roll;
+	pSnapshot->orientation = m_orientation;
+
+	// publish (full barrier), the previously published snapshot is the next back buffer
+	m_backSnapshot = InterlockedExchange(&m_latestSnapshot, m_backSnapshot | VIEWADJUSTMENT_SNAPSHOT_NEW) & ~VIEWADJUSTMENT_SNAPSHOT_NEW;
+}
+
+/**
+* Makes the latest published view transforms the ones returned by the matrix getters (render thread, 
+* once per frame). The getters return the same snapshot until the next call.
+* @return False if no new view transforms were published since the last call.
+***/
+bool ViewAdjustment::AcquireViewTransforms()
+{
+	if (!(m_latestSnapshot & VIEWADJUSTMENT_SNAPSHOT_NEW))
+		return false;
+
+	m_frontSnapshot = InterlockedExchange(&m_latestSnapshot, m_frontSnapshot) & ~VIEWADJUSTMENT_SNAPSHOT_NEW;
+	return true;
+}
+
+/**
+* Returns the head roll of the acquired view transforms, in radians.
+***/
+float ViewAdjustment::Roll()
+{
+	return m_snapshots[m_frontSnapshot].roll;
+}
+
+/**
+* Returns the tracker orientation (yaw, pitch, roll) of the acquired view transforms, in radians.
+***/
+D3DXVECTOR3 ViewAdjustment::Orientation()
+{
+	return m_snapshots[m_frontSnapshot].orientation;
 }
 
 
 D3DXMATRIX ViewAdjustment::PositionMatrix()
 {
-	return matPosition;
+	return m_snapshots[m_frontSnapshot].matPosition;
 }
 
 /**
@@ -375,7 +487,7 @@ D3DXMATRIX ViewAdjustment::PositionMatrix()
 ***/
 D3DXMATRIX ViewAdjustment::LeftAdjustmentMatrix()
 {
-	return matViewProjTransformLeft;
+	return m_snapshots[m_frontSnapshot].matViewProjTransformLeft;
 }
 
 /**
@@ -383,7 +495,7 @@ D3DXMATRIX ViewAdjustment::LeftAdjustmentMatrix()
 ***/
 D3DXMATRIX ViewAdjustment::RightAdjustmentMatrix()
 {
-	return matViewProjTransformRight;
+	return m_snapshots[m_frontSnapshot].matViewProjTransformRight;
 }
 
 /**
@@ -391,7 +503,7 @@ D3DXMATRIX ViewAdjustment::RightAdjustmentMatrix()
 ***/
 D3DXMATRIX ViewAdjustment::LeftAdjustmentMatrixNoRoll()
 {
-	return matViewProjTransformLeftNoRoll;
+	return m_snapshots[m_frontSnapshot].matViewProjTransformLeftNoRoll;
 }
 
 /**
@@ -399,7 +511,7 @@ D3DXMATRIX ViewAdjustment::LeftAdjustmentMatrixNoRoll()
 ***/
 D3DXMATRIX ViewAdjustment::RightAdjustmentMatrixNoRoll()
 {
-	return matViewProjTransformRightNoRoll;
+	return m_snapshots[m_frontSnapshot].matViewProjTransformRightNoRoll;
 }
 
 /**
@@ -407,7 +519,7 @@ D3DXMATRIX ViewAdjustment::RightAdjustmentMatrixNoRoll()
 ***/
 D3DXMATRIX ViewAdjustment::LeftView()
 {
-	return matViewProjLeft;
+	return m_snapshots[m_frontSnapshot].matViewProjLeft;
 }
 
 /**
@@ -415,7 +527,7 @@ D3DXMATRIX ViewAdjustment::LeftView()
 ***/
 D3DXMATRIX ViewAdjustment::RightView()
 {
-	return matViewProjRight;
+	return m_snapshots[m_frontSnapshot].matViewProjRight;
 }
 
 /**
@@ -423,7 +535,7 @@ D3DXMATRIX ViewAdjustment::RightView()
 ***/
 D3DXMATRIX ViewAdjustment::LeftViewTransform()
 {
-	return transformLeft;
+	return m_snapshots[m_frontSnapshot].transformLeft;
 }
 
 /**
@@ -431,7 +543,7 @@ D3DXMATRIX ViewAdjustment::LeftViewTransform()
 ***/
 D3DXMATRIX ViewAdjustment::RightViewTransform()
 {
-	return transformRight;
+	return m_snapshots[m_frontSnapshot].transformRight;
 }
 
 /**
@@ -439,7 +551,7 @@ D3DXMATRIX ViewAdjustment::RightViewTransform()
 ***/
 D3DXMATRIX ViewAdjustment::Projection()
 {
-	return matBasicProjection;
+	return m_snapshots[m_frontSnapshot].matBasicProjection;
 }
 
 /**
@@ -447,7 +559,7 @@ D3DXMATRIX ViewAdjustment::Projection()
 ***/
 D3DXMATRIX ViewAdjustment::ProjectionInverse()
 {
-	return matProjectionInv;
+	return m_snapshots[m_frontSnapshot].matProjectionInv;
 }
 
 /**
@@ -455,7 +567,7 @@ D3DXMATRIX ViewAdjustment::ProjectionInverse()
 ***/
 D3DXMATRIX ViewAdjustment::RollMatrix()
 {
-	return rollMatrix;
+	return m_snapshots[m_frontSnapshot].rollMatrix;
 }
 
 /**
@@ -463,7 +575,7 @@ D3DXMATRIX ViewAdjustment::RollMatrix()
 ***/
 D3DXMATRIX ViewAdjustment::RollMatrixNegative()
 {
-	return rollMatrixNegative;
+	return m_snapshots[m_frontSnapshot].rollMatrixNegative;
 }
 
 /**
@@ -471,7 +583,7 @@ D3DXMATRIX ViewAdjustment::RollMatrixNegative()
 ***/
 D3DXMATRIX ViewAdjustment::RollMatrixHalf()
 {
-	return rollMatrixHalf;
+	return m_snapshots[m_frontSnapshot].rollMatrixHalf;
 }
 
 /**
@@ -479,7 +591,7 @@ D3DXMATRIX ViewAdjustment::RollMatrixHalf()
 ***/
 D3DXMATRIX ViewAdjustment::LeftHUDMatrix()
 {
-	return matHudLeft;
+	return m_snapshots[m_frontSnapshot].matHudLeft;
 }
 
 /**
@@ -487,7 +599,7 @@ D3DXMATRIX ViewAdjustment::LeftHUDMatrix()
 ***/
 D3DXMATRIX ViewAdjustment::RightHUDMatrix()
 {
-	return matHudRight;
+	return m_snapshots[m_frontSnapshot].matHudRight;
 }
 
 /**
@@ -495,7 +607,7 @@ D3DXMATRIX ViewAdjustment::RightHUDMatrix()
 ***/
 D3DXMATRIX ViewAdjustment::LeftGUIMatrix()
 {
-	return matGuiLeft;
+	return m_snapshots[m_frontSnapshot].matGuiLeft;
 }
 
 /**
@@ -503,7 +615,7 @@ D3DXMATRIX ViewAdjustment::LeftGUIMatrix()
 ***/
 D3DXMATRIX ViewAdjustment::RightGUIMatrix()
 {
-	return matGuiRight;
+	return m_snapshots[m_frontSnapshot].matGuiRight;
 }
 
 /**
@@ -511,7 +623,7 @@ D3DXMATRIX ViewAdjustment::RightGUIMatrix()
 ***/
 D3DXMATRIX ViewAdjustment::Squash()
 {
-	return matSquash;
+	return m_snapshots[m_frontSnapshot].matSquash;
 }
 
 /**
@@ -519,7 +631,7 @@ D3DXMATRIX ViewAdjustment::Squash()
 ***/
 D3DXMATRIX ViewAdjustment::HUDDistance()
 {
-	return matHudDistance;
+	return m_snapshots[m_frontSnapshot].matHudDistance;
 }
 
 /**
@@ -527,7 +639,7 @@ D3DXMATRIX ViewAdjustment::HUDDistance()
 ***/
 D3DXMATRIX ViewAdjustment::LeftHUD3DDepth()
 {
-	return matLeftHud3DDepth;
+	return m_snapshots[m_frontSnapshot].matLeftHud3DDepth;
 }
 
 /**
@@ -535,7 +647,7 @@ D3DXMATRIX ViewAdjustment::LeftHUD3DDepth()
 ***/
 D3DXMATRIX ViewAdjustment::RightHUD3DDepth()
 {
-	return matRightHud3DDepth;
+	return m_snapshots[m_frontSnapshot].matRightHud3DDepth;
 }
 
 /**
@@ -543,7 +655,7 @@ D3DXMATRIX ViewAdjustment::RightHUD3DDepth()
 ***/
 D3DXMATRIX ViewAdjustment::LeftHUD3DDepthShifted()
 {
-	return matLeftHud3DDepthShifted;
+	return m_snapshots[m_frontSnapshot].matLeftHud3DDepthShifted;
 }
 
 /**
@@ -551,7 +663,7 @@ D3DXMATRIX ViewAdjustment::LeftHUD3DDepthShifted()
 ***/
 D3DXMATRIX ViewAdjustment::RightHUD3DDepthShifted()
 {
-	return matRightHud3DDepthShifted;
+	return m_snapshots[m_frontSnapshot].matRightHud3DDepthShifted;
 }
 
 /**
@@ -559,7 +671,7 @@ D3DXMATRIX ViewAdjustment::RightHUD3DDepthShifted()
 ***/
 D3DXMATRIX ViewAdjustment::LeftGUI3DDepth()
 {
-	return matLeftGui3DDepth;
+	return m_snapshots[m_frontSnapshot].matLeftGui3DDepth;
 }
 
 /**
@@ -567,7 +679,7 @@ D3DXMATRIX ViewAdjustment::LeftGUI3DDepth()
 ***/
 D3DXMATRIX ViewAdjustment::RightGUI3DDepth()
 {
-	return matRightGui3DDepth;
+	return m_snapshots[m_frontSnapshot].matRightGui3DDepth;
 }
 
 /**
@@ -602,14 +714,25 @@ void ViewAdjustment::GatherMatrix(D3DXMATRIX& matrixLeft, D3DXMATRIX& matrixRigh
 ***/
 float ViewAdjustment::ChangeWorldScale(float toAdd)
 {
+	EnterCriticalSection(&m_cs);
+
+	// the tracking worker must not compute with the unclamped scale
 	config->worldScaleFactor+= toAdd;
 	vireio::clamp(&config->worldScaleFactor, 0.000001f, 1000000.0f);
-	return config->worldScaleFactor;
+	float worldScale = config->worldScaleFactor;
+
+	LeaveCriticalSection(&m_cs);
+	return worldScale;
 }
 
+/**
+* Sets convergence.
+***/
 float ViewAdjustment::SetConvergence(float newConvergence)
 {
+	EnterCriticalSection(&m_cs);
 	this->convergence = newConvergence;
+	LeaveCriticalSection(&m_cs);
 	return newConvergence;
 }
 
@@ -618,11 +741,15 @@ float ViewAdjustment::SetConvergence(float newConvergence)
 ***/
 float ViewAdjustment::ChangeConvergence(float toAdd)
 {
+	EnterCriticalSection(&m_cs);
+
 	convergence += toAdd;
 
 	vireio::clamp(&convergence, minConvergence, maxConvergence);
+	float newConvergence = convergence;
 
-	return convergence;
+	LeaveCriticalSection(&m_cs);
+	return newConvergence;
 }
 
 /**
@@ -630,9 +757,13 @@ float ViewAdjustment::ChangeConvergence(float toAdd)
 ***/
 void ViewAdjustment::ChangeGUISquash(float newSquash)
 {
+	EnterCriticalSection(&m_cs);
+
 	squash = newSquash;
 
 	D3DXMatrixScaling(&matSquash, squash, squash, 1);
+
+	LeaveCriticalSection(&m_cs);
 }
 
 /**
@@ -640,10 +771,14 @@ void ViewAdjustment::ChangeGUISquash(float newSquash)
 ***/
 void ViewAdjustment::ChangeGUI3DDepth(float newGui3DDepth)
 {
+	EnterCriticalSection(&m_cs);
+
 	gui3DDepth = newGui3DDepth;
 
 	D3DXMatrixTranslation(&matLeftGui3DDepth, gui3DDepth+SeparationIPDAdjustment(), 0, 0);
 	D3DXMatrixTranslation(&matRightGui3DDepth, -(gui3DDepth+SeparationIPDAdjustment()), 0, 0);
+
+	LeaveCriticalSection(&m_cs);
 }
 
 /**
@@ -651,9 +786,13 @@ void ViewAdjustment::ChangeGUI3DDepth(float newGui3DDepth)
 ***/
 void ViewAdjustment::ChangeHUDDistance(float newHudDistance)
 {
+	EnterCriticalSection(&m_cs);
+
 	hudDistance = newHudDistance;
 
 	D3DXMatrixTranslation(&matHudDistance, 0, 0, hudDistance);
+
+	LeaveCriticalSection(&m_cs);
 }
 
 /**
@@ -661,6 +800,8 @@ void ViewAdjustment::ChangeHUDDistance(float newHudDistance)
 ***/
 void ViewAdjustment::ChangeHUD3DDepth(float newHud3DDepth)
 {
+	EnterCriticalSection(&m_cs);
+
 	hud3DDepth = newHud3DDepth;
 
 	D3DXMatrixTranslation(&matLeftHud3DDepth, -hud3DDepth, 0, 0);
@@ -668,6 +809,8 @@ void ViewAdjustment::ChangeHUD3DDepth(float newHud3DDepth)
 	float additionalSeparation = (1.5f-hudDistance)*hmdInfo->GetLensXCenterOffset();
 	D3DXMatrixTranslation(&matLeftHud3DDepthShifted, hud3DDepth+additionalSeparation, 0, 0);
 	D3DXMatrixTranslation(&matRightHud3DDepthShifted, -hud3DDepth-additionalSeparation, 0, 0);
+
+	LeaveCriticalSection(&m_cs);
 }
 
 /**
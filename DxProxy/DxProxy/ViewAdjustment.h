@@ -41,6 +41,51 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define LEFT_CONSTANT -1
 #define RIGHT_CONSTANT 1
 
+/**
+* Snapshot buffers : one read by the render thread, one published, one being computed.
+***/
+#define VIEWADJUSTMENT_SNAPSHOTS 3
+/**
+* Flags a published snapshot not acquired yet.
+***/
+#define VIEWADJUSTMENT_SNAPSHOT_NEW 0x4
+
+/**
+* View transforms computed by ViewAdjustment::ComputeViewTransforms().
+* Immutable once published, the render thread reads the acquired snapshot for a whole frame.
+***/
+struct ViewTransformSnapshot
+{
+	D3DXMATRIX matPosition;
+	D3DXMATRIX matBasicProjection;
+	D3DXMATRIX matProjectionInv;
+	D3DXMATRIX rollMatrix;
+	D3DXMATRIX rollMatrixNegative;
+	D3DXMATRIX rollMatrixHalf;
+	D3DXMATRIX transformLeft;
+	D3DXMATRIX transformRight;
+	D3DXMATRIX matViewProjLeft;
+	D3DXMATRIX matViewProjRight;
+	D3DXMATRIX matViewProjTransformLeft;
+	D3DXMATRIX matViewProjTransformRight;
+	D3DXMATRIX matViewProjTransformLeftNoRoll;
+	D3DXMATRIX matViewProjTransformRightNoRoll;
+	D3DXMATRIX matHudLeft;
+	D3DXMATRIX matHudRight;
+	D3DXMATRIX matGuiLeft;
+	D3DXMATRIX matGuiRight;
+	D3DXMATRIX matSquash;
+	D3DXMATRIX matHudDistance;
+	D3DXMATRIX matLeftHud3DDepth;
+	D3DXMATRIX matRightHud3DDepth;
+	D3DXMATRIX matLeftHud3DDepthShifted;
+	D3DXMATRIX matRightHud3DDepthShifted;
+	D3DXMATRIX matLeftGui3DDepth;
+	D3DXMATRIX matRightGui3DDepth;
+	float roll;  /**< Head roll, radians */
+	D3DXVECTOR3 orientation;  /**< Tracker yaw, pitch, roll the transforms were computed for, radians */
+};
+
 /**
 * Class for eye and head roll adjustment matrix calculation.
 * Calculates left and right view projection transform matrices.
@@ -59,8 +104,12 @@ public:
 	void          Save(ProxyConfig& cfg);
 	void          UpdateProjectionMatrices(float aspectRatio, float fov_horiz);
 	void          UpdateRoll(float roll);
+	void          UpdateOrientation(float yaw, float pitch, float roll);
 	void		  UpdatePosition(float yaw, float pitch, float roll, float xPosition = 0.0f, float yPosition = 0.0f, float zPosition = 0.0f);
 	void          ComputeViewTransforms(); 
+	bool          AcquireViewTransforms();
+	float         Roll();
+	D3DXVECTOR3   Orientation();
 	D3DXMATRIX    PositionMatrix();
 	D3DXMATRIX    LeftAdjustmentMatrix();
 	D3DXMATRIX    RightAdjustmentMatrix();
@@ -108,7 +157,32 @@ public:
 	HMDisplayInfo* HMDInfo();	
 
 private:
+	/*** ViewAdjustment private methods ***/
+	void          PublishViewTransforms();
+
 	ProxyConfig *config;
+
+	/**
+	* Guards the matrices below and the values they are computed from (convergence, ipd, world scale),
+	* the view transforms may be computed on a tracking worker thread while menus change these values.
+	***/
+	CRITICAL_SECTION m_cs;
+	/**
+	* Snapshot buffers, see AcquireViewTransforms().
+	***/
+	ViewTransformSnapshot m_snapshots[VIEWADJUSTMENT_SNAPSHOTS];
+	/**
+	* Snapshot read by the render thread (render thread only).
+	***/
+	LONG m_frontSnapshot;
+	/**
+	* Snapshot being computed (guarded by m_cs).
+	***/
+	LONG m_backSnapshot;
+	/**
+	* Latest published snapshot, VIEWADJUSTMENT_SNAPSHOT_NEW set if not acquired yet.
+	***/
+	volatile LONG m_latestSnapshot;
 	
 	D3DXVECTOR3 positionTransformVec;
 
@@ -249,6 +323,10 @@ private:
 	*/
 	float m_roll;
 	/**
+	* Tracker orientation (yaw, pitch, roll) published with the view transforms.
+	***/
+	D3DXVECTOR3 m_orientation;
+	/**
 	* Interpupillary distance.
 	* As provided from Oculus Configuration Utility (or set in the "user.xml" file).
 	***/
@@ -33,7 +33,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <CommCtrl.h> 
 #include <ctime>  
 #include <cstdlib>  
+#include <stdio.h>
 #include "ProxyHelper.h"
+#include "Telemetry.h"
 #include <map>
 #include "Resource.h"
 #include "Version.h"
@@ -309,23 +311,29 @@ public:
 					TextOut (paint_device_context,290,149,"Oculus Profile:",15);
 					TextOut (paint_device_context,420,149,oculusProfile.Name.c_str(),oculusProfile.Name.size());
 					TextOut (paint_device_context,290,183,"Current FPS:",12);
-					//Now get FPS from the registry
-					HKEY hKey;
-					LONG openRes = RegOpenKeyEx(HKEY_CURRENT_USER, "SOFTWARE\\Vireio\\Perception", 0, KEY_ALL_ACCESS, &hKey);
-					if (openRes==ERROR_SUCCESS)
+					//Now get FPS from the proxy telemetry shared memory
 					{
-						char fpsBuffer[10];
-						memset(fpsBuffer, 0, 10);
-						DWORD dwDataSize = 10;
-						LONG lResult = RegGetValue(hKey, NULL, "FPS", RRF_RT_REG_SZ, NULL, (LPVOID)&fpsBuffer, &dwDataSize);
-						if (lResult == ERROR_SUCCESS)
+						bool fpsShown = false;
+						HANDLE hTelemetry = OpenFileMapping(FILE_MAP_READ, FALSE, TELEMETRY_SHARED_MEMORY_NAME);
+						if (hTelemetry)
 						{
-							TextOut (paint_device_context,420,183,fpsBuffer, strlen(fpsBuffer));
-							//Now delete, if this isn't refreshed, then we'll report blank next time round
-							RegDeleteValue(hKey, "FPS");
-							RegCloseKey(hKey);
+							TelemetryData* pTelemetry = (TelemetryData*)MapViewOfFile(hTelemetry, FILE_MAP_READ, 0, 0, sizeof(TelemetryData));
+							if (pTelemetry)
+							{
+								TelemetryData telemetry;
+								// not refreshed for two seconds, then the game isn't presenting (anymore)
+								if (TelemetryRead(pTelemetry, &telemetry) && (GetTickCount() - telemetry.tickCount < 2000))
+								{
+									char fpsBuffer[32];
+									sprintf_s(fpsBuffer, "%.1f", telemetry.fps);
+									TextOut (paint_device_context,420,183,fpsBuffer, strlen(fpsBuffer));
+									fpsShown = true;
+								}
+								UnmapViewOfFile(pTelemetry);
+							}
+							CloseHandle(hTelemetry);
 						}
-						else
+						if (!fpsShown)
 							TextOut (paint_device_context,420,183,"--", 2);
 					}
 
@@ -446,6 +454,8 @@ int WINAPI wWinMain(HINSTANCE instance_handle, HINSTANCE, LPWSTR, INT) {
 	main_window.add_item2("FreeTrack\t20");
 	main_window.add_item2("Shared Memory Tracker\t30");
 	main_window.add_item2("OculusTrack\t40");
+	main_window.add_item2("Socket Tracker (UDP)\t50");
+	main_window.add_item2("Replay Tracker\t60");
 
 
     UINT32 num_of_paths = 0;
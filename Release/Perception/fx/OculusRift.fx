@@ -120,13 +120,10 @@ float2 ApplyZBuffer(float2 coord,float2 origCoord, float depth)
 	return newPos;
 }
 
-float4 SBSRift(float2 Tex : TEXCOORD0) : COLOR
+// Samples and composes the output color from the warped (rotated, offset and scaled) 
+// texture coordinates of each channel. Tex is the screen coordinate.
+float4 RiftCompose(float2 Tex, float2 tcRed, float2 tcGreen, float2 tcBlue)
 {
-	float2 newPos = Tex;
-	float2 tcRed;
-	float2 tcGreen;
-	float2 tcBlue;
-	float angle = Rotation;
 	float3 outColor;	
 	float z;
 	float depthValue = 0.0f;
@@ -142,23 +139,6 @@ float4 SBSRift(float2 Tex : TEXCOORD0) : COLOR
 		return tex2D(TexMap2, pos.xy);
 	}
 
-	if (Tex.x > 0.5f) {
-		// mirror to get the right-eye distortion
-		newPos.x = 1.0f - newPos.x;
-		angle = -Rotation;
-	}  
-
-	// Chromatic Aberation Correction using coefs from SDK.
-	tcBlue = HmdWarp(newPos, float2(Chroma.z, Chroma.w));
-	tcBlue = rotatePoint(angle, tcBlue);
-	if (Tex.x > 0.5f)
-	{
-		// unmirror the right-eye coords
-		tcBlue.x = 1 - tcBlue.x;
-	}	
-	tcBlue.x = tcBlue.x - ViewportXOffset;
-	tcBlue.y = tcBlue.y - ViewportYOffset;
-	tcBlue = ScalePoint(ZoomScale, tcBlue);	
 	if(ZBuffer)
 	{
 		//TODO Try sampling from other texture to see if that makes any difference (that makes no sense since they are identical but worhth a try)
@@ -184,48 +164,14 @@ float4 SBSRift(float2 Tex : TEXCOORD0) : COLOR
 			applyDepthFunctions = true;
 		}
 		tcBlue = ApplyZBuffer(tcBlue,Tex,depthValue);	
-	}	
-
-	// Clamp on blue, because we expand the blue channel outward the most.
-	// Symmetry makes this ok to do before any unmirroring.
-	if (any(clamp(tcBlue.xy, float2(0.0,0.0), float2(1.0, 1.0)) - tcBlue.xy))
-		return 0;
-
-	// Chromatic Aberation Correction using coefs from SDK.
-	tcRed = HmdWarp(newPos, float2(Chroma.x, Chroma.y));
-	tcRed = rotatePoint(angle, tcRed);
-	if (Tex.x > 0.5f)
-	{
-		// unmirror the right-eye coords
-		tcRed.x = 1 - tcRed.x;
-	}	
-	tcRed.x = tcRed.x - ViewportXOffset;
-	tcRed.y = tcRed.y - ViewportYOffset;
-	tcRed = ScalePoint(ZoomScale, tcRed);	
-	if(ZBuffer)
-	{
 		tcRed = ApplyZBuffer(tcRed,Tex,depthValue);	
-	}	
-
-	tcGreen = HmdWarp(newPos, float2(0.0f, 0.0f));
-	tcGreen = rotatePoint(angle, tcGreen);
-	if (Tex.x > 0.5f)
-	{
-		// unmirror the right-eye coords
-		tcGreen.x = 1 - tcGreen.x;
-	}	
-	tcGreen.x = tcGreen.x - ViewportXOffset;
-	tcGreen.y = tcGreen.y - ViewportYOffset;
-	tcGreen = ScalePoint(ZoomScale, tcGreen);	
-	if(ZBuffer)
-	{
 		tcGreen = ApplyZBuffer(tcGreen,Tex,depthValue);	
 	}	
 
+	// Clamp on blue, because we expand the blue channel outward the most.
 	if (any(clamp(tcBlue.xy, float2(0.0,0.0), float2(1.0, 1.0)) - tcBlue.xy))
 		return 0;
 
-	
 	if (ZBufferVisualisationMode && ZBuffer) 
 	{
 		if(applyDepthFunctions)
@@ -332,6 +278,76 @@ float4 SBSRift(float2 Tex : TEXCOORD0) : COLOR
 	return returnColour;
 }
 
+float4 SBSRift(float2 Tex : TEXCOORD0) : COLOR
+{
+	float2 newPos = Tex;
+	float2 tcRed;
+	float2 tcGreen;
+	float2 tcBlue;
+	float angle = Rotation;
+
+	if (Tex.x > 0.5f) {
+		// mirror to get the right-eye distortion
+		newPos.x = 1.0f - newPos.x;
+		angle = -Rotation;
+	}  
+
+	// Chromatic Aberation Correction using coefs from SDK.
+	tcBlue = HmdWarp(newPos, float2(Chroma.z, Chroma.w));
+	tcBlue = rotatePoint(angle, tcBlue);
+	if (Tex.x > 0.5f)
+	{
+		// unmirror the right-eye coords
+		tcBlue.x = 1 - tcBlue.x;
+	}	
+	tcBlue.x = tcBlue.x - ViewportXOffset;
+	tcBlue.y = tcBlue.y - ViewportYOffset;
+	tcBlue = ScalePoint(ZoomScale, tcBlue);	
+
+	// Chromatic Aberation Correction using coefs from SDK.
+	tcRed = HmdWarp(newPos, float2(Chroma.x, Chroma.y));
+	tcRed = rotatePoint(angle, tcRed);
+	if (Tex.x > 0.5f)
+	{
+		// unmirror the right-eye coords
+		tcRed.x = 1 - tcRed.x;
+	}	
+	tcRed.x = tcRed.x - ViewportXOffset;
+	tcRed.y = tcRed.y - ViewportYOffset;
+	tcRed = ScalePoint(ZoomScale, tcRed);	
+
+	tcGreen = HmdWarp(newPos, float2(0.0f, 0.0f));
+	tcGreen = rotatePoint(angle, tcGreen);
+	if (Tex.x > 0.5f)
+	{
+		// unmirror the right-eye coords
+		tcGreen.x = 1 - tcGreen.x;
+	}	
+	tcGreen.x = tcGreen.x - ViewportXOffset;
+	tcGreen.y = tcGreen.y - ViewportYOffset;
+	tcGreen = ScalePoint(ZoomScale, tcGreen);	
+
+	return RiftCompose(Tex, tcRed, tcGreen, tcBlue);
+}
+
+// Rotation, viewport offset and zoom of an interpolated mesh coordinate. Not part of the (static) mesh,
+// they change per frame (roll, reprojection, telescope). Rotating the unmirrored right-eye coordinate
+// by Rotation equals rotating the mirrored one by -Rotation and unmirroring, as SBSRift does.
+float2 MeshPoint(float2 coord)
+{
+	float2 newPos = rotatePoint(Rotation, coord);
+	newPos.x = newPos.x - ViewportXOffset;
+	newPos.y = newPos.y - ViewportYOffset;
+	return ScalePoint(ZoomScale, newPos);
+}
+
+// Distortion mesh version : the warped and unmirrored coordinates of each channel are computed per 
+// vertex (DistortionMesh.cpp) and interpolated, rotation, offset and zoom are applied here.
+float4 SBSRiftMesh(float2 Tex : TEXCOORD0, float2 tcRed : TEXCOORD1, float2 tcGreen : TEXCOORD2, float2 tcBlue : TEXCOORD3) : COLOR
+{
+	return RiftCompose(Tex, MeshPoint(tcRed), MeshPoint(tcGreen), MeshPoint(tcBlue));
+}
+
 technique ViewShader
 {
 	pass P0
@@ -339,4 +355,13 @@ technique ViewShader
 		VertexShader = null;
 		PixelShader  = compile ps_3_0 SBSRift();
 	}
+}
+
+technique ViewShaderMesh
+{
+	pass P0
+	{
+		VertexShader = null;
+		PixelShader  = compile ps_3_0 SBSRiftMesh();
+	}
 }
\ No newline at end of file
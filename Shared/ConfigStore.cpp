@@ -0,0 +1,149 @@
+#include "ConfigStore.h"
+#include "VireioUtil.h"
+
+using namespace pugi;
+using std::string;
+
+/**
+* The process wide store (constructed before DllMain/main).
+***/
+static ConfigStore configStore;
+
+/**
+* Constructor.
+***/
+ConfigStore::ConfigStore()
+{
+	InitializeCriticalSection(&cs);
+}
+
+/**
+* Destructor, releases the documents. Unsaved changes are lost.
+***/
+ConfigStore::~ConfigStore()
+{
+	for (size_t i = 0; i < files.size(); i++)
+		delete files[i];
+	files.clear();
+	DeleteCriticalSection(&cs);
+}
+
+/**
+* Returns the process wide store.
+***/
+ConfigStore& ConfigStore::Instance()
+{
+	return configStore;
+}
+
+/**
+* Locks the store, documents and their nodes may be used until Unlock().
+***/
+void ConfigStore::Lock()
+{
+	EnterCriticalSection(&cs);
+}
+
+/**
+* Unlocks the store.
+***/
+void ConfigStore::Unlock()
+{
+	LeaveCriticalSection(&cs);
+}
+
+/**
+* Returns the parsed file, parses it if it wasn't parsed yet or changed on disk since.
+* Unsaved changes are kept even if the file changed on disk, they are saved over it.
+* @param path Full path of the file.
+* @return NULL if the file is missing or doesn't parse.
+***/
+xml_document* ConfigStore::Get(const string& path)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &attributes))
+		return NULL;
+
+	File* pFile = Find(path);
+	if (!pFile)
+	{
+		pFile = new File();
+		pFile->path = path;
+		pFile->loaded = false;
+		pFile->changed = false;
+		files.push_back(pFile);
+	}
+
+	if (pFile->loaded && (pFile->changed || 
+		((pFile->size == attributes.nFileSizeLow) && (CompareFileTime(&pFile->time, &attributes.ftLastWriteTime) == 0))))
+		return &pFile->doc;
+
+	vireio::debugf("ConfigStore: parsing %s\n", path.c_str());
+	xml_parse_result result = pFile->doc.load_file(path.c_str());
+	pFile->loaded = (result.status == status_ok);
+	pFile->changed = false;
+	pFile->size = attributes.nFileSizeLow;
+	pFile->time = attributes.ftLastWriteTime;
+
+	return pFile->loaded ? &pFile->doc : NULL;
+}
+
+/**
+* Marks the file of a node as changed (the node of a document returned by Get()).
+***/
+void ConfigStore::MarkChanged(const xml_node& node)
+{
+	xml_node root = node.root();
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		if (files[i]->loaded && (files[i]->doc == root))
+		{
+			files[i]->changed = true;
+			return;
+		}
+	}
+}
+
+/**
+* Saves the file if it changed : writes a temporary file and renames it over the file.
+* @param path Full path of the file.
+* @return False if the file isn't in the store or could not be written.
+***/
+bool ConfigStore::Save(const string& path)
+{
+	File* pFile = Find(path);
+	if (!pFile || !pFile->loaded)
+		return false;
+	if (!pFile->changed)
+		return true;
+
+	string tempPath = vireio::retprintf("%s.%u.tmp", path.c_str(), GetCurrentProcessId());
+	if (!pFile->doc.save_file(tempPath.c_str()) || 
+		!MoveFileEx(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		OutputDebugString("ConfigStore: Save failed\n");
+		DeleteFile(tempPath.c_str());
+		return false;
+	}
+
+	// the saved file is the parsed state
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &attributes))
+	{
+		pFile->size = attributes.nFileSizeLow;
+		pFile->time = attributes.ftLastWriteTime;
+	}
+	pFile->changed = false;
+	return true;
+}
+
+/**
+* Returns the file of the path, NULL if not in the store.
+***/
+ConfigStore::File* ConfigStore::Find(const string& path)
+{
+	for (size_t i = 0; i < files.size(); i++)
+		if (_stricmp(files[i]->path.c_str(), path.c_str()) == 0)
+			return files[i];
+	return NULL;
+}
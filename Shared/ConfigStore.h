@@ -0,0 +1,68 @@
+
+#ifndef CONFIG_STORE_H_INCLUDED
+#define CONFIG_STORE_H_INCLUDED
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include "pugixml.hpp"
+
+/**
+* Parse-once store of the configuration files (config.xml, users.xml, profiles.xml).
+* Each file is parsed once and kept in memory, it is only parsed again if it changed on disk.
+* Changed attributes mark their file as changed (MarkChanged()), Save() writes changed files only,
+* to a temporary file which then replaces the file (atomic rename).
+* Documents and their nodes may only be used while the store is locked (ConfigStoreLock).
+***/
+class ConfigStore
+{
+public:
+	ConfigStore();
+	virtual ~ConfigStore();
+
+	/*** ConfigStore public methods ***/
+	static ConfigStore& Instance();
+	void Lock();
+	void Unlock();
+	pugi::xml_document* Get(const std::string& path);
+	void MarkChanged(const pugi::xml_node& node);
+	bool Save(const std::string& path);
+
+private:
+	/**
+	* One configuration file.
+	***/
+	struct File
+	{
+		std::string path;          /**< Full path */
+		pugi::xml_document doc;    /**< Parsed document */
+		bool loaded;               /**< True if doc holds the parsed file */
+		bool changed;              /**< True if doc has changes not saved yet */
+		DWORD size;                /**< File size at the last load or save */
+		FILETIME time;             /**< Last write time at the last load or save */
+	};
+
+	/*** ConfigStore private methods ***/
+	File* Find(const std::string& path);
+
+	/**
+	* The files, in order of first use.
+	***/
+	std::vector<File*> files;
+	/**
+	* Guards the store and the documents.
+	***/
+	CRITICAL_SECTION cs;
+};
+
+/**
+* Locks the configuration store for the lifetime of the object (recursive).
+***/
+class ConfigStoreLock
+{
+public:
+	ConfigStoreLock() {ConfigStore::Instance().Lock();}
+	~ConfigStoreLock() {ConfigStore::Instance().Unlock();}
+};
+
+#endif
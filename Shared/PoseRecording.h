@@ -0,0 +1,65 @@
+
+#ifndef POSE_RECORDING_H_INCLUDED
+#define POSE_RECORDING_H_INCLUDED
+
+#include <stdio.h>
+
+/**
+* Pose recording file magic ('VTPR') and version.
+***/
+#define POSE_RECORDING_MAGIC 0x52505456
+#define POSE_RECORDING_VERSION 1
+
+#pragma pack(push, 1)
+/**
+* Pose recording file header, followed by PoseRecord entries until the end of the file.
+* Only standard C types (little endian, packed), so offline tools on any platform can read recordings.
+***/
+struct PoseRecordingHeader
+{
+	unsigned int magic;       /**< POSE_RECORDING_MAGIC */
+	unsigned int version;     /**< POSE_RECORDING_VERSION */
+	unsigned int recordSize;  /**< sizeof(PoseRecord) */
+	unsigned int reserved;    /**< Zero */
+};
+
+/**
+* One recorded pose, as consumed by the proxy (primary orientation and position of the tracker).
+***/
+struct PoseRecord
+{
+	long long timeUs;         /**< Update time, microseconds since the recording (re)started */
+	float yaw, pitch, roll;   /**< Orientation, radians */
+	float x, y, z;            /**< Position */
+	int status;               /**< MotionTrackerStatus at the update */
+};
+#pragma pack(pop)
+
+/**
+* Writes the header to a new (empty) recording file.
+* @return False on write error.
+***/
+inline bool PoseRecordingWriteHeader(FILE* pFile)
+{
+	PoseRecordingHeader header;
+	header.magic = POSE_RECORDING_MAGIC;
+	header.version = POSE_RECORDING_VERSION;
+	header.recordSize = sizeof(PoseRecord);
+	header.reserved = 0;
+	return fwrite(&header, sizeof(header), 1, pFile) == 1;
+}
+
+/**
+* Reads and checks the header of a recording file, the file is then positioned at the first record.
+* @return False if the file isn't a recording of this version.
+***/
+inline bool PoseRecordingReadHeader(FILE* pFile)
+{
+	PoseRecordingHeader header;
+	if (fread(&header, sizeof(header), 1, pFile) != 1)
+		return false;
+	return (header.magic == POSE_RECORDING_MAGIC) && (header.version == POSE_RECORDING_VERSION) &&
+		(header.recordSize == sizeof(PoseRecord));
+}
+
+#endif
@@ -0,0 +1,228 @@
+
+#ifndef PROFILE_INDEX_H_INCLUDED
+#define PROFILE_INDEX_H_INCLUDED
+
+#include <windows.h>
+#include <string.h>
+#include <vector>
+
+/**
+* Profile index file, next to cfg\profiles.xml.
+***/
+#define PROFILE_INDEX_FILE "cfg\\profiles.idx"
+
+/**
+* Index magic ('VPIX') and version.
+***/
+#define PROFILE_INDEX_MAGIC 0x58495056
+#define PROFILE_INDEX_VERSION 1
+
+/**
+* Profile entry flags.
+***/
+#define PROFILE_INDEX_64BIT 0x0001  /**< cpu_architecture="64bit" */
+
+/**
+* Profile index header.
+* Compact lookup table of cfg\profiles.xml : profile entries in file order, an open addressing hash
+* table (linear probing) of entry numbers keyed by the hash of the game exe and a string pool.
+* The source size and write time identify the profiles.xml the index was built from.
+***/
+struct ProfileIndexHeader
+{
+	DWORD magic;          /**< PROFILE_INDEX_MAGIC */
+	DWORD version;        /**< PROFILE_INDEX_VERSION */
+	DWORD fileSize;       /**< Size of the whole index */
+	DWORD sourceSize;     /**< Size of profiles.xml */
+	FILETIME sourceTime;  /**< Last write time of profiles.xml */
+	DWORD entryCount;     /**< Profile entries */
+	DWORD entriesOffset;  /**< ProfileIndexEntry[entryCount] */
+	DWORD slotCount;      /**< Hash slots, power of two, at least twice the entries */
+	DWORD slotsOffset;    /**< DWORD[slotCount] : entry number + 1, zero if empty */
+	DWORD stringsOffset;  /**< String pool, zero terminated strings up to the end of the index */
+};
+
+/**
+* One profile.
+***/
+struct ProfileIndexEntry
+{
+	DWORD hash;           /**< ProfileIndexHash() of the game exe */
+	DWORD exeOffset;      /**< game_exe, offset in the index */
+	DWORD dirOffset;      /**< dir_contains, offset in the index, zero if none */
+	DWORD flags;          /**< PROFILE_INDEX_ flags */
+};
+
+/**
+* Hash of a game exe name (FNV-1a, case sensitive as the profile lookup).
+***/
+inline DWORD ProfileIndexHash(const char* name)
+{
+	DWORD hash = 2166136261u;
+	for (const unsigned char* p = (const unsigned char*)name; *p; p++)
+		hash = (hash ^ *p) * 16777619u;
+	return hash;
+}
+
+/**
+* True if the data is a consistent index of this version built from the given source file.
+* @param pData The index.
+* @param size Size of the index data.
+* @param sourceSize Size of profiles.xml.
+* @param sourceTime Last write time of profiles.xml.
+***/
+inline bool ProfileIndexIsValid(const void* pData, DWORD size, DWORD sourceSize, FILETIME sourceTime)
+{
+	const ProfileIndexHeader* pIndex = (const ProfileIndexHeader*)pData;
+	if ((size < sizeof(ProfileIndexHeader)) || (pIndex->magic != PROFILE_INDEX_MAGIC) || 
+		(pIndex->version != PROFILE_INDEX_VERSION) || (pIndex->fileSize != size))
+		return false;
+	if ((pIndex->sourceSize != sourceSize) || (CompareFileTime(&pIndex->sourceTime, &sourceTime) != 0))
+		return false;
+	if ((pIndex->slotCount == 0) || (pIndex->slotCount & (pIndex->slotCount - 1)) || (pIndex->slotCount < pIndex->entryCount))
+		return false;
+	if ((pIndex->entriesOffset + pIndex->entryCount * sizeof(ProfileIndexEntry) > pIndex->slotsOffset) ||
+		(pIndex->slotsOffset + pIndex->slotCount * sizeof(DWORD) > pIndex->stringsOffset) ||
+		(pIndex->stringsOffset >= size))
+		return false;
+	// strings are zero terminated up to the end
+	return ((const char*)pData)[size - 1] == 0;
+}
+
+/**
+* Returns a string of the index, empty if the offset is out of the string pool.
+***/
+inline const char* ProfileIndexString(const ProfileIndexHeader* pIndex, DWORD offset)
+{
+	if ((offset < pIndex->stringsOffset) || (offset >= pIndex->fileSize))
+		return "";
+	return (const char*)pIndex + offset;
+}
+
+/**
+* Returns the profile entries (file order).
+***/
+inline const ProfileIndexEntry* ProfileIndexEntries(const ProfileIndexHeader* pIndex)
+{
+	return (const ProfileIndexEntry*)((const char*)pIndex + pIndex->entriesOffset);
+}
+
+/**
+* Finds the next profile of a game exe, in file order.
+* @param pIndex The (valid) index.
+* @param name The game exe.
+* @param hash ProfileIndexHash(name).
+* @param pSlot [in, out] Hash slot to continue at, set to hash & (slotCount - 1) for the first call.
+* @return The entry, NULL if there are no more profiles of the exe.
+***/
+inline const ProfileIndexEntry* ProfileIndexFindNext(const ProfileIndexHeader* pIndex, const char* name, DWORD hash, DWORD* pSlot)
+{
+	const DWORD* pSlots = (const DWORD*)((const char*)pIndex + pIndex->slotsOffset);
+	const ProfileIndexEntry* pEntries = ProfileIndexEntries(pIndex);
+	DWORD mask = pIndex->slotCount - 1;
+
+	// linear probing, the table is never full
+	for (DWORD i = 0; i < pIndex->slotCount; i++)
+	{
+		DWORD slot = *pSlot;
+		DWORD entry = pSlots[slot];
+		if ((entry == 0) || (entry > pIndex->entryCount))
+			return NULL;
+		*pSlot = (slot + 1) & mask;
+
+		const ProfileIndexEntry* pEntry = &pEntries[entry - 1];
+		if ((pEntry->hash == hash) && (strcmp(ProfileIndexString(pIndex, pEntry->exeOffset), name) == 0))
+			return pEntry;
+	}
+	return NULL;
+}
+
+/**
+* Builds a profile index, profiles are added in file order.
+***/
+class ProfileIndexBuilder
+{
+public:
+	ProfileIndexBuilder() : m_strings(1, '\0') {}
+
+	/**
+	* Adds a profile.
+	* @param exe The game exe.
+	* @param dir The dir_contains filter, empty if none.
+	* @param flags PROFILE_INDEX_ flags.
+	***/
+	void Add(const char* exe, const char* dir, DWORD flags)
+	{
+		ProfileIndexEntry entry;
+		entry.hash = ProfileIndexHash(exe);
+		entry.exeOffset = (DWORD)m_strings.size();
+		m_strings.insert(m_strings.end(), exe, exe + strlen(exe) + 1);
+		entry.dirOffset = 0;
+		if (*dir)
+		{
+			entry.dirOffset = (DWORD)m_strings.size();
+			m_strings.insert(m_strings.end(), dir, dir + strlen(dir) + 1);
+		}
+		entry.flags = flags;
+		m_entries.push_back(entry);
+	}
+
+	/**
+	* Lays out the index of the added profiles.
+	* @param sourceSize Size of profiles.xml.
+	* @param sourceTime Last write time of profiles.xml.
+	* @param index [out] The index.
+	***/
+	void Build(DWORD sourceSize, FILETIME sourceTime, std::vector<char>& index)
+	{
+		DWORD slotCount = 16;
+		while (slotCount < m_entries.size() * 2)
+			slotCount <<= 1;
+
+		ProfileIndexHeader header;
+		header.magic = PROFILE_INDEX_MAGIC;
+		header.version = PROFILE_INDEX_VERSION;
+		header.sourceSize = sourceSize;
+		header.sourceTime = sourceTime;
+		header.entryCount = (DWORD)m_entries.size();
+		header.entriesOffset = sizeof(ProfileIndexHeader);
+		header.slotCount = slotCount;
+		header.slotsOffset = header.entriesOffset + header.entryCount * sizeof(ProfileIndexEntry);
+		header.stringsOffset = header.slotsOffset + slotCount * sizeof(DWORD);
+		header.fileSize = header.stringsOffset + (DWORD)m_strings.size();
+
+		// hash table in file order, so the profiles of an exe are probed in file order
+		std::vector<ProfileIndexEntry> entries(m_entries);
+		std::vector<DWORD> slots(slotCount, 0);
+		for (DWORD i = 0; i < header.entryCount; i++)
+		{
+			entries[i].exeOffset += header.stringsOffset;
+			if (entries[i].dirOffset)
+				entries[i].dirOffset += header.stringsOffset;
+
+			DWORD slot = entries[i].hash & (slotCount - 1);
+			while (slots[slot])
+				slot = (slot + 1) & (slotCount - 1);
+			slots[slot] = i + 1;
+		}
+
+		index.resize(header.fileSize);
+		memcpy(&index[0], &header, sizeof(header));
+		if (!entries.empty())
+			memcpy(&index[header.entriesOffset], &entries[0], entries.size() * sizeof(ProfileIndexEntry));
+		memcpy(&index[header.slotsOffset], &slots[0], slots.size() * sizeof(DWORD));
+		memcpy(&index[header.stringsOffset], &m_strings[0], m_strings.size());
+	}
+
+private:
+	/**
+	* Entries, string offsets relative to the string pool until the index is laid out.
+	***/
+	std::vector<ProfileIndexEntry> m_entries;
+	/**
+	* String pool, starts with the empty string.
+	***/
+	std::vector<char> m_strings;
+};
+
+#endif
@@ -30,6 +30,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ProxyHelper.h"
 #include "VireioUtil.h"
 #include "ConfigDefaults.h"
+#include "ProfileIndex.h"
+#include "ConfigStore.h"
 #include "json/json.h"
 
 #include <algorithm>
@@ -156,13 +158,20 @@ string getFilenamePart(const string &path)
  */
 template<class T> static void set_attribute(xml_node &node, const char *key, T newValue)
 {
-	if(node.attribute(key).empty())
+	xml_attribute attribute = node.attribute(key);
+	if(attribute.empty())
 	{
-		node.append_attribute(key).set_value(newValue);
+		attribute = node.append_attribute(key);
+		attribute.set_value(newValue);
+		ConfigStore::Instance().MarkChanged(node);
 	}
 	else
 	{
-		node.attribute(key).set_value(newValue);
+		// only changed values get the file saved
+		string oldValue = attribute.value();
+		attribute.set_value(newValue);
+		if (oldValue != attribute.value())
+			ConfigStore::Instance().MarkChanged(node);
 	}
 }
 
@@ -349,12 +358,12 @@ bool ProxyHelper::LoadUserConfig(UserConfig &userConfig)
 	// get global config
 	string configPath = GetPath("cfg\\config.xml");
 
-	xml_document docConfig;
-	xml_parse_result resultConfig = docConfig.load_file(configPath.c_str());
+	ConfigStoreLock lock;
+	xml_document* pDocConfig = ConfigStore::Instance().Get(configPath);
 
-	if(resultConfig.status == status_ok)
+	if(pDocConfig)
 	{
-		xml_node xml_config = docConfig.child("config");
+		xml_node xml_config = pDocConfig->child("config");
 
 		userConfig.mode = xml_config.attribute("stereo_mode").as_int();
 		userConfig.mode2 = xml_config.attribute("tracker_mode").as_int();
@@ -383,19 +392,19 @@ bool ProxyHelper::SaveUserConfig(int mode, float aspect)
 	// get global config
 	string configPath = GetPath("cfg\\config.xml");
 
-	xml_document docConfig;
-	xml_parse_result resultConfig = docConfig.load_file(configPath.c_str());
+	ConfigStoreLock lock;
+	xml_document* pDocConfig = ConfigStore::Instance().Get(configPath);
 
-	if(resultConfig.status == status_ok)
+	if(pDocConfig)
 	{
-		xml_node xml_config = docConfig.child("config");
+		xml_node xml_config = pDocConfig->child("config");
 
 		if(mode >= 0)
-			xml_config.attribute("stereo_mode") = mode;
+			set_attribute(xml_config, "stereo_mode", mode);
 		if(aspect >= 0.0f)
-			xml_config.attribute("aspect_multiplier") = aspect;
+			set_attribute(xml_config, "aspect_multiplier", aspect);
 
-		docConfig.save_file(configPath.c_str());
+		ConfigStore::Instance().Save(configPath);
 
 		return true;
 	}
@@ -414,17 +423,17 @@ bool ProxyHelper::LoadUserConfig(ProxyConfig& config, OculusProfile& oculusProfi
 	string usersPath = GetPath("cfg\\users.xml");
 	debugf("%s\n", usersPath.c_str());
 
-	xml_document docUsers;
-	xml_parse_result resultUsers = docUsers.load_file(usersPath.c_str());
+	ConfigStoreLock lock;
+	xml_document* pDocUsers = ConfigStore::Instance().Get(usersPath);
 	xml_node users;
 	xml_node userProfile;
 
 	config.ipd = IPD_DEFAULT;
 
 	// first, load user settings stored in "cfg\users.xml"
-	if(resultUsers.status == status_ok)
+	if(pDocUsers)
 	{
-		xml_node xml_user_profiles = docUsers.child("users");
+		xml_node xml_user_profiles = pDocUsers->child("users");
 
 		for (xml_node user_profile = xml_user_profiles.child("user"); user_profile; user_profile = user_profile.next_sibling("user"))
 		{
@@ -559,14 +568,14 @@ bool ProxyHelper::SaveUserConfig(float ipd)
 	string profilePath = GetPath("cfg\\users.xml");
 	debugf("%s\n", profilePath.c_str());
 
-	xml_document docProfiles;
-	xml_parse_result resultProfiles = docProfiles.load_file(profilePath.c_str());
+	ConfigStoreLock lock;
+	xml_document* pDocProfiles = ConfigStore::Instance().Get(profilePath);
 	xml_node profile;
 	xml_node gameProfile;
 
-	if(resultProfiles.status == status_ok)
+	if(pDocProfiles)
 	{
-		xml_node xml_profiles = docProfiles.child("users");
+		xml_node xml_profiles = pDocProfiles->child("users");
 
 		for (xml_node profile = xml_profiles.child("user"); profile; profile = profile.next_sibling("user"))
 		{
@@ -580,11 +589,11 @@ bool ProxyHelper::SaveUserConfig(float ipd)
 		}
 	}
 
-	if(resultProfiles.status == status_ok && profileFound && gameProfile)
+	if(pDocProfiles && profileFound && gameProfile)
 	{
 		OutputDebugString("Save the settings to profile!!!\n");
-		gameProfile.attribute("ipd") = ipd;
-		docProfiles.save_file(profilePath.c_str());
+		set_attribute(gameProfile, "ipd", ipd);
+		ConfigStore::Instance().Save(profilePath);
 		profileSaved = true;
 	}
 
@@ -600,17 +609,17 @@ bool ProxyHelper::SaveTrackerMode(int mode)
 	// get global config
 	string configPath = GetPath("cfg\\config.xml");
 
-	xml_document docConfig;
-	xml_parse_result resultConfig = docConfig.load_file(configPath.c_str());
+	ConfigStoreLock lock;
+	xml_document* pDocConfig = ConfigStore::Instance().Get(configPath);
 
-	if(resultConfig.status == status_ok)
+	if(pDocConfig)
 	{
-		xml_node xml_config = docConfig.child("config");
+		xml_node xml_config = pDocConfig->child("config");
 
 		if(mode >= 0)
-			xml_config.attribute("tracker_mode") = mode;
+			set_attribute(xml_config, "tracker_mode", mode);
 
-		docConfig.save_file(configPath.c_str());
+		ConfigStore::Instance().Save(configPath);
 
 		return true;
 	}
@@ -627,17 +636,17 @@ bool ProxyHelper::SaveDisplayAdapter(int adapter)
 	// get global config
 	string configPath = GetPath("cfg\\config.xml");
 
-	xml_document docConfig;
-	xml_parse_result resultConfig = docConfig.load_file(configPath.c_str());
+	ConfigStoreLock lock;
+	xml_document* pDocConfig = ConfigStore::Instance().Get(configPath);
 
-	if(resultConfig.status == status_ok)
+	if(pDocConfig)
 	{
-		xml_node xml_config = docConfig.child("config");
+		xml_node xml_config = pDocConfig->child("config");
 
 		if(adapter >= 0)
-			xml_config.attribute("display_adapter") = adapter;
+			set_attribute(xml_config, "display_adapter", adapter);
 
-		docConfig.save_file(configPath.c_str());
+		ConfigStore::Instance().Save(configPath);
 
 		return true;
 	}
@@ -661,12 +670,12 @@ bool ProxyHelper::LoadConfig(ProxyConfig& config, OculusProfile& oculusProfile)
 	string configPath = GetPath("cfg\\config.xml");
 	debugf("%s\n", configPath.c_str());
 
-	xml_document docConfig;
-	xml_parse_result resultConfig = docConfig.load_file(configPath.c_str());
+	ConfigStoreLock lock;
+	xml_document* pDocConfig = ConfigStore::Instance().Get(configPath);
 
-	if(resultConfig.status == status_ok)
+	if(pDocConfig)
 	{
-		xml_node xml_config = docConfig.child("config");
+		xml_node xml_config = pDocConfig->child("config");
 
 		LoadSetting(xml_config, "stereo_mode", &config.stereo_mode);
 		LoadSetting(xml_config, "aspect_multiplier", &config.aspect_multiplier);
@@ -688,14 +697,13 @@ bool ProxyHelper::LoadConfig(ProxyConfig& config, OculusProfile& oculusProfile)
 	debugf("%s\n", profilePath.c_str());
 	string targetPath = GetTargetPath();
 
-	xml_document docProfiles;
-	xml_parse_result resultProfiles = docProfiles.load_file(profilePath.c_str());
+	xml_document* pDocProfiles = ConfigStore::Instance().Get(profilePath);
 	xml_node profile;
 	xml_node gameProfile;
 
-	if(resultProfiles.status == status_ok)
+	if(pDocProfiles)
 	{
-		xml_node xml_profiles = docProfiles.child("profiles");
+		xml_node xml_profiles = pDocProfiles->child("profiles");
 
 		for (xml_node profile = xml_profiles.child("profile"); profile; profile = profile.next_sibling("profile"))
 		{
@@ -724,7 +732,7 @@ bool ProxyHelper::LoadConfig(ProxyConfig& config, OculusProfile& oculusProfile)
 		}
 	}
 
-	if(resultProfiles.status == status_ok && profileFound && gameProfile)
+	if(pDocProfiles && profileFound && gameProfile)
 	{
 		OutputDebugString("Set the config to profile!!!\n");
 
@@ -819,14 +827,14 @@ bool ProxyHelper::SaveConfig(ProxyConfig& config)
 	debugf("%s\n", profilePath.c_str());
 	string targetPath = GetTargetPath();
 
-	xml_document docProfiles;
-	xml_parse_result resultProfiles = docProfiles.load_file(profilePath.c_str());
+	ConfigStoreLock lock;
+	xml_document* pDocProfiles = ConfigStore::Instance().Get(profilePath);
 	xml_node profile;
 	xml_node gameProfile;
 
-	if(resultProfiles.status == status_ok)
+	if(pDocProfiles)
 	{
-		xml_node xml_profiles = docProfiles.child("profiles");
+		xml_node xml_profiles = pDocProfiles->child("profiles");
 
 		for (xml_node profile = xml_profiles.child("profile"); profile; profile = profile.next_sibling("profile"))
 		{
@@ -857,7 +865,7 @@ bool ProxyHelper::SaveConfig(ProxyConfig& config)
 		}
 	}
 
-	if(resultProfiles.status == status_ok && profileFound && gameProfile)
+	if(pDocProfiles && profileFound && gameProfile)
 	{
 		OutputDebugString("Save the settings to profile!!!\n");
 
@@ -871,7 +879,7 @@ bool ProxyHelper::SaveConfig(ProxyConfig& config)
 
 		HandleGameProfile(CONFIG_SAVE, gameProfile, config);
 
-		docProfiles.save_file(profilePath.c_str());
+		ConfigStore::Instance().Save(profilePath);
 
 		profileSaved = true;
 	}
@@ -985,6 +993,21 @@ void HandleGameProfile(ProxyHelper::ConfigTransferDirection dir, xml_node &node,
 	HANDLE_SETTING(swap_eyes,                false);
 	HANDLE_SETTING_ATTR("ipd_offset",              IPDOffset, 0.0f);
 	HANDLE_SETTING_ATTR("use_sdk_pose_prediction", useSDKPosePrediction, true);
+	HANDLE_SETTING_ATTR("late_latch_reprojection", lateLatchReprojection, false);
+	HANDLE_SETTING_ATTR("tracker_sampling",        trackerSampling, false);
+	HANDLE_SETTING_ATTR("tracking_worker",         trackingWorker, false);
+	HANDLE_SETTING_ATTR("log_file",                logFile, false);
+	HANDLE_SETTING_ATTR("prediction_ms",           predictionMs, 0.0f);
+	HANDLE_SETTING_ATTR("prediction_velocity_filter",     predictionVelocityFilter, 0.5f);
+	HANDLE_SETTING_ATTR("prediction_acceleration_filter", predictionAccelerationFilter, 0.8f);
+	HANDLE_SETTING_ATTR("mouse_emulation_rate",    mouseEmulationRate, 0.0f);
+	HANDLE_SETTING_ATTR("mouse_yaw_deadzone",      mouseYawDeadzone, 0.0f);
+	HANDLE_SETTING_ATTR("mouse_pitch_deadzone",    mousePitchDeadzone, 0.0f);
+	HANDLE_SETTING_ATTR("mouse_yaw_exponent",      mouseYawExponent, 1.0f);
+	HANDLE_SETTING_ATTR("mouse_pitch_exponent",    mousePitchExponent, 1.0f);
+	HANDLE_SETTING_ATTR("tracker_record_path",     trackerRecordPath, "");
+	HANDLE_SETTING_ATTR("tracker_replay_path",     trackerReplayPath, "");
+	HANDLE_SETTING_ATTR("tracker_replay_speed",    trackerReplaySpeed, 1.0f);
 	HANDLE_SETTING_ATTR("y_offset",                YOffset, 0.0f);
 	HANDLE_SETTING(yaw_multiplier,           DEFAULT_YAW_MULTIPLIER);
 	HANDLE_SETTING(pitch_multiplier,         DEFAULT_PITCH_MULTIPLIER);
@@ -1069,6 +1092,8 @@ void HandleGameProfile(ProxyHelper::ConfigTransferDirection dir, xml_node &node,
 	HANDLE_SETTING(HotkeyResetOrientation,  (LShift + Key('R')) || (LCtrl + Key('R')) || (Button(8)+Button(9)));
 	HANDLE_SETTING(HotkeyShowFPS,           (LShift+Key('F')) || (LCtrl+Key('F')));
 	HANDLE_SETTING(HotkeyScreenshot,        Key(VK_RCONTROL) + Key(VK_MULTIPLY));
+	HANDLE_SETTING(HotkeyBurstCapture,      Key(VK_RCONTROL) + Key(VK_DIVIDE));
+	HANDLE_SETTING(HotkeyFrameProfile,      Key(VK_RCONTROL) + Key(VK_SUBTRACT));
 	HANDLE_SETTING(HotkeyTelescopeMode,     Key(VK_LMENU) + Key(VK_MBUTTON));
 	HANDLE_SETTING(HotkeyToggleFreePitch,   LShift+Key('X'));
 	HANDLE_SETTING(HotkeyComfortMode,       LShift+Key('M'));
@@ -1117,6 +1142,125 @@ bool ProxyHelper::ParseGameType(std::string gameType, ProxyHelper::GameTypeEntry
 	return false;
 }
 
+/**
+* Read-only view of the profile index : the mapped index file, or the index built in memory if the 
+* index file could not be written.
+***/
+class ProfileIndexView
+{
+public:
+	ProfileIndexView() : hFile(INVALID_HANDLE_VALUE), hMapping(NULL), pIndex(NULL) {}
+	~ProfileIndexView() {Unmap();}
+
+	void Unmap()
+	{
+		if (hMapping)
+		{
+			if (pIndex)
+				UnmapViewOfFile(pIndex);
+			CloseHandle(hMapping);
+		}
+		if (hFile != INVALID_HANDLE_VALUE)
+			CloseHandle(hFile);
+		hFile = INVALID_HANDLE_VALUE;
+		hMapping = NULL;
+		pIndex = NULL;
+	}
+
+	HANDLE hFile;
+	HANDLE hMapping;
+	const ProfileIndexHeader* pIndex;
+	std::vector<char> built;
+};
+
+/**
+* Builds the profile index of profiles.xml.
+* @param profilePath Path of profiles.xml.
+* @param source File attributes of profiles.xml.
+* @param index [out] The index.
+* @return False if profiles.xml could not be parsed.
+***/
+static bool BuildProfileIndex(const string& profilePath, const WIN32_FILE_ATTRIBUTE_DATA& source, std::vector<char>& index)
+{
+	xml_document docProfiles;
+	xml_parse_result resultProfiles = docProfiles.load_file(profilePath.c_str());
+	if(resultProfiles.status != status_ok)
+		return false;
+
+	ProfileIndexBuilder builder;
+	xml_node xml_profiles = docProfiles.child("profiles");
+	for (xml_node profile = xml_profiles.child("profile"); profile; profile = profile.next_sibling("profile"))
+	{
+		bool _64bit = (profile.attribute("cpu_architecture").as_string("32bit") == string("64bit"));
+		builder.Add(profile.attribute("game_exe").value(), profile.attribute("dir_contains").as_string(), 
+			_64bit ? PROFILE_INDEX_64BIT : 0);
+	}
+
+	builder.Build(source.nFileSizeLow, source.ftLastWriteTime, index);
+	return true;
+}
+
+/**
+* Writes the profile index file : to a temporary file, then replaces the index.
+* Fails harmlessly if the directory is read-only or another process maps the old index.
+***/
+static bool WriteProfileIndex(const string& indexPath, const std::vector<char>& index)
+{
+	string tempPath = retprintf("%s.%u", indexPath.c_str(), GetCurrentProcessId());
+	HANDLE hFile = CreateFile(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD written = 0;
+	BOOL ok = WriteFile(hFile, &index[0], (DWORD)index.size(), &written, NULL) && (written == index.size());
+	CloseHandle(hFile);
+
+	if (!ok || !MoveFileEx(tempPath.c_str(), indexPath.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFile(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+/**
+* Opens the profile index, rebuilds it if profiles.xml changed since it was built.
+* The lookup of the hook in every process is then a file mapping and a hash probe instead of 
+* parsing profiles.xml.
+* @param profilePath Path of profiles.xml.
+* @param indexPath Path of the index file.
+* @param view [out] The index.
+* @return False if there is no (valid) profiles.xml.
+***/
+static bool OpenProfileIndex(const string& profilePath, const string& indexPath, ProfileIndexView& view)
+{
+	WIN32_FILE_ATTRIBUTE_DATA source;
+	if (!GetFileAttributesEx(profilePath.c_str(), GetFileExInfoStandard, &source))
+		return false;
+
+	view.hFile = CreateFile(indexPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (view.hFile != INVALID_HANDLE_VALUE)
+	{
+		DWORD size = GetFileSize(view.hFile, NULL);
+		if ((size != INVALID_FILE_SIZE) && (size >= sizeof(ProfileIndexHeader)))
+		{
+			view.hMapping = CreateFileMapping(view.hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (view.hMapping)
+				view.pIndex = (const ProfileIndexHeader*)MapViewOfFile(view.hMapping, FILE_MAP_READ, 0, 0, 0);
+			if (view.pIndex && ProfileIndexIsValid(view.pIndex, size, source.nFileSizeLow, source.ftLastWriteTime))
+				return true;
+		}
+		view.Unmap();
+	}
+
+	OutputDebugString("PxHelp: Rebuilding profile index.\n");
+	if (!BuildProfileIndex(profilePath, source, view.built))
+		return false;
+	WriteProfileIndex(indexPath, view.built);
+	view.pIndex = (const ProfileIndexHeader*)&view.built[0];
+	return true;
+}
+
 /**
 * True if process has a configuration profile.
 * @param name The exe process name.
@@ -1125,31 +1269,26 @@ bool ProxyHelper::HasProfile(const char* name, const char *path)
 {
 	// get the profile
 	bool profileFound = false;
-	string profilePath = GetPath("cfg\\profiles.xml");
-
-	xml_document docProfiles;
-	xml_parse_result resultProfiles = docProfiles.load_file(profilePath.c_str());
-	xml_node profile;
+	ProfileIndexView index;
 
-	if(resultProfiles.status == status_ok)
+	if (OpenProfileIndex(GetPath("cfg\\profiles.xml"), GetPath(PROFILE_INDEX_FILE), index))
 	{
-		xml_node xml_profiles = docProfiles.child("profiles");
-
-		for (xml_node profile = xml_profiles.child("profile"); profile; profile = profile.next_sibling("profile"))
+		DWORD hash = ProfileIndexHash(name);
+		DWORD slot = hash & (index.pIndex->slotCount - 1);
+		const ProfileIndexEntry* pProfile;
+		while ((pProfile = ProfileIndexFindNext(index.pIndex, name, hash, &slot)) != NULL)
 		{
-			if(strcmp(name, profile.attribute("game_exe").value()) == 0)
+			//Check against dir name too if present
+			const char* dirContains = ProfileIndexString(index.pIndex, pProfile->dirOffset);
+			if (*dirContains && path)
 			{
-				//Check against dir name too if present
-				if (profile.attribute("dir_contains").as_string() && path)
-				{
-					if (string(path).find(profile.attribute("dir_contains").as_string()) == string::npos)
-						continue;
-				}
-
-				OutputDebugString("Found a profile!!!\n");
-				profileFound = true;
-				break;
+				if (string(path).find(dirContains) == string::npos)
+					continue;
 			}
+
+			OutputDebugString("Found a profile!!!\n");
+			profileFound = true;
+			break;
 		}
 	}
 
@@ -1159,21 +1298,16 @@ bool ProxyHelper::HasProfile(const char* name, const char *path)
 bool ProxyHelper::GetProfileGameExes(std::vector<std::pair<std::string, bool>> &gameExes)
 {
 	// get the profile
-	string profilePath = GetPath("cfg\\profiles.xml");
+	ProfileIndexView index;
 
-	xml_document docProfiles;
-	xml_parse_result resultProfiles = docProfiles.load_file(profilePath.c_str());
-	xml_node profile;
-
-	if(resultProfiles.status == status_ok)
+	if (OpenProfileIndex(GetPath("cfg\\profiles.xml"), GetPath(PROFILE_INDEX_FILE), index))
 	{
-		xml_node xml_profiles = docProfiles.child("profiles");
-
-		for (xml_node profile = xml_profiles.child("profile"); profile; profile = profile.next_sibling("profile"))
+		const ProfileIndexEntry* pProfiles = ProfileIndexEntries(index.pIndex);
+		for (DWORD i = 0; i < index.pIndex->entryCount; i++)
 		{
-			string exe = profile.attribute("game_exe").value();
+			string exe = ProfileIndexString(index.pIndex, pProfiles[i].exeOffset);
 			exe = strToLower(exe);
-			bool _64bit = profile.attribute("cpu_architecture").as_string("32bit") == string("64bit");
+			bool _64bit = (pProfiles[i].flags & PROFILE_INDEX_64BIT) != 0;
 			gameExes.push_back(std::make_pair(exe, _64bit));
 		}
 	}
@@ -1191,40 +1325,36 @@ bool ProxyHelper::GetProfile(char* name, char *path, bool _64bit, ProxyConfig& c
 {
 	// get the profile
 	bool profileFound = false;
-	string profilePath = GetPath("cfg\\profiles.xml");
-
-	xml_document docProfiles;
-	xml_parse_result resultProfiles = docProfiles.load_file(profilePath.c_str());
-	xml_node profile;
+	ProfileIndexView index;
 
-	if(resultProfiles.status == status_ok)
+	if (OpenProfileIndex(GetPath("cfg\\profiles.xml"), GetPath(PROFILE_INDEX_FILE), index))
 	{
-		xml_node xml_profiles = docProfiles.child("profiles");
-
-		for (xml_node profile = xml_profiles.child("profile"); profile; profile = profile.next_sibling("profile"))
+		DWORD hash = ProfileIndexHash(name);
+		DWORD slot = hash & (index.pIndex->slotCount - 1);
+		const ProfileIndexEntry* pProfile;
+		while ((pProfile = ProfileIndexFindNext(index.pIndex, name, hash, &slot)) != NULL)
 		{
-			if(strcmp(name, profile.attribute("game_exe").value()) == 0 &&
-				_64bit == (profile.attribute("cpu_architecture").as_string("32bit") == string("64bit")))
+			if (_64bit != ((pProfile->flags & PROFILE_INDEX_64BIT) != 0))
+				continue;
+
+			//Check against dir name too if present
+			const char* dirContains = ProfileIndexString(index.pIndex, pProfile->dirOffset);
+			if (*dirContains && path)
 			{
-				//Check against dir name too if present
-				if (profile.attribute("dir_contains").as_string() && path)
-				{
-					if (string(path).find(profile.attribute("dir_contains").as_string()) == string::npos)
-						continue;
-				}
+				if (string(path).find(dirContains) == string::npos)
+					continue;
+			}
 
-				OutputDebugString("Found a profile!!!\n");
-				profileFound = true;
+			OutputDebugString("Found a profile!!!\n");
+			profileFound = true;
 
-				break;
-			}
+			break;
 		}
 	}
 
 	return profileFound;
 }
 
-
 ProxyConfig::ProxyConfig()
 {
 	xml_node emptyNode;
@@ -86,6 +86,21 @@ struct ProxyConfig
 	float		YOffset;					/**< The Y offset from the centre of the screen on the Y-axis **/
 	float		IPDOffset;					/**< The IPD offset from the centre of the screen on the X-axis **/
 	bool		useSDKPosePrediction;		/**< Whether the SDK pose prediction should be used for this game **/
+	bool		lateLatchReprojection;		/**< Whether the eye images are reprojected to the orientation at composition time (OculusTracker only, no effect with other trackers) **/
+	bool		trackerSampling;			/**< Whether the tracker device is read on a dedicated sampling thread **/
+	bool		trackingWorker;				/**< Whether tracking and view transforms are computed off the render thread **/
+	bool		logFile;					/**< Whether the binary log is written to vireio_log.txt (always in debug builds) **/
+	float		predictionMs;				/**< Pose prediction time for trackers without SDK prediction, 0 = off **/
+	float		predictionVelocityFilter;	/**< Pose prediction velocity smoothing [0..1) **/
+	float		predictionAccelerationFilter;	/**< Pose prediction acceleration smoothing [0..1], 1 = no acceleration **/
+	float		mouseEmulationRate;			/**< Mouse emulation updates per second, 0 = once per frame **/
+	float		mouseYawDeadzone;			/**< Mouse emulation yaw deadzone, degrees per second **/
+	float		mousePitchDeadzone;			/**< Mouse emulation pitch deadzone, degrees per second **/
+	float		mouseYawExponent;			/**< Mouse emulation yaw response curve exponent, 1 = linear **/
+	float		mousePitchExponent;			/**< Mouse emulation pitch response curve exponent, 1 = linear **/
+	std::string	trackerRecordPath;			/**< Pose recording file, empty = not recording **/
+	std::string	trackerReplayPath;			/**< Pose recording replayed by the replay tracker **/
+	float		trackerReplaySpeed;			/**< Replay speed, 1 = recorded timing, 0 = one pose per frame **/
 	int         hud3DDepthMode;             /**< Current HUD mode. */
 	float       hud3DDepthPresets[4];       /**< HUD 3D Depth presets.*/
 	float       hudDistancePresets[4];      /**< HUD Distance presets.*/
@@ -141,6 +156,8 @@ struct ProxyConfig
 	InputBindingRef HotkeyResetOrientation;
 	InputBindingRef HotkeyShowFPS;
 	InputBindingRef HotkeyScreenshot;
+	InputBindingRef HotkeyBurstCapture;
+	InputBindingRef HotkeyFrameProfile;
 	InputBindingRef HotkeyTelescopeMode;
 	InputBindingRef HotkeyToggleFreePitch;
 	InputBindingRef HotkeyComfortMode;
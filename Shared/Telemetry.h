@@ -0,0 +1,166 @@
+
+#ifndef TELEMETRY_H_INCLUDED
+#define TELEMETRY_H_INCLUDED
+
+#include <windows.h>
+#include <string.h>
+#include <stddef.h>
+
+/**
+* Name of the telemetry shared memory (file mapping), created by the proxy.
+* Any proxy device may open it, only the one holding the writer claim publishes (TelemetryClaim()).
+***/
+#define TELEMETRY_SHARED_MEMORY_NAME "VireioTelemetry"
+
+/**
+* Telemetry layout version, increase if TelemetryData changes.
+***/
+#define TELEMETRY_VERSION 2
+
+/**
+* Frame time histogram : buckets of TELEMETRY_HISTOGRAM_BUCKET_MS, the last one open ended.
+***/
+#define TELEMETRY_HISTOGRAM_BUCKETS 16
+#define TELEMETRY_HISTOGRAM_BUCKET_MS 2.0f
+
+/**
+* Read attempts before a reader gives up (writer keeps interrupting).
+***/
+#define TELEMETRY_READ_RETRIES 16
+
+/**
+* Writer claim timeout : a claim not refreshed for this long (writer gone or stalled) may be taken
+* over by another writer.
+***/
+#define TELEMETRY_CLAIM_TIMEOUT_MS 2000
+
+/**
+* Telemetry block published by the proxy once per frame.
+* Written with a seqlock : sequence is odd while the block is written, readers copy the block and
+* retry if the sequence was odd or changed meanwhile. The writer never waits for readers.
+* Several proxy devices (one per game process, or more in one process) may map the block, the
+* writer claim makes sure only one of them publishes.
+***/
+struct TelemetryData
+{
+	DWORD version;                                         /**< TELEMETRY_VERSION */
+	DWORD size;                                            /**< sizeof(TelemetryData) */
+	volatile LONGLONG writerId;                            /**< Writer holding the claim, 0 if none */
+	volatile DWORD claimTick;                              /**< GetTickCount() at the last claim */
+	volatile LONG sequence;                                /**< Seqlock sequence, odd while writing */
+	DWORD processId;                                       /**< Process of the game */
+	DWORD tickCount;                                       /**< GetTickCount() at the last update */
+	DWORD frameCount;                                      /**< Frames presented */
+	float fps;                                             /**< Frames per second (averaged) */
+	float frameTimeMs;                                     /**< Last frame time */
+	DWORD frameTimeHistogram[TELEMETRY_HISTOGRAM_BUCKETS]; /**< Frame time counts since start */
+	DWORD eyeSwitches;                                     /**< Render side switches, last frame */
+	DWORD drawCalls;                                       /**< Game draw calls, last frame */
+	float trackerLatencyMs;                                /**< Head orientation sample to present, last frame */
+};
+
+/**
+* Returns the histogram bucket of a frame time.
+***/
+inline int TelemetryHistogramBucket(float frameTimeMs)
+{
+	if (frameTimeMs < 0.0f)
+		return 0;
+	int bucket = (int)(frameTimeMs / TELEMETRY_HISTOGRAM_BUCKET_MS);
+	return (bucket < TELEMETRY_HISTOGRAM_BUCKETS) ? bucket : TELEMETRY_HISTOGRAM_BUCKETS - 1;
+}
+
+/**
+* Claims the shared block for a writer, to be called before each write.
+* Succeeds if the writer already holds the claim, if nobody does or if the claim timed out.
+* @param pShared The shared block.
+* @param writerId Unique, non zero writer id (process id in the high part).
+* @return False if another writer holds the claim.
+***/
+inline bool TelemetryClaim(TelemetryData* pShared, LONGLONG writerId)
+{
+	DWORD now = GetTickCount();
+	LONGLONG owner = InterlockedCompareExchange64(&pShared->writerId, 0, 0);
+	if (owner == writerId)
+	{
+		pShared->claimTick = now;
+		return true;
+	}
+	// signed, the claim time may be a bit ahead of ours
+	if ((owner != 0) && ((LONG)(now - pShared->claimTick) < TELEMETRY_CLAIM_TIMEOUT_MS))
+		return false;
+
+	// claim time first, a claim must never be seen with an old claim time
+	pShared->claimTick = now;
+	if (InterlockedCompareExchange64(&pShared->writerId, writerId, owner) != owner)
+		return false;
+
+	// a writer gone during a write left the sequence odd
+	LONG sequence = pShared->sequence;
+	if (sequence & 1)
+		InterlockedCompareExchange(&pShared->sequence, sequence + 1, sequence);
+	return true;
+}
+
+/**
+* Gives up the writer claim (if held).
+***/
+inline void TelemetryRelease(TelemetryData* pShared, LONGLONG writerId)
+{
+	InterlockedCompareExchange64(&pShared->writerId, 0, writerId);
+}
+
+/**
+* Publishes the telemetry values to the shared block.
+* Writers are exclusive : the sequence is made odd by compare exchange, a write is skipped if 
+* another one is in progress (claim taken over meanwhile). Never waits.
+* @param pShared The shared block.
+* @param values The values, version/size/writer/sequence are set here.
+* @return False if the write was skipped.
+***/
+inline bool TelemetryWrite(TelemetryData* pShared, const TelemetryData& values)
+{
+	LONG sequence = pShared->sequence;
+
+	// odd : being written
+	if ((sequence & 1) || (InterlockedCompareExchange(&pShared->sequence, sequence + 1, sequence) != sequence))
+		return false;
+
+	pShared->version = TELEMETRY_VERSION;
+	pShared->size = sizeof(TelemetryData);
+	const size_t payload = offsetof(TelemetryData, processId);
+	memcpy((BYTE*)pShared + payload, (const BYTE*)&values + payload, sizeof(TelemetryData) - payload);
+
+	// even : consistent again (full barrier, the data is visible before the sequence)
+	InterlockedExchange(&pShared->sequence, sequence + 2);
+	return true;
+}
+
+/**
+* Reads a consistent copy of the shared block.
+* @param pShared The shared block.
+* @param pValues [out] The copy.
+* @return False if the block has another version or no consistent copy could be read.
+***/
+inline bool TelemetryRead(const TelemetryData* pShared, TelemetryData* pValues)
+{
+	for (int i = 0; i < TELEMETRY_READ_RETRIES; i++)
+	{
+		LONG before = pShared->sequence;
+		if (before & 1)
+		{
+			YieldProcessor();
+			continue;
+		}
+
+		MemoryBarrier();
+		memcpy(pValues, (const void*)pShared, sizeof(TelemetryData));
+		MemoryBarrier();
+
+		if (pShared->sequence == before)
+			return (pValues->version == TELEMETRY_VERSION) && (pValues->size == sizeof(TelemetryData));
+	}
+	return false;
+}
+
+#endif
@@ -0,0 +1,78 @@
+
+#ifndef TRACKING_DATAGRAM_H_INCLUDED
+#define TRACKING_DATAGRAM_H_INCLUDED
+
+#include <windows.h>
+
+/**
+* Default UDP port of the socket tracker.
+***/
+#define TRACKING_DATAGRAM_PORT 49015
+
+/**
+* Datagram magic ('VTRU') and version.
+***/
+#define TRACKING_DATAGRAM_MAGIC 0x55525456
+#define TRACKING_DATAGRAM_VERSION 1
+
+/**
+* Datagram flags.
+***/
+#define TRACKING_DATAGRAM_POSITION 0x0001  /**< Position fields are valid */
+
+#pragma pack(push, 1)
+/**
+* Binary tracking datagram, one pose per UDP packet (48 bytes, little endian, packed).
+* Orientation as unit quaternion, right handed, Y up, -Z forward (same as the Oculus SDK).
+***/
+struct TrackingDatagram
+{
+	DWORD magic;          /**< TRACKING_DATAGRAM_MAGIC */
+	WORD version;         /**< TRACKING_DATAGRAM_VERSION */
+	WORD flags;           /**< TRACKING_DATAGRAM_ flags */
+	DWORD sequence;       /**< Increased by one per datagram (wraps) */
+	UINT64 timestampUs;   /**< Sample time, sender clock, microseconds */
+	float qw, qx, qy, qz; /**< Orientation */
+	float x, y, z;        /**< Position, meters (TRACKING_DATAGRAM_POSITION) */
+};
+#pragma pack(pop)
+
+/**
+* Fills a datagram, for senders.
+***/
+inline void TrackingDatagramInit(TrackingDatagram* pDatagram, DWORD sequence, UINT64 timestampUs, float qw, float qx, float qy, float qz)
+{
+	ZeroMemory(pDatagram, sizeof(TrackingDatagram));
+	pDatagram->magic = TRACKING_DATAGRAM_MAGIC;
+	pDatagram->version = TRACKING_DATAGRAM_VERSION;
+	pDatagram->sequence = sequence;
+	pDatagram->timestampUs = timestampUs;
+	pDatagram->qw = qw;
+	pDatagram->qx = qx;
+	pDatagram->qy = qy;
+	pDatagram->qz = qz;
+}
+
+/**
+* Sets the (optional) position of a datagram, for senders.
+***/
+inline void TrackingDatagramSetPosition(TrackingDatagram* pDatagram, float x, float y, float z)
+{
+	pDatagram->flags |= TRACKING_DATAGRAM_POSITION;
+	pDatagram->x = x;
+	pDatagram->y = y;
+	pDatagram->z = z;
+}
+
+/**
+* True if the received data is a datagram of this version.
+***/
+inline bool TrackingDatagramIsValid(const void* pData, int size)
+{
+	if (size != sizeof(TrackingDatagram))
+		return false;
+	const TrackingDatagram* pDatagram = (const TrackingDatagram*)pData;
+	return (pDatagram->magic == TRACKING_DATAGRAM_MAGIC) && (pDatagram->version == TRACKING_DATAGRAM_VERSION);
+}
+
+#endif
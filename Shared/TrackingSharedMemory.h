@@ -0,0 +1,233 @@
+
+#ifndef TRACKING_SHARED_MEMORY_H_INCLUDED
+#define TRACKING_SHARED_MEMORY_H_INCLUDED
+
+#include <windows.h>
+#include <string.h>
+
+/**
+* Name of the shared memory tracking file mapping.
+***/
+#define TRACKDATA_SHARED_MEMORY_NAME "VireioSMTrack"
+
+/**
+* Marks a mapping written by a v2 writer ('VTR2').
+***/
+#define TRACKDATA_V2_MAGIC 0x32525456
+#define TRACKDATA_V2_VERSION 2
+
+/**
+* Recent samples kept in the v2 layout.
+***/
+#define TRACKDATA_V2_SAMPLES 16
+
+/**
+* Read attempts before a reader gives up (writer keeps interrupting).
+***/
+#define TRACKDATA_READ_RETRIES 16
+
+/**
+* Shared memory tracking data structure (v1 layout).
+***/
+struct TrackData
+{
+	int DataID;	/**< increased every time data has been sent */
+
+	float Yaw;
+	float Pitch;
+	float Roll;
+
+	float X;
+	float Y;
+	float Z;
+};
+
+/**
+* One timestamped tracking sample.
+***/
+struct TrackSample
+{
+	LONGLONG timestamp;      /**< QueryPerformanceCounter() of the writer at the sample */
+	float yaw, pitch, roll;  /**< Orientation, radians */
+	float x, y, z;           /**< Position */
+};
+
+/**
+* Shared memory tracking data structure (v2 layout).
+* Starts with the v1 layout, v2 writers keep it up to date so v1 readers keep working, v1 writers
+* leave the magic zero so v2 readers fall back to the v1 fields.
+* Written with a seqlock : sequence is odd while the block is written, readers copy the block and
+* retry if the sequence was odd or changed meanwhile.
+***/
+struct TrackDataV2
+{
+	TrackData legacy;                          /**< v1 layout, same values as the latest sample */
+	DWORD magic;                               /**< TRACKDATA_V2_MAGIC */
+	DWORD version;                             /**< TRACKDATA_V2_VERSION */
+	volatile LONG sequence;                    /**< Seqlock sequence, odd while writing */
+	LONG sampleCount;                          /**< Samples written, latest at (sampleCount - 1) % TRACKDATA_V2_SAMPLES */
+	LONGLONG frequency;                        /**< QueryPerformanceFrequency() of the writer */
+	TrackSample samples[TRACKDATA_V2_SAMPLES]; /**< Recent samples */
+};
+
+/**
+* Writer of the shared memory tracking data, to be used by external trackers.
+***/
+struct TrackDataWriter
+{
+	HANDLE hMapping;      /**< File mapping handle */
+	TrackData* pLegacy;   /**< v1 layout, always mapped */
+	TrackDataV2* pV2;     /**< v2 layout, NULL if the mapping was created by a v1 reader (too small) */
+};
+
+/**
+* Publishes a sample to a v2 block (single writer).
+* @param pShared The shared block.
+* @param sample The sample.
+***/
+inline void TrackDataWriteV2(TrackDataV2* pShared, const TrackSample& sample)
+{
+	LONG sequence = pShared->sequence;
+
+	// odd : being written
+	InterlockedExchange(&pShared->sequence, sequence + 1);
+
+	pShared->samples[pShared->sampleCount % TRACKDATA_V2_SAMPLES] = sample;
+	pShared->sampleCount++;
+	pShared->legacy.Yaw = sample.yaw;
+	pShared->legacy.Pitch = sample.pitch;
+	pShared->legacy.Roll = sample.roll;
+	pShared->legacy.X = sample.x;
+	pShared->legacy.Y = sample.y;
+	pShared->legacy.Z = sample.z;
+	pShared->legacy.DataID++;
+	pShared->version = TRACKDATA_V2_VERSION;
+	pShared->magic = TRACKDATA_V2_MAGIC;
+
+	// even : consistent again (full barrier, the data is visible before the sequence)
+	InterlockedExchange(&pShared->sequence, sequence + 2);
+}
+
+/**
+* Reads a consistent copy of a v2 block.
+* @param pShared The shared block.
+* @param pCopy [out] The copy.
+* @return False if the block isn't written by a v2 writer or no consistent copy could be read.
+***/
+inline bool TrackDataReadV2(const TrackDataV2* pShared, TrackDataV2* pCopy)
+{
+	for (int i = 0; i < TRACKDATA_READ_RETRIES; i++)
+	{
+		LONG before = pShared->sequence;
+		if (before & 1)
+		{
+			YieldProcessor();
+			continue;
+		}
+
+		MemoryBarrier();
+		memcpy(pCopy, (const void*)pShared, sizeof(TrackDataV2));
+		MemoryBarrier();
+
+		if (pShared->sequence == before)
+			return (pCopy->magic == TRACKDATA_V2_MAGIC) && (pCopy->version == TRACKDATA_V2_VERSION);
+	}
+	return false;
+}
+
+/**
+* Returns the latest sample of a (consistent) v2 copy.
+* @return False if there is no sample yet.
+***/
+inline bool TrackDataLatestSample(const TrackDataV2& data, TrackSample* pSample)
+{
+	if (data.sampleCount <= 0)
+		return false;
+	*pSample = data.samples[(data.sampleCount - 1) % TRACKDATA_V2_SAMPLES];
+	return true;
+}
+
+/**
+* Opens (or creates) the shared memory for writing.
+* Maps the v2 layout if the mapping is large enough, the v1 layout otherwise.
+* @return False if the mapping could not be opened.
+***/
+inline bool TrackDataOpenWriter(TrackDataWriter* pWriter)
+{
+	pWriter->pLegacy = NULL;
+	pWriter->pV2 = NULL;
+	pWriter->hMapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(TrackDataV2), TEXT(TRACKDATA_SHARED_MEMORY_NAME));
+	if (pWriter->hMapping == NULL)
+		return false;
+
+	// an existing mapping keeps its size, a v1 reader created it with the v1 size
+	pWriter->pV2 = (TrackDataV2*)MapViewOfFile(pWriter->hMapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TrackDataV2));
+	if (pWriter->pV2)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		pWriter->pV2->frequency = frequency.QuadPart;
+		pWriter->pLegacy = &pWriter->pV2->legacy;
+		return true;
+	}
+
+	pWriter->pLegacy = (TrackData*)MapViewOfFile(pWriter->hMapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TrackData));
+	if (pWriter->pLegacy)
+		return true;
+
+	CloseHandle(pWriter->hMapping);
+	pWriter->hMapping = NULL;
+	return false;
+}
+
+/**
+* Publishes a sample, timestamped now.
+* @param yaw, pitch, roll Orientation, radians.
+* @param x, y, z Position.
+***/
+inline void TrackDataWrite(TrackDataWriter* pWriter, float yaw, float pitch, float roll, float x, float y, float z)
+{
+	if (pWriter->pV2)
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+
+		TrackSample sample;
+		sample.timestamp = now.QuadPart;
+		sample.yaw = yaw;
+		sample.pitch = pitch;
+		sample.roll = roll;
+		sample.x = x;
+		sample.y = y;
+		sample.z = z;
+		TrackDataWriteV2(pWriter->pV2, sample);
+	}
+	else if (pWriter->pLegacy)
+	{
+		pWriter->pLegacy->Yaw = yaw;
+		pWriter->pLegacy->Pitch = pitch;
+		pWriter->pLegacy->Roll = roll;
+		pWriter->pLegacy->X = x;
+		pWriter->pLegacy->Y = y;
+		pWriter->pLegacy->Z = z;
+		pWriter->pLegacy->DataID++;
+	}
+}
+
+/**
+* Unmaps and closes the shared memory.
+***/
+inline void TrackDataCloseWriter(TrackDataWriter* pWriter)
+{
+	if (pWriter->pV2)
+		UnmapViewOfFile(pWriter->pV2);
+	else if (pWriter->pLegacy)
+		UnmapViewOfFile(pWriter->pLegacy);
+	if (pWriter->hMapping)
+		CloseHandle(pWriter->hMapping);
+	pWriter->hMapping = NULL;
+	pWriter->pLegacy = NULL;
+	pWriter->pV2 = NULL;
+}
+
+#endif
@@ -0,0 +1,99 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <BinaryLogTest.cpp> :
+Unit tests of the binary log : writer thread shutdown and log file output.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "BinaryLog.h"
+#include <stdlib.h>
+#include <string>
+
+/**
+* Contents of vireio_log.txt, false if there is no log file.
+***/
+static bool ReadLog(std::string* pText)
+{
+	FILE* pFile = fopen("vireio_log.txt", "r");
+	if (!pFile)
+		return false;
+	pText->clear();
+	char buffer[256];
+	size_t length;
+	while ((length = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+		pText->append(buffer, length);
+	fclose(pFile);
+	return true;
+}
+
+static void NoFileByDefault()
+{
+	BLOG1("debug output only %d", 1);
+	BinaryLog::Shutdown();
+
+	std::string text;
+	VIREIO_CHECK(!ReadLog(&text));
+}
+
+static void ShutdownDrainsToFile()
+{
+	BinaryLog::SetFileOutput(true);
+	BLOG1("first record %d", 2);
+	BinaryLog::Shutdown();
+
+	// joined and drained, the file is closed
+	std::string text;
+	VIREIO_CHECK(ReadLog(&text));
+	VIREIO_CHECK(text.find("first record 2") != std::string::npos);
+}
+
+static void WriterRestartsAfterShutdown()
+{
+	BLOG1("second record %d", 3);
+	Sleep(BINARYLOG_DRAIN_MS * 4);
+
+	// drained by the restarted writer thread, appended to the file of the first shutdown
+	std::string text;
+	VIREIO_CHECK(ReadLog(&text));
+	VIREIO_CHECK(text.find("first record 2") != std::string::npos);
+	VIREIO_CHECK(text.find("second record 3") != std::string::npos);
+
+	BinaryLog::Shutdown();
+	BinaryLog::Shutdown();
+	BinaryLog::SetFileOutput(false);
+	BLOG1("third record %d", 4);
+	BinaryLog::Shutdown();
+	VIREIO_CHECK(ReadLog(&text));
+	VIREIO_CHECK(text.find("third record 4") == std::string::npos);
+}
+
+int main()
+{
+	// log file of this run only
+	char directory[] = "/tmp/vireio_binarylog_XXXXXX";
+	if (!mkdtemp(directory) || (chdir(directory) != 0))
+		return 1;
+
+	VIREIO_RUN(NoFileByDefault);
+	VIREIO_RUN(ShutdownDrainsToFile);
+	VIREIO_RUN(WriterRestartsAfterShutdown);
+
+	remove("vireio_log.txt");
+	rmdir(directory);
+	return vireio_test::Result();
+}
@@ -0,0 +1,290 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <CompositionStatesTest.cpp> :
+Unit tests of the composition states on a call counting device : device calls of one composition
+pass with the state block and with the selected states, recording once, no leaked game objects.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "CompositionStates.h"
+
+/**
+* Composition passes of the steady state tests.
+***/
+#define PASSES 10
+
+/**
+* Reference counted game object, counts the live objects of its device.
+***/
+template <class T> class MockObject : public T
+{
+public:
+	explicit MockObject(int* pLive) : m_pLive(pLive), m_refCount(1) { (*m_pLive)++; }
+	virtual ~MockObject() { (*m_pLive)--; }
+	virtual ULONG WINAPI AddRef() { return ++m_refCount; }
+	virtual ULONG WINAPI Release() { ULONG count = --m_refCount; if (count == 0) delete this; return count; }
+
+private:
+	int* m_pLive;
+	ULONG m_refCount;
+};
+
+/**
+* Mock game texture, no surfaces.
+***/
+class MockTexture : public MockObject<IDirect3DTexture9>
+{
+public:
+	explicit MockTexture(int* pLive) : MockObject<IDirect3DTexture9>(pLive) {}
+	virtual HRESULT WINAPI GetSurfaceLevel(UINT Level, IDirect3DSurface9** ppSurfaceLevel) { return E_NOTIMPL; }
+};
+
+/**
+* Mock state block, counts captures and applies.
+***/
+class MockStateBlock : public MockObject<IDirect3DStateBlock9>
+{
+public:
+	MockStateBlock(int* pLive, int* pCaptures, int* pApplies) : MockObject<IDirect3DStateBlock9>(pLive), m_pCaptures(pCaptures), m_pApplies(pApplies) {}
+	virtual HRESULT WINAPI Capture() { (*m_pCaptures)++; return D3D_OK; }
+	virtual HRESULT WINAPI Apply() { (*m_pApplies)++; return D3D_OK; }
+
+private:
+	int* m_pCaptures;
+	int* m_pApplies;
+};
+
+/**
+* Call counting device, the game objects are returned add-refed like the actual device does.
+***/
+class CountingDevice : public IDirect3DDevice9
+{
+public:
+	CountingDevice() : live(0), gets(0), sets(0), captures(0), applies(0), records(0), failBegin(false)
+	{
+		m_pTexture = new MockTexture(&live);
+		m_pVertexShader = new MockObject<IDirect3DVertexShader9>(&live);
+		m_pPixelShader = new MockObject<IDirect3DPixelShader9>(&live);
+		m_pDeclaration = new MockObject<IDirect3DVertexDeclaration9>(&live);
+		m_pRenderTarget = new MockObject<IDirect3DSurface9>(&live);
+	}
+	virtual ~CountingDevice()
+	{
+		m_pTexture->Release();
+		m_pVertexShader->Release();
+		m_pPixelShader->Release();
+		m_pDeclaration->Release();
+		m_pRenderTarget->Release();
+	}
+
+	/**
+	* Game objects and state blocks alive besides the ones held by the device.
+	***/
+	int Leaked() { return live - 5; }
+	int Calls() { return gets + sets + captures + applies; }
+	void ResetCounts() { gets = sets = captures = applies = 0; }
+
+	virtual HRESULT WINAPI BeginStateBlock() { if (failBegin) return E_FAIL; records++; return D3D_OK; }
+	virtual HRESULT WINAPI EndStateBlock(IDirect3DStateBlock9** ppSB) { *ppSB = new MockStateBlock(&live, &captures, &applies); return D3D_OK; }
+
+	virtual HRESULT WINAPI SetTransform(D3DTRANSFORMSTATETYPE State, const D3DMATRIX* pMatrix) { sets++; return D3D_OK; }
+	virtual HRESULT WINAPI SetRenderState(D3DRENDERSTATETYPE State, DWORD Value) { sets++; return D3D_OK; }
+	virtual HRESULT WINAPI GetRenderState(D3DRENDERSTATETYPE State, DWORD* pValue) { gets++; *pValue = 0; return D3D_OK; }
+	virtual HRESULT WINAPI SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value) { sets++; return D3D_OK; }
+	virtual HRESULT WINAPI GetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD* pValue) { gets++; *pValue = 0; return D3D_OK; }
+	virtual HRESULT WINAPI SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value) { sets++; return D3D_OK; }
+	virtual HRESULT WINAPI GetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD* pValue) { gets++; *pValue = 0; return D3D_OK; }
+	virtual HRESULT WINAPI SetTexture(DWORD Stage, IDirect3DBaseTexture9* pTexture) { sets++; return D3D_OK; }
+	virtual HRESULT WINAPI GetTexture(DWORD Stage, IDirect3DBaseTexture9** ppTexture) { gets++; return Get(m_pTexture, ppTexture); }
+	virtual HRESULT WINAPI SetVertexShader(IDirect3DVertexShader9* pShader) { sets++; return D3D_OK; }
+	virtual HRESULT WINAPI GetVertexShader(IDirect3DVertexShader9** ppShader) { gets++; return Get(m_pVertexShader, ppShader); }
+	virtual HRESULT WINAPI SetPixelShader(IDirect3DPixelShader9* pShader) { sets++; return D3D_OK; }
+	virtual HRESULT WINAPI GetPixelShader(IDirect3DPixelShader9** ppShader) { gets++; return Get(m_pPixelShader, ppShader); }
+	virtual HRESULT WINAPI SetVertexDeclaration(IDirect3DVertexDeclaration9* pDecl) { sets++; return D3D_OK; }
+	virtual HRESULT WINAPI GetVertexDeclaration(IDirect3DVertexDeclaration9** ppDecl) { gets++; return Get(m_pDeclaration, ppDecl); }
+	virtual HRESULT WINAPI SetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9* pRenderTarget) { sets++; return D3D_OK; }
+	virtual HRESULT WINAPI GetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9** ppRenderTarget) { gets++; return Get(m_pRenderTarget, ppRenderTarget); }
+
+	int live;
+	int gets;
+	int sets;
+	int captures;
+	int applies;
+	int records;
+	bool failBegin;
+
+private:
+	template <class T, class U> HRESULT Get(T* pObject, U** ppObject)
+	{
+		pObject->AddRef();
+		*ppObject = pObject;
+		return D3D_OK;
+	}
+
+	IDirect3DTexture9* m_pTexture;
+	IDirect3DVertexShader9* m_pVertexShader;
+	IDirect3DPixelShader9* m_pPixelShader;
+	IDirect3DVertexDeclaration9* m_pDeclaration;
+	IDirect3DSurface9* m_pRenderTarget;
+};
+
+/**
+* One composition pass as StereoView::Draw() does it : save, fullscreen states, eye textures and back
+* buffer, restore (the view effect draw is not counted).
+***/
+static void ComposeOnce(CountingDevice* pDevice, CompositionStates* pStates, bool stateBlock)
+{
+	if (stateBlock)
+	{
+		if (!pStates->HasStateBlock() && pStates->BeginRecord())
+		{
+			pDevice->SetTexture(0, NULL);
+			pDevice->SetTexture(1, NULL);
+			pStates->EndRecord();
+		}
+		pStates->CaptureStateBlock();
+	}
+	else
+		pStates->SaveSelectedStates();
+
+	pStates->SetFullscreenStates();
+	pDevice->SetTexture(0, NULL);
+	pDevice->SetTexture(1, NULL);
+	pDevice->SetRenderTarget(0, NULL);
+
+	if (stateBlock)
+		pStates->ApplyStateBlock();
+	else
+		pStates->RestoreSelectedStates();
+}
+
+/**
+* Device calls of the fullscreen render itself, without saving and restoring.
+***/
+static int FullscreenCalls()
+{
+	CountingDevice device;
+	CompositionStates states;
+	states.Init(&device, 0);
+	states.SetFullscreenStates();
+	device.SetTexture(0, NULL);
+	device.SetTexture(1, NULL);
+	device.SetRenderTarget(0, NULL);
+	VIREIO_CHECK(device.gets == 0);
+	return device.Calls();
+}
+
+/**
+* With the state block a pass reads no state : one capture and one apply replace the per state
+* reads and writes of the selected states.
+***/
+static void StateBlockReplacesGetSet()
+{
+	int fullscreen = FullscreenCalls();
+	VIREIO_CHECK(fullscreen > 0);
+
+	CountingDevice blockDevice;
+	int blockCalls = 0;
+	{
+		CompositionStates states;
+		states.Init(&blockDevice, 0);
+		ComposeOnce(&blockDevice, &states, true);
+		VIREIO_CHECK(blockDevice.records == 1);
+		VIREIO_CHECK(states.HasStateBlock());
+
+		for (int i = 0; i < PASSES; i++)
+		{
+			blockDevice.ResetCounts();
+			ComposeOnce(&blockDevice, &states, true);
+			VIREIO_CHECK(blockDevice.gets == 0);
+			VIREIO_CHECK(blockDevice.captures == 1);
+			VIREIO_CHECK(blockDevice.applies == 1);
+			VIREIO_CHECK(blockDevice.Calls() == fullscreen + 2);
+		}
+		blockCalls = blockDevice.Calls();
+		VIREIO_CHECK(blockDevice.records == 1);
+	}
+	VIREIO_CHECK(blockDevice.Leaked() == 0);
+
+	CountingDevice selectedDevice;
+	int selectedCalls = 0;
+	{
+		CompositionStates states;
+		states.Init(&selectedDevice, 0);
+		for (int i = 0; i < PASSES; i++)
+		{
+			selectedDevice.ResetCounts();
+			ComposeOnce(&selectedDevice, &states, false);
+			VIREIO_CHECK(selectedDevice.gets == 27);
+			VIREIO_CHECK(selectedDevice.sets == fullscreen + 27);
+			VIREIO_CHECK(selectedDevice.captures + selectedDevice.applies == 0);
+			VIREIO_CHECK(selectedDevice.Leaked() == 0);
+		}
+		selectedCalls = selectedDevice.Calls();
+		VIREIO_CHECK(!states.HasStateBlock());
+		VIREIO_CHECK(selectedDevice.records == 0);
+	}
+	VIREIO_CHECK(blockCalls < selectedCalls);
+}
+
+/**
+* No state block if recording can't start, the pass still composes, later passes retry.
+***/
+static void FailedRecordLeavesNoBlock()
+{
+	CountingDevice device;
+	{
+		CompositionStates states;
+		states.Init(&device, 0);
+		device.failBegin = true;
+		ComposeOnce(&device, &states, true);
+		VIREIO_CHECK(!states.HasStateBlock());
+		VIREIO_CHECK(device.captures + device.applies == 0);
+		VIREIO_CHECK(device.sets > 0);
+
+		device.failBegin = false;
+		ComposeOnce(&device, &states, true);
+		VIREIO_CHECK(states.HasStateBlock());
+		VIREIO_CHECK(device.records == 1);
+	}
+	VIREIO_CHECK(device.Leaked() == 0);
+}
+
+/**
+* Objects saved but not restored yet are released with the state block.
+***/
+static void ReleasesSavedObjects()
+{
+	CountingDevice device;
+	CompositionStates states;
+	states.Init(&device, 0);
+	ComposeOnce(&device, &states, true);
+	states.SaveSelectedStates();
+	VIREIO_CHECK(device.Leaked() > 0);
+	states.ReleaseEverything();
+	VIREIO_CHECK(device.Leaked() == 0);
+	VIREIO_CHECK(!states.HasStateBlock());
+}
+
+int main()
+{
+	VIREIO_RUN(StateBlockReplacesGetSet);
+	VIREIO_RUN(FailedRecordLeavesNoBlock);
+	VIREIO_RUN(ReleasesSavedObjects);
+	return vireio_test::Result();
+}
@@ -0,0 +1,182 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ConfigSaverTest.cpp> :
+Unit tests of the background configuration saver on a slow and a failing filesystem : submits
+never wait for a write, coalescing of snapshots, pending snapshots written on stop.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "ConfigSaver.h"
+
+/**
+* Snapshots submitted while the first write hangs.
+***/
+#define COALESCED_SNAPSHOTS 10
+
+/**
+* The game configuration is loaded and saved by ProxyHelper (not built here), the saver tests
+* replace the write.
+***/
+ProxyConfig::ProxyConfig()
+{
+}
+
+ProxyHelper::ProxyHelper()
+{
+}
+
+bool ProxyHelper::SaveConfig(ProxyConfig& config)
+{
+	return false;
+}
+
+static DWORD Elapsed(LARGE_INTEGER start)
+{
+	LARGE_INTEGER now, frequency;
+	QueryPerformanceCounter(&now);
+	QueryPerformanceFrequency(&frequency);
+	return (DWORD)((now.QuadPart - start.QuadPart) * 1000 / frequency.QuadPart);
+}
+
+/**
+* Filesystem whose writes hang until the gate opens, records the written world scales.
+***/
+class SlowSaver : public ConfigSaver
+{
+public:
+	SlowSaver() : m_succeed(true)
+	{
+		m_hGate = CreateEvent(NULL, TRUE, TRUE, NULL);
+		m_hWriting = CreateEvent(NULL, FALSE, FALSE, NULL);
+	}
+	virtual ~SlowSaver()
+	{
+		Stop();
+		CloseHandle(m_hGate);
+		CloseHandle(m_hWriting);
+	}
+
+	std::vector<float> Written()
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		return m_written;
+	}
+
+	HANDLE m_hGate;
+	HANDLE m_hWriting;
+	volatile bool m_succeed;
+
+protected:
+	virtual bool Write(ProxyConfig& config)
+	{
+		SetEvent(m_hWriting);
+		WaitForSingleObject(m_hGate, INFINITE);
+		if (!m_succeed)
+			return false;
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_written.push_back(config.worldScaleFactor);
+		return true;
+	}
+
+private:
+	std::mutex m_lock;
+	std::vector<float> m_written;
+};
+
+static ProxyConfig Snapshot(float worldScale)
+{
+	ProxyConfig config;
+	config.worldScaleFactor = worldScale;
+	return config;
+}
+
+/**
+* Submits while a write hangs return at once, the snapshots are coalesced to the latest one.
+***/
+static void SubmitDoesNotWaitForWrite()
+{
+	SlowSaver saver;
+	ResetEvent(saver.m_hGate);
+	saver.Submit(Snapshot(1.0f));
+	VIREIO_CHECK(WaitForSingleObject(saver.m_hWriting, 2000) == WAIT_OBJECT_0);
+
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+	for (int i = 2; i <= COALESCED_SNAPSHOTS + 1; i++)
+		saver.Submit(Snapshot((float)i));
+	VIREIO_CHECK(Elapsed(start) < 100);
+	VIREIO_CHECK(saver.GetSaveCount() == 0);
+
+	SetEvent(saver.m_hGate);
+	saver.Stop();
+	std::vector<float> written = saver.Written();
+	VIREIO_CHECK(written.size() == 2);
+	VIREIO_CHECK(saver.GetSaveCount() == 2);
+	if (written.size() == 2)
+	{
+		VIREIO_CHECK(written[0] == 1.0f);
+		VIREIO_CHECK(written[1] == (float)(COALESCED_SNAPSHOTS + 1));
+	}
+}
+
+/**
+* A snapshot submitted right before the stop is written.
+***/
+static void StopWritesPendingSnapshot()
+{
+	SlowSaver saver;
+	saver.Submit(Snapshot(3.0f));
+	saver.Stop();
+	std::vector<float> written = saver.Written();
+	VIREIO_CHECK(written.size() == 1);
+	if (written.size() == 1)
+		VIREIO_CHECK(written[0] == 3.0f);
+
+	// stopping twice, and without snapshots, writes nothing
+	saver.Stop();
+	SlowSaver idle;
+	idle.Stop();
+	VIREIO_CHECK(saver.Written().size() == 1);
+	VIREIO_CHECK(idle.Written().empty());
+}
+
+/**
+* Failed writes are not counted, the next snapshot is written.
+***/
+static void FailedWriteIsNotCounted()
+{
+	SlowSaver saver;
+	saver.m_succeed = false;
+	saver.Submit(Snapshot(4.0f));
+	VIREIO_CHECK(WaitForSingleObject(saver.m_hWriting, 2000) == WAIT_OBJECT_0);
+
+	saver.m_succeed = true;
+	saver.Submit(Snapshot(5.0f));
+	saver.Stop();
+	std::vector<float> written = saver.Written();
+	VIREIO_CHECK(!written.empty() && (written.back() == 5.0f));
+	VIREIO_CHECK(saver.GetSaveCount() == (LONG)written.size());
+}
+
+int main()
+{
+	VIREIO_RUN(SubmitDoesNotWaitForWrite);
+	VIREIO_RUN(StopWritesPendingSnapshot);
+	VIREIO_RUN(FailedWriteIsNotCounted);
+	return vireio_test::Result();
+}
@@ -0,0 +1,232 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ConfigStoreTest.cpp> :
+Unit tests of the configuration store on temporary files : parsing once, parsing again after
+changes on disk, change-only saving through a temporary file and a rename.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "ConfigStore.h"
+#include "VireioUtil.h"
+#include <dirent.h>
+#include <stdlib.h>
+
+using std::string;
+
+/**
+* Temporary directory of the test files.
+***/
+static string g_directory;
+
+static string TestPath(const char* name)
+{
+	return g_directory + "/" + name;
+}
+
+static void WriteText(const string& path, const char* text)
+{
+	FILE* pFile = fopen(path.c_str(), "wb");
+	fputs(text, pFile);
+	fclose(pFile);
+}
+
+static string ReadText(const string& path)
+{
+	string text;
+	FILE* pFile = fopen(path.c_str(), "rb");
+	if (!pFile)
+		return text;
+	char buffer[256];
+	size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+		text.append(buffer, count);
+	fclose(pFile);
+	return text;
+}
+
+/**
+* Names of the files in the test directory, to find temporary files left behind.
+***/
+static std::vector<string> DirectoryFiles()
+{
+	std::vector<string> names;
+	DIR* pDir = opendir(g_directory.c_str());
+	while (struct dirent* pEntry = readdir(pDir))
+		if ((strcmp(pEntry->d_name, ".") != 0) && (strcmp(pEntry->d_name, "..") != 0))
+			names.push_back(pEntry->d_name);
+	closedir(pDir);
+	return names;
+}
+
+static int Value(pugi::xml_document* pDoc)
+{
+	return pDoc->child("config").attribute("value").as_int();
+}
+
+static void SetValue(pugi::xml_document* pDoc, int value)
+{
+	pDoc->child("config").attribute("value").set_value(value);
+}
+
+/**
+* Reads come from memory until the file changes on disk.
+***/
+static void ParsesOnce()
+{
+	ConfigStore store;
+	string path = TestPath("once.xml");
+	WriteText(path, "<config value=\"1\"/>");
+
+	pugi::xml_document* pDoc = store.Get(path);
+	VIREIO_CHECK(pDoc != NULL);
+	if (!pDoc)
+		return;
+	VIREIO_CHECK(Value(pDoc) == 1);
+
+	// not parsed again : an unmarked change in memory stays
+	SetValue(pDoc, 2);
+	VIREIO_CHECK(store.Get(path) == pDoc);
+	VIREIO_CHECK(Value(store.Get(path)) == 2);
+
+	// changed on disk (other size) : parsed again
+	WriteText(path, "<config value=\"30\"/>");
+	VIREIO_CHECK(Value(store.Get(path)) == 30);
+
+	VIREIO_CHECK(store.Get(TestPath("missing.xml")) == NULL);
+	WriteText(TestPath("broken.xml"), "<config value=\"1\">");
+	VIREIO_CHECK(store.Get(TestPath("broken.xml")) == NULL);
+}
+
+/**
+* Unchanged files are not written, changed files are replaced through a temporary file.
+***/
+static void SavesChangesOnly()
+{
+	ConfigStore store;
+	string path = TestPath("save.xml");
+	const char* original = "<config value=\"1\" />";
+	WriteText(path, original);
+	VIREIO_CHECK(!store.Save(path));
+
+	pugi::xml_document* pDoc = store.Get(path);
+	VIREIO_CHECK(pDoc != NULL);
+	if (!pDoc)
+		return;
+
+	// unmarked : nothing written
+	SetValue(pDoc, 2);
+	VIREIO_CHECK(store.Save(path));
+	VIREIO_CHECK(ReadText(path) == original);
+
+	// marked : written, no temporary file left
+	std::vector<string> before = DirectoryFiles();
+	store.MarkChanged(pDoc->child("config"));
+	VIREIO_CHECK(store.Save(path));
+	VIREIO_CHECK(DirectoryFiles() == before);
+	pugi::xml_document saved;
+	VIREIO_CHECK(saved.load_file(path.c_str()));
+	VIREIO_CHECK(Value(&saved) == 2);
+
+	// the saved file is not parsed again, saved again only after the next change
+	VIREIO_CHECK(store.Get(path) == pDoc);
+	SetValue(pDoc, 3);
+	VIREIO_CHECK(Value(store.Get(path)) == 3);
+	string savedText = ReadText(path);
+	VIREIO_CHECK(store.Save(path));
+	VIREIO_CHECK(ReadText(path) == savedText);
+
+	// nodes of other documents are ignored
+	store.MarkChanged(saved.child("config"));
+	VIREIO_CHECK(store.Save(path));
+	VIREIO_CHECK(ReadText(path) == savedText);
+}
+
+/**
+* Unsaved changes are kept over changes on disk and saved over them.
+***/
+static void KeepsUnsavedChanges()
+{
+	ConfigStore store;
+	string path = TestPath("unsaved.xml");
+	WriteText(path, "<config value=\"1\"/>");
+
+	pugi::xml_document* pDoc = store.Get(path);
+	VIREIO_CHECK(pDoc != NULL);
+	if (!pDoc)
+		return;
+	SetValue(pDoc, 2);
+	store.MarkChanged(pDoc->child("config"));
+
+	WriteText(path, "<config value=\"40\"/>");
+	VIREIO_CHECK(Value(store.Get(path)) == 2);
+	VIREIO_CHECK(store.Save(path));
+
+	pugi::xml_document saved;
+	VIREIO_CHECK(saved.load_file(path.c_str()));
+	VIREIO_CHECK(Value(&saved) == 2);
+}
+
+/**
+* A failed write leaves the file untouched, no temporary file behind and the change pending.
+***/
+static void FailedSaveKeepsFile()
+{
+	ConfigStore store;
+	string path = TestPath("failed.xml");
+	const char* original = "<config value=\"1\"/>";
+	WriteText(path, original);
+
+	pugi::xml_document* pDoc = store.Get(path);
+	VIREIO_CHECK(pDoc != NULL);
+	if (!pDoc)
+		return;
+	SetValue(pDoc, 2);
+	store.MarkChanged(pDoc->child("config"));
+
+	// the temporary file can't be created where a directory is
+	string tempPath = vireio::retprintf("%s.%u.tmp", path.c_str(), GetCurrentProcessId());
+	VIREIO_CHECK(mkdir(tempPath.c_str(), 0700) == 0);
+	VIREIO_CHECK(!store.Save(path));
+	VIREIO_CHECK(ReadText(path) == original);
+	rmdir(tempPath.c_str());
+
+	VIREIO_CHECK(store.Save(path));
+	pugi::xml_document saved;
+	VIREIO_CHECK(saved.load_file(path.c_str()));
+	VIREIO_CHECK(Value(&saved) == 2);
+	VIREIO_CHECK(access(tempPath.c_str(), F_OK) != 0);
+}
+
+int main()
+{
+	char directory[] = "/tmp/ConfigStoreTest.XXXXXX";
+	if (!mkdtemp(directory))
+		return 1;
+	g_directory = directory;
+
+	VIREIO_RUN(ParsesOnce);
+	VIREIO_RUN(SavesChangesOnly);
+	VIREIO_RUN(KeepsUnsavedChanges);
+	VIREIO_RUN(FailedSaveKeepsFile);
+
+	std::vector<string> names = DirectoryFiles();
+	for (size_t i = 0; i < names.size(); i++)
+		unlink(TestPath(names[i].c_str()).c_str());
+	rmdir(directory);
+	return vireio_test::Result();
+}
@@ -0,0 +1,208 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <DistortionMeshTest.cpp> :
+Unit tests of the distortion mesh : grid vertices against the per pixel warp, deterministic 
+output, index ranges.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "DistortionMesh.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+/**
+* Maximum difference of a vertex texture coordinate to the per pixel warp.
+***/
+#define WARP_TOLERANCE 1e-5f
+
+/**
+* Rift DK1 like parameters, optionally rotated, offset and zoomed.
+***/
+static DistortionParameters Parameters(float rotation, float offset, float zoom)
+{
+	DistortionParameters params;
+	params.LensCenter[0] = 0.2863f;
+	params.LensCenter[1] = 0.5f;
+	params.Scale[0] = 0.1469f;
+	params.Scale[1] = 0.2350f;
+	params.ScaleIn[0] = 4.0f;
+	params.ScaleIn[1] = 2.5f;
+	params.HmdWarpParam[0] = 1.0f;
+	params.HmdWarpParam[1] = 0.22f;
+	params.HmdWarpParam[2] = 0.24f;
+	params.HmdWarpParam[3] = 0.0f;
+	params.Chroma[0] = -0.006f;
+	params.Chroma[1] = 0.0f;
+	params.Chroma[2] = 0.014f;
+	params.Chroma[3] = 0.0f;
+	params.Resolution[0] = 1280.0f;
+	params.Resolution[1] = 800.0f;
+	params.Rotation = rotation;
+	params.ViewportXOffset = offset;
+	params.ViewportYOffset = -offset;
+	params.ZoomScale = zoom;
+	params.TargetWidth = 1280.0f;
+	params.TargetHeight = 800.0f;
+	return params;
+}
+
+static bool Near(const float* a, const float* b)
+{
+	return (fabsf(a[0] - b[0]) <= WARP_TOLERANCE) && (fabsf(a[1] - b[1]) <= WARP_TOLERANCE);
+}
+
+/**
+* Every grid vertex matches the per pixel warp of its screen texture coordinate, all channels.
+***/
+static void MatchesPerPixelWarp(const DistortionParameters& params)
+{
+	std::vector<DISTORTIONVERTEX> vertices;
+	DistortionMesh::BuildVertices(params, vertices);
+	VIREIO_CHECK(vertices.size() == DistortionMesh::VertexCount());
+	if (vertices.size() != DistortionMesh::VertexCount())
+		return;
+
+	int mismatches = 0;
+	int misplaced = 0;
+	UINT index = 0;
+	for (UINT eye = 0; eye < 2; eye++)
+	{
+		for (UINT row = 0; row <= DISTORTION_MESH_ROWS; row++)
+		{
+			for (UINT column = 0; column <= DISTORTION_MESH_COLUMNS; column++, index++)
+			{
+				const DISTORTIONVERTEX& vertex = vertices[index];
+				float u = (eye * 0.5f) + (0.5f * (float)column / (float)DISTORTION_MESH_COLUMNS);
+				float v = (float)row / (float)DISTORTION_MESH_ROWS;
+				if ((vertex.u != u) || (vertex.v != v) ||
+					(vertex.x != (u * params.TargetWidth) - 0.5f) || (vertex.y != (v * params.TargetHeight) - 0.5f) ||
+					(vertex.z != 0.0f) || (vertex.rhw != 1.0f))
+					misplaced++;
+
+				// the per pixel warp counts the center line to the left eye, use the pixels right of it 
+				// for the first right eye column
+				if ((eye == 1) && (column == 0))
+					u = nextafterf(u, 1.0f);
+
+				float red[2], green[2], blue[2];
+				DistortionMesh::WarpTexCoords(params, u, v, red, green, blue);
+				if (!Near(&vertex.redU, red) || !Near(&vertex.greenU, green) || !Near(&vertex.blueU, blue))
+					mismatches++;
+			}
+		}
+	}
+	VIREIO_CHECK(index == DistortionMesh::VertexCount());
+	VIREIO_CHECK(misplaced == 0);
+	VIREIO_CHECK(mismatches == 0);
+}
+
+static void MatchesPerPixelWarpDefault()
+{
+	MatchesPerPixelWarp(Parameters(0.0f, 0.0f, 1.0f));
+}
+
+static void MatchesPerPixelWarpRotated()
+{
+	MatchesPerPixelWarp(Parameters(0.3f, 0.0f, 1.0f));
+	MatchesPerPixelWarp(Parameters(-1.2f, 0.05f, 0.8f));
+}
+
+/**
+* Chromatic aberration correction moves red and blue apart from green.
+***/
+static void SeparatesColorChannels()
+{
+	std::vector<DISTORTIONVERTEX> vertices;
+	DistortionMesh::BuildVertices(Parameters(0.0f, 0.0f, 1.0f), vertices);
+
+	// left eye top left corner, far from the lens center
+	const DISTORTIONVERTEX& corner = vertices[0];
+	VIREIO_CHECK(corner.redU != corner.greenU);
+	VIREIO_CHECK(corner.blueU != corner.greenU);
+
+	// without chroma parameters all channels are equal
+	DistortionParameters params = Parameters(0.0f, 0.0f, 1.0f);
+	memset(params.Chroma, 0, sizeof(params.Chroma));
+	DistortionMesh::BuildVertices(params, vertices);
+	int different = 0;
+	for (size_t i = 0; i < vertices.size(); i++)
+		if ((vertices[i].redU != vertices[i].greenU) || (vertices[i].blueV != vertices[i].greenV))
+			different++;
+	VIREIO_CHECK(different == 0);
+}
+
+/**
+* Same parameters, byte identical vertices (the mesh is rebuilt only when parameters change).
+***/
+static void IdenticalInputsIdenticalOutput()
+{
+	DistortionParameters params = Parameters(0.3f, 0.05f, 0.8f);
+	std::vector<DISTORTIONVERTEX> first;
+	std::vector<DISTORTIONVERTEX> second;
+	DistortionMesh::BuildVertices(params, first);
+	second.assign(first.size(), DISTORTIONVERTEX());
+	memset(&second[0], 0xcd, second.size() * sizeof(DISTORTIONVERTEX));
+	DistortionMesh::BuildVertices(params, second);
+	VIREIO_CHECK(first.size() == second.size());
+	VIREIO_CHECK(memcmp(&first[0], &second[0], first.size() * sizeof(DISTORTIONVERTEX)) == 0);
+
+	std::vector<WORD> firstIndices;
+	std::vector<WORD> secondIndices;
+	DistortionMesh::BuildIndices(firstIndices);
+	DistortionMesh::BuildIndices(secondIndices);
+	VIREIO_CHECK(firstIndices == secondIndices);
+}
+
+/**
+* Indices stay within the eye grid of their triangle, all vertices are used.
+***/
+static void IndicesCoverBothGrids()
+{
+	const UINT eyeVertices = (DISTORTION_MESH_COLUMNS + 1) * (DISTORTION_MESH_ROWS + 1);
+	std::vector<WORD> indices;
+	DistortionMesh::BuildIndices(indices);
+	VIREIO_CHECK(indices.size() == DistortionMesh::IndexCount());
+	VIREIO_CHECK(indices.size() == DistortionMesh::PrimitiveCount() * 3);
+
+	std::vector<bool> used(DistortionMesh::VertexCount(), false);
+	int crossing = 0;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		UINT eye = indices[i] / eyeVertices;
+		for (size_t k = 0; k < 3; k++)
+		{
+			if ((indices[i + k] >= DistortionMesh::VertexCount()) || (indices[i + k] / eyeVertices != eye))
+				crossing++;
+			else
+				used[indices[i + k]] = true;
+		}
+	}
+	VIREIO_CHECK(crossing == 0);
+	VIREIO_CHECK(std::find(used.begin(), used.end(), false) == used.end());
+}
+
+int main()
+{
+	VIREIO_RUN(MatchesPerPixelWarpDefault);
+	VIREIO_RUN(MatchesPerPixelWarpRotated);
+	VIREIO_RUN(SeparatesColorChannels);
+	VIREIO_RUN(IdenticalInputsIdenticalOutput);
+	VIREIO_RUN(IndicesCoverBothGrids);
+	return vireio_test::Result();
+}
@@ -0,0 +1,101 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <EffectCacheTest.cpp> :
+Unit tests of the EffectCache key and cache file name.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "EffectCache.h"
+
+static std::vector<BYTE> Source(const char* text)
+{
+	return std::vector<BYTE>(text, text + strlen(text));
+}
+
+static bool EndsWith(const std::string& text, const std::string& end)
+{
+	return (text.size() >= end.size()) && (text.compare(text.size() - end.size(), end.size(), end) == 0);
+}
+
+static void KeyIsStable()
+{
+	D3DXMACRO defines[] = {{"EYE", "1"}, {NULL, NULL}};
+	EffectCache::CacheKey a = EffectCache::ComputeKey(Source("float4 main() : COLOR { return 1; }"), "fx", defines, 0x800);
+	EffectCache::CacheKey b = EffectCache::ComputeKey(Source("float4 main() : COLOR { return 1; }"), "fx", defines, 0x800);
+	VIREIO_CHECK(EffectCache::KeysEqual(a, b));
+	VIREIO_CHECK(a.version == EFFECTCACHE_VERSION);
+	VIREIO_CHECK(a.sdkVersion == D3DX_SDK_VERSION);
+}
+
+static void KeyChangesWithSourceAndOptions()
+{
+	D3DXMACRO defines[] = {{"EYE", "1"}, {NULL, NULL}};
+	D3DXMACRO otherDefines[] = {{"EYE", "2"}, {NULL, NULL}};
+	std::vector<BYTE> source = Source("float4 main() : COLOR { return 1; }");
+	EffectCache::CacheKey key = EffectCache::ComputeKey(source, "fx", defines, 0x800);
+
+	VIREIO_CHECK(!EffectCache::KeysEqual(key, EffectCache::ComputeKey(Source("float4 main() : COLOR { return 0; }"), "fx", defines, 0x800)));
+	VIREIO_CHECK(!EffectCache::KeysEqual(key, EffectCache::ComputeKey(source, "asm", defines, 0x800)));
+	VIREIO_CHECK(!EffectCache::KeysEqual(key, EffectCache::ComputeKey(source, "fx", otherDefines, 0x800)));
+	VIREIO_CHECK(!EffectCache::KeysEqual(key, EffectCache::ComputeKey(source, "fx", NULL, 0x800)));
+	VIREIO_CHECK(!EffectCache::KeysEqual(key, EffectCache::ComputeKey(source, "fx", defines, 0)));
+}
+
+static void KeyChangesWithVersions()
+{
+	EffectCache::CacheKey key = EffectCache::ComputeKey(Source("vs_2_0"), "asm", NULL, 0);
+
+	EffectCache::CacheKey otherSdk = key;
+	otherSdk.sdkVersion = D3DX_SDK_VERSION - 1;
+	VIREIO_CHECK(!EffectCache::KeysEqual(key, otherSdk));
+
+	EffectCache::CacheKey otherVersion = key;
+	otherVersion.version = EFFECTCACHE_VERSION - 1;
+	VIREIO_CHECK(!EffectCache::KeysEqual(key, otherVersion));
+}
+
+static void FileNameHashesFullPath()
+{
+	std::string a = EffectCache::CacheFileName("C:\\Perception\\fx\\Side.fx", ".fxo");
+	std::string b = EffectCache::CacheFileName("C:\\Perception\\shaders\\Side.fx", ".fxo");
+
+	VIREIO_CHECK(a != b);
+	VIREIO_CHECK(a.compare(0, 8, "Side.fx.") == 0);
+	VIREIO_CHECK(EndsWith(a, ".fxo"));
+	VIREIO_CHECK(a == EffectCache::CacheFileName("C:\\Perception\\fx\\Side.fx", ".fxo"));
+	VIREIO_CHECK(a != EffectCache::CacheFileName("C:\\Perception\\fx\\Side.fx", ".vso"));
+}
+
+static void FileNameIgnoresCaseAndSeparator()
+{
+	std::string a = EffectCache::CacheFileName("C:\\Perception\\fx\\Side.fx", ".fxo");
+	std::string b = EffectCache::CacheFileName("c:/perception/FX/side.fx", ".fxo");
+
+	// same file, only the name part keeps its case
+	VIREIO_CHECK(a.substr(a.find('.') + 1) == b.substr(b.find('.') + 1));
+}
+
+int main()
+{
+	VIREIO_RUN(KeyIsStable);
+	VIREIO_RUN(KeyChangesWithSourceAndOptions);
+	VIREIO_RUN(KeyChangesWithVersions);
+	VIREIO_RUN(FileNameHashesFullPath);
+	VIREIO_RUN(FileNameIgnoresCaseAndSeparator);
+	return vireio_test::Result();
+}
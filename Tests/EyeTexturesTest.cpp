@@ -0,0 +1,200 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <EyeTexturesTest.cpp> :
+Unit tests of the stereo view eye textures on a mock device : input selection, creation on first 
+use, no objects kept after a partial failure, no retries before a device reset.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "EyeTextures.h"
+
+class MockDevice;
+
+/**
+* Mock surface, counts the live objects of its device.
+***/
+class MockSurface : public IDirect3DSurface9
+{
+public:
+	explicit MockSurface(int* pLive) : m_pLive(pLive), m_refCount(1) { (*m_pLive)++; }
+	virtual ~MockSurface() { (*m_pLive)--; }
+	virtual ULONG WINAPI AddRef() { return ++m_refCount; }
+	virtual ULONG WINAPI Release() { ULONG count = --m_refCount; if (count == 0) delete this; return count; }
+
+private:
+	int* m_pLive;
+	ULONG m_refCount;
+};
+
+/**
+* Mock texture, the surface level fails if the device says so.
+***/
+class MockTexture : public IDirect3DTexture9
+{
+public:
+	MockTexture(int* pLive, bool surfaceFails) : m_pLive(pLive), m_refCount(1), m_surfaceFails(surfaceFails) { (*m_pLive)++; }
+	virtual ~MockTexture() { (*m_pLive)--; }
+	virtual ULONG WINAPI AddRef() { return ++m_refCount; }
+	virtual ULONG WINAPI Release() { ULONG count = --m_refCount; if (count == 0) delete this; return count; }
+	virtual HRESULT WINAPI GetSurfaceLevel(UINT Level, IDirect3DSurface9** ppSurfaceLevel)
+	{
+		if (m_surfaceFails)
+		{
+			*ppSurfaceLevel = NULL;
+			return E_FAIL;
+		}
+		// surfaces hold a texture reference
+		AddRef();
+		*ppSurfaceLevel = new TextureSurface(m_pLive, this);
+		return D3D_OK;
+	}
+
+private:
+	class TextureSurface : public MockSurface
+	{
+	public:
+		TextureSurface(int* pLive, MockTexture* pTexture) : MockSurface(pLive), m_pTexture(pTexture) {}
+		virtual ~TextureSurface() { m_pTexture->Release(); }
+	private:
+		MockTexture* m_pTexture;
+	};
+
+	int* m_pLive;
+	ULONG m_refCount;
+	bool m_surfaceFails;
+};
+
+/**
+* Mock device, fails the n-th texture creation or surface level call (counted from 1, 0 = none).
+***/
+class MockDevice : public IDirect3DDevice9
+{
+public:
+	MockDevice() : live(0), creations(0), failCreation(0), failSurface(0) {}
+	virtual HRESULT WINAPI CreateTexture(UINT Width, UINT Height, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DTexture9** ppTexture, HANDLE* pSharedHandle)
+	{
+		creations++;
+		lastWidth = Width;
+		lastUsage = Usage;
+		if (creations == failCreation)
+		{
+			*ppTexture = NULL;
+			return E_OUTOFMEMORY;
+		}
+		*ppTexture = new MockTexture(&live, creations == failSurface);
+		return D3D_OK;
+	}
+
+	int live;
+	int creations;
+	int failCreation;
+	int failSurface;
+	UINT lastWidth;
+	DWORD lastUsage;
+};
+
+static D3DSURFACE_DESC BackBufferDesc()
+{
+	D3DSURFACE_DESC desc;
+	ZeroMemory(&desc, sizeof(desc));
+	desc.Format = D3DFMT_X8R8G8B8;
+	desc.Width = 1920;
+	desc.Height = 1080;
+	return desc;
+}
+
+/**
+* Sampleable eyes need no textures, else both are created once.
+***/
+static void CreatesTexturesOnFirstCopy()
+{
+	MockDevice device;
+	{
+		EyeTextures eyeTextures;
+		VIREIO_CHECK(eyeTextures.SelectInput(&device, BackBufferDesc(), true) == EYE_INPUT_DIRECT);
+		VIREIO_CHECK(device.creations == 0);
+		VIREIO_CHECK(eyeTextures.GetLeftTexture() == NULL);
+
+		VIREIO_CHECK(eyeTextures.SelectInput(&device, BackBufferDesc(), false) == EYE_INPUT_COPY);
+		VIREIO_CHECK(device.creations == 2);
+		VIREIO_CHECK(device.lastWidth == 1920);
+		VIREIO_CHECK(device.lastUsage == D3DUSAGE_RENDERTARGET);
+		VIREIO_CHECK(eyeTextures.GetLeftTexture() && eyeTextures.GetRightTexture());
+		VIREIO_CHECK(eyeTextures.GetLeftSurface() && eyeTextures.GetRightSurface());
+
+		// kept while switching between direct sampling and copies
+		VIREIO_CHECK(eyeTextures.SelectInput(&device, BackBufferDesc(), true) == EYE_INPUT_DIRECT);
+		VIREIO_CHECK(eyeTextures.SelectInput(&device, BackBufferDesc(), false) == EYE_INPUT_COPY);
+		VIREIO_CHECK(device.creations == 2);
+		VIREIO_CHECK(device.live == 4);
+
+		// device reset
+		eyeTextures.ReleaseEverything();
+		VIREIO_CHECK(device.live == 0);
+		VIREIO_CHECK(eyeTextures.GetLeftSurface() == NULL);
+		VIREIO_CHECK(eyeTextures.SelectInput(&device, BackBufferDesc(), false) == EYE_INPUT_COPY);
+		VIREIO_CHECK(device.creations == 4);
+	}
+	VIREIO_CHECK(device.live == 0);
+}
+
+/**
+* Any failing step releases everything created before and selects the back buffer, creation is
+* not tried again before the next reset.
+***/
+static void PartialFailureKeepsNothing()
+{
+	for (int step = 0; step < 4; step++)
+	{
+		MockDevice device;
+		if (step % 2 == 0)
+			device.failCreation = step / 2 + 1;
+		else
+			device.failSurface = step / 2 + 1;
+
+		EyeTextures eyeTextures;
+		VIREIO_CHECK(eyeTextures.SelectInput(&device, BackBufferDesc(), false) == EYE_INPUT_BACK_BUFFER);
+		VIREIO_CHECK(device.live == 0);
+		VIREIO_CHECK(eyeTextures.GetLeftTexture() == NULL);
+		VIREIO_CHECK(eyeTextures.GetRightTexture() == NULL);
+		VIREIO_CHECK(eyeTextures.GetLeftSurface() == NULL);
+		VIREIO_CHECK(eyeTextures.GetRightSurface() == NULL);
+
+		// not retried every frame, sampleable eyes still sampled directly
+		int creations = device.creations;
+		VIREIO_CHECK(eyeTextures.SelectInput(&device, BackBufferDesc(), false) == EYE_INPUT_BACK_BUFFER);
+		VIREIO_CHECK(eyeTextures.SelectInput(&device, BackBufferDesc(), true) == EYE_INPUT_DIRECT);
+		VIREIO_CHECK(device.creations == creations);
+
+		// retried after a reset
+		device.failCreation = 0;
+		device.failSurface = 0;
+		eyeTextures.ReleaseEverything();
+		VIREIO_CHECK(eyeTextures.SelectInput(&device, BackBufferDesc(), false) == EYE_INPUT_COPY);
+		VIREIO_CHECK(device.live == 4);
+		eyeTextures.ReleaseEverything();
+		VIREIO_CHECK(device.live == 0);
+	}
+}
+
+int main()
+{
+	VIREIO_RUN(CreatesTexturesOnFirstCopy);
+	VIREIO_RUN(PartialFailureKeepsNothing);
+	return vireio_test::Result();
+}
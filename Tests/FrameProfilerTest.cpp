@@ -0,0 +1,141 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <FrameProfilerTest.cpp> :
+Unit tests of the FrameProfiler : marker overhead, capture export, dropped events.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "FrameProfiler.h"
+#include <string>
+#include <thread>
+
+/**
+* Upper bound of the cost of one scoped marker (two time stamps and a ring write), in nanoseconds.
+* Typically well below 100 ns, the bound only catches locks or allocations on the hot path.
+***/
+#define MAX_MARKER_OVERHEAD_NS 1000.0
+
+static double ElapsedNs(LONGLONG begin, LONGLONG end)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return (double)(end - begin) * 1000000000.0 / (double)frequency.QuadPart;
+}
+
+static std::string ReadFile(const char* fileName)
+{
+	std::string text;
+	FILE* pFile = NULL;
+	if ((fopen_s(&pFile, fileName, "r") != 0) || !pFile)
+		return text;
+	char buf[4096];
+	size_t count;
+	while ((count = fread(buf, 1, sizeof(buf), pFile)) > 0)
+		text.append(buf, count);
+	fclose(pFile);
+	return text;
+}
+
+static int CountOf(const std::string& text, const std::string& part)
+{
+	int count = 0;
+	for (size_t pos = text.find(part); pos != std::string::npos; pos = text.find(part, pos + part.size()))
+		count++;
+	return count;
+}
+
+static void CompiledOutMarker()
+{
+	PROFILE_SCOPE("CompiledOut");
+}
+
+static void MarkerOverhead()
+{
+	const int markers = 1000000;
+	LONG dropped = FrameProfiler::GetDroppedCount();
+
+	LONGLONG begin = FrameProfiler::Now();
+	for (int i = 0; i < markers; i++)
+	{
+		ProfileScope scope("Overhead");
+		// drain well before the ring is full, as the present thread would
+		if ((i & 4095) == 4095)
+			FrameProfiler::EndFrame();
+	}
+	LONGLONG end = FrameProfiler::Now();
+	FrameProfiler::EndFrame();
+
+	double perMarker = ElapsedNs(begin, end) / markers;
+	printf("marker overhead %.1f ns\n", perMarker);
+	VIREIO_CHECK(perMarker < MAX_MARKER_OVERHEAD_NS);
+	VIREIO_CHECK(FrameProfiler::GetDroppedCount() == dropped);
+}
+
+static void FullRingDropsEvents()
+{
+	FrameProfiler::EndFrame();
+	LONG dropped = FrameProfiler::GetDroppedCount();
+
+	LONGLONG now = FrameProfiler::Now();
+	for (int i = 0; i < FRAMEPROFILER_RING_SIZE + 10; i++)
+		FrameProfiler::Record("Full", now, now);
+
+	VIREIO_CHECK(FrameProfiler::GetDroppedCount() == dropped + 10);
+	FrameProfiler::EndFrame();
+}
+
+static void CaptureExportsAllThreads()
+{
+	FrameProfiler::StartCapture();
+	VIREIO_CHECK(FrameProfiler::IsCapturing());
+
+	std::thread worker([]()
+	{
+		for (int i = 0; i < 100; i++)
+			ProfileScope scope("Worker");
+	});
+	worker.join();
+
+	for (int frame = 0; frame < FRAMEPROFILER_CAPTURE_FRAMES; frame++)
+	{
+		{
+			ProfileScope scope("Draw");
+			CompiledOutMarker();
+		}
+		FrameProfiler::EndFrame();
+	}
+	VIREIO_CHECK(!FrameProfiler::IsCapturing());
+
+	std::string trace = ReadFile("frame_profile_1.json");
+	VIREIO_CHECK(trace.compare(0, 15, "{\"traceEvents\":") == 0);
+	VIREIO_CHECK(CountOf(trace, "\"name\":\"Draw\"") == FRAMEPROFILER_CAPTURE_FRAMES);
+	VIREIO_CHECK(CountOf(trace, "\"name\":\"Worker\"") == 100);
+	VIREIO_CHECK(CountOf(trace, "\"name\":\"Frame\"") == FRAMEPROFILER_CAPTURE_FRAMES);
+#ifndef PROFILE_FRAMES
+	VIREIO_CHECK(CountOf(trace, "CompiledOut") == 0);
+#endif
+	remove("frame_profile_1.json");
+}
+
+int main()
+{
+	VIREIO_RUN(MarkerOverhead);
+	VIREIO_RUN(FullRingDropsEvents);
+	VIREIO_RUN(CaptureExportsAllThreads);
+	return vireio_test::Result();
+}
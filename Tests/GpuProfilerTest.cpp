@@ -0,0 +1,230 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <GpuProfilerTest.cpp> :
+Unit tests of the GpuProfiler on mock timestamp queries.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "GpuProfiler.h"
+#include <math.h>
+
+/**
+* Mock timestamp clock, microseconds.
+***/
+#define MOCK_FREQUENCY 1000000
+
+class MockDevice;
+
+/**
+* Mock query : timestamps take the device GPU clock at Issue(END), results are available once 
+* the device says so.
+***/
+class MockQuery : public IDirect3DQuery9
+{
+public:
+	MockQuery(MockDevice* pDevice, D3DQUERYTYPE type);
+	virtual ~MockQuery();
+	virtual ULONG WINAPI AddRef() { return ++m_refCount; }
+	virtual ULONG WINAPI Release() { ULONG count = --m_refCount; if (count == 0) delete this; return count; }
+	virtual HRESULT WINAPI Issue(DWORD dwIssueFlags);
+	virtual HRESULT WINAPI GetData(void* pData, DWORD dwSize, DWORD dwGetDataFlags);
+
+private:
+	MockDevice* m_pDevice;
+	D3DQUERYTYPE m_type;
+	ULONG m_refCount;
+	UINT64 m_timestamp;
+};
+
+class MockDevice : public IDirect3DDevice9
+{
+public:
+	MockDevice() : gpuTime(0), ready(true), disjoint(false), liveQueries(0), timestampQueries(0) {}
+	virtual HRESULT WINAPI CreateQuery(D3DQUERYTYPE Type, IDirect3DQuery9** ppQuery)
+	{
+		if (Type == D3DQUERYTYPE_TIMESTAMP)
+			timestampQueries++;
+		*ppQuery = new MockQuery(this, Type);
+		return D3D_OK;
+	}
+
+	UINT64 gpuTime;
+	bool ready;
+	bool disjoint;
+	int liveQueries;
+	int timestampQueries;
+};
+
+MockQuery::MockQuery(MockDevice* pDevice, D3DQUERYTYPE type) : m_pDevice(pDevice), m_type(type), m_refCount(1), m_timestamp(0)
+{
+	m_pDevice->liveQueries++;
+}
+
+MockQuery::~MockQuery()
+{
+	m_pDevice->liveQueries--;
+}
+
+HRESULT WINAPI MockQuery::Issue(DWORD dwIssueFlags)
+{
+	if (dwIssueFlags & D3DISSUE_END)
+		m_timestamp = m_pDevice->gpuTime;
+	return D3D_OK;
+}
+
+HRESULT WINAPI MockQuery::GetData(void* pData, DWORD dwSize, DWORD dwGetDataFlags)
+{
+	if (!m_pDevice->ready)
+		return S_FALSE;
+
+	switch (m_type)
+	{
+	case D3DQUERYTYPE_TIMESTAMPDISJOINT:
+		*(BOOL*)pData = m_pDevice->disjoint ? TRUE : FALSE;
+		break;
+	case D3DQUERYTYPE_TIMESTAMPFREQ:
+		*(UINT64*)pData = MOCK_FREQUENCY;
+		break;
+	default:
+		*(UINT64*)pData = m_timestamp;
+		break;
+	}
+	return S_OK;
+}
+
+static bool Near(float a, float b)
+{
+	return fabs(a - b) < 0.001f;
+}
+
+/**
+* Runs GPUPROFILER_LOG_FRAMES frames : eye switches of 10 us each, then 1 ms composition and 0.5 ms HUD.
+***/
+static void RunFrames(GpuProfiler& profiler, MockDevice& device, int eyeSwitches)
+{
+	for (int frame = 0; frame < GPUPROFILER_LOG_FRAMES; frame++)
+	{
+		for (int i = 0; i < eyeSwitches; i++)
+		{
+			profiler.Mark((i & 1) ? GPS_RIGHT_EYE : GPS_LEFT_EYE);
+			device.gpuTime += 10;
+		}
+		profiler.Mark(GPS_COMPOSITION);
+		device.gpuTime += 1000;
+		profiler.Mark(GPS_HUD);
+		device.gpuTime += 500;
+		profiler.EndFrame();
+	}
+}
+
+static void SectionsAreAttributed()
+{
+	MockDevice device;
+	GpuProfiler profiler;
+	profiler.Init(&device);
+
+	RunFrames(profiler, device, 10);
+
+	VIREIO_CHECK(Near(profiler.GetSectionMs(GPS_LEFT_EYE), 0.05f));
+	VIREIO_CHECK(Near(profiler.GetSectionMs(GPS_RIGHT_EYE), 0.05f));
+	VIREIO_CHECK(Near(profiler.GetSectionMs(GPS_BOTH_EYES), 0.0f));
+	VIREIO_CHECK(Near(profiler.GetSectionMs(GPS_COMPOSITION), 1.0f));
+	VIREIO_CHECK(Near(profiler.GetSectionMs(GPS_HUD), 0.5f));
+	VIREIO_CHECK(profiler.GetDroppedCount() == 0);
+	VIREIO_CHECK(profiler.GetOverflowCount() == 0);
+}
+
+static void EyeSwitchFloodKeepsFrameSections()
+{
+	MockDevice device;
+	GpuProfiler profiler;
+	profiler.Init(&device);
+
+	RunFrames(profiler, device, 1000);
+
+	// all eye time accounted for, composition and HUD still measured
+	float eyesMs = profiler.GetSectionMs(GPS_LEFT_EYE) + profiler.GetSectionMs(GPS_RIGHT_EYE) + profiler.GetSectionMs(GPS_BOTH_EYES);
+	VIREIO_CHECK(Near(eyesMs, 10.0f));
+	VIREIO_CHECK(profiler.GetSectionMs(GPS_BOTH_EYES) > 9.0f);
+	VIREIO_CHECK(Near(profiler.GetSectionMs(GPS_COMPOSITION), 1.0f));
+	VIREIO_CHECK(Near(profiler.GetSectionMs(GPS_HUD), 0.5f));
+	VIREIO_CHECK(profiler.GetOverflowCount() == GPUPROFILER_LOG_FRAMES);
+	VIREIO_CHECK(device.timestampQueries <= GPUPROFILER_FRAMES * GPUPROFILER_MAX_MARKS);
+}
+
+static void UnfinishedAndDisjointFramesAreDropped()
+{
+	MockDevice device;
+	GpuProfiler profiler;
+	profiler.Init(&device);
+
+	// never ready : dropped when the query set is reused, never waited for
+	device.ready = false;
+	RunFrames(profiler, device, 2);
+	VIREIO_CHECK(profiler.GetDroppedCount() == GPUPROFILER_LOG_FRAMES - GPUPROFILER_FRAMES);
+
+	UINT dropped = profiler.GetDroppedCount();
+	device.ready = true;
+	device.disjoint = true;
+	RunFrames(profiler, device, 2);
+	VIREIO_CHECK(profiler.GetDroppedCount() == dropped + GPUPROFILER_LOG_FRAMES + GPUPROFILER_FRAMES);
+	VIREIO_CHECK(Near(profiler.GetSectionMs(GPS_COMPOSITION), 0.0f));
+}
+
+static void ReleaseFreesAllQueries()
+{
+	MockDevice device;
+	{
+		GpuProfiler profiler;
+		profiler.Init(&device);
+		RunFrames(profiler, device, 100);
+		VIREIO_CHECK(device.liveQueries > 0);
+
+		profiler.ReleaseEverything();
+		VIREIO_CHECK(device.liveQueries == 0);
+
+		// recreated on use after a reset
+		RunFrames(profiler, device, 2);
+		VIREIO_CHECK(device.liveQueries > 0);
+	}
+	VIREIO_CHECK(device.liveQueries == 0);
+}
+
+static void ResolveFrameRejectsInvalidTimestamps()
+{
+	UINT64 timestamps[3] = {100, 50, 200};
+	GpuProfileSection sections[3] = {GPS_LEFT_EYE, GPS_RIGHT_EYE, GPS_COUNT};
+	float sectionMs[GPS_COUNT];
+	VIREIO_CHECK(!GpuProfiler::ResolveFrame(timestamps, sections, 3, MOCK_FREQUENCY, sectionMs));
+	VIREIO_CHECK(!GpuProfiler::ResolveFrame(timestamps, sections, 3, 0, sectionMs));
+
+	timestamps[1] = 150;
+	VIREIO_CHECK(GpuProfiler::ResolveFrame(timestamps, sections, 3, MOCK_FREQUENCY, sectionMs));
+	VIREIO_CHECK(Near(sectionMs[GPS_LEFT_EYE], 0.05f));
+	VIREIO_CHECK(Near(sectionMs[GPS_RIGHT_EYE], 0.05f));
+}
+
+int main()
+{
+	VIREIO_RUN(SectionsAreAttributed);
+	VIREIO_RUN(EyeSwitchFloodKeepsFrameSections);
+	VIREIO_RUN(UnfinishedAndDisjointFramesAreDropped);
+	VIREIO_RUN(ReleaseFreesAllQueries);
+	VIREIO_RUN(ResolveFrameRejectsInvalidTimestamps);
+	return vireio_test::Result();
+}
@@ -0,0 +1,213 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <InitTaskGraphTest.cpp> :
+Unit tests of the initialization task graph : dependency ordering, waiting for single tasks,
+running on the calling thread if no worker starts, empty graphs.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "InitTaskGraph.h"
+#include <algorithm>
+#include <atomic>
+
+/**
+* Tasks of the ordering stress graph, each depends on up to three earlier ones.
+***/
+#define STRESS_TASKS 200
+
+/**
+* Order the tasks finished in, tasks append their index.
+***/
+class RunLog
+{
+public:
+	void Done(int task)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_order.push_back(task);
+	}
+	/**
+	* Position of the task in the run order, -1 if it didn't run.
+	***/
+	int Position(int task)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		std::vector<int>::iterator it = std::find(m_order.begin(), m_order.end(), task);
+		return (it == m_order.end()) ? -1 : (int)(it - m_order.begin());
+	}
+	size_t Count()
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		return m_order.size();
+	}
+
+private:
+	std::mutex m_lock;
+	std::vector<int> m_order;
+};
+
+/**
+* Every task runs once, after all its dependencies.
+***/
+static void RunsDependenciesFirst()
+{
+	RunLog log;
+	std::vector<std::vector<int> > dependencies(STRESS_TASKS);
+	{
+		InitTaskGraph graph;
+		for (int i = 0; i < STRESS_TASKS; i++)
+		{
+			int task = graph.Add("Task", [&log, i]() {log.Done(i);});
+			for (int d = 1; d <= 3; d++)
+			{
+				int dependency = (i * 7 + d * 13) % STRESS_TASKS;
+				if (dependency < task)
+				{
+					graph.DependsOn(task, dependency);
+					dependencies[task].push_back(dependency);
+				}
+			}
+		}
+		VIREIO_CHECK(graph.Start());
+		graph.WaitAll();
+		VIREIO_CHECK(log.Count() == STRESS_TASKS);
+	}
+
+	int misordered = 0;
+	for (int i = 0; i < STRESS_TASKS; i++)
+		for (size_t d = 0; d < dependencies[i].size(); d++)
+			if (log.Position(dependencies[i][d]) >= log.Position(i))
+				misordered++;
+	VIREIO_CHECK(misordered == 0);
+	VIREIO_CHECK(log.Count() == STRESS_TASKS);
+}
+
+/**
+* Tasks run on the workers, Wait() joins a single task while others still run, a task
+* depending on a hanging one doesn't start.
+***/
+static void WaitsForSingleTasks()
+{
+	HANDLE hGate = CreateEvent(NULL, TRUE, FALSE, NULL);
+	DWORD callerThread = GetCurrentThreadId();
+	std::atomic<DWORD> taskThread(0);
+	std::atomic<bool> dependentRan(false);
+	RunLog log;
+
+	InitTaskGraph graph;
+	int hanging = graph.Add("Hanging", [&]() {WaitForSingleObject(hGate, INFINITE); log.Done(0);});
+	int quick = graph.Add("Quick", [&]() {taskThread = GetCurrentThreadId(); log.Done(1);});
+	int dependent = graph.Add("Dependent", [&]() {dependentRan = true; log.Done(2);});
+	graph.DependsOn(dependent, hanging);
+	VIREIO_CHECK(graph.Start());
+
+	graph.Wait(quick);
+	VIREIO_CHECK(log.Position(1) == 0);
+	Sleep(50);
+	VIREIO_CHECK(!dependentRan);
+	VIREIO_CHECK(log.Position(0) == -1);
+
+	SetEvent(hGate);
+	graph.Wait(dependent);
+	VIREIO_CHECK(dependentRan);
+	VIREIO_CHECK(log.Position(0) < log.Position(2));
+	graph.WaitAll();
+	VIREIO_CHECK(log.Count() == 3);
+	VIREIO_CHECK((taskThread != 0) && (taskThread != callerThread));
+	CloseHandle(hGate);
+}
+
+/**
+* Without workers the tasks run on the calling thread in the order they were added.
+***/
+static void RunsInlineWithoutWorkers()
+{
+	DWORD callerThread = GetCurrentThreadId();
+	int otherThread = 0;
+	RunLog log;
+
+	InitTaskGraph graph(2);
+	for (int i = 0; i < 5; i++)
+		graph.Add("Inline", [&, i]() {log.Done(i); if (GetCurrentThreadId() != callerThread) otherThread++;});
+	graph.DependsOn(3, 1);
+	graph.DependsOn(4, 2);
+
+	vireio_win32::ThreadFailures() = 2;
+	VIREIO_CHECK(!graph.Start());
+	vireio_win32::ThreadFailures() = 0;
+
+	// all done when Start() returns
+	VIREIO_CHECK(log.Count() == 5);
+	for (int i = 0; i < 5; i++)
+		VIREIO_CHECK(log.Position(i) == i);
+	VIREIO_CHECK(otherThread == 0);
+	graph.Wait(4);
+	graph.WaitAll();
+	VIREIO_CHECK(log.Count() == 5);
+}
+
+/**
+* Empty graphs, graphs never started and invalid dependencies.
+***/
+static void EmptyAndUnstartedGraphs()
+{
+	{
+		InitTaskGraph graph;
+		VIREIO_CHECK(graph.Start());
+		graph.WaitAll();
+		graph.Wait(0);
+		graph.WaitAll();
+	}
+	{
+		InitTaskGraph graph;
+		graph.WaitAll();
+	}
+
+	// WaitAll() starts the graph, the destructor does too
+	RunLog log;
+	{
+		InitTaskGraph graph;
+		graph.Add("First", [&]() {log.Done(0);});
+		graph.WaitAll();
+		VIREIO_CHECK(log.Count() == 1);
+	}
+	{
+		InitTaskGraph graph;
+		int first = graph.Add("First", [&]() {log.Done(1);});
+		int second = graph.Add("Second", [&]() {log.Done(2);});
+
+		// cycles can't be declared : forward and self dependencies are ignored
+		graph.DependsOn(first, second);
+		graph.DependsOn(second, second);
+		graph.DependsOn(second, 5);
+	}
+	VIREIO_CHECK(log.Count() == 3);
+	VIREIO_CHECK(log.Position(2) >= 0);
+}
+
+int main()
+{
+	// several workers, whatever the host
+	vireio_win32::ProcessorCount() = 4;
+
+	VIREIO_RUN(RunsDependenciesFirst);
+	VIREIO_RUN(WaitsForSingleTasks);
+	VIREIO_RUN(RunsInlineWithoutWorkers);
+	VIREIO_RUN(EmptyAndUnstartedGraphs);
+	return vireio_test::Result();
+}
@@ -0,0 +1,245 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <MotionTrackerConnectionTest.cpp> :
+Unit tests of the motion tracker connection with a fake tracker factory : probing, loss and
+reconnection, no blocking on a hanging probe thread.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "MotionTrackerConnection.h"
+#include "MotionTrackerFactory.h"
+#include <atomic>
+
+/**
+* Time to wait for the probe thread to hand out a tracker.
+***/
+#define SWITCH_TIMEOUT_MS (TRACKERCONNECTION_LOST_MS + 2000)
+
+/**
+* Fake trackers created and deleted.
+***/
+static std::atomic<int> g_created(0);
+static std::atomic<int> g_deleted(0);
+/**
+* Status of the next fake tracker created.
+***/
+static std::atomic<int> g_nextStatus(MTS_OK);
+/**
+* The factory blocks while this event is reset, like a device initialization hanging in a driver.
+***/
+static HANDLE g_hFactoryGate = NULL;
+
+/**
+* The game configuration is loaded by ProxyHelper (not built here), the connection only copies it.
+***/
+ProxyConfig::ProxyConfig()
+{
+}
+
+/**
+* Tracker with a settable status.
+***/
+class FakeTracker : public MotionTracker
+{
+public:
+	FakeTracker(MotionTrackerStatus status) : m_status(status) {g_created++;}
+	virtual ~FakeTracker() {g_deleted++;}
+	virtual MotionTrackerStatus getStatus() {return (MotionTrackerStatus)m_status.load();}
+	virtual char* GetTrackerDescription() {return (char*)"FakeTracker";}
+
+	std::atomic<int> m_status;
+};
+
+MotionTracker* MotionTrackerFactory::Get(ProxyConfig& config)
+{
+	WaitForSingleObject(g_hFactoryGate, INFINITE);
+	return new FakeTracker((MotionTrackerStatus)g_nextStatus.load());
+}
+
+static DWORD Elapsed(LARGE_INTEGER start)
+{
+	LARGE_INTEGER now, frequency;
+	QueryPerformanceCounter(&now);
+	QueryPerformanceFrequency(&frequency);
+	return (DWORD)((now.QuadPart - start.QuadPart) * 1000 / frequency.QuadPart);
+}
+
+/**
+* Calls Update() once per millisecond (a frame) until it returns the tracker to switch to.
+* @return The new tracker, NULL on timeout.
+***/
+static MotionTracker* WaitForSwitch(MotionTrackerConnection* pConnection, MotionTracker* pCurrent)
+{
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+	while (Elapsed(start) < SWITCH_TIMEOUT_MS)
+	{
+		MotionTracker* pNew = pConnection->Update(pCurrent);
+		if (pNew)
+			return pNew;
+		Sleep(1);
+	}
+	return NULL;
+}
+
+/**
+* Waits until every fake tracker is deleted (released by a probe thread).
+***/
+static bool WaitForRelease()
+{
+	for (int i = 0; (i < 2000) && (g_deleted != g_created); i++)
+		Sleep(1);
+	return g_deleted == g_created;
+}
+
+static void ConnectsOnProbe()
+{
+	ProxyConfig config;
+	MotionTrackerConnection connection;
+	SetEvent(g_hFactoryGate);
+	g_nextStatus = MTS_OK;
+
+	MotionTracker* pPending = connection.Start(&config);
+	VIREIO_CHECK(pPending->getStatus() == MTS_INITIALISING);
+
+	MotionTracker* pTracker = WaitForSwitch(&connection, pPending);
+	VIREIO_CHECK(pTracker != NULL);
+	if (!pTracker)
+		return;
+	VIREIO_CHECK(pTracker->getStatus() == MTS_OK);
+	VIREIO_CHECK(connection.GetState() == TCS_ACTIVE);
+	VIREIO_CHECK(connection.Update(pTracker) == NULL);
+
+	connection.Stop();
+	delete pTracker;
+	VIREIO_CHECK(WaitForRelease());
+}
+
+/**
+* Update() never waits for a probe still creating the device.
+***/
+static void UpdateDoesNotBlock()
+{
+	ProxyConfig config;
+	MotionTrackerConnection connection;
+	ResetEvent(g_hFactoryGate);
+	g_nextStatus = MTS_OK;
+
+	MotionTracker* pPending = connection.Start(&config);
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+	bool switched = false;
+	for (int i = 0; i < 100; i++)
+		switched |= (connection.Update(pPending) != NULL);
+	VIREIO_CHECK(!switched);
+	VIREIO_CHECK(Elapsed(start) < 100);
+	VIREIO_CHECK(connection.GetState() == TCS_PROBING);
+
+	SetEvent(g_hFactoryGate);
+	MotionTracker* pTracker = WaitForSwitch(&connection, pPending);
+	VIREIO_CHECK(pTracker != NULL);
+	connection.Stop();
+	delete pTracker;
+	VIREIO_CHECK(WaitForRelease());
+}
+
+/**
+* Stop() gives up on a hanging probe thread, the abandoned thread releases its tracker itself.
+***/
+static void StopAbandonsHangingProbe()
+{
+	ProxyConfig config;
+	MotionTrackerConnection* pConnection = new MotionTrackerConnection();
+	ResetEvent(g_hFactoryGate);
+	g_nextStatus = MTS_OK;
+
+	MotionTracker* pPending = pConnection->Start(&config);
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+	pConnection->Stop();
+	DWORD stopMs = Elapsed(start);
+	VIREIO_CHECK(stopMs >= TRACKERCONNECTION_STOP_MS - 100);
+	VIREIO_CHECK(stopMs < TRACKERCONNECTION_STOP_MS + 1000);
+	VIREIO_CHECK(pConnection->GetState() == TCS_IDLE);
+	delete pPending;
+	delete pConnection;
+
+	// the device shows up after the connection is gone
+	int created = g_created;
+	SetEvent(g_hFactoryGate);
+	for (int i = 0; (i < 2000) && (g_created == created); i++)
+		Sleep(1);
+	VIREIO_CHECK(g_created == created + 1);
+	VIREIO_CHECK(WaitForRelease());
+}
+
+/**
+* A tracker reporting a device failure is switched to a neutral tracker, released on the probe
+* thread and replaced by a new one.
+***/
+static void ReconnectsLostTracker()
+{
+	ProxyConfig config;
+	MotionTrackerConnection connection;
+	SetEvent(g_hFactoryGate);
+	g_nextStatus = MTS_OK;
+
+	MotionTracker* pPending = connection.Start(&config);
+	FakeTracker* pTracker = (FakeTracker*)WaitForSwitch(&connection, pPending);
+	VIREIO_CHECK(pTracker != NULL);
+	if (!pTracker)
+		return;
+
+	// short failures are tolerated
+	pTracker->m_status = MTS_NOHMDDETECTED;
+	VIREIO_CHECK(connection.Update(pTracker) == NULL);
+	pTracker->m_status = MTS_OK;
+	VIREIO_CHECK(connection.Update(pTracker) == NULL);
+
+	pTracker->m_status = MTS_NOHMDDETECTED;
+	int deleted = g_deleted;
+	MotionTracker* pNeutral = WaitForSwitch(&connection, pTracker);
+	VIREIO_CHECK(pNeutral != NULL);
+	if (!pNeutral)
+		return;
+	VIREIO_CHECK(pNeutral->getStatus() == MTS_NOHMDDETECTED);
+	VIREIO_CHECK(connection.GetState() == TCS_LOST);
+	VIREIO_CHECK(g_deleted == deleted);
+
+	MotionTracker* pReconnected = WaitForSwitch(&connection, pNeutral);
+	VIREIO_CHECK(pReconnected != NULL);
+	VIREIO_CHECK(g_deleted == deleted + 1);
+	VIREIO_CHECK(connection.GetState() == TCS_ACTIVE);
+
+	connection.Stop();
+	delete pReconnected;
+	VIREIO_CHECK(WaitForRelease());
+}
+
+int main()
+{
+	g_hFactoryGate = CreateEvent(NULL, TRUE, TRUE, NULL);
+
+	VIREIO_RUN(ConnectsOnProbe);
+	VIREIO_RUN(UpdateDoesNotBlock);
+	VIREIO_RUN(StopAbandonsHangingProbe);
+	VIREIO_RUN(ReconnectsLostTracker);
+
+	CloseHandle(g_hFactoryGate);
+	return vireio_test::Result();
+}
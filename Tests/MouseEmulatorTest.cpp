@@ -0,0 +1,224 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <MouseEmulatorTest.cpp> :
+Unit tests of the mouse emulation engine with a fake mouse injector.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "MotionTracker.h"
+#include <atomic>
+#include <stdlib.h>
+
+/**
+* Tick interval of the deterministic tests, ms.
+***/
+#define TICK_MS 4
+
+/**
+* Sums the mouse motion instead of sending it.
+***/
+class FakeInjector : public MouseInjector
+{
+public:
+	FakeInjector() : moves(0), dx(0), dy(0) {}
+	virtual void Move(LONG x, LONG y) { moves++; dx += x; dy += y; }
+
+	std::atomic<int> moves;
+	std::atomic<LONG> dx, dy;
+};
+
+static LONGLONG Ticks(double milliseconds)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return (LONGLONG)(milliseconds * (double)frequency.QuadPart / 1000.0);
+}
+
+/**
+* Submits one pose per tick (constant speed, mouse degrees) and ticks the emulator through it.
+* Tick times are ahead of the submits, so each tick sends all of the remaining motion.
+***/
+class Turner
+{
+public:
+	Turner(MouseEmulator* pEmulator) : m_pEmulator(pEmulator), yaw(0.0f), pitch(0.0f)
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		m_time = now.QuadPart + Ticks(60000.0);
+	}
+
+	void Turn(int ticks, float yawPerTick, float pitchPerTick)
+	{
+		for (int i = 0; i < ticks; i++)
+		{
+			yaw += yawPerTick;
+			pitch += pitchPerTick;
+			m_pEmulator->SubmitPose(yaw, pitch);
+			m_time += Ticks(TICK_MS);
+			m_pEmulator->Tick(m_time);
+		}
+	}
+
+	float yaw, pitch;
+
+private:
+	MouseEmulator* m_pEmulator;
+	LONGLONG m_time;
+};
+
+static void FollowsPoses()
+{
+	FakeInjector injector;
+	MouseEmulator emulator(&injector);
+	emulator.SetMultipliers(10.0f, 5.0f);
+
+	// first tick only follows
+	Turner turner(&emulator);
+	turner.Turn(100, 0.5f, 0.2f);
+	VIREIO_CHECK(abs(injector.dx - 495) <= 1);
+	VIREIO_CHECK(abs(injector.dy - 99) <= 1);
+}
+
+static void CarriesSubUnitMotion()
+{
+	FakeInjector injector;
+	MouseEmulator emulator(&injector);
+
+	// a tenth of a unit per tick
+	Turner turner(&emulator);
+	turner.Turn(201, 0.1f, 0.0f);
+	VIREIO_CHECK(abs(injector.dx - 20) <= 1);
+	VIREIO_CHECK(injector.moves <= 21);
+	VIREIO_CHECK(injector.dy == 0);
+}
+
+static void DisabledAndJumpsDontMove()
+{
+	FakeInjector injector;
+	MouseEmulator emulator(&injector);
+
+	Turner turner(&emulator);
+	emulator.SetEnabled(false);
+	turner.Turn(50, 1.0f, 0.0f);
+	VIREIO_CHECK(injector.moves == 0);
+
+	// enabling doesn't send the motion while disabled
+	emulator.SetEnabled(true);
+	turner.Turn(10, 1.0f, 0.0f);
+	VIREIO_CHECK(abs(injector.dx - 10) <= 1);
+
+	// recenter
+	LONG dx = injector.dx;
+	turner.yaw = 0.0f;
+	turner.Turn(1, 0.0f, 0.0f);
+	VIREIO_CHECK(injector.dx == dx);
+	turner.Turn(10, 1.0f, 0.0f);
+	VIREIO_CHECK(abs(injector.dx - dx - 10) <= 1);
+}
+
+static void DeadzoneRemovesDrift()
+{
+	FakeInjector injector;
+	MouseEmulator emulator(&injector);
+	MouseAxisCurve curve;
+	curve.deadzone = 5.0f;
+	curve.exponent = 1.0f;
+	emulator.SetCurves(curve, curve);
+	emulator.SetMultipliers(100.0f, 100.0f);
+
+	// 2.5 degrees per second
+	Turner turner(&emulator);
+	turner.Turn(250, 0.01f, 0.01f);
+	VIREIO_CHECK(injector.moves == 0);
+
+	// 25 degrees per second, 20 above the deadzone
+	turner.Turn(250, 0.1f, 0.0f);
+	VIREIO_CHECK(abs(injector.dx - 2000) <= 2);
+}
+
+static void SpreadsSubmittedPoses()
+{
+	FakeInjector injector;
+	MouseEmulator emulator(&injector);
+	emulator.SetMultipliers(10.0f, 10.0f);
+
+	// two submits 20 ms apart : the next pose is spread over 20 ms
+	LARGE_INTEGER now;
+	emulator.SubmitPose(0.0f, 0.0f);
+	QueryPerformanceCounter(&now);
+	emulator.Tick(now.QuadPart);
+	Sleep(20);
+	emulator.SubmitPose(2.0f, -1.0f);
+	QueryPerformanceCounter(&now);
+	LONGLONG submitted = now.QuadPart;
+
+	emulator.Tick(submitted + Ticks(5.0));
+	VIREIO_CHECK((injector.dx > 0) && (injector.dx < 20));
+	emulator.Tick(submitted + Ticks(40.0));
+	VIREIO_CHECK(abs(injector.dx - 20) <= 1);
+	VIREIO_CHECK(abs(injector.dy + 10) <= 1);
+}
+
+/**
+* Sampled tracker : the emulation thread resamples the pose history, pitch up is mouse up.
+***/
+static void ResamplesPoseHistory()
+{
+	TrackerSampler sampler(NULL);
+	FakeInjector injector;
+	MouseEmulator emulator(&injector);
+	VIREIO_CHECK(emulator.Start(250.0f, &sampler, (float)(2.0 * PI)));
+	VIREIO_CHECK(emulator.IsRunning());
+
+	// one degree per 10 ms
+	for (int i = 0; i <= 30; i++)
+	{
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		TrackerPose pose;
+		ZeroMemory(&pose, sizeof(pose));
+		pose.time = now.QuadPart;
+		pose.yaw = (float)i * (float)(PI / 180.0);
+		pose.pitch = (float)i * (float)(PI / 360.0);
+		sampler.Push(pose);
+		Sleep(10);
+	}
+
+	emulator.Stop();
+	VIREIO_CHECK(!emulator.IsRunning());
+	int moves = injector.moves;
+	VIREIO_CHECK(moves > 0);
+	VIREIO_CHECK((injector.dx > 20) && (injector.dx <= 30));
+	VIREIO_CHECK((injector.dy < -10) && (injector.dy >= -15));
+
+	// no ticks after Stop()
+	Sleep(20);
+	VIREIO_CHECK(injector.moves == moves);
+}
+
+int main()
+{
+	VIREIO_RUN(FollowsPoses);
+	VIREIO_RUN(CarriesSubUnitMotion);
+	VIREIO_RUN(DisabledAndJumpsDontMove);
+	VIREIO_RUN(DeadzoneRemovesDrift);
+	VIREIO_RUN(SpreadsSubmittedPoses);
+	VIREIO_RUN(ResamplesPoseHistory);
+	return vireio_test::Result();
+}
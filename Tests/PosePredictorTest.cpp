@@ -0,0 +1,125 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <PosePredictorTest.cpp> :
+Unit tests of the pose prediction : extrapolation and a stopped head.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "PosePredictor.h"
+#include <math.h>
+
+/**
+* Sample interval, yaw velocity (radians per second).
+***/
+#define INTERVAL_MS 10
+#define YAW_VELOCITY 1.0f
+
+static LONGLONG Ticks(double milliseconds)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return (LONGLONG)(milliseconds * (double)frequency.QuadPart / 1000.0);
+}
+
+static TrackerPose Pose(double milliseconds, float yaw)
+{
+	TrackerPose pose;
+	ZeroMemory(&pose, sizeof(pose));
+	pose.time = Ticks(milliseconds);
+	pose.yaw = yaw;
+	return pose;
+}
+
+/**
+* Turns with constant velocity for 100 ms.
+* @return The time of the last sample, ms.
+***/
+static double Turn(PosePredictor* pPredictor)
+{
+	double milliseconds = 0.0;
+	for (int i = 0; i <= 10; i++)
+	{
+		milliseconds = i * INTERVAL_MS;
+		pPredictor->AddSample(Pose(milliseconds, YAW_VELOCITY * (float)(milliseconds / 1000.0)));
+	}
+	return milliseconds;
+}
+
+static void ExtrapolatesVelocity()
+{
+	PosePredictor predictor;
+	predictor.SetFilters(20.0f, 0.5f, 1.0f);
+	double last = Turn(&predictor);
+
+	TrackerPose predicted;
+	VIREIO_CHECK(predictor.Predict(Ticks(last + 20.0), &predicted));
+	VIREIO_CHECK(fabs(predicted.yaw - YAW_VELOCITY * 0.12f) < 0.001f);
+
+	// repeats within the still intervals keep the estimate (tracker slower than the reads)
+	predictor.AddSample(Pose(last + INTERVAL_MS, YAW_VELOCITY * (float)(last / 1000.0)));
+	VIREIO_CHECK(predictor.Predict(Ticks(last + 20.0), &predicted));
+	VIREIO_CHECK(fabs(predicted.yaw - YAW_VELOCITY * 0.12f) < 0.001f);
+}
+
+static void StoppedHeadIsNotExtrapolated()
+{
+	PosePredictor predictor;
+	predictor.SetFilters(20.0f, 0.5f, 1.0f);
+	double last = Turn(&predictor);
+	float yaw = YAW_VELOCITY * (float)(last / 1000.0);
+
+	// no new data for three intervals
+	for (int i = 1; i <= 3; i++)
+		predictor.AddSample(Pose(last + i * INTERVAL_MS, yaw));
+
+	TrackerPose predicted;
+	VIREIO_CHECK(predictor.Predict(Ticks(last + 100.0), &predicted));
+	VIREIO_CHECK(predicted.yaw == yaw);
+
+	// moving again : velocity from the still pose, not from the last change
+	double moved = last + 4 * INTERVAL_MS;
+	predictor.AddSample(Pose(moved, yaw + YAW_VELOCITY * 0.01f));
+	VIREIO_CHECK(predictor.Predict(Ticks(moved + 10.0), &predicted));
+	VIREIO_CHECK(fabs(predicted.yaw - (yaw + YAW_VELOCITY * 0.02f)) < 0.001f);
+}
+
+static void ResetForgetsTheInterval()
+{
+	PosePredictor predictor;
+	predictor.SetFilters(20.0f, 0.5f, 1.0f);
+	Turn(&predictor);
+	predictor.Reset();
+
+	TrackerPose predicted;
+	VIREIO_CHECK(!predictor.Predict(Ticks(0.0), &predicted));
+
+	// two slow samples, the first repeat after them isn't taken as a stop
+	predictor.AddSample(Pose(1000.0, 0.0f));
+	predictor.AddSample(Pose(1100.0, 0.1f));
+	predictor.AddSample(Pose(1150.0, 0.1f));
+	VIREIO_CHECK(predictor.Predict(Ticks(1200.0), &predicted));
+	VIREIO_CHECK(fabs(predicted.yaw - 0.2f) < 0.001f);
+}
+
+int main()
+{
+	VIREIO_RUN(ExtrapolatesVelocity);
+	VIREIO_RUN(StoppedHeadIsNotExtrapolated);
+	VIREIO_RUN(ResetForgetsTheInterval);
+	return vireio_test::Result();
+}
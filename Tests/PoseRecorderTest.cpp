@@ -0,0 +1,272 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <PoseRecorderTest.cpp> :
+Unit tests of pose recording and replay on temporary files : record times, round trips at speed 0
+and at the recorded timing, looping, rejected files.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "ReplayTracker.h"
+#include <stdlib.h>
+#include <string>
+
+using std::string;
+
+/**
+* Time between the recorded poses of the timing tests, ms.
+***/
+#define POSE_INTERVAL_MS 200
+
+/**
+* Temporary directory of the test files.
+***/
+static string g_directory;
+
+static string TestPath(const char* name)
+{
+	return g_directory + "/" + name;
+}
+
+static LONGLONG Ticks(double milliseconds)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return (LONGLONG)(milliseconds * (double)frequency.QuadPart / 1000.0);
+}
+
+static LONGLONG Now()
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return now.QuadPart;
+}
+
+/**
+* Pose n of the test recordings : yaw 0.1 * n radians, position (n, 2n, 3n).
+***/
+static TrackerPose Pose(LONGLONG time, int n)
+{
+	TrackerPose pose;
+	ZeroMemory(&pose, sizeof(pose));
+	pose.time = time;
+	pose.yaw = 0.1f * (float)n;
+	pose.pitch = -0.1f * (float)n;
+	pose.roll = 0.05f * (float)n;
+	pose.x = (float)n;
+	pose.y = 2.0f * (float)n;
+	pose.z = 3.0f * (float)n;
+	return pose;
+}
+
+/**
+* Records poses POSE_INTERVAL_MS apart, starting at Open().
+***/
+static bool RecordPoses(const string& path, int count)
+{
+	PoseRecorder recorder;
+	if (!recorder.Open(path.c_str()))
+		return false;
+	LONGLONG start = Now();
+	for (int n = 0; n < count; n++)
+		recorder.Record(Pose(start + Ticks(n * POSE_INTERVAL_MS), n), 1.0f, MTS_OK);
+	return true;
+}
+
+static std::vector<PoseRecord> ReadRecords(const string& path)
+{
+	std::vector<PoseRecord> records;
+	FILE* pFile = fopen(path.c_str(), "rb");
+	if (!pFile)
+		return records;
+	if (PoseRecordingReadHeader(pFile))
+	{
+		PoseRecord record;
+		while (fread(&record, sizeof(record), 1, pFile) == 1)
+			records.push_back(record);
+	}
+	fclose(pFile);
+	return records;
+}
+
+/**
+* Replayed pose number (from the position), -1 if the replay returned no pose.
+***/
+static int Replayed(ReplayTracker* pTracker)
+{
+	float yaw, pitch, roll, x, y, z;
+	if (pTracker->getOrientationAndPosition(&yaw, &pitch, &roll, &x, &y, &z) != 0)
+		return -1;
+	int n = (int)x;
+	VIREIO_CHECK(fabs(yaw - 0.1f * (float)n) < 1e-6f);
+	VIREIO_CHECK(fabs(pitch + 0.1f * (float)n) < 1e-6f);
+	VIREIO_CHECK((y == 2.0f * x) && (z == 3.0f * x));
+	VIREIO_CHECK(pTracker->primaryYaw == -yaw);
+	VIREIO_CHECK(pTracker->primaryRoll == -roll);
+	return n;
+}
+
+/**
+* Record times start at Open(), poses sampled before are recorded at 0, poses read twice once.
+***/
+static void RecordTimes()
+{
+	string path = TestPath("times.vrec");
+	{
+		PoseRecorder recorder;
+		VIREIO_CHECK(recorder.Open(path.c_str()));
+		LONGLONG start = Now();
+		recorder.Record(Pose(start - Ticks(1000.0), 0), 1.0f, MTS_OK);
+		recorder.Record(Pose(start + Ticks(10.0), 1), 1.0f, MTS_OK);
+		recorder.Record(Pose(start + Ticks(10.0), 1), 1.0f, MTS_OK);
+		recorder.Record(Pose(start + Ticks(30.0), 2), 2.0f, MTS_NOORIENTATION);
+	}
+
+	std::vector<PoseRecord> records = ReadRecords(path);
+	VIREIO_CHECK(records.size() == 3);
+	if (records.size() != 3)
+		return;
+	VIREIO_CHECK(records[0].timeUs == 0);
+	VIREIO_CHECK((records[1].timeUs >= 10000) && (records[1].timeUs < 11000));
+	VIREIO_CHECK((records[2].timeUs >= 30000) && (records[2].timeUs < 31000));
+	VIREIO_CHECK(records[2].yaw == 0.4f);
+	VIREIO_CHECK(records[2].x == 2.0f);
+	VIREIO_CHECK(records[2].status == MTS_NOORIENTATION);
+}
+
+/**
+* Speed 0 steps one pose per update and loops, poses the tracker had none for return no pose.
+***/
+static void ReplaysOnePosePerUpdate()
+{
+	string path = TestPath("step.vrec");
+	VIREIO_CHECK(RecordPoses(path, 3));
+
+	ReplayTracker tracker(path.c_str(), 0.0f);
+	VIREIO_CHECK(tracker.getStatus() == MTS_OK);
+	for (int i = 0; i < 7; i++)
+		VIREIO_CHECK(Replayed(&tracker) == i % 3);
+
+	// negative speeds step too
+	ReplayTracker negative(path.c_str(), -1.0f);
+	VIREIO_CHECK(Replayed(&negative) == 0);
+	VIREIO_CHECK(Replayed(&negative) == 1);
+
+	string lostPath = TestPath("lost.vrec");
+	{
+		PoseRecorder recorder;
+		VIREIO_CHECK(recorder.Open(lostPath.c_str()));
+		recorder.Record(Pose(Now(), 0), 1.0f, MTS_OK);
+		recorder.Record(Pose(Now() + Ticks(10.0), 1), 1.0f, MTS_INITFAIL);
+	}
+	ReplayTracker lost(lostPath.c_str(), 0.0f);
+	VIREIO_CHECK(Replayed(&lost) == 0);
+	VIREIO_CHECK(Replayed(&lost) == -1);
+	VIREIO_CHECK(Replayed(&lost) == 0);
+}
+
+/**
+* Speed 1 plays at the recorded timing and loops after the last pose, other speeds scale it.
+***/
+static void ReplaysRecordedTiming()
+{
+	string path = TestPath("timing.vrec");
+	VIREIO_CHECK(RecordPoses(path, 3));
+
+	{
+		ReplayTracker tracker(path.c_str(), 1.0f);
+		VIREIO_CHECK(Replayed(&tracker) == 0);
+
+		// half way between pose 1 and 2, then past the end (looped)
+		Sleep(POSE_INTERVAL_MS * 3 / 2);
+		VIREIO_CHECK(Replayed(&tracker) == 1);
+		Sleep(POSE_INTERVAL_MS);
+		VIREIO_CHECK(Replayed(&tracker) == 0);
+	}
+	{
+		ReplayTracker tracker(path.c_str(), 2.0f);
+		VIREIO_CHECK(Replayed(&tracker) == 0);
+		Sleep(POSE_INTERVAL_MS * 3 / 4);
+		VIREIO_CHECK(Replayed(&tracker) == 1);
+	}
+}
+
+static void WriteHeader(const string& path, unsigned int magic, unsigned int version, int records)
+{
+	FILE* pFile = fopen(path.c_str(), "wb");
+	PoseRecordingHeader header;
+	header.magic = magic;
+	header.version = version;
+	header.recordSize = sizeof(PoseRecord);
+	header.reserved = 0;
+	fwrite(&header, sizeof(header), 1, pFile);
+	PoseRecord record;
+	ZeroMemory(&record, sizeof(record));
+	record.status = MTS_OK;
+	for (int i = 0; i < records; i++)
+		fwrite(&record, sizeof(record), 1, pFile);
+	fclose(pFile);
+}
+
+static bool Rejected(const string& path)
+{
+	ReplayTracker tracker(path.c_str(), 0.0f);
+	float yaw, pitch, roll, x, y, z;
+	return (tracker.getStatus() == MTS_INITFAIL) && (tracker.getOrientationAndPosition(&yaw, &pitch, &roll, &x, &y, &z) == -1);
+}
+
+/**
+* Missing files, other files, other versions and empty recordings are not replayed.
+***/
+static void RejectsBadRecordings()
+{
+	string path = TestPath("bad.vrec");
+	VIREIO_CHECK(Rejected(TestPath("missing.vrec")));
+
+	WriteHeader(path, POSE_RECORDING_MAGIC, POSE_RECORDING_VERSION, 2);
+	VIREIO_CHECK(!Rejected(path));
+	WriteHeader(path, POSE_RECORDING_MAGIC + 1, POSE_RECORDING_VERSION, 2);
+	VIREIO_CHECK(Rejected(path));
+	WriteHeader(path, POSE_RECORDING_MAGIC, POSE_RECORDING_VERSION + 1, 2);
+	VIREIO_CHECK(Rejected(path));
+	WriteHeader(path, POSE_RECORDING_MAGIC, POSE_RECORDING_VERSION, 0);
+	VIREIO_CHECK(Rejected(path));
+
+	FILE* pFile = fopen(path.c_str(), "wb");
+	fputs("VRPT", pFile);
+	fclose(pFile);
+	VIREIO_CHECK(Rejected(path));
+}
+
+int main()
+{
+	char directory[] = "/tmp/PoseRecorderTest.XXXXXX";
+	if (!mkdtemp(directory))
+		return 1;
+	g_directory = directory;
+
+	VIREIO_RUN(RecordTimes);
+	VIREIO_RUN(ReplaysOnePosePerUpdate);
+	VIREIO_RUN(ReplaysRecordedTiming);
+	VIREIO_RUN(RejectsBadRecordings);
+
+	const char* names[] = {"times.vrec", "step.vrec", "lost.vrec", "timing.vrec", "bad.vrec"};
+	for (int i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+		unlink(TestPath(names[i]).c_str());
+	rmdir(directory);
+	return vireio_test::Result();
+}
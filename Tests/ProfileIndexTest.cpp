@@ -0,0 +1,199 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ProfileIndexTest.cpp> :
+Unit tests of the profile index : layout, hash probing in file order, validation of stale and
+damaged index files.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "ProfileIndex.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+* Profiles of the collision test, far more than the initial 16 hash slots.
+***/
+#define MANY_PROFILES 1000
+
+/**
+* Size and write time of the fake profiles.xml.
+***/
+static const DWORD g_sourceSize = 87000;
+static FILETIME SourceTime()
+{
+	FILETIME time;
+	time.dwLowDateTime = 0x12345678;
+	time.dwHighDateTime = 0x01d00000;
+	return time;
+}
+
+static const ProfileIndexHeader* Header(const std::vector<char>& index)
+{
+	return (const ProfileIndexHeader*)&index[0];
+}
+
+static bool IsValid(const std::vector<char>& index)
+{
+	return ProfileIndexIsValid(&index[0], (DWORD)index.size(), g_sourceSize, SourceTime());
+}
+
+/**
+* Entry number (file order) of the next profile of the exe, -1 if none.
+***/
+static int FindNext(const std::vector<char>& index, const char* name, DWORD* pSlot)
+{
+	const ProfileIndexEntry* pEntry = ProfileIndexFindNext(Header(index), name, ProfileIndexHash(name), pSlot);
+	return pEntry ? (int)(pEntry - ProfileIndexEntries(Header(index))) : -1;
+}
+
+static DWORD FirstSlot(const std::vector<char>& index, const char* name)
+{
+	return ProfileIndexHash(name) & (Header(index)->slotCount - 1);
+}
+
+static void FindsProfilesInFileOrder()
+{
+	ProfileIndexBuilder builder;
+	builder.Add("game.exe", "Steam", 0);
+	builder.Add("other.exe", "", 0);
+	builder.Add("game.exe", "", PROFILE_INDEX_64BIT);
+	builder.Add("Game.exe", "", 0);
+	std::vector<char> index;
+	builder.Build(g_sourceSize, SourceTime(), index);
+	VIREIO_CHECK(IsValid(index));
+	VIREIO_CHECK(Header(index)->entryCount == 4);
+
+	// all profiles of an exe, in file order, case sensitive
+	DWORD slot = FirstSlot(index, "game.exe");
+	VIREIO_CHECK(FindNext(index, "game.exe", &slot) == 0);
+	VIREIO_CHECK(FindNext(index, "game.exe", &slot) == 2);
+	VIREIO_CHECK(FindNext(index, "game.exe", &slot) == -1);
+	slot = FirstSlot(index, "Game.exe");
+	VIREIO_CHECK(FindNext(index, "Game.exe", &slot) == 3);
+	VIREIO_CHECK(FindNext(index, "Game.exe", &slot) == -1);
+	slot = FirstSlot(index, "missing.exe");
+	VIREIO_CHECK(FindNext(index, "missing.exe", &slot) == -1);
+
+	// strings and flags
+	const ProfileIndexEntry* pEntries = ProfileIndexEntries(Header(index));
+	VIREIO_CHECK(strcmp(ProfileIndexString(Header(index), pEntries[0].exeOffset), "game.exe") == 0);
+	VIREIO_CHECK(strcmp(ProfileIndexString(Header(index), pEntries[0].dirOffset), "Steam") == 0);
+	VIREIO_CHECK(strcmp(ProfileIndexString(Header(index), pEntries[1].dirOffset), "") == 0);
+	VIREIO_CHECK(pEntries[0].flags == 0);
+	VIREIO_CHECK(pEntries[2].flags == PROFILE_INDEX_64BIT);
+	VIREIO_CHECK(strcmp(ProfileIndexString(Header(index), Header(index)->fileSize), "") == 0);
+}
+
+/**
+* Every profile is found through colliding hash slots, the table grows with the profiles.
+***/
+static void FindsAllOfManyProfiles()
+{
+	ProfileIndexBuilder builder;
+	for (int i = 0; i < MANY_PROFILES; i++)
+	{
+		char name[32];
+		sprintf(name, "game%d.exe", i);
+		builder.Add(name, "", 0);
+	}
+	std::vector<char> index;
+	builder.Build(g_sourceSize, SourceTime(), index);
+	VIREIO_CHECK(IsValid(index));
+	VIREIO_CHECK(Header(index)->slotCount >= 2 * MANY_PROFILES);
+
+	int found = 0;
+	int probed = 0;
+	for (int i = 0; i < MANY_PROFILES; i++)
+	{
+		char name[32];
+		sprintf(name, "game%d.exe", i);
+		DWORD first = FirstSlot(index, name);
+		DWORD slot = first;
+		if (FindNext(index, name, &slot) == i)
+			found++;
+		if (slot != ((first + 1) & (Header(index)->slotCount - 1)))
+			probed++;
+		VIREIO_CHECK(FindNext(index, name, &slot) == -1);
+	}
+	VIREIO_CHECK(found == MANY_PROFILES);
+	VIREIO_CHECK(probed > 0);
+}
+
+static void EmptyIndex()
+{
+	ProfileIndexBuilder builder;
+	std::vector<char> index;
+	builder.Build(g_sourceSize, SourceTime(), index);
+	VIREIO_CHECK(IsValid(index));
+	VIREIO_CHECK(Header(index)->entryCount == 0);
+
+	DWORD slot = FirstSlot(index, "game.exe");
+	VIREIO_CHECK(FindNext(index, "game.exe", &slot) == -1);
+}
+
+/**
+* Index files of another profiles.xml, other versions or damaged ones are rebuilt.
+***/
+static void RejectsStaleOrDamagedIndex()
+{
+	ProfileIndexBuilder builder;
+	builder.Add("game.exe", "Steam", 0);
+	std::vector<char> index;
+	builder.Build(g_sourceSize, SourceTime(), index);
+	VIREIO_CHECK(IsValid(index));
+
+	FILETIME otherTime = SourceTime();
+	otherTime.dwLowDateTime++;
+	VIREIO_CHECK(!ProfileIndexIsValid(&index[0], (DWORD)index.size(), g_sourceSize + 1, SourceTime()));
+	VIREIO_CHECK(!ProfileIndexIsValid(&index[0], (DWORD)index.size(), g_sourceSize, otherTime));
+	VIREIO_CHECK(!ProfileIndexIsValid(&index[0], (DWORD)index.size() - 1, g_sourceSize, SourceTime()));
+	VIREIO_CHECK(!ProfileIndexIsValid(&index[0], sizeof(ProfileIndexHeader) - 1, g_sourceSize, SourceTime()));
+
+	std::vector<char> damaged = index;
+	((ProfileIndexHeader*)&damaged[0])->magic++;
+	VIREIO_CHECK(!IsValid(damaged));
+
+	damaged = index;
+	((ProfileIndexHeader*)&damaged[0])->version++;
+	VIREIO_CHECK(!IsValid(damaged));
+
+	damaged = index;
+	((ProfileIndexHeader*)&damaged[0])->slotCount = 24;
+	VIREIO_CHECK(!IsValid(damaged));
+
+	damaged = index;
+	((ProfileIndexHeader*)&damaged[0])->entryCount = 1000;
+	VIREIO_CHECK(!IsValid(damaged));
+
+	damaged = index;
+	((ProfileIndexHeader*)&damaged[0])->stringsOffset = (DWORD)index.size();
+	VIREIO_CHECK(!IsValid(damaged));
+
+	damaged = index;
+	damaged[damaged.size() - 1] = 'x';
+	VIREIO_CHECK(!IsValid(damaged));
+}
+
+int main()
+{
+	VIREIO_RUN(FindsProfilesInFileOrder);
+	VIREIO_RUN(FindsAllOfManyProfiles);
+	VIREIO_RUN(EmptyIndex);
+	VIREIO_RUN(RejectsStaleOrDamagedIndex);
+	return vireio_test::Result();
+}
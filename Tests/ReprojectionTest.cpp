@@ -0,0 +1,149 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ReprojectionTest.cpp> :
+Unit tests of the rotational reprojection math : sign conventions, the MaxDelta cut-off, angle 
+wraparound, invalid fields of view and aspect ratios.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "Reprojection.h"
+#include <limits>
+#include <math.h>
+
+#define TEST_PI 3.14159265358979f
+
+static bool Near(float a, float b)
+{
+	return fabsf(a - b) <= 1e-5f;
+}
+
+static bool IsIdentity(const ReprojectionWarp& warp)
+{
+	return (warp.offsetX == 0.0f) && (warp.offsetY == 0.0f) && (warp.rotation == 0.0f);
+}
+
+/**
+* Warp of a head rotation by the given deltas from a fixed render orientation, 90 degrees, 16:10.
+***/
+static ReprojectionWarp Turn(float yaw, float pitch, float roll)
+{
+	return Reprojection::Compute(0.3f, -0.2f, 0.1f, 0.3f + yaw, -0.2f + pitch, 0.1f + roll, 90.0f, 1.6f);
+}
+
+/**
+* Turning left moves the image right, looking up moves it down, rolling left turns it right.
+***/
+static void SignConventions()
+{
+	VIREIO_CHECK(IsIdentity(Turn(0.0f, 0.0f, 0.0f)));
+
+	ReprojectionWarp left = Turn(0.1f, 0.0f, 0.0f);
+	VIREIO_CHECK(left.offsetX > 0.0f);
+	VIREIO_CHECK((left.offsetY == 0.0f) && (left.rotation == 0.0f));
+	// 90 degrees : the image plane is 2 units wide at distance 1
+	VIREIO_CHECK(Near(left.offsetX, tanf(0.1f) / 2.0f));
+	VIREIO_CHECK(Near(Turn(-0.1f, 0.0f, 0.0f).offsetX, -left.offsetX));
+
+	ReprojectionWarp up = Turn(0.0f, 0.1f, 0.0f);
+	VIREIO_CHECK(up.offsetY > 0.0f);
+	VIREIO_CHECK((up.offsetX == 0.0f) && (up.rotation == 0.0f));
+	// the vertical field of view is narrower, same angle moves further
+	VIREIO_CHECK(Near(up.offsetY, left.offsetX * 1.6f));
+	VIREIO_CHECK(Near(Turn(0.0f, -0.1f, 0.0f).offsetY, -up.offsetY));
+
+	ReprojectionWarp roll = Turn(0.0f, 0.0f, 0.1f);
+	VIREIO_CHECK(Near(roll.rotation, -0.1f));
+	VIREIO_CHECK((roll.offsetX == 0.0f) && (roll.offsetY == 0.0f));
+
+	// a narrower field of view moves the image further for the same turn
+	ReprojectionWarp narrow = Reprojection::Compute(0.0f, 0.0f, 0.0f, 0.1f, 0.0f, 0.0f, 60.0f, 1.6f);
+	VIREIO_CHECK(narrow.offsetX > left.offsetX);
+}
+
+/**
+* Deltas beyond MaxDelta on any axis are a tracker jump, no reprojection at all.
+***/
+static void CutsOffLargeDeltas()
+{
+	float below = Reprojection::MaxDelta - 0.01f;
+	float beyond = Reprojection::MaxDelta + 0.01f;
+
+	VIREIO_CHECK(!IsIdentity(Turn(below, 0.0f, 0.0f)));
+	VIREIO_CHECK(!IsIdentity(Turn(0.0f, -below, 0.0f)));
+	VIREIO_CHECK(!IsIdentity(Turn(0.0f, 0.0f, below)));
+
+	VIREIO_CHECK(IsIdentity(Turn(beyond, 0.0f, 0.0f)));
+	VIREIO_CHECK(IsIdentity(Turn(-beyond, 0.0f, 0.0f)));
+	VIREIO_CHECK(IsIdentity(Turn(0.0f, beyond, 0.0f)));
+	VIREIO_CHECK(IsIdentity(Turn(0.0f, 0.0f, -beyond)));
+
+	// one axis beyond drops the others too
+	VIREIO_CHECK(IsIdentity(Turn(0.1f, 0.1f, beyond)));
+}
+
+/**
+* Deltas take the short way around at +-pi.
+***/
+static void WrapsAroundPi()
+{
+	VIREIO_CHECK(Near(Reprojection::AngleDelta(TEST_PI - 0.05f, -TEST_PI + 0.05f), 0.1f));
+	VIREIO_CHECK(Near(Reprojection::AngleDelta(-TEST_PI + 0.05f, TEST_PI - 0.05f), -0.1f));
+	VIREIO_CHECK(Near(Reprojection::AngleDelta(0.2f, 0.5f), 0.3f));
+	VIREIO_CHECK(Near(Reprojection::AngleDelta(0.5f, 0.2f), -0.3f));
+	VIREIO_CHECK(Near(Reprojection::AngleDelta(0.0f, 4.0f * TEST_PI + 0.1f), 0.1f));
+	VIREIO_CHECK(Near(Reprojection::AngleDelta(0.0f, -4.0f * TEST_PI - 0.1f), -0.1f));
+	VIREIO_CHECK(fabsf(Reprojection::AngleDelta(-TEST_PI, TEST_PI)) < 1e-5f);
+
+	// turning left across the yaw seam is a small turn left
+	ReprojectionWarp warp = Reprojection::Compute(TEST_PI - 0.05f, 0.0f, 0.0f, -TEST_PI + 0.05f, 0.0f, 0.0f, 90.0f, 1.6f);
+	VIREIO_CHECK(Near(warp.offsetX, tanf(0.1f) / 2.0f));
+	warp = Reprojection::Compute(0.0f, 0.0f, TEST_PI - 0.05f, 0.0f, 0.0f, -TEST_PI + 0.05f, 90.0f, 1.6f);
+	VIREIO_CHECK(Near(warp.rotation, -0.1f));
+}
+
+/**
+* Zero, negative, too wide or non finite fields of view and aspect ratios, and non finite
+* orientations, give no reprojection.
+***/
+static void RejectsInvalidInputs()
+{
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float infinity = std::numeric_limits<float>::infinity();
+	const float fovs[] = {0.0f, -90.0f, 180.0f, 270.0f, nan, infinity};
+	const float aspects[] = {0.0f, -1.6f, nan, infinity};
+
+	for (size_t i = 0; i < sizeof(fovs) / sizeof(fovs[0]); i++)
+		VIREIO_CHECK(IsIdentity(Reprojection::Compute(0.0f, 0.0f, 0.0f, 0.1f, 0.1f, 0.1f, fovs[i], 1.6f)));
+	for (size_t i = 0; i < sizeof(aspects) / sizeof(aspects[0]); i++)
+		VIREIO_CHECK(IsIdentity(Reprojection::Compute(0.0f, 0.0f, 0.0f, 0.1f, 0.1f, 0.1f, 90.0f, aspects[i])));
+
+	VIREIO_CHECK(IsIdentity(Reprojection::Compute(nan, 0.0f, 0.0f, 0.1f, 0.1f, 0.1f, 90.0f, 1.6f)));
+	VIREIO_CHECK(IsIdentity(Reprojection::Compute(0.0f, 0.0f, 0.0f, 0.1f, 0.1f, infinity, 90.0f, 1.6f)));
+
+	// just inside the valid range
+	VIREIO_CHECK(!IsIdentity(Reprojection::Compute(0.0f, 0.0f, 0.0f, 0.1f, 0.1f, 0.1f, 179.0f, 0.01f)));
+}
+
+int main()
+{
+	VIREIO_RUN(SignConventions);
+	VIREIO_RUN(CutsOffLargeDeltas);
+	VIREIO_RUN(WrapsAroundPi);
+	VIREIO_RUN(RejectsInvalidInputs);
+	return vireio_test::Result();
+}
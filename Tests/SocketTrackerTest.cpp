@@ -0,0 +1,232 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <SocketTrackerTest.cpp> :
+Unit tests of the socket tracker binary UDP mode over loopback.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include <winsock2.h>
+#include "VireioTest.h"
+#include "SocketTracker.h"
+#include <math.h>
+
+/**
+* Time to wait for the receiver thread.
+***/
+#define RECEIVE_TIMEOUT_MS 2000
+
+/**
+* Loopback sender.
+***/
+class Sender
+{
+public:
+	Sender(int port)
+	{
+		m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		ZeroMemory(&m_address, sizeof(m_address));
+		m_address.sin_family = AF_INET;
+		m_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		m_address.sin_port = htons((u_short)port);
+	}
+	~Sender() { closesocket(m_socket); }
+
+	void Send(const void* pData, int size)
+	{
+		sendto(m_socket, (const char*)pData, size, 0, (sockaddr*)&m_address, sizeof(m_address));
+	}
+
+	/**
+	* Sends a yaw rotation, timestamped now (minus an age).
+	***/
+	void SendYaw(DWORD sequence, float yaw, int ageMs = 0)
+	{
+		TrackingDatagram datagram;
+		TrackingDatagramInit(&datagram, sequence, NowUs() - (UINT64)ageMs * 1000, cosf(yaw * 0.5f), 0.0f, sinf(yaw * 0.5f), 0.0f);
+		Send(&datagram, sizeof(datagram));
+	}
+
+	static UINT64 NowUs()
+	{
+		LARGE_INTEGER now, frequency;
+		QueryPerformanceCounter(&now);
+		QueryPerformanceFrequency(&frequency);
+		return (UINT64)((double)now.QuadPart * 1000000.0 / (double)frequency.QuadPart);
+	}
+
+private:
+	SOCKET m_socket;
+	sockaddr_in m_address;
+};
+
+/**
+* Tracker listening on the default port, or the next free one.
+* @return The port, 0 if none.
+***/
+static int Listen(SocketTracker* pTracker)
+{
+	if (pTracker->getStatus() != MTS_NOTINIT)
+		return TRACKING_DATAGRAM_PORT;
+	for (int port = TRACKING_DATAGRAM_PORT + 1; port < TRACKING_DATAGRAM_PORT + 32; port++)
+	{
+		if (pTracker->ListenOnPort(port))
+			return port;
+	}
+	return 0;
+}
+
+static bool WaitForYaw(SocketTracker* pTracker, float yaw, TrackerPose* pPose)
+{
+	for (int waited = 0; waited < RECEIVE_TIMEOUT_MS; waited++)
+	{
+		if (pTracker->readOrientationAndPosition(&pPose->yaw, &pPose->pitch, &pPose->roll, &pPose->x, &pPose->y, &pPose->z) == 0 &&
+			(fabs(pPose->yaw - yaw) < 0.0001f))
+			return true;
+		Sleep(1);
+	}
+	return false;
+}
+
+static bool WaitForDropped(SocketTracker* pTracker, LONG dropped)
+{
+	for (int waited = 0; (waited < RECEIVE_TIMEOUT_MS) && (pTracker->GetDroppedCount() < dropped); waited++)
+		Sleep(1);
+	return pTracker->GetDroppedCount() == dropped;
+}
+
+static void ReceivesPoses()
+{
+	SocketTracker tracker(STM_UDP_BINARY);
+	int port = Listen(&tracker);
+	VIREIO_CHECK(port != 0);
+	VIREIO_CHECK(tracker.getStatus() == MTS_NOORIENTATION);
+
+	Sender sender(port);
+	TrackerPose pose;
+	for (DWORD sequence = 1; sequence <= 10; sequence++)
+		sender.SendYaw(sequence, 0.05f * sequence);
+	VIREIO_CHECK(WaitForYaw(&tracker, 0.5f, &pose));
+	VIREIO_CHECK(tracker.getStatus() == MTS_OK);
+	VIREIO_CHECK((fabs(pose.pitch) < 0.0001f) && (fabs(pose.roll) < 0.0001f));
+	VIREIO_CHECK(tracker.GetDroppedCount() == 0);
+
+	// position and a non unit quaternion
+	TrackingDatagram datagram;
+	TrackingDatagramInit(&datagram, 11, Sender::NowUs(), 2.0f * cosf(0.3f), 0.0f, 2.0f * sinf(0.3f), 0.0f);
+	TrackingDatagramSetPosition(&datagram, 0.1f, 0.2f, 0.3f);
+	sender.Send(&datagram, sizeof(datagram));
+	VIREIO_CHECK(WaitForYaw(&tracker, 0.6f, &pose));
+	VIREIO_CHECK((pose.x == 0.1f) && (pose.y == 0.2f) && (pose.z == 0.3f));
+}
+
+static void DropsInvalidAndOutOfOrder()
+{
+	SocketTracker tracker(STM_UDP_BINARY);
+	int port = Listen(&tracker);
+	VIREIO_CHECK(port != 0);
+
+	Sender sender(port);
+	TrackerPose pose;
+	sender.SendYaw(5, 0.5f);
+	VIREIO_CHECK(WaitForYaw(&tracker, 0.5f, &pose));
+
+	// older and duplicate sequence
+	sender.SendYaw(4, 0.4f);
+	sender.SendYaw(5, 0.4f);
+	VIREIO_CHECK(WaitForDropped(&tracker, 2));
+
+	// wrong size, wrong magic, zero quaternion
+	char garbage[sizeof(TrackingDatagram)];
+	ZeroMemory(garbage, sizeof(garbage));
+	sender.Send(garbage, sizeof(garbage) - 1);
+	sender.Send(garbage, sizeof(garbage));
+	TrackingDatagram datagram;
+	TrackingDatagramInit(&datagram, 6, Sender::NowUs(), 0.0f, 0.0f, 0.0f, 0.0f);
+	sender.Send(&datagram, sizeof(datagram));
+	VIREIO_CHECK(WaitForDropped(&tracker, 5));
+
+	// stale : spent much longer in transit than the others
+	sender.SendYaw(7, 0.7f, 500);
+	VIREIO_CHECK(WaitForDropped(&tracker, 6));
+
+	// sequences compare across the wrap : 0xFFFFFFFF is before 5
+	sender.SendYaw(0xFFFFFFFF, 0.8f);
+	VIREIO_CHECK(WaitForDropped(&tracker, 7));
+	sender.SendYaw(8, 0.8f);
+	VIREIO_CHECK(WaitForYaw(&tracker, 0.8f, &pose));
+	VIREIO_CHECK(tracker.GetDroppedCount() == 7);
+}
+
+/**
+* Makes the receiver start fail on a free port (after the bind), then listens on that port again :
+* works only if the failure closed the socket.
+* @param failures The failure counter of the object to fail (thread or event).
+* @return The port, 0 if none.
+***/
+static int ListenAfterFailure(SocketTracker* pTracker, LONG& failures)
+{
+	for (int port = TRACKING_DATAGRAM_PORT; port < TRACKING_DATAGRAM_PORT + 32; port++)
+	{
+		failures = 1;
+		bool listening = pTracker->ListenOnPort(port);
+		bool failed = (failures == 0);
+		failures = 0;
+		VIREIO_CHECK(!listening);
+		if (!failed)
+			continue;
+
+		// nothing left of the failed start
+		VIREIO_CHECK(pTracker->getStatus() == MTS_NOTINIT);
+		VIREIO_CHECK(!pTracker->isSampling());
+		return pTracker->ListenOnPort(port) ? port : 0;
+	}
+	return 0;
+}
+
+/**
+* A receiver that can't start releases the pose history, the stop event and the socket.
+***/
+static void FailedStartReleasesEverything()
+{
+	LONG* counters[] = {&vireio_win32::ThreadFailures(), &vireio_win32::EventFailures()};
+	for (int i = 0; i < 2; i++)
+	{
+		// no receiver after the constructor, whatever the default port
+		*counters[i] = 1000;
+		SocketTracker tracker(STM_UDP_BINARY);
+		*counters[i] = 0;
+		VIREIO_CHECK(tracker.getStatus() == MTS_NOTINIT);
+		VIREIO_CHECK(!tracker.isSampling());
+
+		int port = ListenAfterFailure(&tracker, *counters[i]);
+		VIREIO_CHECK(port != 0);
+		VIREIO_CHECK(tracker.isSampling());
+
+		Sender sender(port);
+		TrackerPose pose;
+		sender.SendYaw(1, 0.3f);
+		VIREIO_CHECK(WaitForYaw(&tracker, 0.3f, &pose));
+	}
+}
+
+int main()
+{
+	VIREIO_RUN(ReceivesPoses);
+	VIREIO_RUN(DropsInvalidAndOutOfOrder);
+	VIREIO_RUN(FailedStartReleasesEverything);
+	return vireio_test::Result();
+}
@@ -0,0 +1,283 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <StateBlockApplyProgramTest.cpp> :
+Unit tests of the proxy state block apply program : operations compiled for full, vertex, pixel 
+and selected captures, same states in the same order as the former per item apply.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "StateBlockApplyProgram.h"
+#include <map>
+#include <set>
+#include <stdlib.h>
+
+/**
+* Random layouts compared to the per item apply.
+***/
+#define RANDOM_LAYOUTS 2000
+
+typedef std::vector<StateBlockApplyProgram::Operation> Program;
+
+/**
+* Selected states of the capture types, as set by the D3D9ProxyStateBlock constructor 
+* (the non-indexed apply steps are in order of CaptureableState).
+***/
+static const DWORD g_fullStates = (1 << APPLY_INDEX_BUFFER) | (1 << APPLY_VIEWPORT) | (1 << APPLY_VIEW_MATRICES) | 
+	(1 << APPLY_PROJECTION_MATRICES) | (1 << APPLY_PIXEL_SHADER) | (1 << APPLY_VERTEX_SHADER) | (1 << APPLY_VERTEX_DECLARATION);
+static const DWORD g_vertexStates = (1 << APPLY_VERTEX_SHADER) | (1 << APPLY_VERTEX_DECLARATION);
+static const DWORD g_pixelStates = (1 << APPLY_PIXEL_SHADER);
+
+static Program Compile(ApplyShaders shaders, DWORD selectedStates, DWORD vertexBufferMask, DWORD textureMask, bool reApplyStereo)
+{
+	Program program;
+	StateBlockApplyProgram::Compile(shaders, selectedStates, vertexBufferMask, textureMask, reApplyStereo, program);
+	return program;
+}
+
+static bool Equal(const Program& program, const StateBlockApplyProgram::Operation* pExpected, size_t count)
+{
+	if (program.size() != count)
+		return false;
+	for (size_t i = 0; i < count; i++)
+		if ((program[i].step != pExpected[i].step) || (program[i].index != pExpected[i].index))
+			return false;
+	return true;
+}
+
+static bool Equal(const Program& program, const Program& expected)
+{
+	return expected.empty() ? program.empty() : Equal(program, &expected[0], expected.size());
+}
+
+/**
+* Full capture : all non-indexed states, both shaders and all registers.
+***/
+static void CompilesFullCapture()
+{
+	const StateBlockApplyProgram::Operation expected[] = {
+		{APPLY_INDEX_BUFFER, 0}, {APPLY_VIEWPORT, 0}, {APPLY_VIEW_MATRICES, 0}, {APPLY_PROJECTION_MATRICES, 0},
+		{APPLY_PIXEL_SHADER, 0}, {APPLY_VERTEX_SHADER, 0}, {APPLY_VERTEX_DECLARATION, 0},
+		{APPLY_VERTEX_BUFFER, 0}, {APPLY_VERTEX_BUFFER, 3},
+		{APPLY_MANAGED_VERTEX_SHADER, 0}, {APPLY_MANAGED_PIXEL_SHADER, 0},
+		{APPLY_VERTEX_SHADER_REGISTERS, 0}, {APPLY_PIXEL_SHADER_REGISTERS, 0},
+		{APPLY_TEXTURE, 0}, {APPLY_TEXTURE, 16}, {APPLY_TEXTURE, 20}};
+	Program program = Compile(APPLY_SHADERS_ALL, g_fullStates, (1 << 0) | (1 << 3), (1 << 0) | (1 << 16) | (1 << 20), false);
+	VIREIO_CHECK(Equal(program, expected, sizeof(expected) / sizeof(expected[0])));
+
+	// mixed sides : non-indexed states flagged, textures set on the actual device again
+	program = Compile(APPLY_SHADERS_ALL, g_fullStates, 0, (1 << 2), true);
+	VIREIO_CHECK(program.size() == 7 + 4 + 1);
+	int flagged = 0;
+	for (size_t i = 0; i < 7 && i < program.size(); i++)
+		if (program[i].index == 1)
+			flagged++;
+	VIREIO_CHECK(flagged == 7);
+	VIREIO_CHECK((program.back().step == APPLY_TEXTURE_STEREO) && (program.back().index == 2));
+}
+
+/**
+* Vertex capture : vertex shader, declaration and registers only.
+***/
+static void CompilesVertexCapture()
+{
+	const StateBlockApplyProgram::Operation expected[] = {
+		{APPLY_VERTEX_SHADER, 0}, {APPLY_VERTEX_DECLARATION, 0}, {APPLY_VERTEX_BUFFER, 1},
+		{APPLY_MANAGED_VERTEX_SHADER, 0}, {APPLY_VERTEX_SHADER_REGISTERS, 0}};
+	Program program = Compile(APPLY_SHADERS_VERTEX, g_vertexStates, (1 << 1), 0, false);
+	VIREIO_CHECK(Equal(program, expected, sizeof(expected) / sizeof(expected[0])));
+}
+
+/**
+* Pixel capture : pixel shader and registers only.
+***/
+static void CompilesPixelCapture()
+{
+	const StateBlockApplyProgram::Operation expected[] = {
+		{APPLY_PIXEL_SHADER, 0}, {APPLY_MANAGED_PIXEL_SHADER, 0}, {APPLY_PIXEL_SHADER_REGISTERS, 0},
+		{APPLY_TEXTURE, 1}, {APPLY_TEXTURE, 15}};
+	Program program = Compile(APPLY_SHADERS_PIXEL, g_pixelStates, 0, (1 << 1) | (1 << 15), false);
+	VIREIO_CHECK(Equal(program, expected, sizeof(expected) / sizeof(expected[0])));
+}
+
+/**
+* Selected capture : only recorded states, managed shaders only if recorded, registers always 
+* (partial register sets).
+***/
+static void CompilesSelectedCapture()
+{
+	const StateBlockApplyProgram::Operation empty[] = {
+		{APPLY_VERTEX_SHADER_REGISTERS, 0}, {APPLY_PIXEL_SHADER_REGISTERS, 0}};
+	VIREIO_CHECK(Equal(Compile(APPLY_SHADERS_SELECTED, 0, 0, 0, false), empty, 2));
+
+	const StateBlockApplyProgram::Operation viewAndPixel[] = {
+		{APPLY_VIEW_MATRICES, 1}, {APPLY_PIXEL_SHADER, 1},
+		{APPLY_MANAGED_PIXEL_SHADER, 0}, {APPLY_VERTEX_SHADER_REGISTERS, 0}, {APPLY_PIXEL_SHADER_REGISTERS, 0},
+		{APPLY_TEXTURE_STEREO, 0}};
+	Program program = Compile(APPLY_SHADERS_SELECTED, (1 << APPLY_VIEW_MATRICES) | (1 << APPLY_PIXEL_SHADER), 0, 1, true);
+	VIREIO_CHECK(Equal(program, viewAndPixel, sizeof(viewAndPixel) / sizeof(viewAndPixel[0])));
+
+	const StateBlockApplyProgram::Operation vertexShader[] = {
+		{APPLY_VERTEX_SHADER, 0}, {APPLY_VERTEX_BUFFER, 15},
+		{APPLY_MANAGED_VERTEX_SHADER, 0}, {APPLY_VERTEX_SHADER_REGISTERS, 0}, {APPLY_PIXEL_SHADER_REGISTERS, 0}};
+	program = Compile(APPLY_SHADERS_SELECTED, (1 << APPLY_VERTEX_SHADER), (1 << 15), 0, false);
+	VIREIO_CHECK(Equal(program, vertexShader, sizeof(vertexShader) / sizeof(vertexShader[0])));
+}
+
+/**
+* Captured layout as the former apply kept it : a set of selected states, vertex buffers by 
+* stream and textures by sampler stage.
+***/
+struct ItemLayout
+{
+	std::set<int> selectedStates;
+	std::map<UINT, int> vertexBuffers;
+	std::map<DWORD, int> textureStages;
+};
+
+/**
+* Sampler slot of a stage, as D3D9ProxyStateBlock::TextureSlot().
+***/
+static UINT TextureSlot(DWORD stage)
+{
+	return (stage < 16) ? stage : (16 + stage - D3DDMAPSAMPLER);
+}
+
+static void Add(Program& program, ApplyStep step, UINT index)
+{
+	StateBlockApplyProgram::Operation operation = {step, index};
+	program.push_back(operation);
+}
+
+/**
+* The per item apply before the apply program, same steps as the former Apply() (one combined 
+* SetFromStateBlockData() call is the vertex and pixel register steps).
+***/
+static Program ItemApply(ApplyShaders shaders, const ItemLayout& layout, bool reApplyStereo)
+{
+	Program program;
+	for (std::set<int>::const_iterator it = layout.selectedStates.begin(); it != layout.selectedStates.end(); ++it)
+		Add(program, (ApplyStep)*it, reApplyStereo ? 1 : 0);
+
+	for (std::map<UINT, int>::const_iterator it = layout.vertexBuffers.begin(); it != layout.vertexBuffers.end(); ++it)
+		Add(program, APPLY_VERTEX_BUFFER, it->first);
+
+	switch (shaders)
+	{
+	case APPLY_SHADERS_SELECTED:
+		if (layout.selectedStates.count(APPLY_VERTEX_SHADER) == 1)
+			Add(program, APPLY_MANAGED_VERTEX_SHADER, 0);
+		if (layout.selectedStates.count(APPLY_PIXEL_SHADER) == 1)
+			Add(program, APPLY_MANAGED_PIXEL_SHADER, 0);
+		Add(program, APPLY_VERTEX_SHADER_REGISTERS, 0);
+		Add(program, APPLY_PIXEL_SHADER_REGISTERS, 0);
+		break;
+	case APPLY_SHADERS_ALL:
+		Add(program, APPLY_MANAGED_VERTEX_SHADER, 0);
+		Add(program, APPLY_MANAGED_PIXEL_SHADER, 0);
+		Add(program, APPLY_VERTEX_SHADER_REGISTERS, 0);
+		Add(program, APPLY_PIXEL_SHADER_REGISTERS, 0);
+		break;
+	case APPLY_SHADERS_VERTEX:
+		Add(program, APPLY_MANAGED_VERTEX_SHADER, 0);
+		Add(program, APPLY_VERTEX_SHADER_REGISTERS, 0);
+		break;
+	case APPLY_SHADERS_PIXEL:
+	default:
+		Add(program, APPLY_MANAGED_PIXEL_SHADER, 0);
+		Add(program, APPLY_PIXEL_SHADER_REGISTERS, 0);
+		break;
+	}
+
+	for (std::map<DWORD, int>::const_iterator it = layout.textureStages.begin(); it != layout.textureStages.end(); ++it)
+		Add(program, reApplyStereo ? APPLY_TEXTURE_STEREO : APPLY_TEXTURE, TextureSlot(it->first));
+	return program;
+}
+
+/**
+* Random layouts of all capture types apply the same states in the same order as before.
+***/
+static void MatchesItemApply()
+{
+	const ApplyShaders shaders[] = {APPLY_SHADERS_SELECTED, APPLY_SHADERS_ALL, APPLY_SHADERS_VERTEX, APPLY_SHADERS_PIXEL};
+	const DWORD states[] = {g_fullStates, g_fullStates, g_vertexStates, g_pixelStates};
+	srand(27);
+
+	int mismatches = 0;
+	for (int i = 0; i < RANDOM_LAYOUTS; i++)
+	{
+		int type = i % 4;
+		bool reApplyStereo = ((i / 4) % 2) == 1;
+		ItemLayout layout;
+		DWORD selectedStates = 0;
+		DWORD vertexBufferMask = 0;
+		DWORD textureMask = 0;
+
+		// selected captures record any of the states, the other types their fixed set
+		for (int state = APPLY_INDEX_BUFFER; state <= APPLY_VERTEX_DECLARATION; state++)
+		{
+			if ((states[type] & (1 << state)) && ((type != 0) || (rand() % 2)))
+			{
+				layout.selectedStates.insert(state);
+				selectedStates |= (1 << state);
+			}
+		}
+		for (UINT stream = 0; stream < STATEBLOCK_VERTEX_STREAMS; stream++)
+		{
+			if (rand() % 4 == 0)
+			{
+				layout.vertexBuffers[stream] = 1;
+				vertexBufferMask |= (1 << stream);
+			}
+		}
+		for (UINT slot = 0; slot < STATEBLOCK_TEXTURE_SLOTS; slot++)
+		{
+			if (rand() % 4 == 0)
+			{
+				DWORD stage = (slot < 16) ? slot : (D3DDMAPSAMPLER + slot - 16);
+				layout.textureStages[stage] = 1;
+				textureMask |= (1 << slot);
+			}
+		}
+
+		if (!Equal(Compile(shaders[type], selectedStates, vertexBufferMask, textureMask, reApplyStereo), ItemApply(shaders[type], layout, reApplyStereo)))
+			mismatches++;
+	}
+	VIREIO_CHECK(mismatches == 0);
+}
+
+/**
+* The program is rebuilt from scratch.
+***/
+static void ReplacesPreviousProgram()
+{
+	Program program = Compile(APPLY_SHADERS_ALL, g_fullStates, 0xffff, 0x1fffff, false);
+	VIREIO_CHECK(program.size() == 7 + STATEBLOCK_VERTEX_STREAMS + 4 + STATEBLOCK_TEXTURE_SLOTS);
+	StateBlockApplyProgram::Compile(APPLY_SHADERS_PIXEL, 0, 0, 0, false, program);
+	VIREIO_CHECK(program.size() == 2);
+}
+
+int main()
+{
+	VIREIO_RUN(CompilesFullCapture);
+	VIREIO_RUN(CompilesVertexCapture);
+	VIREIO_RUN(CompilesPixelCapture);
+	VIREIO_RUN(CompilesSelectedCapture);
+	VIREIO_RUN(MatchesItemApply);
+	VIREIO_RUN(ReplacesPreviousProgram);
+	return vireio_test::Result();
+}
@@ -0,0 +1,134 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <TelemetryTest.cpp> :
+Unit tests of the telemetry block : writer claim and concurrent writers.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "Telemetry.h"
+#include <thread>
+
+#define WRITER_A ((1LL << 32) | 1)
+#define WRITER_B ((2LL << 32) | 1)
+
+static TelemetryData Values(DWORD processId, DWORD frame, DWORD tickCount)
+{
+	TelemetryData values;
+	ZeroMemory(&values, sizeof(values));
+	values.processId = processId;
+	values.tickCount = tickCount;
+	values.frameCount = frame;
+	values.drawCalls = frame;
+	values.eyeSwitches = frame;
+	return values;
+}
+
+static void ClaimIsExclusive()
+{
+	TelemetryData shared;
+	ZeroMemory(&shared, sizeof(shared));
+
+	VIREIO_CHECK(TelemetryClaim(&shared, WRITER_A));
+	VIREIO_CHECK(TelemetryWrite(&shared, Values(1, 1, GetTickCount())));
+	VIREIO_CHECK(!TelemetryClaim(&shared, WRITER_B));
+	VIREIO_CHECK(TelemetryClaim(&shared, WRITER_A));
+
+	TelemetryData read;
+	VIREIO_CHECK(TelemetryRead(&shared, &read));
+	VIREIO_CHECK(read.processId == 1);
+	VIREIO_CHECK(read.writerId == WRITER_A);
+
+	TelemetryRelease(&shared, WRITER_B);
+	VIREIO_CHECK(!TelemetryClaim(&shared, WRITER_B));
+	TelemetryRelease(&shared, WRITER_A);
+	VIREIO_CHECK(TelemetryClaim(&shared, WRITER_B));
+	VIREIO_CHECK(!TelemetryClaim(&shared, WRITER_A));
+}
+
+static void StaleClaimIsTakenOver()
+{
+	TelemetryData shared;
+	ZeroMemory(&shared, sizeof(shared));
+
+	VIREIO_CHECK(TelemetryClaim(&shared, WRITER_A));
+	VIREIO_CHECK(TelemetryWrite(&shared, Values(1, 1, GetTickCount())));
+	VIREIO_CHECK(!TelemetryClaim(&shared, WRITER_B));
+
+	// writer A gone in the middle of a write, long ago
+	shared.sequence++;
+	shared.claimTick = GetTickCount() - TELEMETRY_CLAIM_TIMEOUT_MS - 1000;
+	VIREIO_CHECK(TelemetryClaim(&shared, WRITER_B));
+	VIREIO_CHECK((shared.sequence & 1) == 0);
+	VIREIO_CHECK(TelemetryWrite(&shared, Values(2, 1, GetTickCount())));
+
+	TelemetryData read;
+	VIREIO_CHECK(TelemetryRead(&shared, &read));
+	VIREIO_CHECK(read.processId == 2);
+}
+
+static void ConcurrentWritersStayConsistent()
+{
+	TelemetryData shared;
+	ZeroMemory(&shared, sizeof(shared));
+	volatile bool done = false;
+	volatile LONG inconsistent = 0;
+	volatile LONG published[2] = {0, 0};
+
+	std::thread writers[2];
+	for (int w = 0; w < 2; w++)
+	{
+		writers[w] = std::thread([&, w]()
+		{
+			LONGLONG writerId = (w == 0) ? WRITER_A : WRITER_B;
+			for (DWORD frame = 1; frame <= 200000; frame++)
+			{
+				if (TelemetryClaim(&shared, writerId) && TelemetryWrite(&shared, Values(w + 1, frame, GetTickCount())))
+					InterlockedIncrement(&published[w]);
+			}
+		});
+	}
+
+	std::thread reader([&]()
+	{
+		while (!done)
+		{
+			TelemetryData read;
+			if (TelemetryRead(&shared, &read) &&
+				((read.drawCalls != read.frameCount) || (read.eyeSwitches != read.frameCount)))
+				InterlockedIncrement(&inconsistent);
+		}
+	});
+
+	writers[0].join();
+	writers[1].join();
+	done = true;
+	reader.join();
+
+	VIREIO_CHECK(inconsistent == 0);
+	VIREIO_CHECK((shared.sequence & 1) == 0);
+	// the first claim holds for the whole run
+	VIREIO_CHECK((published[0] == 0) != (published[1] == 0));
+}
+
+int main()
+{
+	VIREIO_RUN(ClaimIsExclusive);
+	VIREIO_RUN(StaleClaimIsTakenOver);
+	VIREIO_RUN(ConcurrentWritersStayConsistent);
+	return vireio_test::Result();
+}
@@ -0,0 +1,228 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <TrackerSamplerTest.cpp> :
+Unit tests of the tracker sampler pose history : ring wraparound, poses at times between and outside
+the samples, yaw interpolation across +-PI, readers racing the sampling thread.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "MotionTracker.h"
+#include <atomic>
+#include <thread>
+
+/**
+* Performance counter ticks between the test poses.
+***/
+#define POSE_TICKS 100
+/**
+* Poses pushed by the racing writer.
+***/
+#define RACE_POSES 200000
+
+/**
+* Pose n of the test history : time (n + 1) * POSE_TICKS, position (n, -n, 2n).
+* Interpolated poses keep y == -x and z == 2x exactly, torn copies don't.
+***/
+static TrackerPose Pose(ULONG n)
+{
+	TrackerPose pose;
+	ZeroMemory(&pose, sizeof(pose));
+	pose.time = (LONGLONG)(n + 1) * POSE_TICKS;
+	pose.x = (float)n;
+	pose.y = -(float)n;
+	pose.z = 2.0f * (float)n;
+	return pose;
+}
+
+static bool IsConsistent(const TrackerPose& pose)
+{
+	return (pose.y == -pose.x) && (pose.z == 2.0f * pose.x);
+}
+
+static void EmptyHistory()
+{
+	TrackerSampler sampler(NULL);
+	TrackerPose pose;
+	VIREIO_CHECK(!sampler.GetLatest(&pose));
+	VIREIO_CHECK(!sampler.GetAt(0, &pose));
+}
+
+/**
+* Poses between two samples are interpolated, times after the latest pose return the latest,
+* times before the history return the oldest pose.
+***/
+static void PosesBetweenAndOutsideSamples()
+{
+	TrackerSampler sampler(NULL);
+	for (ULONG n = 0; n < 10; n++)
+		sampler.Push(Pose(n));
+
+	TrackerPose pose;
+	VIREIO_CHECK(sampler.GetLatest(&pose));
+	VIREIO_CHECK(pose.x == 9.0f);
+
+	VIREIO_CHECK(sampler.GetAt(Pose(5).time + POSE_TICKS / 4, &pose));
+	VIREIO_CHECK(fabs(pose.x - 5.25f) < 1e-5f);
+	VIREIO_CHECK(pose.time == Pose(5).time + POSE_TICKS / 4);
+	VIREIO_CHECK(IsConsistent(pose));
+
+	VIREIO_CHECK(sampler.GetAt(Pose(3).time, &pose));
+	VIREIO_CHECK(pose.x == 3.0f);
+
+	VIREIO_CHECK(sampler.GetAt(Pose(9).time + 1000 * POSE_TICKS, &pose));
+	VIREIO_CHECK(pose.x == 9.0f);
+	VIREIO_CHECK(pose.time == Pose(9).time);
+
+	VIREIO_CHECK(sampler.GetAt(0, &pose));
+	VIREIO_CHECK(pose.x == 0.0f);
+	VIREIO_CHECK(pose.time == Pose(0).time);
+}
+
+/**
+* After the ring wrapped the latest pose is still found, the history holds the last
+* TRACKERSAMPLER_RING_SIZE - 1 poses (the slot written next is kept out).
+***/
+static void RingWraparound()
+{
+	const ULONG count = 3 * TRACKERSAMPLER_RING_SIZE + 5;
+	TrackerSampler sampler(NULL);
+	for (ULONG n = 0; n < count; n++)
+		sampler.Push(Pose(n));
+
+	TrackerPose pose;
+	VIREIO_CHECK(sampler.GetLatest(&pose));
+	VIREIO_CHECK(pose.x == (float)(count - 1));
+
+	// interpolated across the ring start
+	ULONG first = count - (count & (TRACKERSAMPLER_RING_SIZE - 1)) - 1;
+	VIREIO_CHECK(sampler.GetAt(Pose(first).time + POSE_TICKS / 2, &pose));
+	VIREIO_CHECK(fabs(pose.x - ((float)first + 0.5f)) < 1e-4f);
+	VIREIO_CHECK(IsConsistent(pose));
+
+	ULONG oldest = count - (TRACKERSAMPLER_RING_SIZE - 1);
+	VIREIO_CHECK(sampler.GetAt(Pose(oldest).time, &pose));
+	VIREIO_CHECK(pose.x == (float)oldest);
+	VIREIO_CHECK(sampler.GetAt(Pose(oldest - 1).time, &pose));
+	VIREIO_CHECK(pose.x == (float)oldest);
+	VIREIO_CHECK(sampler.GetAt(0, &pose));
+	VIREIO_CHECK(pose.x == (float)oldest);
+}
+
+/**
+* Yaw is interpolated along the shortest angle, across +-PI in both directions.
+***/
+static void YawAcrossPi()
+{
+	TrackerPose older = Pose(0);
+	TrackerPose newer = Pose(1);
+	older.yaw = (float)PI - 0.1f;
+	newer.yaw = -(float)PI + 0.1f;
+
+	TrackerPose pose;
+	TrackerSampler::Interpolate(older, newer, older.time + POSE_TICKS / 4, &pose);
+	VIREIO_CHECK(fabs(pose.yaw - ((float)PI - 0.05f)) < 1e-4f);
+	TrackerSampler::Interpolate(older, newer, older.time + POSE_TICKS / 2, &pose);
+	VIREIO_CHECK(fabs(fabs(pose.yaw) - (float)PI) < 1e-4f);
+	TrackerSampler::Interpolate(older, newer, older.time + 3 * POSE_TICKS / 4, &pose);
+	VIREIO_CHECK(fabs(pose.yaw - (-(float)PI + 0.05f)) < 1e-4f);
+
+	// other direction, pitch and roll the same way
+	older.yaw = -(float)PI + 0.1f;
+	newer.yaw = (float)PI - 0.1f;
+	older.pitch = older.roll = older.yaw;
+	newer.pitch = newer.roll = newer.yaw;
+	TrackerSampler::Interpolate(older, newer, older.time + POSE_TICKS / 4, &pose);
+	VIREIO_CHECK(fabs(pose.yaw - (-(float)PI + 0.05f)) < 1e-4f);
+	VIREIO_CHECK(pose.pitch == pose.yaw);
+	VIREIO_CHECK(pose.roll == pose.yaw);
+
+	// no wrap within +-PI, clamped outside the two poses
+	older.yaw = -0.5f;
+	newer.yaw = 0.5f;
+	TrackerSampler::Interpolate(older, newer, older.time + POSE_TICKS / 2, &pose);
+	VIREIO_CHECK(fabs(pose.yaw) < 1e-5f);
+	TrackerSampler::Interpolate(older, newer, newer.time + POSE_TICKS, &pose);
+	VIREIO_CHECK(pose.yaw == 0.5f);
+	TrackerSampler::Interpolate(older, newer, older.time - POSE_TICKS, &pose);
+	VIREIO_CHECK(pose.yaw == -0.5f);
+}
+
+/**
+* A reader racing the sampling thread never gets a torn pose, latest poses never go back in time.
+***/
+static void ReaderRacesWriter()
+{
+	TrackerSampler sampler(NULL);
+	std::atomic<bool> done(false);
+	std::thread writer([&]() {
+		for (ULONG n = 0; n < RACE_POSES; n++)
+		{
+			sampler.Push(Pose(n));
+			if ((n & 1023) == 0)
+				std::this_thread::yield();
+		}
+		done = true;
+	});
+
+	int torn = 0;
+	int backwards = 0;
+	int reads = 0;
+	float lastX = -1.0f;
+	while (!done || (reads == 0))
+	{
+		TrackerPose latest;
+		if (!sampler.GetLatest(&latest))
+			continue;
+		reads++;
+		if (!IsConsistent(latest) || (latest.time != (LONGLONG)(latest.x + 1.0f) * POSE_TICKS))
+			torn++;
+		if (latest.x < lastX)
+			backwards++;
+		lastX = latest.x;
+
+		// between two poses, or the oldest one if the writer got far ahead
+		TrackerPose pose;
+		LONGLONG time = latest.time - 10 * POSE_TICKS - POSE_TICKS / 2;
+		if (sampler.GetAt(time, &pose))
+		{
+			if (!IsConsistent(pose))
+				torn++;
+			if (pose.x < (float)(time / POSE_TICKS) - 1.5f - 0.1f)
+				backwards++;
+		}
+	}
+	writer.join();
+
+	VIREIO_CHECK(reads > 0);
+	VIREIO_CHECK(torn == 0);
+	VIREIO_CHECK(backwards == 0);
+
+	TrackerPose pose;
+	VIREIO_CHECK(sampler.GetLatest(&pose));
+	VIREIO_CHECK(pose.x == (float)(RACE_POSES - 1));
+}
+
+int main()
+{
+	VIREIO_RUN(EmptyHistory);
+	VIREIO_RUN(PosesBetweenAndOutsideSamples);
+	VIREIO_RUN(RingWraparound);
+	VIREIO_RUN(YawAcrossPi);
+	VIREIO_RUN(ReaderRacesWriter);
+	return vireio_test::Result();
+}
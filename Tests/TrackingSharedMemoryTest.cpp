@@ -0,0 +1,177 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <TrackingSharedMemoryTest.cpp> :
+Unit tests of the shared memory tracking protocol : seqlock stress test and v1 fallback.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "TrackingSharedMemory.h"
+#include <atomic>
+#include <thread>
+
+/**
+* Samples written by the stress writer (exact as float).
+***/
+#define STRESS_SAMPLES 2000000
+
+/**
+* Sample with all fields derived from its number, a torn copy mixes numbers.
+***/
+static TrackSample Sample(int number)
+{
+	TrackSample sample;
+	sample.timestamp = number;
+	sample.yaw = (float)number;
+	sample.pitch = (float)number + 0.5f;
+	sample.roll = (float)number + 0.25f;
+	sample.x = -(float)number;
+	sample.y = -(float)number - 0.5f;
+	sample.z = -(float)number - 0.25f;
+	return sample;
+}
+
+static bool IsSample(const TrackSample& sample, int number)
+{
+	TrackSample expected = Sample(number);
+	return (sample.timestamp == expected.timestamp) && (sample.yaw == expected.yaw) && (sample.pitch == expected.pitch) &&
+		(sample.roll == expected.roll) && (sample.x == expected.x) && (sample.y == expected.y) && (sample.z == expected.z);
+}
+
+/**
+* A copy is consistent if the legacy fields, the latest sample and the ring all belong to the 
+* same write.
+***/
+static bool IsConsistent(const TrackDataV2& copy)
+{
+	int latest = copy.sampleCount - 1;
+	if (latest < 0)
+		return copy.legacy.DataID == 0;
+	if (copy.legacy.DataID != copy.sampleCount)
+		return false;
+	if ((copy.legacy.Yaw != (float)latest) || (copy.legacy.Z != -(float)latest - 0.25f))
+		return false;
+
+	for (int age = 0; (age < TRACKDATA_V2_SAMPLES) && (age <= latest); age++)
+	{
+		int number = latest - age;
+		if (!IsSample(copy.samples[number % TRACKDATA_V2_SAMPLES], number))
+			return false;
+	}
+	return true;
+}
+
+static void NoTornReads()
+{
+	static TrackDataV2 shared;
+	ZeroMemory(&shared, sizeof(shared));
+
+	std::atomic<bool> done(false);
+	std::thread writer([&]()
+	{
+		for (int number = 0; number < STRESS_SAMPLES; number++)
+			TrackDataWriteV2(&shared, Sample(number));
+		done = true;
+	});
+
+	int reads = 0, torn = 0, backwards = 0;
+	LONG lastCount = 0;
+	while (!done)
+	{
+		TrackDataV2 copy;
+		if (!TrackDataReadV2(&shared, &copy))
+			continue;
+		reads++;
+		if (!IsConsistent(copy))
+			torn++;
+		if (copy.sampleCount < lastCount)
+			backwards++;
+		lastCount = copy.sampleCount;
+	}
+	writer.join();
+
+	printf("  %d consistent reads during %d writes\n", reads - torn, STRESS_SAMPLES);
+	VIREIO_CHECK(reads > 0);
+	VIREIO_CHECK(torn == 0);
+	VIREIO_CHECK(backwards == 0);
+
+	TrackDataV2 copy;
+	TrackSample latest;
+	VIREIO_CHECK(TrackDataReadV2(&shared, &copy));
+	VIREIO_CHECK(IsConsistent(copy));
+	VIREIO_CHECK(TrackDataLatestSample(copy, &latest));
+	VIREIO_CHECK(IsSample(latest, STRESS_SAMPLES - 1));
+}
+
+static void V1BlockIsRejected()
+{
+	TrackDataV2 shared;
+	ZeroMemory(&shared, sizeof(shared));
+	shared.legacy.Yaw = 1.0f;
+	shared.legacy.DataID = 1;
+
+	TrackDataV2 copy;
+	TrackSample latest;
+	VIREIO_CHECK(!TrackDataReadV2(&shared, &copy));
+
+	TrackDataWriteV2(&shared, Sample(0));
+	VIREIO_CHECK(TrackDataReadV2(&shared, &copy));
+	VIREIO_CHECK(TrackDataLatestSample(copy, &latest));
+	VIREIO_CHECK(IsSample(latest, 0));
+	VIREIO_CHECK(copy.legacy.DataID == 2);
+}
+
+static void WriterFallsBackToV1Mapping()
+{
+	// a v1 reader created the mapping first, with the v1 size
+	HANDLE hReader = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(TrackData), TEXT(TRACKDATA_SHARED_MEMORY_NAME));
+	VIREIO_CHECK(hReader != NULL);
+	TrackData* pReader = (TrackData*)MapViewOfFile(hReader, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TrackData));
+	VIREIO_CHECK(pReader != NULL);
+
+	TrackDataWriter writer;
+	VIREIO_CHECK(TrackDataOpenWriter(&writer));
+	VIREIO_CHECK(writer.pV2 == NULL);
+	VIREIO_CHECK(writer.pLegacy != NULL);
+
+	TrackDataWrite(&writer, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f);
+	VIREIO_CHECK(pReader->DataID == 1);
+	VIREIO_CHECK((pReader->Yaw == 1.0f) && (pReader->Roll == 3.0f) && (pReader->Z == 6.0f));
+
+	TrackDataCloseWriter(&writer);
+	CloseHandle(hReader);
+
+	// v2 layout once the mapping is created by the writer
+	VIREIO_CHECK(TrackDataOpenWriter(&writer));
+	VIREIO_CHECK(writer.pV2 != NULL);
+	TrackDataWrite(&writer, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f);
+
+	TrackDataV2 copy;
+	TrackSample latest;
+	VIREIO_CHECK(TrackDataReadV2(writer.pV2, &copy));
+	VIREIO_CHECK(TrackDataLatestSample(copy, &latest));
+	VIREIO_CHECK((latest.yaw == 1.0f) && (latest.z == 6.0f) && (copy.legacy.Pitch == 2.0f));
+	TrackDataCloseWriter(&writer);
+}
+
+int main()
+{
+	VIREIO_RUN(NoTornReads);
+	VIREIO_RUN(V1BlockIsRejected);
+	VIREIO_RUN(WriterFallsBackToV1Mapping);
+	return vireio_test::Result();
+}
@@ -0,0 +1,217 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <ViewAdjustmentTest.cpp> :
+Unit tests of the view adjustment : snapshot consistency while a tracking worker computes the view
+transforms and menus change their values.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#include "VireioTest.h"
+#include "ViewAdjustment.h"
+#include <math.h>
+#include <atomic>
+#include <thread>
+
+/**
+* View transforms computed by the stress worker.
+***/
+#define STRESS_UPDATES 100000
+/**
+* Roll step of the stress worker, radians.
+***/
+#define STRESS_ROLL_STEP 0.0001f
+
+/**
+* The game configuration is loaded by ProxyHelper (not built here), the tests set the members the
+* view adjustment reads.
+***/
+ProxyConfig::ProxyConfig()
+{
+}
+
+namespace vireio
+{
+	void clamp(float* pfToClamp, float min, float max)
+	{
+		*pfToClamp > max ? *pfToClamp = max : (*pfToClamp < min ? *pfToClamp = min : *pfToClamp = *pfToClamp);
+	}
+}
+
+/**
+* Rift DK1 like display.
+***/
+class FakeDisplayInfo : public HMDisplayInfo
+{
+public:
+	virtual std::string GetHMDName() {return "FakeDisplay";}
+	virtual std::pair<UINT, UINT> GetResolution() {return std::make_pair(1280u, 800u);}
+	virtual std::pair<float, float> GetPhysicalScreenSize() {return std::make_pair(0.14976f, 0.0936f);}
+	virtual float GetEyeToScreenDistance() {return 0.041f;}
+	virtual float GetPhysicalLensSeparation() {return 0.064f;}
+	virtual float GetLensYCenterOffset() {return 0.5f;}
+	virtual float GetLensIPDCenterOffset() {return 0.0f;}
+	virtual float GetMinDistortionScale() {return -1.0f;}
+};
+
+/**
+* HMD configuration, matrix roll.
+***/
+static void InitConfig(ProxyConfig* pConfig)
+{
+	pConfig->stereo_mode = 100;
+	pConfig->PFOVToggle = false;
+	pConfig->convergenceEnabled = true;
+	pConfig->rollImpl = 1;
+	pConfig->worldScaleFactor = 2.0f;
+	pConfig->convergence = 50.0f;
+	pConfig->ipd = IPD_DEFAULT;
+}
+
+static bool Near(float a, float b)
+{
+	return fabs(a - b) <= 0.00001f * (1.0f + fabs(b));
+}
+
+/**
+* A snapshot is consistent if orientation, roll and eye transforms belong to the same computation :
+* same roll everywhere, symmetric separation of a clamped world scale.
+***/
+static bool IsConsistent(ViewAdjustment* pViewAdjustment)
+{
+	float roll = pViewAdjustment->Roll();
+	if (pViewAdjustment->Orientation().z != roll)
+		return false;
+
+	D3DXMATRIX expectedRoll;
+	D3DXMatrixRotationZ(&expectedRoll, roll);
+	D3DXMATRIX rollMatrix = pViewAdjustment->RollMatrix();
+	if ((rollMatrix._11 != expectedRoll._11) || (rollMatrix._12 != expectedRoll._12))
+		return false;
+
+	// matrix roll : roll times separation
+	D3DXMATRIX left = pViewAdjustment->LeftViewTransform();
+	D3DXMATRIX right = pViewAdjustment->RightViewTransform();
+	if ((left._11 != rollMatrix._11) || (right._12 != rollMatrix._12))
+		return false;
+
+	float separation = right._41;
+	if ((left._41 != -separation) || (separation <= 0.0f))
+		return false;
+	float worldScale = separation / (IPD_DEFAULT / 2.0f);
+	return Near(worldScale, 0.000001f) || Near(worldScale, 2.000001f);
+}
+
+/**
+* Tracking worker computing the view transforms, the render thread acquiring them, a menu thread
+* changing the world scale through the lower clamp limit meanwhile.
+***/
+static void SnapshotsStayConsistent()
+{
+	ProxyConfig config;
+	InitConfig(&config);
+	FakeDisplayInfo displayInfo;
+	ViewAdjustment viewAdjustment(&displayInfo, &config);
+	viewAdjustment.Load(config);
+	viewAdjustment.ChangeWorldScale(0.000001f);
+
+	std::atomic<bool> done(false);
+	std::thread worker([&]()
+	{
+		for (int i = 1; i <= STRESS_UPDATES; i++)
+		{
+			float roll = i * STRESS_ROLL_STEP;
+			viewAdjustment.UpdateOrientation(0.0f, 0.0f, roll);
+			viewAdjustment.UpdateRoll(roll);
+			viewAdjustment.ComputeViewTransforms();
+		}
+		done = true;
+	});
+	std::thread menu([&]()
+	{
+		// 2.000001 -> 0.000001 (-7.999999 unclamped) -> 2.000001
+		while (!done)
+		{
+			viewAdjustment.ChangeWorldScale(-10.0f);
+			viewAdjustment.ChangeWorldScale(2.0f);
+		}
+	});
+
+	int acquired = 0;
+	int inconsistent = 0;
+	int backwards = 0;
+	float lastRoll = 0.0f;
+	while (!done)
+	{
+		if (!viewAdjustment.AcquireViewTransforms())
+			continue;
+
+		acquired++;
+		if (!IsConsistent(&viewAdjustment))
+			inconsistent++;
+		if (viewAdjustment.Roll() < lastRoll)
+			backwards++;
+		lastRoll = viewAdjustment.Roll();
+	}
+	worker.join();
+	menu.join();
+
+	viewAdjustment.AcquireViewTransforms();
+	VIREIO_CHECK(acquired > 0);
+	VIREIO_CHECK(inconsistent == 0);
+	VIREIO_CHECK(backwards == 0);
+	VIREIO_CHECK(viewAdjustment.Roll() == STRESS_UPDATES * STRESS_ROLL_STEP);
+	VIREIO_CHECK(IsConsistent(&viewAdjustment));
+}
+
+/**
+* Concurrent convergence and world scale changes, no change gets lost.
+***/
+static void ChangesAreAtomic()
+{
+	ProxyConfig config;
+	InitConfig(&config);
+	FakeDisplayInfo displayInfo;
+	ViewAdjustment viewAdjustment(&displayInfo, &config);
+	viewAdjustment.Load(config);
+
+	auto change = [&](float sign)
+	{
+		for (int i = 0; i < STRESS_UPDATES; i++)
+		{
+			viewAdjustment.ChangeConvergence(sign);
+			viewAdjustment.ChangeWorldScale(sign * 0.5f);
+			viewAdjustment.ChangeConvergence(-sign);
+			viewAdjustment.ChangeWorldScale(-sign * 0.5f);
+		}
+	};
+	std::thread up(change, 1.0f);
+	std::thread down(change, -1.0f);
+	up.join();
+	down.join();
+
+	VIREIO_CHECK(viewAdjustment.Convergence() == 50.0f);
+	VIREIO_CHECK(config.worldScaleFactor == 2.0f);
+	VIREIO_CHECK(viewAdjustment.SetConvergence(200.0f) == 200.0f);
+	VIREIO_CHECK(viewAdjustment.ChangeConvergence(0.0f) == 100.0f);
+}
+
+int main()
+{
+	VIREIO_RUN(SnapshotsStayConsistent);
+	VIREIO_RUN(ChangesAreAtomic);
+	return vireio_test::Result();
+}
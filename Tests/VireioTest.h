@@ -0,0 +1,67 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <VireioTest.h> :
+Minimal check macros for the unit tests (Tests/CMakeLists.txt).
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef VIREIOTEST_H_INCLUDED
+#define VIREIOTEST_H_INCLUDED
+
+#include <stdio.h>
+
+/**
+* Checks a condition, failures are reported and counted (the test goes on).
+***/
+#define VIREIO_CHECK(cond) vireio_test::Check((cond) ? true : false, #cond, __FILE__, __LINE__)
+
+/**
+* Runs a test function.
+***/
+#define VIREIO_RUN(test) vireio_test::Run(test, #test)
+
+namespace vireio_test
+{
+	/**
+	* Number of failed checks.
+	***/
+	inline int& Failures() { static int failures = 0; return failures; }
+
+	inline bool Check(bool ok, const char* expression, const char* file, int line)
+	{
+		if (!ok)
+		{
+			fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+			Failures()++;
+		}
+		return ok;
+	}
+
+	inline void Run(void (*test)(), const char* name)
+	{
+		int failures = Failures();
+		test();
+		printf("%s %s\n", (Failures() == failures) ? "[ OK ]" : "[FAIL]", name);
+	}
+
+	/**
+	* Exit code of the test executable.
+	***/
+	inline int Result() { return (Failures() == 0) ? 0 : 1; }
+}
+
+#endif
@@ -0,0 +1,244 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <d3d9.h> :
+Direct3D 9 declarations used by the unit tested classes (Tests/CMakeLists.txt), 
+interfaces only have the methods these classes call (tests implement them as mocks, device 
+methods a test doesn't mock fail with E_NOTIMPL).
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef VIREIO_TEST_D3D9_H_INCLUDED
+#define VIREIO_TEST_D3D9_H_INCLUDED
+
+#include <windows.h>
+
+#define D3D_OK S_OK
+
+#define D3DISSUE_END (1 << 0)
+#define D3DISSUE_BEGIN (1 << 1)
+#define D3DGETDATA_FLUSH (1 << 0)
+
+#define D3DUSAGE_RENDERTARGET 0x00000001L
+
+#define D3DDMAPSAMPLER 256
+#define D3DVERTEXTEXTURESAMPLER0 (D3DDMAPSAMPLER + 1)
+#define D3DVERTEXTEXTURESAMPLER3 (D3DDMAPSAMPLER + 4)
+
+#define D3DFVF_XYZRHW 0x004
+#define D3DFVF_TEX1 0x100
+#define D3DFVF_TEX4 0x400
+
+struct D3DMATRIX
+{
+	union
+	{
+		struct
+		{
+			float _11, _12, _13, _14;
+			float _21, _22, _23, _24;
+			float _31, _32, _33, _34;
+			float _41, _42, _43, _44;
+		};
+		float m[4][4];
+	};
+};
+
+enum D3DQUERYTYPE
+{
+	D3DQUERYTYPE_EVENT = 8,
+	D3DQUERYTYPE_TIMESTAMP = 10,
+	D3DQUERYTYPE_TIMESTAMPDISJOINT = 11,
+	D3DQUERYTYPE_TIMESTAMPFREQ = 12
+};
+
+enum D3DRENDERSTATETYPE
+{
+	D3DRS_ZENABLE = 7,
+	D3DRS_ZWRITEENABLE = 14,
+	D3DRS_ALPHATESTENABLE = 15,
+	D3DRS_CULLMODE = 22,
+	D3DRS_ALPHABLENDENABLE = 27,
+	D3DRS_STENCILENABLE = 52,
+	D3DRS_LIGHTING = 137,
+	D3DRS_SRGBWRITEENABLE = 194
+};
+
+enum D3DTEXTURESTAGESTATETYPE
+{
+	D3DTSS_COLOROP = 1,
+	D3DTSS_COLORARG1 = 2,
+	D3DTSS_ALPHAOP = 4,
+	D3DTSS_ALPHAARG1 = 5,
+	D3DTSS_CONSTANT = 32
+};
+
+enum D3DSAMPLERSTATETYPE
+{
+	D3DSAMP_ADDRESSU = 1,
+	D3DSAMP_ADDRESSV = 2,
+	D3DSAMP_ADDRESSW = 3,
+	D3DSAMP_MAGFILTER = 5,
+	D3DSAMP_MINFILTER = 6,
+	D3DSAMP_MIPFILTER = 7,
+	D3DSAMP_SRGBTEXTURE = 11
+};
+
+enum D3DTRANSFORMSTATETYPE
+{
+	D3DTS_VIEW = 2,
+	D3DTS_PROJECTION = 3,
+	D3DTS_WORLD = 256
+};
+
+#define D3DCULL_NONE 1
+#define D3DZB_TRUE 1
+#define D3DTOP_SELECTARG1 2
+#define D3DTA_TEXTURE 0x00000002
+#define D3DTA_CONSTANT 0x00000006
+#define D3DTADDRESS_CLAMP 3
+
+enum D3DFORMAT
+{
+	D3DFMT_UNKNOWN = 0,
+	D3DFMT_A8R8G8B8 = 21,
+	D3DFMT_X8R8G8B8 = 22
+};
+
+enum D3DPOOL
+{
+	D3DPOOL_DEFAULT = 0,
+	D3DPOOL_MANAGED = 1,
+	D3DPOOL_SYSTEMMEM = 2
+};
+
+enum D3DRESOURCETYPE
+{
+	D3DRTYPE_SURFACE = 1,
+	D3DRTYPE_TEXTURE = 3
+};
+
+enum D3DMULTISAMPLE_TYPE
+{
+	D3DMULTISAMPLE_NONE = 0
+};
+
+enum D3DTEXTUREFILTERTYPE
+{
+	D3DTEXF_NONE = 0,
+	D3DTEXF_POINT = 1,
+	D3DTEXF_LINEAR = 2,
+	D3DTEXF_ANISOTROPIC = 3
+};
+
+struct D3DSURFACE_DESC
+{
+	D3DFORMAT Format;
+	D3DRESOURCETYPE Type;
+	DWORD Usage;
+	D3DPOOL Pool;
+	D3DMULTISAMPLE_TYPE MultiSampleType;
+	DWORD MultiSampleQuality;
+	UINT Width;
+	UINT Height;
+};
+
+struct IDirect3DSurface9
+{
+	virtual ~IDirect3DSurface9() {}
+	virtual ULONG WINAPI AddRef() = 0;
+	virtual ULONG WINAPI Release() = 0;
+};
+
+struct IDirect3DBaseTexture9
+{
+	virtual ~IDirect3DBaseTexture9() {}
+	virtual ULONG WINAPI AddRef() = 0;
+	virtual ULONG WINAPI Release() = 0;
+};
+
+struct IDirect3DTexture9 : public IDirect3DBaseTexture9
+{
+	virtual HRESULT WINAPI GetSurfaceLevel(UINT Level, IDirect3DSurface9** ppSurfaceLevel) = 0;
+};
+
+struct IDirect3DQuery9
+{
+	virtual ~IDirect3DQuery9() {}
+	virtual ULONG WINAPI AddRef() = 0;
+	virtual ULONG WINAPI Release() = 0;
+	virtual HRESULT WINAPI Issue(DWORD dwIssueFlags) = 0;
+	virtual HRESULT WINAPI GetData(void* pData, DWORD dwSize, DWORD dwGetDataFlags) = 0;
+};
+
+struct IDirect3DStateBlock9
+{
+	virtual ~IDirect3DStateBlock9() {}
+	virtual ULONG WINAPI AddRef() = 0;
+	virtual ULONG WINAPI Release() = 0;
+	virtual HRESULT WINAPI Capture() = 0;
+	virtual HRESULT WINAPI Apply() = 0;
+};
+
+struct IDirect3DVertexShader9
+{
+	virtual ~IDirect3DVertexShader9() {}
+	virtual ULONG WINAPI AddRef() = 0;
+	virtual ULONG WINAPI Release() = 0;
+};
+
+struct IDirect3DPixelShader9
+{
+	virtual ~IDirect3DPixelShader9() {}
+	virtual ULONG WINAPI AddRef() = 0;
+	virtual ULONG WINAPI Release() = 0;
+};
+
+struct IDirect3DVertexDeclaration9
+{
+	virtual ~IDirect3DVertexDeclaration9() {}
+	virtual ULONG WINAPI AddRef() = 0;
+	virtual ULONG WINAPI Release() = 0;
+};
+
+struct IDirect3DDevice9
+{
+	virtual ~IDirect3DDevice9() {}
+	virtual HRESULT WINAPI CreateQuery(D3DQUERYTYPE Type, IDirect3DQuery9** ppQuery) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI CreateTexture(UINT Width, UINT Height, UINT Levels, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IDirect3DTexture9** ppTexture, HANDLE* pSharedHandle) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI BeginStateBlock() { return E_NOTIMPL; }
+	virtual HRESULT WINAPI EndStateBlock(IDirect3DStateBlock9** ppSB) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI SetTransform(D3DTRANSFORMSTATETYPE State, const D3DMATRIX* pMatrix) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI SetRenderState(D3DRENDERSTATETYPE State, DWORD Value) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI GetRenderState(D3DRENDERSTATETYPE State, DWORD* pValue) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI GetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD* pValue) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI GetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD* pValue) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI SetTexture(DWORD Stage, IDirect3DBaseTexture9* pTexture) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI GetTexture(DWORD Stage, IDirect3DBaseTexture9** ppTexture) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI SetVertexShader(IDirect3DVertexShader9* pShader) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI GetVertexShader(IDirect3DVertexShader9** ppShader) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI SetPixelShader(IDirect3DPixelShader9* pShader) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI GetPixelShader(IDirect3DPixelShader9** ppShader) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI SetVertexDeclaration(IDirect3DVertexDeclaration9* pDecl) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI GetVertexDeclaration(IDirect3DVertexDeclaration9** ppDecl) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI SetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9* pRenderTarget) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI GetRenderTarget(DWORD RenderTargetIndex, IDirect3DSurface9** ppRenderTarget) { return E_NOTIMPL; }
+	virtual HRESULT WINAPI StretchRect(IDirect3DSurface9* pSourceSurface, const RECT* pSourceRect, IDirect3DSurface9* pDestSurface, const RECT* pDestRect, D3DTEXTUREFILTERTYPE Filter) { return E_NOTIMPL; }
+};
+
+#endif
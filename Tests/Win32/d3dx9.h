@@ -0,0 +1,219 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <d3dx9.h> :
+D3DX 9 declarations used by the unit tested classes (Tests/CMakeLists.txt), 
+interfaces are only declared, the math functions are implemented inline.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef VIREIO_TEST_D3DX9_H_INCLUDED
+#define VIREIO_TEST_D3DX9_H_INCLUDED
+
+#include <d3d9.h>
+#include <math.h>
+
+/**
+* June 2010 DirectX SDK.
+***/
+#define D3DX_SDK_VERSION 43
+
+struct D3DXMACRO
+{
+	LPCSTR Name;
+	LPCSTR Definition;
+};
+
+struct ID3DXEffect;
+struct ID3DXBuffer;
+typedef ID3DXEffect* LPD3DXEFFECT;
+typedef ID3DXBuffer* LPD3DXBUFFER;
+
+#define D3DX_PI 3.141592654f
+#define D3DXToRadian(degree) ((degree) * (D3DX_PI / 180.0f))
+
+struct D3DXVECTOR3
+{
+	D3DXVECTOR3() {}
+	D3DXVECTOR3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+	float x, y, z;
+};
+
+struct D3DXVECTOR4
+{
+	D3DXVECTOR4() {}
+	D3DXVECTOR4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+	float x, y, z, w;
+};
+
+/**
+* Row major matrix, row vectors (v' = v * M), as D3DX.
+***/
+struct D3DXMATRIX : public D3DMATRIX
+{
+	D3DXMATRIX() {}
+	D3DXMATRIX(const D3DMATRIX& mat) : D3DMATRIX(mat) {}
+	D3DXMATRIX(float f11, float f12, float f13, float f14,
+		float f21, float f22, float f23, float f24,
+		float f31, float f32, float f33, float f34,
+		float f41, float f42, float f43, float f44)
+	{
+		_11 = f11; _12 = f12; _13 = f13; _14 = f14;
+		_21 = f21; _22 = f22; _23 = f23; _24 = f24;
+		_31 = f31; _32 = f32; _33 = f33; _34 = f34;
+		_41 = f41; _42 = f42; _43 = f43; _44 = f44;
+	}
+
+	float& operator () (UINT row, UINT col) {return m[row][col];}
+	float operator () (UINT row, UINT col) const {return m[row][col];}
+
+	D3DXMATRIX operator * (const D3DXMATRIX& mat) const
+	{
+		D3DXMATRIX out;
+		for (int row = 0; row < 4; row++)
+			for (int col = 0; col < 4; col++)
+				out.m[row][col] = m[row][0] * mat.m[0][col] + m[row][1] * mat.m[1][col] +
+					m[row][2] * mat.m[2][col] + m[row][3] * mat.m[3][col];
+		return out;
+	}
+	D3DXMATRIX& operator *= (const D3DXMATRIX& mat) {return *this = *this * mat;}
+};
+
+inline D3DXMATRIX* D3DXMatrixIdentity(D3DXMATRIX* pOut)
+{
+	*pOut = D3DXMATRIX(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixMultiply(D3DXMATRIX* pOut, const D3DXMATRIX* pM1, const D3DXMATRIX* pM2)
+{
+	*pOut = *pM1 * *pM2;
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixTranslation(D3DXMATRIX* pOut, float x, float y, float z)
+{
+	*pOut = D3DXMATRIX(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, y, z, 1);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixScaling(D3DXMATRIX* pOut, float sx, float sy, float sz)
+{
+	*pOut = D3DXMATRIX(sx, 0, 0, 0, 0, sy, 0, 0, 0, 0, sz, 0, 0, 0, 0, 1);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixRotationX(D3DXMATRIX* pOut, float angle)
+{
+	float c = cosf(angle), s = sinf(angle);
+	*pOut = D3DXMATRIX(1, 0, 0, 0, 0, c, s, 0, 0, -s, c, 0, 0, 0, 0, 1);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixRotationY(D3DXMATRIX* pOut, float angle)
+{
+	float c = cosf(angle), s = sinf(angle);
+	*pOut = D3DXMATRIX(c, 0, -s, 0, 0, 1, 0, 0, s, 0, c, 0, 0, 0, 0, 1);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixRotationZ(D3DXMATRIX* pOut, float angle)
+{
+	float c = cosf(angle), s = sinf(angle);
+	*pOut = D3DXMATRIX(c, s, 0, 0, -s, c, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixPerspectiveFovLH(D3DXMATRIX* pOut, float fovy, float aspect, float zn, float zf)
+{
+	float yScale = 1.0f / tanf(fovy / 2.0f);
+	float xScale = yScale / aspect;
+	*pOut = D3DXMATRIX(xScale, 0, 0, 0, 0, yScale, 0, 0, 0, 0, zf / (zf - zn), 1, 0, 0, -zn * zf / (zf - zn), 0);
+	return pOut;
+}
+
+inline D3DXMATRIX* D3DXMatrixPerspectiveOffCenterLH(D3DXMATRIX* pOut, float l, float r, float b, float t, float zn, float zf)
+{
+	*pOut = D3DXMATRIX(2 * zn / (r - l), 0, 0, 0, 0, 2 * zn / (t - b), 0, 0,
+		(l + r) / (l - r), (t + b) / (b - t), zf / (zf - zn), 1, 0, 0, zn * zf / (zn - zf), 0);
+	return pOut;
+}
+
+/**
+* Gauss-Jordan inversion, NULL if the matrix is singular.
+***/
+inline D3DXMATRIX* D3DXMatrixInverse(D3DXMATRIX* pOut, float* pDeterminant, const D3DXMATRIX* pM)
+{
+	double a[4][8];
+	for (int row = 0; row < 4; row++)
+		for (int col = 0; col < 4; col++)
+		{
+			a[row][col] = pM->m[row][col];
+			a[row][col + 4] = (row == col) ? 1.0 : 0.0;
+		}
+
+	double determinant = 1.0;
+	for (int col = 0; col < 4; col++)
+	{
+		int pivot = col;
+		for (int row = col + 1; row < 4; row++)
+			if (fabs(a[row][col]) > fabs(a[pivot][col]))
+				pivot = row;
+		if (a[pivot][col] == 0.0)
+			return NULL;
+		if (pivot != col)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				double swap = a[col][i]; a[col][i] = a[pivot][i]; a[pivot][i] = swap;
+			}
+			determinant = -determinant;
+		}
+
+		double diagonal = a[col][col];
+		determinant *= diagonal;
+		for (int i = 0; i < 8; i++)
+			a[col][i] /= diagonal;
+		for (int row = 0; row < 4; row++)
+		{
+			if (row == col)
+				continue;
+			double factor = a[row][col];
+			for (int i = 0; i < 8; i++)
+				a[row][i] -= factor * a[col][i];
+		}
+	}
+
+	for (int row = 0; row < 4; row++)
+		for (int col = 0; col < 4; col++)
+			pOut->m[row][col] = (float)a[row][col + 4];
+	if (pDeterminant)
+		*pDeterminant = (float)determinant;
+	return pOut;
+}
+
+inline D3DXVECTOR3* D3DXVec3TransformNormal(D3DXVECTOR3* pOut, const D3DXVECTOR3* pV, const D3DXMATRIX* pM)
+{
+	D3DXVECTOR3 v = *pV;
+	pOut->x = v.x * pM->_11 + v.y * pM->_21 + v.z * pM->_31;
+	pOut->y = v.x * pM->_12 + v.y * pM->_22 + v.z * pM->_32;
+	pOut->z = v.x * pM->_13 + v.y * pM->_23 + v.z * pM->_33;
+	return pOut;
+}
+
+#endif
@@ -0,0 +1,598 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <windows.h> :
+Win32 subset for building the platform independent classes and their unit tests on 
+non Windows hosts (Tests/CMakeLists.txt). Not used by the Visual Studio projects.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef VIREIO_TEST_WINDOWS_H_INCLUDED
+#define VIREIO_TEST_WINDOWS_H_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*** basic types (LLP64 sizes) ***/
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef long long LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef unsigned long long UINT64;
+typedef int INT;
+typedef unsigned int UINT;
+typedef int BOOL;
+typedef int32_t HRESULT;
+typedef void* HANDLE;
+typedef void* LPVOID;
+typedef void* PVOID;
+typedef const char* LPCSTR;
+typedef char* LPSTR;
+typedef const char* LPCTSTR;
+typedef char* LPTSTR;
+typedef void* HKEY;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define WINAPI
+#define __declspec(attribute)
+#define TEXT(text) text
+#define MAXLONG 0x7fffffff
+
+#define S_OK ((HRESULT)0)
+#define S_FALSE ((HRESULT)1)
+#define E_NOTIMPL ((HRESULT)0x80004001)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000E)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+#define ZeroMemory(p, size) memset((p), 0, (size))
+
+typedef intptr_t INT_PTR;
+typedef uintptr_t UINT_PTR;
+typedef uintptr_t ULONG_PTR;
+
+typedef union _LARGE_INTEGER
+{
+	struct { DWORD LowPart; LONG HighPart; };
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct tagRECT
+{
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+} RECT;
+
+typedef struct _FILETIME
+{
+	DWORD dwLowDateTime;
+	DWORD dwHighDateTime;
+} FILETIME;
+
+inline LONG CompareFileTime(const FILETIME* pTime1, const FILETIME* pTime2)
+{
+	ULONGLONG time1 = ((ULONGLONG)pTime1->dwHighDateTime << 32) | pTime1->dwLowDateTime;
+	ULONGLONG time2 = ((ULONGLONG)pTime2->dwHighDateTime << 32) | pTime2->dwLowDateTime;
+	return (time1 < time2) ? -1 : ((time1 > time2) ? 1 : 0);
+}
+
+/*** interlocked (full barrier) ***/
+inline LONG InterlockedIncrement(volatile LONG* p) { return __sync_add_and_fetch(p, 1); }
+inline LONG InterlockedDecrement(volatile LONG* p) { return __sync_sub_and_fetch(p, 1); }
+inline LONG InterlockedExchange(volatile LONG* p, LONG value) { __sync_synchronize(); return __sync_lock_test_and_set(p, value); }
+inline LONG InterlockedExchangeAdd(volatile LONG* p, LONG value) { return __sync_fetch_and_add(p, value); }
+inline LONG InterlockedCompareExchange(volatile LONG* p, LONG exchange, LONG comparand) { return __sync_val_compare_and_swap(p, comparand, exchange); }
+inline LONGLONG InterlockedExchange64(volatile LONGLONG* p, LONGLONG value) { __sync_synchronize(); return __sync_lock_test_and_set(p, value); }
+inline LONGLONG InterlockedCompareExchange64(volatile LONGLONG* p, LONGLONG exchange, LONGLONG comparand) { return __sync_val_compare_and_swap(p, comparand, exchange); }
+inline PVOID InterlockedExchangePointer(PVOID volatile* p, PVOID value) { __sync_synchronize(); return __sync_lock_test_and_set(p, value); }
+#define MemoryBarrier() __sync_synchronize()
+#define _ReadBarrier() __asm__ __volatile__("" ::: "memory")
+#define _WriteBarrier() __asm__ __volatile__("" ::: "memory")
+#define _ReadWriteBarrier() __asm__ __volatile__("" ::: "memory")
+#define YieldProcessor() sched_yield()
+
+/*** time, ticks are nanoseconds ***/
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* pCount)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	pCount->QuadPart = (LONGLONG)now.tv_sec * 1000000000LL + now.tv_nsec;
+	return TRUE;
+}
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* pFrequency) { pFrequency->QuadPart = 1000000000LL; return TRUE; }
+inline DWORD GetTickCount() { LARGE_INTEGER t; QueryPerformanceCounter(&t); return (DWORD)(t.QuadPart / 1000000LL); }
+inline void Sleep(DWORD milliseconds) { usleep((useconds_t)milliseconds * 1000); }
+
+/*** process, thread ids and thread local storage ***/
+#define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#define VIREIO_TEST_TLS_SLOTS 64
+inline DWORD GetCurrentProcessId() { return (DWORD)getpid(); }
+inline DWORD GetCurrentThreadId() { return (DWORD)syscall(SYS_gettid); }
+inline LPVOID* TlsSlots() { static __thread LPVOID slots[VIREIO_TEST_TLS_SLOTS]; return slots; }
+inline DWORD TlsAlloc()
+{
+	static volatile LONG count = 0;
+	LONG index = InterlockedIncrement(&count) - 1;
+	return (index < VIREIO_TEST_TLS_SLOTS) ? (DWORD)index : TLS_OUT_OF_INDEXES;
+}
+inline LPVOID TlsGetValue(DWORD index) { return TlsSlots()[index]; }
+inline BOOL TlsSetValue(DWORD index, LPVOID value) { TlsSlots()[index] = value; return TRUE; }
+
+/*** debug output, to stderr ***/
+inline void OutputDebugString(const char* text) { fputs(text, stderr); }
+
+/*** waitable objects : events, semaphores, threads ***/
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+#define WAIT_FAILED ((DWORD)0xFFFFFFFF)
+#define STILL_ACTIVE 259
+#define THREAD_PRIORITY_LOWEST (-2)
+#define THREAD_PRIORITY_BELOW_NORMAL (-1)
+#define THREAD_PRIORITY_NORMAL 0
+#define THREAD_PRIORITY_ABOVE_NORMAL 1
+#define THREAD_PRIORITY_HIGHEST 2
+#define THREAD_PRIORITY_TIME_CRITICAL 15
+
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(LPVOID);
+
+namespace vireio_win32
+{
+	/**
+	* Waitable object, all state guarded by Lock().
+	***/
+	struct Object
+	{
+		enum Kind { EVENT, SEMAPHORE, THREAD, MAPPING } kind;
+		bool manualReset;
+		bool signaled;
+		LONG count;
+		LONG maximumCount;
+		DWORD exitCode;
+		LONG references;
+		std::thread thread;
+		std::string name;
+		std::vector<char> memory;
+	};
+
+	inline std::mutex& Lock() { static std::mutex lock; return lock; }
+	inline std::condition_variable& Signal() { static std::condition_variable signal; return signal; }
+
+	inline bool IsSignaled(Object* pObject)
+	{
+		return (pObject->kind == Object::SEMAPHORE) ? (pObject->count > 0) : pObject->signaled;
+	}
+
+	inline void Acquire(Object* pObject)
+	{
+		if (pObject->kind == Object::SEMAPHORE)
+			pObject->count--;
+		else if ((pObject->kind == Object::EVENT) && !pObject->manualReset)
+			pObject->signaled = false;
+	}
+
+	/**
+	* Drops a reference (lock held), the thread of a closed thread object is detached.
+	***/
+	inline std::map<std::string, Object*>& Mappings() { static std::map<std::string, Object*> mappings; return mappings; }
+
+	inline void Release(Object* pObject)
+	{
+		if (--pObject->references > 0)
+			return;
+		if (pObject->thread.joinable())
+			pObject->thread.detach();
+		if (!pObject->name.empty())
+			Mappings().erase(pObject->name);
+		delete pObject;
+	}
+
+	inline Object* NewObject(Object::Kind kind)
+	{
+		Object* pObject = new Object();
+		pObject->kind = kind;
+		pObject->manualReset = false;
+		pObject->signaled = false;
+		pObject->count = 0;
+		pObject->maximumCount = 0;
+		pObject->exitCode = STILL_ACTIVE;
+		pObject->references = 1;
+		return pObject;
+	}
+
+	/**
+	* Waits until the predicate is true (lock held), INFINITE or milliseconds.
+	***/
+	template <typename Predicate> inline bool WaitFor(std::unique_lock<std::mutex>& lock, DWORD milliseconds, Predicate ready)
+	{
+		if (milliseconds == INFINITE)
+		{
+			Signal().wait(lock, ready);
+			return true;
+		}
+		return Signal().wait_for(lock, std::chrono::milliseconds(milliseconds), ready);
+	}
+}
+
+namespace vireio_win32
+{
+	/**
+	* CreateEvent() calls left to fail, for the tests of the cleanup when no event is created.
+	***/
+	inline LONG& EventFailures() { static LONG failures = 0; return failures; }
+}
+
+inline HANDLE CreateEvent(void* pAttributes, BOOL manualReset, BOOL initialState, LPCSTR name)
+{
+	if (vireio_win32::EventFailures() > 0)
+	{
+		vireio_win32::EventFailures()--;
+		return NULL;
+	}
+	vireio_win32::Object* pObject = vireio_win32::NewObject(vireio_win32::Object::EVENT);
+	pObject->manualReset = (manualReset != FALSE);
+	pObject->signaled = (initialState != FALSE);
+	return pObject;
+}
+
+inline BOOL SetEvent(HANDLE hEvent)
+{
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	((vireio_win32::Object*)hEvent)->signaled = true;
+	vireio_win32::Signal().notify_all();
+	return TRUE;
+}
+
+inline BOOL ResetEvent(HANDLE hEvent)
+{
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	((vireio_win32::Object*)hEvent)->signaled = false;
+	return TRUE;
+}
+
+inline HANDLE CreateSemaphore(void* pAttributes, LONG initialCount, LONG maximumCount, LPCSTR name)
+{
+	vireio_win32::Object* pObject = vireio_win32::NewObject(vireio_win32::Object::SEMAPHORE);
+	pObject->count = initialCount;
+	pObject->maximumCount = maximumCount;
+	return pObject;
+}
+
+inline BOOL ReleaseSemaphore(HANDLE hSemaphore, LONG releaseCount, LONG* pPreviousCount)
+{
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	vireio_win32::Object* pObject = (vireio_win32::Object*)hSemaphore;
+	if (pPreviousCount)
+		*pPreviousCount = pObject->count;
+	if (pObject->count + releaseCount > pObject->maximumCount)
+		return FALSE;
+	pObject->count += releaseCount;
+	vireio_win32::Signal().notify_all();
+	return TRUE;
+}
+
+namespace vireio_win32
+{
+	/**
+	* CreateThread() calls left to fail, for the tests of the fallbacks when no thread starts.
+	***/
+	inline LONG& ThreadFailures() { static LONG failures = 0; return failures; }
+}
+
+inline HANDLE CreateThread(void* pAttributes, size_t stackSize, LPTHREAD_START_ROUTINE pStart, LPVOID pParam, DWORD flags, DWORD* pThreadId)
+{
+	if (vireio_win32::ThreadFailures() > 0)
+	{
+		vireio_win32::ThreadFailures()--;
+		return NULL;
+	}
+	vireio_win32::Object* pObject = vireio_win32::NewObject(vireio_win32::Object::THREAD);
+	pObject->references = 2;
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	pObject->thread = std::thread([pObject, pStart, pParam]()
+	{
+		DWORD exitCode = pStart(pParam);
+		std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+		pObject->exitCode = exitCode;
+		pObject->signaled = true;
+		vireio_win32::Signal().notify_all();
+		vireio_win32::Release(pObject);
+	});
+	if (pThreadId)
+		*pThreadId = 0;
+	return pObject;
+}
+
+inline BOOL SetThreadPriority(HANDLE hThread, int priority) { return TRUE; }
+
+inline BOOL GetExitCodeThread(HANDLE hThread, DWORD* pExitCode)
+{
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	*pExitCode = ((vireio_win32::Object*)hThread)->exitCode;
+	return TRUE;
+}
+
+inline BOOL CloseHandle(HANDLE hObject)
+{
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	vireio_win32::Release((vireio_win32::Object*)hObject);
+	return TRUE;
+}
+
+inline DWORD WaitForSingleObject(HANDLE hObject, DWORD milliseconds)
+{
+	vireio_win32::Object* pObject = (vireio_win32::Object*)hObject;
+	std::unique_lock<std::mutex> lock(vireio_win32::Lock());
+	if (!vireio_win32::WaitFor(lock, milliseconds, [pObject]() { return vireio_win32::IsSignaled(pObject); }))
+		return WAIT_TIMEOUT;
+	vireio_win32::Acquire(pObject);
+	return WAIT_OBJECT_0;
+}
+
+inline DWORD WaitForMultipleObjects(DWORD count, const HANDLE* pHandles, BOOL waitAll, DWORD milliseconds)
+{
+	std::unique_lock<std::mutex> lock(vireio_win32::Lock());
+	DWORD signaled = 0;
+	bool ready = vireio_win32::WaitFor(lock, milliseconds, [&]()
+	{
+		for (DWORD i = 0; i < count; i++)
+		{
+			bool isSignaled = vireio_win32::IsSignaled((vireio_win32::Object*)pHandles[i]);
+			if (!waitAll && isSignaled)
+			{
+				signaled = i;
+				return true;
+			}
+			if (waitAll && !isSignaled)
+				return false;
+		}
+		return (waitAll != FALSE);
+	});
+	if (!ready)
+		return WAIT_TIMEOUT;
+
+	for (DWORD i = 0; i < count; i++)
+	{
+		if (waitAll || (i == signaled))
+			vireio_win32::Acquire((vireio_win32::Object*)pHandles[i]);
+	}
+	return WAIT_OBJECT_0 + signaled;
+}
+
+/*** file mappings (process local, named mappings are shared until the last handle is closed) ***/
+#define INVALID_HANDLE_VALUE ((HANDLE)(INT_PTR)-1)
+#define PAGE_READWRITE 0x04
+#define FILE_MAP_ALL_ACCESS 0xF001F
+#define FILE_MAP_READ 0x0004
+
+inline HANDLE CreateFileMapping(HANDLE hFile, void* pAttributes, DWORD protect, DWORD sizeHigh, DWORD sizeLow, LPCSTR name)
+{
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	if (name && vireio_win32::Mappings().count(name))
+	{
+		// an existing mapping keeps its size
+		vireio_win32::Object* pObject = vireio_win32::Mappings()[name];
+		pObject->references++;
+		return pObject;
+	}
+
+	vireio_win32::Object* pObject = vireio_win32::NewObject(vireio_win32::Object::MAPPING);
+	pObject->memory.assign(sizeLow, 0);
+	if (name)
+	{
+		pObject->name = name;
+		vireio_win32::Mappings()[name] = pObject;
+	}
+	return pObject;
+}
+
+inline HANDLE OpenFileMapping(DWORD access, BOOL inherit, LPCSTR name)
+{
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	if (!vireio_win32::Mappings().count(name))
+		return NULL;
+	vireio_win32::Object* pObject = vireio_win32::Mappings()[name];
+	pObject->references++;
+	return pObject;
+}
+
+/**
+* Views fail if they are larger than the mapping, the view stays valid while the mapping is open.
+***/
+inline LPVOID MapViewOfFile(HANDLE hMapping, DWORD access, DWORD offsetHigh, DWORD offsetLow, size_t size)
+{
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	vireio_win32::Object* pObject = (vireio_win32::Object*)hMapping;
+	if (offsetLow + size > pObject->memory.size())
+		return NULL;
+	return &pObject->memory[offsetLow];
+}
+
+inline BOOL UnmapViewOfFile(const void* pView) { return TRUE; }
+
+/*** files ***/
+#define MOVEFILE_REPLACE_EXISTING 0x00000001
+#define MOVEFILE_WRITE_THROUGH 0x00000008
+
+typedef enum _GET_FILEEX_INFO_LEVELS
+{
+	GetFileExInfoStandard
+} GET_FILEEX_INFO_LEVELS;
+
+typedef struct _WIN32_FILE_ATTRIBUTE_DATA
+{
+	DWORD dwFileAttributes;
+	FILETIME ftCreationTime;
+	FILETIME ftLastAccessTime;
+	FILETIME ftLastWriteTime;
+	DWORD nFileSizeHigh;
+	DWORD nFileSizeLow;
+} WIN32_FILE_ATTRIBUTE_DATA;
+
+/**
+* Size and last write time (100 ns units, Unix epoch) only.
+***/
+inline BOOL GetFileAttributesEx(LPCSTR fileName, GET_FILEEX_INFO_LEVELS level, void* pInfo)
+{
+	struct stat status;
+	if (stat(fileName, &status) != 0)
+		return FALSE;
+	WIN32_FILE_ATTRIBUTE_DATA* pData = (WIN32_FILE_ATTRIBUTE_DATA*)pInfo;
+	memset(pData, 0, sizeof(WIN32_FILE_ATTRIBUTE_DATA));
+	ULONGLONG time = (ULONGLONG)status.st_mtim.tv_sec * 10000000ULL + status.st_mtim.tv_nsec / 100;
+	pData->ftLastWriteTime.dwLowDateTime = (DWORD)time;
+	pData->ftLastWriteTime.dwHighDateTime = (DWORD)(time >> 32);
+	pData->nFileSizeHigh = (DWORD)((ULONGLONG)status.st_size >> 32);
+	pData->nFileSizeLow = (DWORD)status.st_size;
+	return TRUE;
+}
+
+/**
+* rename() replaces the target atomically, like MOVEFILE_REPLACE_EXISTING on one volume.
+***/
+inline BOOL MoveFileEx(LPCSTR existingFileName, LPCSTR newFileName, DWORD flags)
+{
+	if (!(flags & MOVEFILE_REPLACE_EXISTING) && (access(newFileName, F_OK) == 0))
+		return FALSE;
+	return (rename(existingFileName, newFileName) == 0) ? TRUE : FALSE;
+}
+
+inline BOOL DeleteFile(LPCSTR fileName) { return (unlink(fileName) == 0) ? TRUE : FALSE; }
+
+/*** critical sections (recursive) ***/
+struct CRITICAL_SECTION
+{
+	std::recursive_mutex* pMutex;
+};
+
+inline void InitializeCriticalSection(CRITICAL_SECTION* pSection) { pSection->pMutex = new std::recursive_mutex(); }
+inline void DeleteCriticalSection(CRITICAL_SECTION* pSection) { delete pSection->pMutex; pSection->pMutex = NULL; }
+inline void EnterCriticalSection(CRITICAL_SECTION* pSection) { pSection->pMutex->lock(); }
+inline void LeaveCriticalSection(CRITICAL_SECTION* pSection) { pSection->pMutex->unlock(); }
+inline BOOL TryEnterCriticalSection(CRITICAL_SECTION* pSection) { return pSection->pMutex->try_lock() ? TRUE : FALSE; }
+
+/*** system ***/
+struct SYSTEM_INFO
+{
+	DWORD dwNumberOfProcessors;
+};
+
+namespace vireio_win32
+{
+	/**
+	* Processors reported by GetSystemInfo(), the host's if 0. Lets the tests run several
+	* workers on single processor hosts.
+	***/
+	inline DWORD& ProcessorCount() { static DWORD processors = 0; return processors; }
+}
+
+inline void GetSystemInfo(SYSTEM_INFO* pInfo)
+{
+	unsigned int processors = vireio_win32::ProcessorCount() ? vireio_win32::ProcessorCount() : std::thread::hardware_concurrency();
+	pInfo->dwNumberOfProcessors = (processors > 0) ? processors : 1;
+}
+
+/*** input (SendInput() does nothing) ***/
+#define INPUT_MOUSE 0
+#define MOUSEEVENTF_MOVE 0x0001
+
+struct MOUSEINPUT
+{
+	LONG dx;
+	LONG dy;
+	DWORD mouseData;
+	DWORD dwFlags;
+	DWORD time;
+	ULONG_PTR dwExtraInfo;
+};
+
+struct INPUT
+{
+	DWORD type;
+	union
+	{
+		MOUSEINPUT mi;
+	};
+};
+
+inline UINT SendInput(UINT count, INPUT* pInputs, int size) { return count; }
+
+/*** multimedia timer resolution (mmsystem.h) ***/
+#define TIMERR_NOERROR 0
+inline UINT timeBeginPeriod(UINT period) { return TIMERR_NOERROR; }
+inline UINT timeEndPeriod(UINT period) { return TIMERR_NOERROR; }
+
+/*** secure CRT ***/
+#define vsnprintf_s vsnprintf
+#define _TRUNCATE ((size_t)-1)
+#define _stricmp strcasecmp
+#include <strings.h>
+
+inline int fopen_s(FILE** ppFile, const char* fileName, const char* mode)
+{
+	*ppFile = fopen(fileName, mode);
+	return *ppFile ? 0 : 1;
+}
+
+/**
+* _snprintf_s with _TRUNCATE : -1 if the text was truncated.
+***/
+inline int _snprintf_s(char* buffer, size_t bufferSize, size_t count, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int result = vsnprintf(buffer, bufferSize, format, args);
+	va_end(args);
+	return ((result < 0) || ((size_t)result >= bufferSize)) ? -1 : result;
+}
+
+template <size_t size> inline int sprintf_s(char (&buffer)[size], const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int result = vsnprintf(buffer, size, format, args);
+	va_end(args);
+	return result;
+}
+
+#endif
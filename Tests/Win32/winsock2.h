@@ -0,0 +1,139 @@
+/********************************************************************
+Vireio Perception: Open-Source Stereoscopic 3D Driver
+Copyright (C) 2012 Andres Hernandez
+
+File <winsock2.h> :
+Winsock subset on BSD sockets for the unit tests (Tests/CMakeLists.txt).
+Event selects are emulated by a thread polling the socket.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+********************************************************************/
+
+#ifndef VIREIO_TEST_WINSOCK2_H_INCLUDED
+#define VIREIO_TEST_WINSOCK2_H_INCLUDED
+
+#include <windows.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <atomic>
+
+typedef int SOCKET;
+typedef unsigned short u_short;
+typedef HANDLE WSAEVENT;
+
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR (-1)
+#define WSA_INVALID_EVENT ((WSAEVENT)NULL)
+#define FD_READ 0x01
+#define WSAEWOULDBLOCK 10035
+#define WSAECONNRESET 10054
+#define MAKEWORD(low, high) ((WORD)(((BYTE)(low)) | (((WORD)((BYTE)(high))) << 8)))
+
+struct WSADATA
+{
+	WORD wVersion;
+	WORD wHighVersion;
+};
+
+inline int WSAStartup(WORD version, WSADATA* pData)
+{
+	pData->wVersion = version;
+	pData->wHighVersion = version;
+	return 0;
+}
+
+inline int WSACleanup() { return 0; }
+inline int WSAGetLastError() { return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? WSAEWOULDBLOCK : errno; }
+inline int closesocket(SOCKET s) { return (s == INVALID_SOCKET) ? SOCKET_ERROR : close(s); }
+
+namespace vireio_win32
+{
+	/**
+	* Event select : sets the event while the socket is readable, until the event is closed.
+	***/
+	struct EventSelect
+	{
+		std::atomic<bool> stop;
+		std::thread thread;
+	};
+
+	inline std::map<WSAEVENT, EventSelect*>& EventSelects() { static std::map<WSAEVENT, EventSelect*> selects; return selects; }
+
+	inline void StopEventSelect(WSAEVENT hEvent)
+	{
+		EventSelect* pSelect = NULL;
+		{
+			std::lock_guard<std::mutex> lock(Lock());
+			if (EventSelects().count(hEvent))
+			{
+				pSelect = EventSelects()[hEvent];
+				EventSelects().erase(hEvent);
+			}
+		}
+		if (pSelect)
+		{
+			pSelect->stop = true;
+			pSelect->thread.join();
+			delete pSelect;
+		}
+	}
+}
+
+inline WSAEVENT WSACreateEvent() { return CreateEvent(NULL, TRUE, FALSE, NULL); }
+inline BOOL WSAResetEvent(WSAEVENT hEvent) { return ResetEvent(hEvent); }
+
+inline BOOL WSACloseEvent(WSAEVENT hEvent)
+{
+	vireio_win32::StopEventSelect(hEvent);
+	return CloseHandle(hEvent);
+}
+
+/**
+* Makes the socket non-blocking, FD_READ only.
+***/
+inline int WSAEventSelect(SOCKET s, WSAEVENT hEvent, long events)
+{
+	vireio_win32::StopEventSelect(hEvent);
+	if (fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) != 0)
+		return SOCKET_ERROR;
+
+	vireio_win32::EventSelect* pSelect = new vireio_win32::EventSelect();
+	pSelect->stop = false;
+	pSelect->thread = std::thread([pSelect, s, hEvent]()
+	{
+		while (!pSelect->stop)
+		{
+			pollfd readable;
+			readable.fd = s;
+			readable.events = POLLIN;
+			readable.revents = 0;
+			if ((poll(&readable, 1, 5) > 0) && (readable.revents & POLLIN))
+			{
+				SetEvent(hEvent);
+				Sleep(1);
+			}
+		}
+	});
+
+	std::lock_guard<std::mutex> lock(vireio_win32::Lock());
+	vireio_win32::EventSelects()[hEvent] = pSelect;
+	return 0;
+}
+
+#endif